@@ -3,6 +3,7 @@
 #include <vurl/vulkan_header.hpp>
 #include <iostream>
 #include <cstring>
+#include <cstdio>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/rotate_vector.hpp>
 
@@ -106,6 +107,7 @@ void Application::Uninitialize() {
 
 void Application::Run() {
     float speed = 1.0f;
+    uint32_t frameCount = 0;
 
     while (!glfwWindowShouldClose(window)) {
         glm::vec3 cameraDirection = scene->GetCameraDirection();
@@ -148,6 +150,14 @@ void Application::Run() {
         scene->SetCameraPosition(position);
 
         scene->Draw();
+
+        //Report how much geometry the cluster cull removes
+        if (++frameCount % 60 == 0) {
+            char title[128];
+            snprintf(title, sizeof(title), "vurl example - %.1f%% triangles culled", scene->GetCulledTriangleRatio() * 100.0f);
+            glfwSetWindowTitle(window, title);
+        }
+
         xMouseDelta = 0;
         yMouseDelta = 0;
         glfwPollEvents();
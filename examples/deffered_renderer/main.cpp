@@ -7,7 +7,7 @@
 
 //Ugly function
 std::shared_ptr<Primitive> CreatePrimitive(std::shared_ptr<Scene> scene, tinygltf::Model& model, tinygltf::Primitive& gltfPrimitive) {
-    std::shared_ptr<Primitive> primitive = std::make_shared<Primitive>(scene->GetGraph());
+    std::shared_ptr<Primitive> primitive = std::make_shared<Primitive>();
 
     std::vector<Vertex> vertices{};
     std::vector<uint32_t> indices{};
@@ -56,6 +56,10 @@ std::shared_ptr<Primitive> CreatePrimitive(std::shared_ptr<Scene> scene, tinyglt
         vertices[i].position.y *= -1;
         vertices[i].normal = normalPtr[i];
     }
+
+    //Mirroring y flips the winding, restore it so cluster cones face outwards
+    for (size_t i = 0; i + 2 < indices.size(); i += 3)
+        std::swap(indices[i + 1], indices[i + 2]);
     
     primitive->SetVertices(vertices);
     primitive->SetIndices(indices);
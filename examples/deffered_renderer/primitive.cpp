@@ -1,36 +1,40 @@
 #include "primitive.hpp"
 
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <algorithm>
 
-Primitive::Primitive(std::shared_ptr<Vurl::RenderGraph> graph) : graph{ graph } {
-    vertexBuffer = graph->CreateBuffer<Vurl::Resource<Vurl::Buffer>>("Vertex Buffer", false);
-    indexBuffer = graph->CreateBuffer<Vurl::Resource<Vurl::Buffer>>("Index Buffer", false);
-
-    std::shared_ptr<Vurl::Buffer> vertexBufferSlice = std::make_shared<Vurl::Buffer>();
-    std::shared_ptr<Vurl::Buffer> indexBufferSlice = std::make_shared<Vurl::Buffer>();
-
-    vertexBufferSlice->usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-    indexBufferSlice->usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
-
-    vertexBuffer->SetSliceCount(1);
-    indexBuffer->SetSliceCount(1);
-    vertexBuffer->SetResourceSlice(vertexBufferSlice, 0);
-    indexBuffer->SetResourceSlice(indexBufferSlice, 0);
-}
-
-Primitive::~Primitive() {
-
-}
 
 void Primitive::SetVertices(std::vector<Vertex>& vertices) {
-    std::shared_ptr<Vurl::Buffer> vertexBufferSlice = vertexBuffer->GetResourceSlice(0);
-    vertexBufferSlice->size = vertices.size() * sizeof(Vertex);
-
-    graph->CommitBuffer(vertexBuffer, (const uint8_t*)vertices.data(), vertices.size() * sizeof(Vertex));
+    this->vertices = vertices;
+    if (vertices.empty()) {
+        boundingSphere = glm::vec4( 0.0f, 0.0f, 0.0f, 0.0f );
+        return;
+    }
+
+    //Sphere around the bounding box center, loose but cheap
+    glm::vec3 min = vertices[0].position;
+    glm::vec3 max = vertices[0].position;
+    for (const Vertex& vertex : vertices) {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+
+    glm::vec3 center = (min + max) * 0.5f;
+    float radius = 0.0f;
+    for (const Vertex& vertex : vertices)
+        radius = std::max(radius, glm::distance(center, vertex.position));
+
+    boundingSphere = glm::vec4(center, radius);
 }
 
 void Primitive::SetIndices(std::vector<uint32_t>& indices) {
-    std::shared_ptr<Vurl::Buffer> indexBufferSlice = indexBuffer->GetResourceSlice(0);
-    indexBufferSlice->size = indices.size() * sizeof(uint32_t);
-
-    graph->CommitBuffer(indexBuffer, (const uint8_t*)indices.data(), indices.size() * sizeof(uint32_t));
+    this->indices = indices;
 }
+
+void Primitive::BuildClusters(uint32_t maxTrianglesPerCluster) {
+    clusters.clear();
+    if (vertices.empty())
+        return;
+    Vurl::BuildClusters(&vertices[0].position.x, sizeof(Vertex), indices.data(), (uint32_t)indices.size(), maxTrianglesPerCluster, clusters);
+}
\ No newline at end of file
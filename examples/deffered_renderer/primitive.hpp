@@ -1,33 +1,45 @@
 #pragma once
 
 #include <glm/vec3.hpp>
-#include <vurl/buffer.hpp>
-#include <vurl/render_graph.hpp>
+#include <glm/vec4.hpp>
+#include <vurl/vertex_layout.hpp>
+#include <vurl/cluster.hpp>
 #include <vector>
 #include "material.hpp"
 
 
+template<> struct Vurl::VertexAttributeFormatTraits<glm::vec3> : Vurl::VertexAttributeFormatOf<Vurl::VertexInputAttributeFormat::Vector3> {};
+
 struct Vertex {
     glm::vec3 position;
     glm::vec3 normal;
 };
 
+using VertexLayout = Vurl::VertexLayout<Vertex, VURL_VERTEX_ATTRIBUTE(Vertex, position), VURL_VERTEX_ATTRIBUTE(Vertex, normal)>;
+
+//CPU-side geometry, the scene merges every primitive into shared geometry arena
 class Primitive {
 public:
-    Primitive(std::shared_ptr<Vurl::RenderGraph> graph);
-    ~Primitive();
+    Primitive() = default;
+    ~Primitive() = default;
 
     void SetVertices(std::vector<Vertex>& vertices);
     void SetIndices(std::vector<uint32_t>& indices);
+    //Split the indices into clusters for the cull pass, call after setting vertices and indices
+    void BuildClusters(uint32_t maxTrianglesPerCluster);
 
-    inline std::shared_ptr<Vurl::Resource<Vurl::Buffer>> GetVertexBuffer() const { return vertexBuffer; }
-    inline std::shared_ptr<Vurl::Resource<Vurl::Buffer>> GetIndexBuffer() const { return indexBuffer; }
+    inline const std::vector<Vertex>& GetVertices() const { return vertices; }
+    inline const std::vector<uint32_t>& GetIndices() const { return indices; }
+    //xyz is the center, w the radius
+    inline glm::vec4 GetBoundingSphere() const { return boundingSphere; }
+    inline const std::vector<Vurl::Cluster>& GetClusters() const { return clusters; }
 
     inline Material& GetMaterial() { return material; }
     
 private:
-    std::shared_ptr<Vurl::RenderGraph> graph = nullptr;
-    std::shared_ptr<Vurl::Resource<Vurl::Buffer>> vertexBuffer = nullptr;
-    std::shared_ptr<Vurl::Resource<Vurl::Buffer>> indexBuffer = nullptr;
+    std::vector<Vertex> vertices{};
+    std::vector<uint32_t> indices{};
+    std::vector<Vurl::Cluster> clusters{};
+    glm::vec4 boundingSphere = glm::vec4( 0.0f, 0.0f, 0.0f, 0.0f );
     Material material;
 };
\ No newline at end of file
@@ -7,24 +7,54 @@
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/scalar_constants.hpp>
+#include <algorithm>
+#include <cstring>
 
+//Empty scenes still need valid buffers to bind
+#define SCENE_MIN_BUFFER_SIZE 64
+#define SCENE_ARENA_VERTEX_CAPACITY (1 << 22)
+#define SCENE_ARENA_INDEX_CAPACITY (1 << 24)
 
-std::shared_ptr<Vurl::Shader> CreateShaderFromFile(const std::string& path, VkDevice device) {
-    std::vector<char> buffer{};
-    std::ifstream file{ path, std::ios::ate | std::ios::binary };
-    if (!file.is_open())
-        return nullptr;
 
-    size_t size = (size_t)file.tellg();
-    file.seekg(0);
-    buffer.resize(size);
-    file.read(buffer.data(), size);
-    file.close();
+bool PackShaderLibrary(const std::string& libraryPath, const std::vector<std::string>& names) {
+    Vurl::ShaderLibraryWriter writer{};
 
-    std::shared_ptr<Vurl::Shader> shader = std::make_shared<Vurl::Shader>(device);
-    shader->CreateShaderModule((const uint32_t*)buffer.data(), buffer.size());
+    for (const std::string& name : names) {
+        std::vector<char> buffer{};
+        std::ifstream file{ "shaders/" + name + ".spv", std::ios::ate | std::ios::binary };
+        if (!file.is_open())
+            return false;
 
-    return shader;
+        size_t size = (size_t)file.tellg();
+        file.seekg(0);
+        buffer.resize(size);
+        file.read(buffer.data(), size);
+        file.close();
+
+        if (writer.AddShader(name, (const uint32_t*)buffer.data(), (uint32_t)buffer.size()) != Vurl::VURL_SUCCESS)
+            return false;
+    }
+
+    return writer.Write(libraryPath);
+}
+
+std::shared_ptr<Vurl::Resource<Vurl::Buffer>> CreateSceneBuffer(std::shared_ptr<Vurl::RenderGraph> graph, const std::string& name, 
+        VkBufferUsageFlags usage, uint32_t sliceCount = 1, bool hostVisible = false) {
+    std::shared_ptr<Vurl::Resource<Vurl::Buffer>> buffer = graph->CreateBuffer<Vurl::Resource<Vurl::Buffer>>(name, false);
+    buffer->SetSliceCount(sliceCount);
+    for (uint32_t i = 0; i < sliceCount; ++i) {
+        std::shared_ptr<Vurl::Buffer> bufferSlice = std::make_shared<Vurl::Buffer>();
+        bufferSlice->usage = usage;
+        bufferSlice->hostVisible = hostVisible;
+        buffer->SetResourceSlice(bufferSlice, i);
+    }
+    return buffer;
+}
+
+void CommitSceneBuffer(std::shared_ptr<Vurl::RenderGraph> graph, std::shared_ptr<Vurl::Resource<Vurl::Buffer>> buffer, const void* data, size_t size) {
+    for (uint32_t i = 0; i < buffer->GetSliceCount(); ++i)
+        buffer->GetResourceSlice(i)->size = std::max(size, (size_t)SCENE_MIN_BUFFER_SIZE);
+    graph->CommitBuffer(buffer, size > 0 ? (const uint8_t*)data : nullptr, (uint32_t)size);
 }
 
 void Scene::Initialize() {
@@ -33,31 +63,43 @@ void Scene::Initialize() {
     graph->CreateTransientCommandPool();
     graph->SetSurface(surface);
 
-    //Mehs input description
-    Vurl::VertexInputDescription meshInputDescription{
-        { 0, Vurl::VertexInputAttributeFormat::Vector3 }, //Position
-        { 1, Vurl::VertexInputAttributeFormat::Vector3 }  //Normal
-    };
+    //Pack the compiled shaders once, later runs only map the library
+    const std::string shaderLibraryPath = "shaders/shaders.slib";
+    shaderLibrary = std::make_shared<Vurl::ShaderLibrary>(context->GetDevice());
+    if (shaderLibrary->Open(shaderLibraryPath) != Vurl::VURL_SUCCESS) {
+        PackShaderLibrary(shaderLibraryPath, { "gpass_vert", "gpass_frag", "lighting_vert", "lighting_frag", "cull_comp", "cluster_cull_comp" });
+        shaderLibrary->Open(shaderLibraryPath);
+    }
 
     //Build all graphics pipelines
     gPassPipeline = std::make_shared<Vurl::GraphicsPipeline>(context->GetDevice());
-    std::shared_ptr<Vurl::Shader> gPassVertexShader = CreateShaderFromFile("shaders/gpass_vert.spv", context->GetDevice());
-    std::shared_ptr<Vurl::Shader> gPassFragmentShader = CreateShaderFromFile("shaders/gpass_frag.spv", context->GetDevice());
+    std::shared_ptr<Vurl::Shader> gPassVertexShader = shaderLibrary->GetShader("gpass_vert");
+    std::shared_ptr<Vurl::Shader> gPassFragmentShader = shaderLibrary->GetShader("gpass_frag");
     gPassPipeline->SetVertexShader(gPassVertexShader);
     gPassPipeline->SetFragmentShader(gPassFragmentShader);
     gPassPipeline->SetPipelineCullMode(VK_CULL_MODE_NONE);
-    gPassPipeline->AddVertexInput(meshInputDescription);
-    gPassPipeline->AddPushConstantRange<MeshPushConstant>(VK_SHADER_STAGE_VERTEX_BIT);
+    gPassPipeline->SetDynamicStateFlags(Vurl::DYNAMIC_STATE_ALL);
+    gPassPipeline->AddVertexInput(VertexLayout::GetDescription());
+    gPassPipeline->AddPushConstantRange<GPassPushConstant>(VK_SHADER_STAGE_VERTEX_BIT);
     gPassPipeline->CreatePipelineLayout();
 
     lightingPassPipeline = std::make_shared<Vurl::GraphicsPipeline>(context->GetDevice());
-    std::shared_ptr<Vurl::Shader> lightingPassVertexShader = CreateShaderFromFile("shaders/lighting_vert.spv", context->GetDevice());
-    std::shared_ptr<Vurl::Shader> lightingPassFragmentShader = CreateShaderFromFile("shaders/lighting_frag.spv", context->GetDevice());
+    std::shared_ptr<Vurl::Shader> lightingPassVertexShader = shaderLibrary->GetShader("lighting_vert");
+    std::shared_ptr<Vurl::Shader> lightingPassFragmentShader = shaderLibrary->GetShader("lighting_frag");
     lightingPassPipeline->SetVertexShader(lightingPassVertexShader);
     lightingPassPipeline->SetFragmentShader(lightingPassFragmentShader);
     lightingPassPipeline->SetPipelineCullMode(VK_CULL_MODE_NONE);
+    lightingPassPipeline->SetDynamicStateFlags(Vurl::DYNAMIC_STATE_ALL);
     lightingPassPipeline->CreatePipelineLayout();
 
+    objectCullPipeline = std::make_shared<Vurl::ComputePipeline>(context->GetDevice());
+    objectCullPipeline->SetComputeShader(shaderLibrary->GetShader("cull_comp"));
+    objectCullPipeline->CreatePipelineLayout();
+
+    clusterCullPipeline = std::make_shared<Vurl::ComputePipeline>(context->GetDevice());
+    clusterCullPipeline->SetComputeShader(shaderLibrary->GetShader("cluster_cull_comp"));
+    clusterCullPipeline->CreatePipelineLayout();
+
     //Create resources
     std::shared_ptr<Vurl::Resource<Vurl::Texture>> depthStencilTarget = graph->CreateTexture<Vurl::Resource<Vurl::Texture>>("Depth Stencil Target", false);
     std::shared_ptr<Vurl::Texture> depthStencilTargetSlice = std::make_shared<Vurl::Texture>();
@@ -89,12 +131,56 @@ void Scene::Initialize() {
     normalTargetSlice->aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     graph->CommitTexture(normalTarget);
 
+    //Geometry lives in the arena buffers for the lifetime of the scene, the cull pass rebuilds the draw commands every frame
+    geometryArena = std::make_shared<Vurl::GeometryArena>(graph, "Geometry Arena", (uint32_t)sizeof(Vertex), 
+            SCENE_ARENA_VERTEX_CAPACITY, SCENE_ARENA_INDEX_CAPACITY, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    geometryArena->Create();
+    compactedIndexBuffer = CreateSceneBuffer(graph, "Compacted Index Buffer", VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    drawDataBuffer = CreateSceneBuffer(graph, "Draw Data Buffer", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    clusterBuffer = CreateSceneBuffer(graph, "Cluster Buffer", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    drawCommandTemplateBuffer = CreateSceneBuffer(graph, "Draw Command Template Buffer", VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    drawCommandBuffer = CreateSceneBuffer(graph, "Draw Command Buffer", 
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    drawCountBuffer = CreateSceneBuffer(graph, "Draw Count Buffer", 
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT);
+    drawCommandIndexBuffer = CreateSceneBuffer(graph, "Draw Command Index Buffer", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+    statisticsBuffer = CreateSceneBuffer(graph, "Cull Statistics Buffer", VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, 
+            VURL_MAX_FRAMES_IN_FLIGHT, true);
+
+    //Every command starts the frame empty and no draw is visible yet
+    std::shared_ptr<Vurl::TransferPass> resetDrawsPass = graph->CreateTransferPass("Reset Draws");
+    resetDrawsPass->CopyBuffer(drawCommandTemplateBuffer, drawCommandBuffer);
+    resetDrawsPass->FillBuffer(drawCountBuffer, 0);
+    resetDrawsPass->FillBuffer(statisticsBuffer, 0);
+
+    //Draws outside the frustum are rejected whole, the visible ones get a command without indices
+    std::shared_ptr<Vurl::ComputePass> objectCullPass = graph->CreateComputePass("Object Cull", objectCullPipeline);
+    objectCullPass->AddStorageBuffer(drawDataBuffer, 0, Vurl::ResourceAccessType::StorageRead);
+    objectCullPass->AddStorageBuffer(drawCommandBuffer, 1, Vurl::ResourceAccessType::StorageWrite);
+    objectCullPass->AddStorageBuffer(drawCountBuffer, 2, Vurl::ResourceAccessType::StorageReadWrite);
+    objectCullPass->AddStorageBuffer(drawCommandIndexBuffer, 3, Vurl::ResourceAccessType::StorageWrite);
+    objectCullPass->AddStorageBuffer(statisticsBuffer, 4, Vurl::ResourceAccessType::StorageReadWrite);
+    objectCullPass->SetDispatchCallback(std::bind(&Scene::ObjectCullDispatchCallback, this, std::placeholders::_1, std::placeholders::_2));
+
+    //Clusters of visible draws append their visible triangles to the draw's command
+    std::shared_ptr<Vurl::ComputePass> clusterCullPass = graph->CreateComputePass("Cluster Cull", clusterCullPipeline);
+    clusterCullPass->AddStorageBuffer(drawDataBuffer, 0, Vurl::ResourceAccessType::StorageRead);
+    clusterCullPass->AddStorageBuffer(clusterBuffer, 1, Vurl::ResourceAccessType::StorageRead);
+    clusterCullPass->AddStorageBuffer(geometryArena->GetIndexBuffer(), 2, Vurl::ResourceAccessType::StorageRead);
+    clusterCullPass->AddStorageBuffer(compactedIndexBuffer, 3, Vurl::ResourceAccessType::StorageWrite);
+    clusterCullPass->AddStorageBuffer(drawCommandBuffer, 4, Vurl::ResourceAccessType::StorageReadWrite);
+    clusterCullPass->AddStorageBuffer(statisticsBuffer, 5, Vurl::ResourceAccessType::StorageReadWrite);
+    clusterCullPass->AddStorageBuffer(drawCommandIndexBuffer, 6, Vurl::ResourceAccessType::StorageRead);
+    clusterCullPass->SetDispatchCallback(std::bind(&Scene::ClusterCullDispatchCallback, this, std::placeholders::_1, std::placeholders::_2));
+
     //Build all graphics passes
-    std::shared_ptr<Vurl::GraphicsPass> gPass = graph->CreateGraphicsPass("GPass", gPassPipeline);
+    gPass = graph->CreateGraphicsPass("GPass", gPassPipeline);
     gPass->AddColorAttachment(colorTarget);
     gPass->AddColorAttachment(normalTarget);
     gPass->ClearAttachment(0, VkClearColorValue{ 0.0f, 0.0f, 0.0f, 1.0f });
     gPass->SetDepthStencilAttachment(depthStencilTarget);
+    gPass->AddStorageBuffer(drawDataBuffer, 0, Vurl::ResourceAccessType::StorageRead);
+    gPass->SetIndexedIndirectDraw(drawCommandBuffer, nullptr, geometryArena->GetVertexBuffer(), compactedIndexBuffer, 1);
     gPass->SetRenderingCallback(std::bind(&Scene::GPassRenderingCallback, this, std::placeholders::_1, std::placeholders::_2));
 
     std::shared_ptr<Vurl::GraphicsPass> lightingPass = graph->CreateGraphicsPass("Lighting Pass", lightingPassPipeline);
@@ -103,19 +189,22 @@ void Scene::Initialize() {
     lightingPass->AddInputAttachment(colorTarget);
     lightingPass->AddInputAttachment(normalTarget);
     lightingPass->SetRenderingCallback(std::bind(&Scene::LightingPassRenderingCallback, this, std::placeholders::_1, std::placeholders::_2));
-
-    graph->Build();
 }
 
 void Scene::Uninitialize() {
     graph->Destroy();
+    graph->DestroyFrameResources();
     graph->DestroyTransientCommandPool();
     graph->DestroyPipelineCache();
+    shaderLibrary->Close();
 }
 
 void Scene::Draw() {
     view = glm::lookAt(position, position + direction, glm::vec3(0.0f, 1.0f, 0.0f));
     projection = glm::perspective(glm::radians(90.0f), (float)surface->GetWidth() / (float)surface->GetHeight(), 0.1f, 2000.0f);
+
+    if (geometryDirty)
+        BuildGeometry();
     //graph->Execute();
 }
 
@@ -126,17 +215,24 @@ void Scene::AddNode(std::shared_ptr<Node> node) {
 
 void Scene::ProcessNode(std::shared_ptr<Node> node) {
     if (node->GetMesh()) {
-        /*std::shared_ptr<Vurl::GraphicsPass> debugForwardPass = graph->GetPassByName<Vurl::GraphicsPass>("Debug Pass");
         std::shared_ptr<Mesh> mesh = node->GetMesh();
 
         for (uint32_t i = 0; i < mesh->GetPrimitiveCount(); ++i) {
             std::shared_ptr<Primitive> primitive = mesh->GetPrimitive(i);
+            if (!primitive)
+                continue;
 
-            debugForwardPass->AddBufferInput(primitive->GetVertexBuffer());
-            debugForwardPass->AddBufferInput(primitive->GetIndexBuffer());
+            //A cull workgroup handles one cluster, one triangle per invocation
+            primitive->BuildClusters(clusterCullPipeline->GetLocalSize(0));
 
+            Vurl::GeometryHandle geometry = AllocateGeometry(primitive);
+            if (geometry == VURL_NULL_HANDLE)
+                continue;
+
+            primitiveGeometry.push_back(geometry);
             primitives.push_back(primitive);
-        }*/
+            geometryDirty = true;
+        }
     }
 
     for (uint32_t i = 0; i < node->GetChildCount(); ++i) {
@@ -144,31 +240,137 @@ void Scene::ProcessNode(std::shared_ptr<Node> node) {
     }
 }
 
-void Scene::GPassRenderingCallback(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
-    MeshPushConstant meshPushConstant{};
-        
-    meshPushConstant.view = view;
-    meshPushConstant.projection = projection;
-    meshPushConstant.model = glm::mat4( 1.0f );
+Vurl::GeometryHandle Scene::AllocateGeometry(std::shared_ptr<Primitive> primitive) {
+    const std::vector<Vertex>& vertices = primitive->GetVertices();
+    const std::vector<uint32_t>& indices = primitive->GetIndices();
+
+    Vurl::GeometryHandle geometry = geometryArena->Allocate(vertices.data(), (uint32_t)vertices.size(), indices.data(), (uint32_t)indices.size());
+    if (geometry != VURL_NULL_HANDLE)
+        return geometry;
 
-    meshPushConstant.mvp = meshPushConstant.projection * meshPushConstant.view * meshPushConstant.model;
+    //Draws are rebuilt from the arena offsets before the next frame, so packing here is safe
+    if (geometryArena->Defragment() > 0)
+        geometryDirty = true;
+    return geometryArena->Allocate(vertices.data(), (uint32_t)vertices.size(), indices.data(), (uint32_t)indices.size());
+}
 
-    vkCmdPushConstants(commandBuffer, gPassPipeline->GetPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(MeshPushConstant), &meshPushConstant);
+void Scene::BuildGeometry() {
+    //The per-draw buffers are recreated at their new size, frames in flight keep the old ones until they complete
+    graph->Destroy();
 
+    //Draws and clusters are rebuilt from the current arena offsets, which move when the arena is defragmented
+    draws.clear();
+    clusters.clear();
     for (uint32_t i = 0; i < primitives.size(); ++i) {
-        std::shared_ptr<Vurl::Buffer> vertexBuffer = primitives[i]->GetVertexBuffer()->GetResourceSlice(frameIndex);
-        std::shared_ptr<Vurl::Buffer> indexBuffer = primitives[i]->GetIndexBuffer()->GetResourceSlice(frameIndex);
+        const Vurl::GeometryAllocation& allocation = geometryArena->GetAllocation(primitiveGeometry[i]);
+
+        uint32_t drawIndex = (uint32_t)draws.size();
+        DrawData& draw = draws.emplace_back();
+        draw.model = glm::mat4( 1.0f );
+        draw.boundingSphere = primitives[i]->GetBoundingSphere();
+        draw.indexCount = allocation.indexCount;
+        draw.firstIndex = allocation.firstIndex;
+        draw.vertexOffset = (int32_t)allocation.vertexOffset;
+        draw.padding = 0;
+
+        for (Vurl::Cluster cluster : primitives[i]->GetClusters()) {
+            cluster.firstIndex += draw.firstIndex;
+            cluster.drawIndex = drawIndex;
+            clusters.push_back(cluster);
+        }
+    }
+
+    //Commands past the visible draw count stay empty, so drawing all of them is harmless
+    std::vector<VkDrawIndexedIndirectCommand> drawCommands(draws.size());
+    for (uint32_t i = 0; i < draws.size(); ++i) {
+        drawCommands[i].indexCount = 0;
+        drawCommands[i].instanceCount = 0;
+        drawCommands[i].firstIndex = 0;
+        drawCommands[i].vertexOffset = 0;
+        drawCommands[i].firstInstance = 0;
+    }
 
-        VkBuffer vertexBuffers[] = { vertexBuffer->vkBuffer };
-        VkDeviceSize offsets[] = { 0 };
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+    //Each draw owns the same index range in the compacted buffer as in the arena
+    CommitSceneBuffer(graph, compactedIndexBuffer, nullptr, (size_t)geometryArena->GetIndexAllocator().GetCapacity() * sizeof(uint32_t));
+    CommitSceneBuffer(graph, drawDataBuffer, draws.data(), draws.size() * sizeof(DrawData));
+    CommitSceneBuffer(graph, clusterBuffer, clusters.data(), clusters.size() * sizeof(Vurl::Cluster));
+    CommitSceneBuffer(graph, drawCommandTemplateBuffer, drawCommands.data(), drawCommands.size() * sizeof(VkDrawIndexedIndirectCommand));
+    CommitSceneBuffer(graph, drawCommandBuffer, nullptr, drawCommands.size() * sizeof(VkDrawIndexedIndirectCommand));
+    CommitSceneBuffer(graph, drawCountBuffer, nullptr, sizeof(uint32_t));
+    CommitSceneBuffer(graph, drawCommandIndexBuffer, nullptr, draws.size() * sizeof(uint32_t));
+    CommitSceneBuffer(graph, statisticsBuffer, nullptr, sizeof(CullStatistics));
+
+    for (uint32_t i = 0; i < statisticsBuffer->GetSliceCount(); ++i)
+        memset(statisticsBuffer->GetResourceSlice(i)->mappedData, 0, sizeof(CullStatistics));
+    cullStatistics = {};
+
+    //The count skips the culled draws, devices without drawIndirectCount draw the empty commands past it instead
+    std::shared_ptr<Vurl::Resource<Vurl::Buffer>> countBuffer = 
+            context->IsDeviceFeatureEnabled(Vurl::DEVICE_FEATURE_DRAW_INDIRECT_COUNT) ? drawCountBuffer : nullptr;
+    gPass->SetIndexedIndirectDraw(drawCommandBuffer, countBuffer, geometryArena->GetVertexBuffer(), compactedIndexBuffer, 
+            std::max((uint32_t)draws.size(), 1u));
+
+    graph->Build();
+    geometryDirty = false;
+}
 
-        vkCmdBindIndexBuffer(commandBuffer, indexBuffer->vkBuffer, 0, VK_INDEX_TYPE_UINT32);
+float Scene::GetCulledTriangleRatio() const {
+    if (cullStatistics.triangleCount == 0)
+        return 0.0f;
+    return (float)(cullStatistics.frustumCulledTriangleCount + cullStatistics.backfaceCulledTriangleCount) / (float)cullStatistics.triangleCount;
+}
 
-        vkCmdDrawIndexed(commandBuffer, indexBuffer->size / sizeof(uint32_t), 1, 0, 0, 0);
+void Scene::GetFrustumPlanes(glm::vec4 planes[6]) const {
+    //Frustum planes from the rows of the view projection matrix, normalized so the sphere tests use world distances
+    glm::mat4x4 viewProjection = projection * view;
+    for (uint32_t i = 0; i < 3; ++i) {
+        for (uint32_t j = 0; j < 2; ++j) {
+            glm::vec4 plane{};
+            for (uint32_t k = 0; k < 4; ++k)
+                plane[k] = viewProjection[k][3] + (j == 0 ? viewProjection[k][i] : -viewProjection[k][i]);
+            planes[i * 2 + j] = plane / glm::length(glm::vec3(plane));
+        }
     }
 }
 
-void Scene::LightingPassRenderingCallback(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
-    vkCmdDraw(commandBuffer, 6, 1, 0, 0);
+void Scene::ObjectCullDispatchCallback(Vurl::CommandEncoder& encoder, uint32_t frameIndex) {
+    ObjectCullPushConstant objectCullPushConstant{};
+    GetFrustumPlanes(objectCullPushConstant.frustumPlanes);
+    objectCullPushConstant.drawCount = (uint32_t)draws.size();
+
+    encoder.PushConstants(objectCullPipeline->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, objectCullPushConstant);
+
+    uint32_t localSize = objectCullPipeline->GetLocalSize(0);
+    encoder.Dispatch((objectCullPushConstant.drawCount + localSize - 1) / localSize, 1, 1);
+}
+
+void Scene::ClusterCullDispatchCallback(Vurl::CommandEncoder& encoder, uint32_t frameIndex) {
+    //The frame that last wrote this slice has finished, its results are read before the slice is reused
+    std::shared_ptr<Vurl::Buffer> statisticsSlice = statisticsBuffer->GetResourceSlice(frameIndex);
+    vmaInvalidateAllocation(context->GetAllocator(), statisticsSlice->allocation, 0, VK_WHOLE_SIZE);
+    memcpy(&cullStatistics, statisticsSlice->mappedData, sizeof(CullStatistics));
+
+    CullPushConstant cullPushConstant{};
+    GetFrustumPlanes(cullPushConstant.frustumPlanes);
+    cullPushConstant.cameraPosition = glm::vec4(position, 1.0f);
+    cullPushConstant.clusterCount = (uint32_t)clusters.size();
+
+    encoder.PushConstants(clusterCullPipeline->GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, cullPushConstant);
+
+    //One workgroup per cluster, spread over y past the guaranteed group count limit
+    uint32_t groupCountX = std::min(cullPushConstant.clusterCount, 65535u);
+    uint32_t groupCountY = groupCountX > 0 ? (cullPushConstant.clusterCount + groupCountX - 1) / groupCountX : 0;
+    encoder.Dispatch(groupCountX, groupCountY, 1);
+}
+
+void Scene::GPassRenderingCallback(Vurl::CommandEncoder& encoder, uint32_t frameIndex) {
+    //Draws are recorded by the graph from the culled command buffer
+    GPassPushConstant gPassPushConstant{};
+    gPassPushConstant.viewProjection = projection * view;
+
+    encoder.PushConstants(gPassPipeline->GetPipelineLayout(), VK_SHADER_STAGE_VERTEX_BIT, gPassPushConstant);
+}
+
+void Scene::LightingPassRenderingCallback(Vurl::CommandEncoder& encoder, uint32_t frameIndex) {
+    encoder.Draw(6, 1, 0, 0);
 }
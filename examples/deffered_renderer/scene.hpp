@@ -1,6 +1,8 @@
 #pragma once
 
 #include <vurl/render_graph.hpp>
+#include <vurl/shader_library.hpp>
+#include <vurl/geometry_arena.hpp>
 
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
@@ -12,11 +14,37 @@
 #include "mesh.hpp"
 #include "primitive.hpp"
 
-struct MeshPushConstant {
-    glm::mat4x4 mvp;
-    glm::mat4x4 projection;
-    glm::mat4x4 view;
+//Matches the std430 layout of DrawData in cull.comp, cluster_cull.comp and gpass.vert
+struct DrawData {
     glm::mat4x4 model;
+    glm::vec4 boundingSphere;
+    uint32_t indexCount;
+    uint32_t firstIndex;
+    int32_t vertexOffset;
+    uint32_t padding;
+};
+
+struct GPassPushConstant {
+    glm::mat4x4 viewProjection;
+};
+
+struct ObjectCullPushConstant {
+    glm::vec4 frustumPlanes[6];
+    uint32_t drawCount;
+};
+
+struct CullPushConstant {
+    glm::vec4 frustumPlanes[6];
+    glm::vec4 cameraPosition;
+    uint32_t clusterCount;
+};
+
+//Written by cull.comp and cluster_cull.comp, read back a few frames later
+struct CullStatistics {
+    uint32_t triangleCount;
+    uint32_t frustumCulledTriangleCount;
+    uint32_t backfaceCulledTriangleCount;
+    uint32_t visibleClusterCount;
 };
 
 class Scene {
@@ -38,10 +66,18 @@ public:
     inline glm::vec3 GetCameraDirection() const { return direction; }
     inline void SetCameraDirection(glm::vec3 direction) { this->direction = direction; }
 
+    inline const CullStatistics& GetCullStatistics() const { return cullStatistics; }
+    float GetCulledTriangleRatio() const;
+
 private:
     void ProcessNode(std::shared_ptr<Node> node);
-    void GPassRenderingCallback(VkCommandBuffer commandBuffer, uint32_t frameIndex);
-    void LightingPassRenderingCallback(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+    Vurl::GeometryHandle AllocateGeometry(std::shared_ptr<Primitive> primitive);
+    void BuildGeometry();
+    void GetFrustumPlanes(glm::vec4 planes[6]) const;
+    void ObjectCullDispatchCallback(Vurl::CommandEncoder& encoder, uint32_t frameIndex);
+    void ClusterCullDispatchCallback(Vurl::CommandEncoder& encoder, uint32_t frameIndex);
+    void GPassRenderingCallback(Vurl::CommandEncoder& encoder, uint32_t frameIndex);
+    void LightingPassRenderingCallback(Vurl::CommandEncoder& encoder, uint32_t frameIndex);
 
 private:
     std::shared_ptr<Vurl::RenderingContext> context = nullptr;
@@ -49,10 +85,33 @@ private:
     std::shared_ptr<Vurl::RenderGraph> graph = nullptr;
     std::vector<std::shared_ptr<Node>> nodes{};
     std::vector<std::shared_ptr<Primitive>> primitives{};
+
+    //Every primitive is suballocated from the arena, one draw per primitive split into clusters
+    std::shared_ptr<Vurl::GeometryArena> geometryArena = nullptr;
+    std::vector<Vurl::GeometryHandle> primitiveGeometry{};
+    std::vector<DrawData> draws{};
+    std::vector<Vurl::Cluster> clusters{};
+    bool geometryDirty = true;
+
+    //The object cull compacts the commands of visible draws and counts them, the cluster cull compacts the indices
+    //of visible clusters into each draw's range of the compacted index buffer
+    std::shared_ptr<Vurl::Resource<Vurl::Buffer>> compactedIndexBuffer = nullptr;
+    std::shared_ptr<Vurl::Resource<Vurl::Buffer>> drawDataBuffer = nullptr;
+    std::shared_ptr<Vurl::Resource<Vurl::Buffer>> clusterBuffer = nullptr;
+    std::shared_ptr<Vurl::Resource<Vurl::Buffer>> drawCommandTemplateBuffer = nullptr;
+    std::shared_ptr<Vurl::Resource<Vurl::Buffer>> drawCommandBuffer = nullptr;
+    std::shared_ptr<Vurl::Resource<Vurl::Buffer>> drawCountBuffer = nullptr;
+    std::shared_ptr<Vurl::Resource<Vurl::Buffer>> drawCommandIndexBuffer = nullptr;
+    std::shared_ptr<Vurl::Resource<Vurl::Buffer>> statisticsBuffer = nullptr;
+    std::shared_ptr<Vurl::GraphicsPass> gPass = nullptr;
+    CullStatistics cullStatistics{};
     
     //Pipeline
+    std::shared_ptr<Vurl::ShaderLibrary> shaderLibrary = nullptr;
     std::shared_ptr<Vurl::GraphicsPipeline> gPassPipeline = nullptr;
     std::shared_ptr<Vurl::GraphicsPipeline> lightingPassPipeline = nullptr;
+    std::shared_ptr<Vurl::ComputePipeline> objectCullPipeline = nullptr;
+    std::shared_ptr<Vurl::ComputePipeline> clusterCullPipeline = nullptr;
 
     //Camera Data
     glm::vec3 position = glm::vec3( 0.0f, 0.0f, 0.0f );
@@ -1,4 +1,6 @@
 glslc gpass.frag -o gpass_frag.spv
 glslc gpass.vert -o gpass_vert.spv
 glslc lighting.frag -o lighting_frag.spv
-glslc lighting.vert -o lighting_vert.spv
\ No newline at end of file
+glslc lighting.vert -o lighting_vert.spv
+glslc cluster_cull.comp -o cluster_cull_comp.spv
+glslc cull.comp -o cull_comp.spv
\ No newline at end of file
@@ -1,18 +1,30 @@
-#version 450
+#version 460
 
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 
 layout(location = 0) out vec3 outNormal;
 
-layout(push_constant) uniform MeshPushConstant {
-    mat4 mvp;
-    mat4 projection;
-    mat4 view;
+struct DrawData {
     mat4 model;
+    vec4 boundingSphere;
+    uint indexCount;
+    uint firstIndex;
+    int vertexOffset;
+    uint padding;
+};
+
+//The cull pass leaves firstInstance = draw index
+layout(std430, set = 0, binding = 0) readonly buffer DrawDataBuffer {
+    DrawData draws[];
+};
+
+layout(push_constant) uniform GPassPushConstant {
+    mat4 viewProjection;
 } constant;
 
 void main() {
-    gl_Position = constant.mvp * vec4(position, 1.0);
-    outNormal = normal;
+    mat4 model = draws[gl_InstanceIndex].model;
+    gl_Position = constant.viewProjection * model * vec4(position, 1.0);
+    outNormal = mat3(model) * normal;
 }
\ No newline at end of file
@@ -2,12 +2,25 @@
 
 #include <vurl/vulkan_header.hpp>
 #include <vurl/resource.hpp>
+#include <vurl/memory_pool.hpp>
+#include <memory>
 
 namespace Vurl {
     struct Buffer {
         VkBuffer vkBuffer = VK_NULL_HANDLE;
         VkDeviceSize size = 0;
         VkBufferUsageFlags usage = 0;
+        VkSharingMode sharingMode = VK_SHARING_MODE_EXCLUSIVE;
         VmaAllocation allocation = VK_NULL_HANDLE;
+        //Host-visible buffers stay mapped for reading results back, the graph makes device writes visible at the end of each frame
+        bool hostVisible = false;
+        void* mappedData = nullptr;
+        //Buffers imported from host memory own their device memory instead of a VMA allocation.
+        //The import starts on the device's alignment, the imported data starts hostImportOffset bytes in.
+        VkDeviceMemory importedMemory = VK_NULL_HANDLE;
+        VkDeviceSize hostImportOffset = 0;
+        std::shared_ptr<void> hostMemoryOwner = nullptr;
+        //Set RESOURCE_CLASS_STATIC_GEOMETRY for vertex and index buffers that are loaded once and kept
+        ResourceClass resourceClass = RESOURCE_CLASS_DEFAULT;
     };
 }
\ No newline at end of file
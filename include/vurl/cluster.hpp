@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace Vurl {
+    //A run of triangles with bounds for GPU culling, laid out like a std430 struct so arrays upload as is.
+    //The cluster faces away from a viewer at p if dot(normalize(coneApex - p), coneAxis) >= coneCutoff.
+    struct Cluster {
+        float boundingSphere[4]{};
+        float coneApex[4]{};
+        float coneAxis[3]{};
+        float coneCutoff = 1.0f;
+        uint32_t firstIndex = 0;
+        uint32_t triangleCount = 0;
+        //Left to the caller, e.g. the draw the cluster belongs to
+        uint32_t drawIndex = 0;
+        uint32_t padding = 0;
+    };
+
+    //Split a triangle list into clusters of up to maxTrianglesPerCluster consecutive triangles, firstIndex is relative to indices.
+    //Cones assume counter-clockwise front faces unless told otherwise, clusters too curved for a useful cone get a cutoff of 1.
+    void BuildClusters(const float* positions, uint32_t positionStride, const uint32_t* indices, uint32_t indexCount, 
+            uint32_t maxTrianglesPerCluster, std::vector<Cluster>& clusters, bool counterClockwise = true);
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vurl/vulkan_header.hpp>
+#include <vurl/graphics_pipeline.hpp>
+#include <cstdint>
+
+#define VURL_MAX_DESCRIPTOR_SET_COUNT 8
+#define VURL_MAX_VERTEX_BUFFER_BINDING_COUNT 16
+#define VURL_MAX_PUSH_CONSTANT_SIZE 256
+
+namespace Vurl {
+    struct CommandEncoderStatistics {
+        uint32_t pipelineBindCount = 0;
+        uint32_t descriptorSetBindCount = 0;
+        uint32_t vertexBufferBindCount = 0;
+        uint32_t indexBufferBindCount = 0;
+        uint32_t pushConstantCount = 0;
+        uint32_t dynamicStateCount = 0;
+        uint32_t drawCount = 0;
+        uint32_t dispatchCount = 0;
+        //Calls dropped because they would set state that is already bound
+        uint32_t elidedCallCount = 0;
+    };
+
+    //Records into a command buffer and drops binds and state that match what is already set.
+    //Commands recorded directly on GetCommandBuffer() are not tracked, call Invalidate after them.
+    class CommandEncoder {
+    public:
+        CommandEncoder() = default;
+        ~CommandEncoder() = default;
+
+        //Start tracking a command buffer in the initial state
+        void Begin(VkCommandBuffer commandBuffer);
+        void Invalidate();
+        inline VkCommandBuffer GetCommandBuffer() const { return vkCommandBuffer; }
+
+        void BindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline);
+        void BindDescriptorSets(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t firstSet, uint32_t setCount, const VkDescriptorSet* sets);
+        void BindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* buffers, const VkDeviceSize* offsets);
+        void BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType);
+        void PushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* values);
+        template<typename T>
+        inline void PushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags, const T& value, uint32_t offset = 0) {
+            PushConstants(layout, stageFlags, offset, sizeof(T), &value);
+        }
+
+        void SetViewport(const VkViewport& viewport);
+        void SetScissor(const VkRect2D& scissor);
+        void SetPrimitiveTopology(VkPrimitiveTopology primitiveTopology);
+        void SetPrimitiveRestartEnable(VkBool32 enable);
+        void SetCullMode(VkCullModeFlags cullMode);
+        void SetFrontFace(VkFrontFace frontFace);
+        void SetDepthTestEnable(VkBool32 enable);
+        void SetDepthWriteEnable(VkBool32 enable);
+        void SetDepthCompareOp(VkCompareOp compareOp);
+
+        void Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance);
+        void DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance);
+        //Needs VK_EXT_multi_draw, every draw uses its own vertexOffset
+        void DrawMultiIndexed(uint32_t drawCount, const VkMultiDrawIndexedInfoEXT* draws, uint32_t instanceCount, uint32_t firstInstance);
+        void DrawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride);
+        void DrawIndexedIndirectCount(VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, 
+                uint32_t maxDrawCount, uint32_t stride);
+        void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ);
+
+        inline const CommandEncoderStatistics& GetStatistics() const { return statistics; }
+        inline void ResetStatistics() { statistics = {}; }
+
+    private:
+        struct BoundDescriptorSets {
+            VkPipelineLayout layouts[VURL_MAX_DESCRIPTOR_SET_COUNT]{};
+            VkDescriptorSet sets[VURL_MAX_DESCRIPTOR_SET_COUNT]{};
+        };
+
+        struct DynamicState {
+            VkViewport viewport{};
+            VkRect2D scissor{};
+            VkPrimitiveTopology primitiveTopology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+            VkBool32 primitiveRestartEnable = VK_FALSE;
+            VkCullModeFlags cullMode = VK_CULL_MODE_NONE;
+            VkFrontFace frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+            VkBool32 depthTestEnable = VK_FALSE;
+            VkBool32 depthWriteEnable = VK_FALSE;
+            VkCompareOp depthCompareOp = VK_COMPARE_OP_NEVER;
+        };
+
+        //Compute gets its own slot, graphics and anything else share the other
+        static inline uint32_t GetBindPointIndex(VkPipelineBindPoint bindPoint) { return bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE ? 1 : 0; }
+        //Return true when the state is already set, otherwise mark it as set
+        bool IsDynamicStateSet(DynamicStateFlags flag, bool equal);
+
+    private:
+        VkCommandBuffer vkCommandBuffer = VK_NULL_HANDLE;
+
+        VkPipeline pipelines[2]{};
+        BoundDescriptorSets descriptorSets[2]{};
+
+        VkBuffer vertexBuffers[VURL_MAX_VERTEX_BUFFER_BINDING_COUNT]{};
+        VkDeviceSize vertexBufferOffsets[VURL_MAX_VERTEX_BUFFER_BINDING_COUNT]{};
+        VkBuffer indexBuffer = VK_NULL_HANDLE;
+        VkDeviceSize indexBufferOffset = 0;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+
+        //Stages that last wrote each byte, 0 when the byte was never pushed with the current layout
+        VkPipelineLayout pushConstantLayout = VK_NULL_HANDLE;
+        VkShaderStageFlags pushConstantStages[VURL_MAX_PUSH_CONSTANT_SIZE]{};
+        uint8_t pushConstantData[VURL_MAX_PUSH_CONSTANT_SIZE]{};
+
+        DynamicState dynamicState{};
+        DynamicStateFlags validDynamicStates = 0;
+
+        CommandEncoderStatistics statistics{};
+    };
+}
\ No newline at end of file
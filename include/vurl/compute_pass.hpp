@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vurl/pass.hpp>
+#include <vurl/render_graph_def.hpp>
+#include <vurl/resource.hpp>
+#include <vurl/texture.hpp>
+#include <vurl/buffer.hpp>
+#include <vurl/compute_pipeline.hpp>
+#include <vector>
+#include <string>
+#include <functional>
+
+namespace Vurl {
+    class RenderGraph;
+
+    class ComputePass : public Pass, public HashedObject {
+    public:
+        ComputePass() = delete;
+        ComputePass(const std::string& name, std::shared_ptr<ComputePipeline> pipeline, RenderGraph* graph);
+        ~ComputePass() = default;
+
+        inline PassType GetPassType() const override { return PassType::Compute; }
+
+        //Access must be one of the storage access types
+        void AddStorageBuffer(std::shared_ptr<Resource<Buffer>> buffer, uint32_t binding, ResourceAccessType access);
+        void AddStorageImage(std::shared_ptr<Resource<Texture>> texture, uint32_t binding, ResourceAccessType access);
+
+        inline uint32_t GetStorageBufferCount() const { return storageBuffers.size(); }
+        inline uint32_t GetStorageImageCount() const { return storageImages.size(); }
+        inline const StorageBinding<BufferHandle>& GetStorageBuffer(uint32_t idx) const { return storageBuffers[idx]; }
+        inline const StorageBinding<TextureHandle>& GetStorageImage(uint32_t idx) const { return storageImages[idx]; }
+        inline const std::vector<StorageBinding<BufferHandle>>& GetStorageBuffers() const { return storageBuffers; }
+        inline const std::vector<StorageBinding<TextureHandle>>& GetStorageImages() const { return storageImages; }
+
+        inline std::shared_ptr<ComputePipeline> GetComputePipeline() const { return computePipeline; }
+
+        //Dispatched as is when there is no dispatch callback
+        inline void SetGroupCount(uint32_t x, uint32_t y = 1, uint32_t z = 1) { groupCount[0] = x; groupCount[1] = y; groupCount[2] = z; }
+        inline uint32_t GetGroupCount(uint32_t axis) const { return groupCount[axis]; }
+
+        //Called with the pipeline and the storage descriptor set bound, must record the dispatch itself
+        inline void SetDispatchCallback(std::function<void(CommandEncoder&, uint32_t)> callback) { dispatchCallback = callback; }
+        inline std::function<void(CommandEncoder&, uint32_t)> GetDispatchCallback() const { return dispatchCallback; }
+
+        inline uint32_t GetHash() const {
+            Hasher hasher{};
+            hasher.U32(computePipeline->GetHash());
+            for (uint32_t i = 0; i < storageBuffers.size(); ++i) {
+                hasher.U32(storageBuffers[i].handle);
+                hasher.U32(storageBuffers[i].binding);
+                hasher.U32((uint32_t)storageBuffers[i].access);
+            }
+            for (uint32_t i = 0; i < storageImages.size(); ++i) {
+                hasher.U32(storageImages[i].handle);
+                hasher.U32(storageImages[i].binding);
+                hasher.U32((uint32_t)storageImages[i].access);
+            }
+            for (uint32_t i = 0; i < resourceAccesses.size(); ++i) {
+                hasher.U32(resourceAccesses[i].handle);
+                hasher.U32((uint32_t)resourceAccesses[i].type);
+            }
+            return hasher.Get();
+        };
+
+    private:
+        std::shared_ptr<ComputePipeline> computePipeline = nullptr;
+
+        std::vector<StorageBinding<BufferHandle>> storageBuffers{};
+        std::vector<StorageBinding<TextureHandle>> storageImages{};
+        uint32_t groupCount[3] = { 1, 1, 1 };
+
+        std::function<void(CommandEncoder&, uint32_t)> dispatchCallback{};
+    };
+}
\ No newline at end of file
@@ -1,3 +1,86 @@
 #pragma once
 
-//TODO
\ No newline at end of file
+#include <vurl/vulkan_header.hpp>
+#include <vurl/shader.hpp>
+#include <vurl/hash.hpp>
+#include <vurl/graphics_pipeline.hpp>
+#include <memory>
+#include <vector>
+#include <cstring>
+
+namespace Vurl {
+    class ComputePipeline : public HashedObject {
+    public:
+        ComputePipeline() = delete;
+        ComputePipeline(VkDevice device) : vkDevice{ device } {}
+        ~ComputePipeline() = default;
+
+        //Descriptor set layouts and push constant ranges are derived from the compute shader's reflection
+        bool CreatePipelineLayout();
+        void DestroyPipelineLayout();
+        inline VkPipelineLayout GetPipelineLayout() const { return vkPipelineLayout; }
+
+        inline uint32_t GetDescriptorSetLayoutCount() const { return (uint32_t)descriptorSetLayouts.size(); }
+        inline VkDescriptorSetLayout GetDescriptorSetLayout(uint32_t set) const { 
+            return set < descriptorSetLayouts.size() ? descriptorSetLayouts[set] : VK_NULL_HANDLE; 
+        }
+        const ShaderDescriptorBinding* FindDescriptorBinding(uint32_t set, uint32_t binding) const;
+
+        inline void SetComputeShader(std::shared_ptr<Shader> shader) { computeShader = shader; }
+        inline std::shared_ptr<Shader> GetComputeShader() const { return computeShader; }
+
+        //Return false if the shader has no constant with this id or its type doesn't match T.
+        template<typename T>
+        inline bool SetSpecializationConstant(uint32_t constantId, T value) {
+            static_assert(GetSpecializationConstantType<T>() != SpecializationConstantType::Unsupported, 
+                    "Specialization constants must be bool, int32_t, uint32_t or float");
+            uint32_t data = 0;
+            if constexpr (std::is_same_v<T, bool>)
+                data = value ? VK_TRUE : VK_FALSE;
+            else
+                memcpy(&data, &value, sizeof(uint32_t));
+            return SetSpecializationConstant(constantId, GetSpecializationConstantType<T>(), data);
+        }
+
+        bool SetSpecializationConstant(uint32_t constantId, SpecializationConstantType type, uint32_t data);
+        void ClearSpecializationConstants() { specializationConstants.clear(); }
+        void GetSpecializationData(std::vector<VkSpecializationMapEntry>& mapEntries, std::vector<uint32_t>& data) const;
+
+        inline uint32_t GetSpecializationHash() const {
+            Hasher hasher{};
+            for (const SpecializationConstant& constant : specializationConstants) {
+                hasher.U32(constant.constantId);
+                hasher.U32(constant.data);
+            }
+            return hasher.Get();
+        }
+
+        //Work group size declared by the shader, used to turn invocation counts into group counts
+        inline uint32_t GetLocalSize(uint32_t axis) const { return computeShader ? computeShader->GetReflection().localSize[axis] : 1; }
+
+        inline uint32_t GetHash() const {
+            Hasher hasher{};
+            Hash(hasher);
+            return hasher.Get();
+        }
+
+        template<typename T>
+        inline void Hash(T& hasher) const {
+            hasher.Ptr(computeShader.get());
+            hasher.Ptr(vkPipelineLayout);
+            for (const SpecializationConstant& constant : specializationConstants) {
+                hasher.U32(constant.constantId);
+                hasher.U32(constant.data);
+            }
+        }
+
+    private:
+        VkDevice vkDevice = VK_NULL_HANDLE;
+
+        std::shared_ptr<Shader> computeShader = nullptr;
+
+        VkPipelineLayout vkPipelineLayout = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSetLayout> descriptorSetLayouts{};
+        std::vector<SpecializationConstant> specializationConstants{};
+    };
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vurl/vulkan_header.hpp>
+#include <functional>
+#include <vector>
+
+namespace Vurl {
+    //Defers the destruction of objects the GPU may still use. Everything retired is tagged with the frame being
+    //recorded and destroyed by the first Collect whose completed frame reached it, so rebuilding the graph or
+    //replacing a resource never needs the device to be idle. The render graph advances the frame and collects.
+    class DeletionQueue {
+    private:
+        struct Entry {
+            uint64_t frameIndex = 0;
+            std::function<void()> destroy{};
+        };
+
+    public:
+        DeletionQueue() = delete;
+        DeletionQueue(VkDevice device, VmaAllocator allocator) : vkDevice{ device }, vmaAllocator{ allocator } {}
+        //Entries still queued are leaked, Flush once the device is idle
+        ~DeletionQueue() = default;
+
+        void Push(std::function<void()> destroy);
+        void DestroyBuffer(VkBuffer buffer, VmaAllocation allocation = VK_NULL_HANDLE);
+        void DestroyImage(VkImage image, VmaAllocation allocation = VK_NULL_HANDLE);
+        void DestroyImageView(VkImageView imageView);
+        void FreeMemory(VkDeviceMemory memory);
+        void DestroyPipeline(VkPipeline pipeline);
+        void DestroyFramebuffer(VkFramebuffer framebuffer);
+        void DestroyRenderPass(VkRenderPass renderPass);
+        void DestroyShader(VkShaderEXT shader);
+        void DestroyCommandPool(VkCommandPool commandPool);
+        void DestroySwapchain(VkSwapchainKHR swapchain);
+
+        //Objects retired from now on may be used by this frame
+        inline void SetFrameIndex(uint64_t frameIndex) { this->frameIndex = frameIndex; }
+        inline uint64_t GetFrameIndex() const { return frameIndex; }
+        //Destroy everything retired up to and including completedFrameIndex, in the order it was retired
+        void Collect(uint64_t completedFrameIndex);
+        //Destroy everything, the device must be idle
+        void Flush();
+
+        inline uint32_t GetPendingCount() const { return (uint32_t)entries.size(); }
+
+    private:
+        VkDevice vkDevice = VK_NULL_HANDLE;
+        VmaAllocator vmaAllocator = VK_NULL_HANDLE;
+
+        uint64_t frameIndex = 0;
+        std::vector<Entry> entries{};
+    };
+}
\ No newline at end of file
@@ -32,8 +32,8 @@ namespace Vurl {
 
         void Reset();
         void Destroy();
-        VkDescriptionSet Allocate(VkDescriptionSetLayout layout);
-        void Allocate(VkDescriptionSet* descriptionSets, VkDescriptionSetLayout* layouts, uint32_t count);
+        VkDescriptorSet Allocate(VkDescriptorSetLayout layout);
+        bool Allocate(VkDescriptorSet* descriptorSets, const VkDescriptorSetLayout* layouts, uint32_t count);
 
     private:
         VkDescriptorPool GetPool();
@@ -47,8 +47,4 @@ namespace Vurl {
         std::vector<VkDescriptorPool> usedPools{};
         std::vector<VkDescriptorPool> freePools{};
     };
-
-    class DescriptorSetLayoutBuilder {
-
-    };
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vurl/rendering_context.hpp>
+#include <vurl/command_encoder.hpp>
+#include <memory>
+#include <vector>
+
+namespace Vurl {
+    //Collect indexed draws that share pipeline and bound buffers and record them with as few commands as possible.
+    //Uses vkCmdDrawMultiIndexedEXT when VK_EXT_multi_draw is enabled, one vkCmdDrawIndexed per draw otherwise.
+    class DrawBatch {
+    public:
+        DrawBatch() = delete;
+        DrawBatch(std::shared_ptr<RenderingContext> context) : context{ context } {}
+        ~DrawBatch() = default;
+
+        inline void AddDraw(uint32_t firstIndex, uint32_t indexCount, int32_t vertexOffset) { 
+            if (indexCount > 0)
+                draws.push_back({ firstIndex, indexCount, vertexOffset }); 
+        }
+        inline void Reserve(uint32_t drawCount) { draws.reserve(drawCount); }
+        inline void Clear() { draws.clear(); }
+
+        //Record every added draw and clear the batch, return the number of draw commands recorded
+        uint32_t Flush(CommandEncoder& encoder, uint32_t instanceCount = 1, uint32_t firstInstance = 0);
+
+        inline uint32_t GetDrawCount() const { return (uint32_t)draws.size(); }
+
+    private:
+        std::shared_ptr<RenderingContext> context = nullptr;
+        std::vector<VkMultiDrawIndexedInfoEXT> draws{};
+    };
+}
\ No newline at end of file
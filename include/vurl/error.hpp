@@ -11,21 +11,37 @@ namespace Vurl {
         VURL_ERROR_DEVICE_CREATION_FAILED,
         VURL_ERROR_SWAPCHAIN_CREATION_FAILED,
         VURL_ERROR_SHADER_MODULE_CREATION_FAILED,
-        VURL_ERROR_REFLECT_SHADER_MODULE_CREATION_FAILD
+        VURL_ERROR_REFLECT_SHADER_MODULE_CREATION_FAILD,
+        VURL_ERROR_SHADER_LIBRARY_OPEN_FAILED,
+        VURL_ERROR_INVALID_SHADER_LIBRARY,
+        VURL_ERROR_KTX2_OPEN_FAILED,
+        VURL_ERROR_INVALID_KTX2,
+        VURL_ERROR_UNSUPPORTED_KTX2,
+        VURL_ERROR_UNSUPPORTED_TEXTURE_FORMAT,
+        VURL_ERROR_TEXTURE_ENCODE_FAILED,
+        VURL_ERROR_TRANSIENT_RESOURCE
     };
 
     inline const char* GetErrorMessage(VurlResult result) {
         const char* messages[] = {
             "Success.",
             "Unsupported vulkan instance version.",
-            "Unsupported vulkan instance extension."
+            "Unsupported vulkan instance extension.",
             "Vulkan instance creation failed.",
             "Vulkan instance is missing. Create a vulkan instance before any other operation.",
             "No suitable physical device found.",
             "Logical device creation failed.",
             "Swapchain creation failed.",
             "Shader module creation failed.",
-            "Reflection shader module creation failed."
+            "Reflection shader module creation failed.",
+            "Shader library could not be opened.",
+            "Shader library is invalid or has an unsupported version.",
+            "KTX2 file could not be opened.",
+            "KTX2 file is invalid.",
+            "KTX2 file uses supercompression or Basis Universal data which is not supported.",
+            "Texture format is not supported by the device and cannot be decompressed.",
+            "Texture could not be encoded or written to the texture cache.",
+            "Transient resources are owned by the render graph and cannot be committed with data."
         };
         return messages[result];
     }
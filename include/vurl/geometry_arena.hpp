@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vurl/render_graph.hpp>
+#include <vurl/resource.hpp>
+#include <vurl/buffer.hpp>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Vurl {
+    typedef int GeometryHandle;
+
+    //First-fit free list over a range of elements, neighbouring free ranges are merged on free
+    class RangeAllocator {
+    public:
+        RangeAllocator() = default;
+        ~RangeAllocator() = default;
+
+        void Reset(uint32_t capacity);
+        bool Allocate(uint32_t count, uint32_t& offset);
+        void Free(uint32_t offset, uint32_t count);
+
+        inline uint32_t GetCapacity() const { return capacity; }
+        inline uint32_t GetFreeCount() const { return freeCount; }
+        uint32_t GetLargestFreeRange() const;
+
+    private:
+        std::map<uint32_t, uint32_t> freeRanges{};
+        uint32_t capacity = 0;
+        uint32_t freeCount = 0;
+    };
+
+    //Offsets and counts are in vertices and indices, indices are relative to vertexOffset
+    struct GeometryAllocation {
+        uint32_t vertexOffset = 0;
+        uint32_t vertexCount = 0;
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+    };
+
+    //Suballocates geometry from one large vertex buffer and one large index buffer, so every draw shares a single bind
+    class GeometryArena {
+    public:
+        GeometryArena() = delete;
+        GeometryArena(std::shared_ptr<RenderGraph> graph, const std::string& name, uint32_t vertexStride, 
+                uint32_t vertexCapacity, uint32_t indexCapacity, VkBufferUsageFlags additionalUsage = 0);
+        ~GeometryArena() = default;
+
+        //Commit both buffers, allocations made before are lost
+        void Create();
+
+        //Return VURL_NULL_HANDLE when either buffer has no free range large enough, Defragment may make room
+        GeometryHandle Allocate(const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+        void Free(GeometryHandle handle);
+        inline const GeometryAllocation& GetAllocation(GeometryHandle handle) const { return allocations[handle]; }
+
+        //Pack live allocations to the start of both buffers with GPU copies, return how many moved.
+        //Offsets of moved allocations change, draws built from them must be updated.
+        uint32_t Defragment();
+        //0 when all free space is one range, close to 1 when it is scattered
+        float GetFragmentation() const;
+
+        inline std::shared_ptr<Resource<Buffer>> GetVertexBuffer() const { return vertexBuffer; }
+        inline std::shared_ptr<Resource<Buffer>> GetIndexBuffer() const { return indexBuffer; }
+        inline uint32_t GetVertexStride() const { return vertexStride; }
+        inline const RangeAllocator& GetVertexAllocator() const { return vertexAllocator; }
+        inline const RangeAllocator& GetIndexAllocator() const { return indexAllocator; }
+
+    private:
+        std::shared_ptr<RenderGraph> graph = nullptr;
+        std::shared_ptr<Resource<Buffer>> vertexBuffer = nullptr;
+        std::shared_ptr<Resource<Buffer>> indexBuffer = nullptr;
+        uint32_t vertexStride = 0;
+
+        RangeAllocator vertexAllocator{};
+        RangeAllocator indexAllocator{};
+        std::vector<GeometryAllocation> allocations{};
+        std::vector<bool> liveAllocations{};
+        std::vector<GeometryHandle> freeHandles{};
+    };
+}
\ No newline at end of file
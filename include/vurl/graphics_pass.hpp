@@ -12,6 +12,18 @@
 
 namespace Vurl {
     class RenderGraph;
+
+    //Draws up to maxDrawCount VkDrawIndexedIndirectCommand entries, the actual count is read from countBuffer.
+    //Count buffers need DEVICE_FEATURE_DRAW_INDIRECT_COUNT, the graph fails to build without it.
+    //Without a count buffer all maxDrawCount entries are drawn, which only needs Vulkan 1.0 indirect draws.
+    struct IndexedIndirectDraw {
+        BufferHandle indirectBuffer = VURL_NULL_HANDLE;
+        BufferHandle countBuffer = VURL_NULL_HANDLE;
+        BufferHandle vertexBuffer = VURL_NULL_HANDLE;
+        BufferHandle indexBuffer = VURL_NULL_HANDLE;
+        uint32_t maxDrawCount = 0;
+        VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+    };
     
     class GraphicsPass : public Pass, public HashedObject {
     public:
@@ -25,8 +37,15 @@ namespace Vurl {
         void AddInputAttachment(std::shared_ptr<Resource<Texture>> texture);
         void SetDepthStencilAttachment(std::shared_ptr<Resource<Texture>> texture);
         void ClearAttachment(uint32_t attachmentIdx, VkClearColorValue color);
-        
-        void AddBufferInput(std::shared_ptr<Resource<Buffer>> buffer);
+
+        //Access must be one of the storage access types
+        void AddStorageBuffer(std::shared_ptr<Resource<Buffer>> buffer, uint32_t binding, ResourceAccessType access);
+        void AddStorageImage(std::shared_ptr<Resource<Texture>> texture, uint32_t binding, ResourceAccessType access);
+
+        //The graph records the draw after the rendering callback, which is left to push constants
+        void SetIndexedIndirectDraw(std::shared_ptr<Resource<Buffer>> indirectBuffer, std::shared_ptr<Resource<Buffer>> countBuffer, 
+                std::shared_ptr<Resource<Buffer>> vertexBuffer, std::shared_ptr<Resource<Buffer>> indexBuffer, 
+                uint32_t maxDrawCount, VkIndexType indexType = VK_INDEX_TYPE_UINT32);
 
         inline uint32_t GetColorAttachmentCount() const { return colorAttachments.size(); }
         inline uint32_t GetInputAttachmentCount() const { return inputAttachments.size(); }
@@ -35,11 +54,20 @@ namespace Vurl {
         inline TextureHandle GetInputAttachment(uint32_t idx) const { return inputAttachments[idx]; }
         inline TextureHandle GetDepthStencilAttachment() const { return depthStencilAttachment; }
         inline std::pair<uint32_t, VkClearColorValue> GetClearAttachmentInfo(uint32_t idx) const { return clearAttachmentInfo[idx]; }
+        bool IsColorAttachmentCleared(uint32_t attachmentIdx) const;
+
+        inline uint32_t GetStorageBufferCount() const { return storageBuffers.size(); }
+        inline uint32_t GetStorageImageCount() const { return storageImages.size(); }
+        inline const std::vector<StorageBinding<BufferHandle>>& GetStorageBuffers() const { return storageBuffers; }
+        inline const std::vector<StorageBinding<TextureHandle>>& GetStorageImages() const { return storageImages; }
+
+        inline bool HasIndexedIndirectDraw() const { return indexedIndirectDraw.indirectBuffer != VURL_NULL_HANDLE; }
+        inline const IndexedIndirectDraw& GetIndexedIndirectDraw() const { return indexedIndirectDraw; }
 
         inline std::shared_ptr<GraphicsPipeline> GetGraphicsPipeline() const { return graphicsPipeline; }
 
-        inline void SetRenderingCallback(std::function<void(VkCommandBuffer, uint32_t)> callback) { renderingCallback = callback; }
-        inline std::function<void(VkCommandBuffer, uint32_t)> GetRenderingCallback() const { return renderingCallback; }
+        inline void SetRenderingCallback(std::function<void(CommandEncoder&, uint32_t)> callback) { renderingCallback = callback; }
+        inline std::function<void(CommandEncoder&, uint32_t)> GetRenderingCallback() const { return renderingCallback; }
         
         inline uint32_t GetHash() const {
             Hasher hasher{};
@@ -50,6 +78,15 @@ namespace Vurl {
                 hasher.U32(inputAttachments[i]);
             for (uint32_t i = 0; i < clearAttachmentInfo.size(); ++i)
                 hasher.U32(clearAttachmentInfo[i].first);
+            for (uint32_t i = 0; i < storageBuffers.size(); ++i)
+                hasher.U32(storageBuffers[i].binding);
+            for (uint32_t i = 0; i < storageImages.size(); ++i)
+                hasher.U32(storageImages[i].binding);
+            hasher.U32(indexedIndirectDraw.maxDrawCount);
+            for (uint32_t i = 0; i < resourceAccesses.size(); ++i) {
+                hasher.U32(resourceAccesses[i].handle);
+                hasher.U32((uint32_t)resourceAccesses[i].type);
+            }
             return hasher.Get();
         };
 
@@ -60,9 +97,10 @@ namespace Vurl {
         std::vector<TextureHandle> inputAttachments{};
         TextureHandle depthStencilAttachment = VURL_NULL_HANDLE;
         std::vector<std::pair<uint32_t, VkClearColorValue>> clearAttachmentInfo{};
-
-        std::vector<BufferHandle> inputBuffers{};
+        std::vector<StorageBinding<BufferHandle>> storageBuffers{};
+        std::vector<StorageBinding<TextureHandle>> storageImages{};
+        IndexedIndirectDraw indexedIndirectDraw{};
         
-        std::function<void(VkCommandBuffer, uint32_t)> renderingCallback{};
+        std::function<void(CommandEncoder&, uint32_t)> renderingCallback{};
     };
 }
\ No newline at end of file
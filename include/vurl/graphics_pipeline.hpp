@@ -5,33 +5,61 @@
 #include <vurl/hash.hpp>
 #include <memory>
 #include <vector>
+#include <cstring>
+#include <type_traits>
 
 namespace Vurl {
     enum class VertexInputAttributeFormat {
         Float,
         Vector2,
         Vector3,
-        Vector4
+        Vector4,
+        Half2,
+        Half4,
+        SNorm8x4,
+        UNorm8x4,
+        SNorm16x2,
+        SNorm16x4,
+        UNorm16x2,
+        UNorm16x4,
+        UNorm10_10_10_2,
+        OctahedralNormal8,  //Unit vector folded into two snorm8, see vertex_packing.hpp
+        OctahedralNormal16  //Unit vector folded into two snorm16, see vertex_packing.hpp
     };
 
+    constexpr uint32_t GetVertexInputAttributeFormatSize(VertexInputAttributeFormat format) {
+        switch (format) {
+            case VertexInputAttributeFormat::Float:   return sizeof(float);
+            case VertexInputAttributeFormat::Vector2: return sizeof(float) * 2;
+            case VertexInputAttributeFormat::Vector3: return sizeof(float) * 3;
+            case VertexInputAttributeFormat::Vector4: return sizeof(float) * 4;
+            case VertexInputAttributeFormat::Half2:              return sizeof(uint16_t) * 2;
+            case VertexInputAttributeFormat::Half4:              return sizeof(uint16_t) * 4;
+            case VertexInputAttributeFormat::SNorm8x4:           return sizeof(uint8_t) * 4;
+            case VertexInputAttributeFormat::UNorm8x4:           return sizeof(uint8_t) * 4;
+            case VertexInputAttributeFormat::SNorm16x2:          return sizeof(uint16_t) * 2;
+            case VertexInputAttributeFormat::SNorm16x4:          return sizeof(uint16_t) * 4;
+            case VertexInputAttributeFormat::UNorm16x2:          return sizeof(uint16_t) * 2;
+            case VertexInputAttributeFormat::UNorm16x4:          return sizeof(uint16_t) * 4;
+            case VertexInputAttributeFormat::UNorm10_10_10_2:    return sizeof(uint32_t);
+            case VertexInputAttributeFormat::OctahedralNormal8:  return sizeof(uint8_t) * 2;
+            case VertexInputAttributeFormat::OctahedralNormal16: return sizeof(uint16_t) * 2;
+            default: return 0;
+        }
+    }
+
     struct VertexInputAttributeDescription {
         uint32_t location = 0;
         uint32_t offset = 0;
         VertexInputAttributeFormat format = VertexInputAttributeFormat::Float;
 
         VertexInputAttributeDescription() = delete;
-        VertexInputAttributeDescription(uint32_t location, VertexInputAttributeFormat format) : 
+        constexpr VertexInputAttributeDescription(uint32_t location, VertexInputAttributeFormat format) : 
                 location{ location }, format{ format } {}
+        constexpr VertexInputAttributeDescription(uint32_t location, VertexInputAttributeFormat format, uint32_t offset) : 
+                location{ location }, offset{ offset }, format{ format } {}
 
-        inline uint32_t GetSize() const {
-            switch (format) {
-                case VertexInputAttributeFormat::Float:   return sizeof(float);
-                case VertexInputAttributeFormat::Vector2: return sizeof(float) * 2;
-                case VertexInputAttributeFormat::Vector3: return sizeof(float) * 3;
-                case VertexInputAttributeFormat::Vector4: return sizeof(float) * 4;
-                default: return 0;
-            }
-        }
+        inline uint32_t GetSize() const { return GetVertexInputAttributeFormatSize(format); }
 
         inline VkFormat GetVkFormat() const {
             switch (format) {
@@ -39,6 +67,17 @@ namespace Vurl {
                 case VertexInputAttributeFormat::Vector2: return VK_FORMAT_R32G32_SFLOAT;
                 case VertexInputAttributeFormat::Vector3: return VK_FORMAT_R32G32B32_SFLOAT;
                 case VertexInputAttributeFormat::Vector4: return VK_FORMAT_R32G32B32A32_SFLOAT;
+                case VertexInputAttributeFormat::Half2:              return VK_FORMAT_R16G16_SFLOAT;
+                case VertexInputAttributeFormat::Half4:              return VK_FORMAT_R16G16B16A16_SFLOAT;
+                case VertexInputAttributeFormat::SNorm8x4:           return VK_FORMAT_R8G8B8A8_SNORM;
+                case VertexInputAttributeFormat::UNorm8x4:           return VK_FORMAT_R8G8B8A8_UNORM;
+                case VertexInputAttributeFormat::SNorm16x2:          return VK_FORMAT_R16G16_SNORM;
+                case VertexInputAttributeFormat::SNorm16x4:          return VK_FORMAT_R16G16B16A16_SNORM;
+                case VertexInputAttributeFormat::UNorm16x2:          return VK_FORMAT_R16G16_UNORM;
+                case VertexInputAttributeFormat::UNorm16x4:          return VK_FORMAT_R16G16B16A16_UNORM;
+                case VertexInputAttributeFormat::UNorm10_10_10_2:    return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+                case VertexInputAttributeFormat::OctahedralNormal8:  return VK_FORMAT_R8G8_SNORM;
+                case VertexInputAttributeFormat::OctahedralNormal16: return VK_FORMAT_R16G16_SNORM;
                 default: return VK_FORMAT_R32_SFLOAT;
             }
         }
@@ -47,12 +86,16 @@ namespace Vurl {
     class VertexInputDescription {
     public:
         VertexInputDescription() = default;
-        VertexInputDescription(std::initializer_list<VertexInputAttributeDescription> attributes) : attributes{ attributes } {
+        VertexInputDescription(std::initializer_list<VertexInputAttributeDescription> attributes, VkVertexInputRate rate = VK_VERTEX_INPUT_RATE_VERTEX) : 
+                attributes{ attributes }, inputRate{ rate } {
             for (VertexInputAttributeDescription& description : this->attributes) {
                 description.offset = stride;
                 stride += description.GetSize();
             }
         }
+        //Explicit offsets and stride, used by VertexLayout where the vertex struct may contain padding
+        VertexInputDescription(const VertexInputAttributeDescription* attributes, uint32_t attributeCount, uint32_t stride, VkVertexInputRate rate = VK_VERTEX_INPUT_RATE_VERTEX) : 
+                attributes(attributes, attributes + attributeCount), inputRate{ rate }, stride{ stride } {}
         ~VertexInputDescription() = default;
 
         inline uint32_t GetAttributeCount() const { return attributes.size(); }
@@ -74,16 +117,64 @@ namespace Vurl {
         uint32_t stride = 0;
     };
 
+    enum DynamicStateFlagBits {
+        DYNAMIC_STATE_VIEWPORT_BIT = 0x00000001,
+        DYNAMIC_STATE_SCISSOR_BIT = 0x00000002,
+        DYNAMIC_STATE_CULL_MODE_BIT = 0x00000004,
+        DYNAMIC_STATE_FRONT_FACE_BIT = 0x00000008,
+        DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_BIT = 0x00000010,
+        DYNAMIC_STATE_DEPTH_TEST_ENABLE_BIT = 0x00000020,
+        DYNAMIC_STATE_DEPTH_WRITE_ENABLE_BIT = 0x00000040,
+        DYNAMIC_STATE_DEPTH_COMPARE_OP_BIT = 0x00000080,
+        DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_BIT = 0x00000100,
+        DYNAMIC_STATE_ALL = 0x000001FF
+    };
+    typedef uint32_t DynamicStateFlags;
+
+    //States that need VK_EXT_extended_dynamic_state (1 or 2) to be dynamic
+    #define VURL_EXTENDED_DYNAMIC_STATE_FLAGS (DYNAMIC_STATE_CULL_MODE_BIT | DYNAMIC_STATE_FRONT_FACE_BIT | \
+            DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_BIT | DYNAMIC_STATE_DEPTH_TEST_ENABLE_BIT | DYNAMIC_STATE_DEPTH_WRITE_ENABLE_BIT | \
+            DYNAMIC_STATE_DEPTH_COMPARE_OP_BIT)
+    #define VURL_EXTENDED_DYNAMIC_STATE_2_FLAGS (DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_BIT)
+
+    struct SpecializationConstant {
+        VkShaderStageFlagBits stage = VK_SHADER_STAGE_VERTEX_BIT;
+        uint32_t constantId = 0;
+        uint32_t data = 0;
+    };
+
+    template<typename T>
+    constexpr SpecializationConstantType GetSpecializationConstantType() {
+        if constexpr (std::is_same_v<T, bool>)
+            return SpecializationConstantType::Bool;
+        else if constexpr (std::is_same_v<T, int32_t>)
+            return SpecializationConstantType::Int;
+        else if constexpr (std::is_same_v<T, uint32_t>)
+            return SpecializationConstantType::UInt;
+        else if constexpr (std::is_same_v<T, float>)
+            return SpecializationConstantType::Float;
+        else
+            return SpecializationConstantType::Unsupported;
+    }
+
     class GraphicsPipeline : public HashedObject {
     public:
         GraphicsPipeline() = delete;
         GraphicsPipeline(VkDevice device) : vkDevice{ device } {}
         ~GraphicsPipeline() = default;
 
+        //Descriptor set layouts are derived from the reflection of all stages, push constant ranges are added explicitly
         bool CreatePipelineLayout();
         void DestroyPipelineLayout();
         inline VkPipelineLayout GetPipelineLayout() const { return vkPipelineLayout; }
 
+        inline uint32_t GetDescriptorSetLayoutCount() const { return (uint32_t)descriptorSetLayouts.size(); }
+        inline const VkDescriptorSetLayout* GetDescriptorSetLayouts() const { return descriptorSetLayouts.data(); }
+        inline VkDescriptorSetLayout GetDescriptorSetLayout(uint32_t set) const { 
+            return set < descriptorSetLayouts.size() ? descriptorSetLayouts[set] : VK_NULL_HANDLE; 
+        }
+        const ShaderDescriptorBinding* FindDescriptorBinding(uint32_t set, uint32_t binding) const;
+
         inline void SetVertexShader(std::shared_ptr<Shader> shader) { vertexShader = shader; }
         inline std::shared_ptr<Shader> GetVertexShader() const { return vertexShader; }
 
@@ -101,6 +192,7 @@ namespace Vurl {
 
         inline uint32_t GetVertexInputCount() const { return vertexInputs.size(); }
         inline const VertexInputDescription& GetVertexInput(uint32_t idx) const { return vertexInputs[idx]; }
+        //Each vertex input is its own binding, numbered in the order they are added
         inline void AddVertexInput(const VertexInputDescription& inputDescription) { vertexInputs.push_back(inputDescription); }
         
         inline void AddPushConstantRange(VkShaderStageFlags stage, uint32_t offset, uint32_t size) {
@@ -112,29 +204,118 @@ namespace Vurl {
             AddPushConstantRange(stage, offset, sizeof(T));
         }
 
-        inline uint32_t GetDynamicStatesCount() const { return (uint32_t)dynamicStates.size(); }
-        inline const VkDynamicState* GetDynamicStates() const { return dynamicStates.data(); }
+        //Return false if the stage's shader has no constant with this id or its type doesn't match T.
+        template<typename T>
+        inline bool SetSpecializationConstant(VkShaderStageFlagBits stage, uint32_t constantId, T value) {
+            static_assert(GetSpecializationConstantType<T>() != SpecializationConstantType::Unsupported, 
+                    "Specialization constants must be bool, int32_t, uint32_t or float");
+            uint32_t data = 0;
+            if constexpr (std::is_same_v<T, bool>)
+                data = value ? VK_TRUE : VK_FALSE;
+            else
+                memcpy(&data, &value, sizeof(uint32_t));
+            return SetSpecializationConstant(stage, constantId, GetSpecializationConstantType<T>(), data);
+        }
+
+        bool SetSpecializationConstant(VkShaderStageFlagBits stage, uint32_t constantId, SpecializationConstantType type, uint32_t data);
+        void ClearSpecializationConstants() { specializationConstants.clear(); }
+        void GetSpecializationData(VkShaderStageFlagBits stage, std::vector<VkSpecializationMapEntry>& mapEntries, std::vector<uint32_t>& data) const;
+        std::shared_ptr<Shader> GetShader(VkShaderStageFlagBits stage) const;
+
+        //Identifies the current value set, each distinct one maps to its own cached pipeline variant
+        inline uint32_t GetSpecializationHash() const {
+            Hasher hasher{};
+            for (const SpecializationConstant& constant : specializationConstants) {
+                hasher.U32(constant.stage);
+                hasher.U32(constant.constantId);
+                hasher.U32(constant.data);
+            }
+            return hasher.Get();
+        }
+
+        inline uint32_t GetPushConstantRangeCount() const { return (uint32_t)pushConstantRanges.size(); }
+        inline const VkPushConstantRange* GetPushConstantRanges() const { return pushConstantRanges.data(); }
+
+        //Promote the given states to dynamic state, the graph set them at bind time.
+        //States needing an extension the device doesn't expose stay baked in the pipeline.
+        inline void SetDynamicStateFlags(DynamicStateFlags flags) { dynamicStateFlags = flags; }
+        inline DynamicStateFlags GetDynamicStateFlags() const { return dynamicStateFlags; }
 
         inline void SetPipelinePrimitiveTopology(VkPrimitiveTopology topology) { vkPrimitiveTopology = topology; }
         inline VkPrimitiveTopology GetPipelinePrimitiveTopology() const { return vkPrimitiveTopology; }
 
+        inline void SetPipelinePrimitiveRestartEnable(bool enable) { primitiveRestartEnable = enable; }
+        inline bool IsPipelinePrimitiveRestartEnabled() const { return primitiveRestartEnable; }
+
         inline void SetPipelineCullMode(VkCullModeFlagBits cullMode) { vkCullMode = cullMode; }
         inline VkCullModeFlagBits GetPipelineCullMode() const { return vkCullMode; }
 
+        inline void SetPipelineFrontFace(VkFrontFace frontFace) { vkFrontFace = frontFace; }
+        inline VkFrontFace GetPipelineFrontFace() const { return vkFrontFace; }
+
+        //Depth test and write only apply to passes with a depth stencil attachment
+        inline void SetPipelineDepthTestEnable(bool enable) { depthTestEnable = enable; }
+        inline bool IsPipelineDepthTestEnabled() const { return depthTestEnable; }
+
+        inline void SetPipelineDepthWriteEnable(bool enable) { depthWriteEnable = enable; }
+        inline bool IsPipelineDepthWriteEnabled() const { return depthWriteEnable; }
+
+        inline void SetPipelineDepthCompareOp(VkCompareOp compareOp) { vkDepthCompareOp = compareOp; }
+        inline VkCompareOp GetPipelineDepthCompareOp() const { return vkDepthCompareOp; }
+
+        static void GetVkDynamicStates(DynamicStateFlags flags, std::vector<VkDynamicState>& dynamicStates);
+        static VkPrimitiveTopology GetPrimitiveTopologyClass(VkPrimitiveTopology topology);
+
         inline uint32_t GetHash() const {
             Hasher hasher{};
+            Hash(hasher);
+            return hasher.Get();
+        }
+
+        //Every field a pipeline variant depends on, written to a Hasher or a HashKey. States are only left out when
+        //they are dynamic on the device, pass the dynamic states it supports.
+        template<typename T>
+        inline void Hash(T& hasher, DynamicStateFlags supportedDynamicStateFlags = ~0u) const {
+            DynamicStateFlags flags = dynamicStateFlags & supportedDynamicStateFlags;
             hasher.Ptr(vertexShader.get());
             hasher.Ptr(fragmentShader.get());
             hasher.Ptr(tessellationControlShader.get());
             hasher.Ptr(tessellationEvaluationShader.get());
             hasher.Ptr(geometryShader.get());
             hasher.Ptr(vkPipelineLayout);
-            for (uint32_t i = 0; i < dynamicStates.size(); ++i)
-                hasher.U32((uint32_t)dynamicStates[i]);
-            hasher.U32(vkPrimitiveTopology);
-            hasher.U32(vkCullMode);
-            return hasher.Get();
-        };
+            for (const VertexInputDescription& vertexInput : vertexInputs) {
+                hasher.U32(vertexInput.GetStride());
+                hasher.U32(vertexInput.GetInputRate());
+                for (uint32_t i = 0; i < vertexInput.GetAttributeCount(); ++i) {
+                    hasher.U32(vertexInput.GetAttribute(i).location);
+                    hasher.U32(vertexInput.GetAttribute(i).offset);
+                    hasher.U32((uint32_t)vertexInput.GetAttribute(i).format);
+                }
+            }
+            for (const SpecializationConstant& constant : specializationConstants) {
+                hasher.U32(constant.stage);
+                hasher.U32(constant.constantId);
+                hasher.U32(constant.data);
+            }
+            hasher.U32(flags);
+            //Dynamic states doesn't make a new pipeline permutation
+            if (flags & DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_BIT)
+                hasher.U32(GetPrimitiveTopologyClass(vkPrimitiveTopology));
+            else
+                hasher.U32(vkPrimitiveTopology);
+            if (!(flags & DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_BIT))
+                hasher.U32(primitiveRestartEnable);
+            if (!(flags & DYNAMIC_STATE_CULL_MODE_BIT))
+                hasher.U32(vkCullMode);
+            if (!(flags & DYNAMIC_STATE_FRONT_FACE_BIT))
+                hasher.U32(vkFrontFace);
+            if (!(flags & DYNAMIC_STATE_DEPTH_TEST_ENABLE_BIT))
+                hasher.U32(depthTestEnable);
+            if (!(flags & DYNAMIC_STATE_DEPTH_WRITE_ENABLE_BIT))
+                hasher.U32(depthWriteEnable);
+            if (!(flags & DYNAMIC_STATE_DEPTH_COMPARE_OP_BIT))
+                hasher.U32(vkDepthCompareOp);
+        }
 
     private:
         VkDevice vkDevice = VK_NULL_HANDLE;
@@ -146,11 +327,18 @@ namespace Vurl {
         std::shared_ptr<Shader> geometryShader = nullptr;
         
         VkPipelineLayout vkPipelineLayout = VK_NULL_HANDLE;
+        std::vector<VkDescriptorSetLayout> descriptorSetLayouts{};
 
         std::vector<VertexInputDescription> vertexInputs{};
         std::vector<VkPushConstantRange> pushConstantRanges{};
-        std::vector<VkDynamicState> dynamicStates{};
+        std::vector<SpecializationConstant> specializationConstants{};
+        DynamicStateFlags dynamicStateFlags = 0;
         VkPrimitiveTopology vkPrimitiveTopology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        bool primitiveRestartEnable = false;
         VkCullModeFlagBits vkCullMode = VK_CULL_MODE_BACK_BIT;
+        VkFrontFace vkFrontFace = VK_FRONT_FACE_CLOCKWISE;
+        bool depthTestEnable = true;
+        bool depthWriteEnable = true;
+        VkCompareOp vkDepthCompareOp = VK_COMPARE_OP_LESS;
     };
 }
\ No newline at end of file
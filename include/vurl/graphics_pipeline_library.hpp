@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vurl/vulkan_header.hpp>
+#include <vurl/hash.hpp>
+#include <vurl/deletion_queue.hpp>
+#include <unordered_map>
+#include <string>
+#include <future>
+
+namespace Vurl {
+    enum GraphicsPipelineLibraryPart {
+        GRAPHICS_PIPELINE_LIBRARY_PART_VERTEX_INPUT_INTERFACE = 0,
+        GRAPHICS_PIPELINE_LIBRARY_PART_PRE_RASTERIZATION_SHADERS,
+        GRAPHICS_PIPELINE_LIBRARY_PART_FRAGMENT_SHADER,
+        GRAPHICS_PIPELINE_LIBRARY_PART_FRAGMENT_OUTPUT_INTERFACE,
+        GRAPHICS_PIPELINE_LIBRARY_PART_MAX
+    };
+
+    //Split graphics pipelines into VK_EXT_graphics_pipeline_library parts, cache each part
+    //independently and hand out a fast-linked pipeline while the optimized one compiles in the background.
+    //Render passes are keyed by compatibility, so parts survive the new render passes of a rebuild.
+    class GraphicsPipelineLibrary {
+    private:
+        struct Part {
+            VkPipeline pipeline = VK_NULL_HANDLE;
+            uint32_t generation = 0;
+        };
+
+        struct LinkedPipeline {
+            VkPipeline fastLinked = VK_NULL_HANDLE;
+            VkPipeline optimized = VK_NULL_HANDLE;
+            std::future<VkPipeline> pendingOptimized{};
+            std::string key{};
+            uint32_t generation = 0;
+        };
+
+    public:
+        GraphicsPipelineLibrary() = delete;
+        GraphicsPipelineLibrary(VkDevice device, VkPipelineCache pipelineCache) : vkDevice{ device }, vkPipelineCache{ pipelineCache } {}
+        ~GraphicsPipelineLibrary() { Destroy(); }
+
+        //Return the id of the linked pipeline, 0 on failure. renderPassKey describes what makes createInfo.renderPass
+        //compatible with other render passes: attachment formats, samples and subpass references.
+        uint32_t Link(const VkGraphicsPipelineCreateInfo& createInfo, const std::string& renderPassKey);
+        //Return the optimized pipeline if it finished compiling, the fast-linked one otherwise.
+        VkPipeline GetLinkedPipeline(uint32_t id);
+        //Retire every part and link not used since the last call, frames in flight may still bind them.
+        void EvictUnused(DeletionQueue& deletionQueue);
+        void Destroy();
+
+        inline uint32_t GetPartCount(GraphicsPipelineLibraryPart part) const { return (uint32_t)parts[part].size(); }
+        inline uint32_t GetLinkedPipelineCount() const { return (uint32_t)linkedPipelines.size(); }
+
+    private:
+        VkPipeline GetPart(GraphicsPipelineLibraryPart part, const VkGraphicsPipelineCreateInfo& createInfo, const std::string& renderPassKey);
+        VkPipeline CreatePart(GraphicsPipelineLibraryPart part, const VkGraphicsPipelineCreateInfo& createInfo);
+        void HashPart(HashKey& hasher, GraphicsPipelineLibraryPart part, const VkGraphicsPipelineCreateInfo& createInfo, const std::string& renderPassKey);
+        void HashShaderStage(HashKey& hasher, const VkPipelineShaderStageCreateInfo& stage);
+        void HashDynamicState(HashKey& hasher, const VkPipelineDynamicStateCreateInfo* dynamicState);
+        VkPipeline CreateLinkedPipeline(VkPipelineLayout layout, const VkPipeline* libraries, bool optimized);
+
+    private:
+        VkDevice vkDevice = VK_NULL_HANDLE;
+        VkPipelineCache vkPipelineCache = VK_NULL_HANDLE;
+
+        std::unordered_map<std::string, Part> parts[GRAPHICS_PIPELINE_LIBRARY_PART_MAX]{};
+        std::unordered_map<std::string, uint32_t> linkedPipelineIds{};
+        std::unordered_map<uint32_t, LinkedPipeline> linkedPipelines{};
+        uint32_t nextLinkedPipelineId = 1;
+        uint32_t generation = 0;
+    };
+}
\ No newline at end of file
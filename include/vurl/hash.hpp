@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
 
 class Hasher {
 public:
@@ -50,6 +51,72 @@ private:
     uint32_t hash = 01610612741u;
 };
 
+//Takes the same fields as Hasher but keeps them, caches compare the whole key so a collision can't return the wrong entry
+class HashKey {
+public:
+    inline void U32(uint32_t v) {
+        key.append((const char*)&v, sizeof(v));
+    }
+
+    inline void S32(int32_t v) {
+        U32((uint32_t)v);
+    }
+
+    inline void F32(float v) {
+        key.append((const char*)&v, sizeof(v));
+    }
+
+    inline void Ptr(const void* ptr) {
+        key.append((const char*)&ptr, sizeof(ptr));
+    }
+
+    //Length prefixed so consecutive fields can't run into each other
+    inline void String(const char* data, size_t size) {
+        U32((uint32_t)size);
+        if (size > 0)
+            key.append(data, size);
+    }
+
+    template<typename T>
+    inline void Data(const T* data, size_t size) {
+        String((const char*)data, size * sizeof(T));
+    }
+
+    inline const std::string& Get() const { return key; }
+
+private:
+    std::string key{};
+};
+
+//128 bit hash of bytes in two 64 bit FNV lanes, FNV-1a and FNV-1 from different offset bases, for names of files
+//a cache keeps across runs where a 32 bit hash would collide
+class WideHasher {
+public:
+    inline void U32(uint32_t v) {
+        Data(&v, 1);
+    }
+
+    template<typename T>
+    inline void Data(const T* data, size_t size) {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < size * sizeof(T); ++i) {
+            hash[0] = (hash[0] ^ bytes[i]) * 1099511628211ull;
+            hash[1] = (hash[1] * 1099511628211ull) ^ bytes[i];
+        }
+    }
+
+    //Each lane mixed so every input bit reaches every output bit
+    inline uint64_t Get(uint32_t lane) const {
+        uint64_t h = hash[lane];
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+        return h ^ (h >> 31);
+    }
+
+private:
+    uint64_t hash[2] = { 14695981039346656037ull, 9650029242287828579ull };
+};
+
 class HashedObject {
 public:
     virtual uint32_t GetHash() const = 0;
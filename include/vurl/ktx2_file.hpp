@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vurl/vulkan_header.hpp>
+#include <vurl/error.hpp>
+#include <vurl/mapped_file.hpp>
+#include <string>
+#include <memory>
+#include <algorithm>
+
+namespace Vurl {
+    //File layout: 12 byte identifier, header, level index, then data format, key/value and supercompression data
+    //followed by the mip levels. Every field is little-endian.
+    struct Ktx2Header {
+        uint8_t identifier[12]{};
+        uint32_t vkFormat = 0;
+        uint32_t typeSize = 0;
+        uint32_t pixelWidth = 0;
+        uint32_t pixelHeight = 0;
+        uint32_t pixelDepth = 0;
+        uint32_t layerCount = 0;
+        uint32_t faceCount = 0;
+        uint32_t levelCount = 0;
+        uint32_t supercompressionScheme = 0;
+        uint32_t dfdByteOffset = 0;
+        uint32_t dfdByteLength = 0;
+        uint32_t kvdByteOffset = 0;
+        uint32_t kvdByteLength = 0;
+        uint64_t sgdByteOffset = 0;
+        uint64_t sgdByteLength = 0;
+    };
+
+    struct Ktx2Level {
+        uint64_t byteOffset = 0;
+        uint64_t byteLength = 0;
+        uint64_t uncompressedByteLength = 0;
+    };
+
+    //Memory-mapped KTX2 container, level data is read straight from the mapping.
+    //Supercompressed and Basis Universal files are rejected.
+    class Ktx2File {
+    public:
+        Ktx2File() = default;
+        ~Ktx2File() { Close(); }
+
+        VurlResult Open(const std::string& path);
+        void Close();
+
+        inline bool IsOpen() const { return header != nullptr; }
+        inline VkFormat GetFormat() const { return (VkFormat)header->vkFormat; }
+        inline uint32_t GetWidth() const { return header->pixelWidth; }
+        inline uint32_t GetHeight() const { return std::max(header->pixelHeight, 1u); }
+        inline uint32_t GetDepth() const { return std::max(header->pixelDepth, 1u); }
+        inline uint32_t GetLayerCount() const { return std::max(header->layerCount, 1u); }
+        inline uint32_t GetFaceCount() const { return header->faceCount; }
+        //0 means the file only stores the base level and the rest of the chain should be generated
+        inline uint32_t GetLevelCount() const { return header->levelCount; }
+        //Every layer and face of the level, tightly packed in layer then face order
+        inline const uint8_t* GetLevelData(uint32_t level) const { return file->GetData() + levels[level].byteOffset; }
+        inline uint64_t GetLevelSize(uint32_t level) const { return levels[level].byteLength; }
+        //Value of an entry of the key/value data, false when the file has no such key
+        bool GetKeyValue(const std::string& key, const uint8_t*& value, uint32_t& size) const;
+
+    private:
+        std::shared_ptr<MappedFile> file = nullptr;
+        const Ktx2Header* header = nullptr;
+        const Ktx2Level* levels = nullptr;
+    };
+}
\ No newline at end of file
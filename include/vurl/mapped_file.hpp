@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace Vurl {
+    //Read-only memory mapping of a whole file
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile() { Close(); }
+
+        bool Open(const std::string& path);
+        void Close();
+
+        inline const uint8_t* GetData() const { return data; }
+        inline size_t GetSize() const { return size; }
+        inline bool IsOpen() const { return data != nullptr; }
+
+    private:
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+    };
+}
\ No newline at end of file
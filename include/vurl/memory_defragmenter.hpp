@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vurl/render_graph.hpp>
+#include <vurl/resource.hpp>
+#include <vurl/texture.hpp>
+#include <vurl/buffer.hpp>
+#include <vurl/memory_pool.hpp>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Vurl {
+    //Exactly one of texture and buffer is set, sliceIndex is the slice that got new handles
+    struct DefragmentationMove {
+        std::shared_ptr<Resource<Texture>> texture = nullptr;
+        std::shared_ptr<Resource<Buffer>> buffer = nullptr;
+        uint32_t sliceIndex = 0;
+    };
+
+    struct DefragmentationStatistics {
+        uint32_t passCount = 0;
+        uint32_t movedAllocationCount = 0;
+        uint64_t movedBytes = 0;
+        uint32_t freedBlockCount = 0;
+        uint64_t freedBytes = 0;
+    };
+
+    //Compacts device memory with VMA's incremental defragmentation. Each pass moves at most the per-pass budget,
+    //the contents are copied with the graph's pending copies at the start of the next frame and the pass ends once
+    //that frame completed, which frees the old memory and any block left empty. Only registered resources move,
+    //never register attachments or storage bindings, passes have their handles baked into descriptors.
+    class MemoryDefragmenter {
+    private:
+        struct MovableResource {
+            std::shared_ptr<Resource<Texture>> texture = nullptr;
+            std::shared_ptr<Resource<Buffer>> buffer = nullptr;
+        };
+
+    public:
+        MemoryDefragmenter() = delete;
+        MemoryDefragmenter(std::shared_ptr<RenderGraph> graph) : graph{ graph } {}
+        //Wait for the device to be idle first when a defragmentation is still running
+        ~MemoryDefragmenter() { Stop(); }
+
+        void AddTexture(std::shared_ptr<Resource<Texture>> texture);
+        void AddBuffer(std::shared_ptr<Resource<Buffer>> buffer);
+        void Remove(std::shared_ptr<Resource<Texture>> texture);
+        void Remove(std::shared_ptr<Resource<Buffer>> buffer);
+
+        //Queue the pools of a class, the default class compacts the allocator's own blocks.
+        //Linear pools cannot be defragmented and are skipped.
+        void Start(ResourceClass resourceClass = RESOURCE_CLASS_DEFAULT);
+        void Stop();
+        inline bool IsActive() const { return defragmentationContext != VK_NULL_HANDLE || !pendingPools.empty(); }
+
+        //Call once per frame before RenderGraph::Execute
+        void Update();
+
+        //Bytes and allocations one pass may move, 0 is unlimited
+        inline void SetPassBudget(VkDeviceSize bytes, uint32_t allocations) { maxBytesPerPass = bytes; maxAllocationsPerPass = allocations; }
+        //Called right after a slice got new handles, descriptors or bindless tables holding the old ones must be updated
+        inline void SetMoveCallback(std::function<void(const DefragmentationMove&)> callback) { moveCallback = callback; }
+
+        inline const DefragmentationStatistics& GetStatistics() const { return statistics; }
+        inline void ResetStatistics() { statistics = {}; }
+
+    private:
+        bool BeginDefragmentation();
+        void EndDefragmentation();
+        void BeginPass();
+        bool MoveAllocation(const VmaDefragmentationMove& move);
+
+    private:
+        std::shared_ptr<RenderGraph> graph = nullptr;
+        std::vector<MovableResource> resources{};
+        std::function<void(const DefragmentationMove&)> moveCallback = nullptr;
+        VkDeviceSize maxBytesPerPass = 32 * 1024 * 1024;
+        uint32_t maxAllocationsPerPass = 64;
+
+        //VK_NULL_HANDLE stands for the allocator's own blocks
+        std::vector<VmaPool> pendingPools{};
+        VmaDefragmentationContext defragmentationContext = VK_NULL_HANDLE;
+        VmaDefragmentationPassMoveInfo passInfo{};
+        bool passActive = false;
+        uint64_t passFrameIndex = 0;
+        std::unordered_map<VmaAllocation, DefragmentationMove> movableAllocations{};
+        DefragmentationStatistics statistics{};
+    };
+}
\ No newline at end of file
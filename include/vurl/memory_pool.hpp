@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vurl/vulkan_header.hpp>
+
+namespace Vurl {
+    //Resources of one class are allocated together so small long-lived allocations don't fragment the blocks
+    //large short-lived ones come and go in
+    enum ResourceClass {
+        RESOURCE_CLASS_DEFAULT = 0,
+        RESOURCE_CLASS_RENDER_TARGET,
+        RESOURCE_CLASS_STATIC_GEOMETRY,
+        RESOURCE_CLASS_PER_FRAME,
+        RESOURCE_CLASS_STAGING,
+        RESOURCE_CLASS_MAX
+    };
+
+    enum class AllocationStrategy {
+        Default,
+        //Best fit, for long-lived allocations
+        MinMemory,
+        //First fit, for allocations made every frame
+        MinTime
+    };
+
+    //Pools are created per memory type the first time a class allocates from it, settings changed later only
+    //apply to pools created after. Allocations a pool cannot hold fall back to the allocator's own blocks.
+    struct MemoryPoolSettings {
+        //0 picks the allocator's preferred block size
+        VkDeviceSize blockSize = 0;
+        //0 is unlimited, a linear pool with a single block is a ring buffer freed in allocation order
+        size_t maxBlockCount = 0;
+        AllocationStrategy strategy = AllocationStrategy::Default;
+        bool linear = false;
+        //Every allocation gets its own memory block instead of a pool
+        bool dedicated = false;
+    };
+}
\ No newline at end of file
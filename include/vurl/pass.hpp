@@ -1,6 +1,13 @@
 #pragma once
 
+#include <vurl/render_graph_def.hpp>
+#include <vurl/resource.hpp>
+#include <vurl/texture.hpp>
+#include <vurl/buffer.hpp>
+#include <vurl/command_encoder.hpp>
 #include <string>
+#include <vector>
+#include <memory>
 
 namespace Vurl {
     class RenderGraph;
@@ -8,9 +15,38 @@ namespace Vurl {
     enum class PassType {
         Graphics,
         Compute,
+        Transfer,
         RayTracing
     };
 
+    //How a pass uses a buffer or image outside of its attachments
+    enum class ResourceAccessType {
+        VertexBuffer,
+        IndexBuffer,
+        IndirectBuffer,
+        UniformBuffer,
+        SampledImage,
+        StorageRead,
+        StorageWrite,
+        StorageReadWrite,
+        TransferRead,
+        TransferWrite
+    };
+
+    struct ResourceAccess {
+        bool isTexture = false;
+        int handle = VURL_NULL_HANDLE;
+        ResourceAccessType type = ResourceAccessType::StorageRead;
+    };
+
+    //Storage resources are bound to descriptor set 0 of the pass pipeline, at the binding given
+    template<typename Handle>
+    struct StorageBinding {
+        Handle handle = VURL_NULL_HANDLE;
+        uint32_t binding = 0;
+        ResourceAccessType access = ResourceAccessType::StorageRead;
+    };
+
     class Pass {
     public:
         Pass() = delete;
@@ -21,8 +57,30 @@ namespace Vurl {
 
         inline const std::string& GetName() const { return name; }
 
+        //Declared accesses order the pass against other passes using the resource and get the barriers they need
+        void AddBufferAccess(std::shared_ptr<Resource<Buffer>> buffer, ResourceAccessType type);
+        void AddTextureAccess(std::shared_ptr<Resource<Texture>> texture, ResourceAccessType type);
+
+        inline uint32_t GetResourceAccessCount() const { return resourceAccesses.size(); }
+        inline const ResourceAccess& GetResourceAccess(uint32_t idx) const { return resourceAccesses[idx]; }
+
+        //Commands the graph recorded for the pass in the last executed frame
+        inline const CommandEncoderStatistics& GetCommandStatistics() const { return commandStatistics; }
+        inline void SetCommandStatistics(const CommandEncoderStatistics& statistics) { commandStatistics = statistics; }
+
+        static bool IsBufferAccessType(ResourceAccessType type);
+        static bool IsTextureAccessType(ResourceAccessType type);
+        static bool IsReadAccessType(ResourceAccessType type);
+        static bool IsWriteAccessType(ResourceAccessType type);
+        static bool IsStorageAccessType(ResourceAccessType type);
+
+    protected:
+        void AddResourceAccess(bool isTexture, int handle, ResourceAccessType type);
+
     protected:
         std::string name{};
         RenderGraph* graph = nullptr;
+        std::vector<ResourceAccess> resourceAccesses{};
+        CommandEncoderStatistics commandStatistics{};
     };
 }
\ No newline at end of file
@@ -3,10 +3,18 @@
 #include <volk.h>
 #include <vurl/pass.hpp>
 #include <vurl/graphics_pass.hpp>
+#include <vurl/compute_pass.hpp>
+#include <vurl/transfer_pass.hpp>
 #include <vurl/render_graph_def.hpp>
 #include <vurl/graphics_pipeline.hpp>
+#include <vurl/graphics_pipeline_library.hpp>
+#include <vurl/compute_pipeline.hpp>
+#include <vurl/descriptor.hpp>
+#include <vurl/deletion_queue.hpp>
+#include <vurl/command_encoder.hpp>
 #include <vurl/resource.hpp>
 #include <vurl/texture.hpp>
+#include <vurl/ktx2_file.hpp>
 #include <vurl/buffer.hpp>
 #include <vurl/rendering_context.hpp>
 #include <vurl/surface.hpp>
@@ -15,32 +23,194 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <functional>
+#include <atomic>
 
 namespace Vurl {
+    #define VURL_GRAPHICS_SHADER_STAGE_COUNT 2
+    #define VURL_ATTACHMENT_STAGES (VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | \
+            VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT)
+    #define VURL_GRAPHICS_SHADER_STAGES (VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT)
+
     class RenderGraph {
     private:
+        struct ShaderObjectPass {
+            VkShaderEXT shaders[VURL_GRAPHICS_SHADER_STAGE_COUNT]{};
+            std::vector<VkVertexInputBindingDescription2EXT> vertexBindings{};
+            std::vector<VkVertexInputAttributeDescription2EXT> vertexAttributes{};
+        };
+
+        struct SpecializationData {
+            std::vector<VkSpecializationMapEntry> mapEntries{};
+            std::vector<uint32_t> data{};
+            VkSpecializationInfo info{};
+        };
+
+        //One set per combination of resource slices, picked by frame or by swapchain image
+        struct PassDescriptorSets {
+            std::vector<VkDescriptorSet> sets{};
+            bool usesBackBuffer = false;
+        };
+
         struct GraphicsPassGroup {
             std::vector<std::shared_ptr<GraphicsPass>> passes{};
             std::unordered_map<TextureHandle, VkAttachmentDescription> attachmentDescriptions{};
+            std::unordered_map<TextureHandle, VkClearValue> attachmentClearValues{};
             std::vector<VkPipeline> pipelines{};
+            std::vector<uint32_t> linkedPipelineIds{};
+            std::vector<DynamicStateFlags> dynamicStateFlags{};
+            std::vector<uint32_t> specializationHashes{};
             std::vector<VkFramebuffer> framebuffers{};
             std::vector<VkClearValue> clearValues{};
+            std::vector<PassDescriptorSets> descriptorSets{};
             VkRenderPass vkRenderPass = VK_NULL_HANDLE;
+            //Equal for compatible render passes, pipelines are cached under it instead of the handle
+            std::string renderPassKey{};
             VkViewport viewport{};
             VkRect2D scissor{};
-            uint32_t minSwapchainColorAttachmentSubpassIndex = -1;
+            uint32_t minSwapchainColorAttachmentSubpassIndex = VURL_INVALID_PASS_INDEX;
+            bool useShaderObjects = false;
+            std::vector<ShaderObjectPass> shaderObjectPasses{};
+        };
+
+        struct ComputePassData {
+            std::shared_ptr<ComputePass> pass = nullptr;
+            VkPipeline pipeline = VK_NULL_HANDLE;
+            uint32_t specializationHash = 0;
+            PassDescriptorSets descriptorSets{};
+        };
+
+        //Adjacent transfer passes that don't touch each other's writes share one barrier batch and one set of copy commands.
+        //The async batch runs on the transfer queue, the next frame waits for it.
+        struct TransferPassBatch {
+            std::vector<uint32_t> passIndices{};
+            uint32_t stepIndex = 0;
+            bool async = false;
+        };
+
+        struct StagingBuffer {
+            VkBuffer vkBuffer = VK_NULL_HANDLE;
+            VmaAllocation allocation = VK_NULL_HANDLE;
+        };
+
+        //Uploads to one texture slice, recorded with those of every other texture in one batch
+        struct PendingTextureUpload {
+            std::shared_ptr<Texture> slice = nullptr;
+            std::vector<std::pair<VkBuffer, VkBufferImageCopy>> copies{};
+            VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            bool generateMips = false;
+        };
+
+        //Levels kept when a texture drops its top mips, the old image is retired once the copy is recorded
+        struct PendingTextureCopy {
+            std::shared_ptr<Texture> srcSlice = nullptr;
+            std::shared_ptr<Texture> dstSlice = nullptr;
+            std::vector<VkImageCopy> regions{};
+        };
+
+        struct PendingBufferCopy {
+            VkBuffer srcBuffer = VK_NULL_HANDLE;
+            VkBuffer dstBuffer = VK_NULL_HANDLE;
+            VkBufferCopy region{};
+            //Copies within a buffer may read what the previous copy wrote
+            bool barrierBefore = false;
+        };
+
+        //How a pass touches a resource, merged over everything the pass declares for it.
+        //version is the resource version the pass reads, or produces when it writes.
+        struct PassResourceAccess {
+            bool isTexture = false;
+            int handle = VURL_NULL_HANDLE;
+            bool read = false;
+            bool write = false;
+            VkPipelineStageFlags stageMask = 0;
+            VkAccessFlags accessMask = 0;
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+            uint32_t version = 0;
+        };
+
+        //Each write starts a new version, readers of a version must run before the next write
+        struct ResourceVersion {
+            uint32_t version = 0;
+            uint32_t writerPassIndex = VURL_INVALID_PASS_INDEX;
+            std::vector<uint32_t> readerPassIndices{};
+        };
+
+        //What the barrier generator knows about the current version of a resource
+        struct ResourceState {
+            VkPipelineStageFlags writeStageMask = 0;
+            VkAccessFlags writeAccessMask = 0;
+            VkPipelineStageFlags readStageMask = 0;
+            VkAccessFlags readAccessMask = 0;
+            VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        };
+
+        struct PassBarrier {
+            bool isTexture = false;
+            int handle = VURL_NULL_HANDLE;
+            VkAccessFlags srcAccessMask = 0;
+            VkAccessFlags dstAccessMask = 0;
+            VkImageLayout oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            VkImageLayout newLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        };
+
+        //One culled pass in execution order, index points into graphicsPassGroups, computePasses or transferPassBatches
+        struct PassExecutionStep {
+            uint32_t passIndex = 0;
+            PassType passType = PassType::Graphics;
+            uint32_t index = 0;
+            VkPipelineStageFlags srcStageMask = 0;
+            VkPipelineStageFlags dstStageMask = 0;
+            std::vector<PassBarrier> barriers{};
+        };
+
+        struct GraphicsPipelineCreateInfo {
+            std::vector<VkDynamicState> dynamicStates{};
+            VkPipelineDynamicStateCreateInfo dynamicState{};
+            std::vector<VkVertexInputBindingDescription> bindingDescriptions{};
+            std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+            VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+            VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
+            VkPipelineViewportStateCreateInfo viewportState{};
+            VkPipelineRasterizationStateCreateInfo rasterizer{};
+            VkPipelineMultisampleStateCreateInfo multisampling{};
+            VkPipelineDepthStencilStateCreateInfo depthStencil{};
+            std::vector<VkPipelineColorBlendAttachmentState> blendAttachmentStates{};
+            VkPipelineColorBlendStateCreateInfo colorBlending{};
+            VkPipelineLayout pipelineLayout{};
+            std::vector<VkPipelineShaderStageCreateInfo> stages{};
+            SpecializationData specializations[VURL_GRAPHICS_SHADER_STAGE_COUNT]{};
+            VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
         };
 
     public:
         RenderGraph() = delete;
         RenderGraph(std::shared_ptr<RenderingContext> context);
+        //Runs the teardown below if it was skipped, the device must still exist
         ~RenderGraph();
         
         void SetSurface(std::shared_ptr<Surface> surface);
+        inline std::shared_ptr<RenderingContext> GetContext() const { return context; }
+        inline uint64_t GetFrameIndex() const { return frameIndex; }
+        //Objects the frames in flight may still use are retired here instead of destroyed
+        inline std::shared_ptr<DeletionQueue> GetDeletionQueue() const { return deletionQueue; }
 
         BufferHandle GetBufferHandle(std::shared_ptr<Resource<Buffer>> buffer);
         void AddExternalBuffer(std::shared_ptr<Resource<Buffer>> buffer);
         void CommitBuffer(std::shared_ptr<Resource<Buffer>> buffer, const uint8_t* initialData = nullptr, uint32_t size = 0);
+        //Both are recorded at the start of the next frame, after everything earlier frames do with the buffer
+        void UpdateBuffer(std::shared_ptr<Resource<Buffer>> buffer, const uint8_t* data, uint32_t size, VkDeviceSize offset = 0);
+        //The ranges may overlap
+        void MoveBufferRange(std::shared_ptr<Resource<Buffer>> buffer, VkDeviceSize srcOffset, VkDeviceSize dstOffset, VkDeviceSize size);
+        //Copy between committed buffers at the start of the next frame, offsets into imported buffers are relative to the imported data
+        void CopyBuffer(std::shared_ptr<Resource<Buffer>> dst, VkDeviceSize dstOffset, std::shared_ptr<Resource<Buffer>> src, 
+                VkDeviceSize srcOffset, VkDeviceSize size);
+        //Wrap host memory such as a file mapping as a buffer with VK_EXT_external_memory_host instead of copying it.
+        //owner is kept alive with the buffer. Returns false when the extension is missing or the driver rejects the
+        //memory, some drivers refuse read-only mappings, commit the buffer with a copy of the data then. Also false when
+        //the data is not aligned for how the buffer is used, such as minStorageBufferOffsetAlignment for storage buffers.
+        //Nothing is replaced unless every slice imports.
+        bool ImportHostBuffer(std::shared_ptr<Resource<Buffer>> buffer, const void* hostPointer, VkDeviceSize size, std::shared_ptr<void> owner = nullptr);
 
         template<typename T>
         std::shared_ptr<T> CreateBuffer(const std::string& name, bool transient = true) {
@@ -55,7 +225,39 @@ namespace Vurl {
 
         TextureHandle GetTextureHandle(std::shared_ptr<Resource<Texture>> texture);
         void AddExternalTexture(std::shared_ptr<Resource<Texture>> texture);
+        //initialData holds the tightly packed base level of every layer, the other levels are generated from it.
+        //Uploaded textures are left in the layout the graph expects for read-only textures.
         void CommitTexture(std::shared_ptr<Resource<Texture>> texture, const uint8_t* initialData = nullptr, uint32_t size = 0);
+        //Take format, extent, layers and every mip level from baseLevel down from the file. Block formats the device
+        //cannot sample are decompressed to RGBA8 on the CPU, other unsupported formats fail.
+        VurlResult CommitTexture(std::shared_ptr<Resource<Texture>> texture, const Ktx2File& file, uint32_t baseLevel = 0);
+        //Upload one mip level of a committed texture the graph only reads, recorded at the start of the next frame
+        void UpdateTexture(std::shared_ptr<Resource<Texture>> texture, const uint8_t* data, uint32_t size, 
+                uint32_t mipLevel = 0, uint32_t baseArrayLayer = 0, uint32_t layerCount = 1);
+        //Rebuild every level past the base one with linear blits, formats without blit support keep their levels
+        void GenerateMips(std::shared_ptr<Resource<Texture>> texture);
+        //Committed textures up to this size are copied from host memory with VK_EXT_host_image_copy when the device
+        //supports it for their format without losing optimal device access. 0 stages every upload.
+        inline void SetHostImageCopySizeLimit(VkDeviceSize size) { hostImageCopySizeLimit = size; }
+        TextureUploadStatistics GetTextureUploadStatistics() const;
+        void ResetTextureUploadStatistics();
+
+        //Release the memory of a committed texture or buffer once frames in flight are done with it, committing
+        //it again restores it. Descriptors built with the old handles are not updated, don't evict resources passes use.
+        void EvictTexture(std::shared_ptr<Resource<Texture>> texture);
+        void EvictBuffer(std::shared_ptr<Resource<Buffer>> buffer);
+        //Replace a committed texture with one levelCount levels smaller that keeps the remaining mip levels.
+        //Fails for textures with pending uploads or without enough levels, and leaves the texture as it was when the
+        //new image cannot be created.
+        bool DropTextureMips(std::shared_ptr<Resource<Texture>> texture, uint32_t levelCount = 1);
+        //Replace a committed texture with one of the given base extent and levelCount more levels, the current levels are
+        //copied to the bottom of the chain. Upload the new top levels with UpdateTexture in the same frame. Fails like DropTextureMips.
+        bool AddTextureMips(std::shared_ptr<Resource<Texture>> texture, uint32_t levelCount, VkExtent3D extent);
+        //Recreate one slice in the memory of a VMA defragmentation move and copy its contents over at the start of the
+        //next frame. The old handle is retired, end the defragmentation pass once that frame completed. Fails for
+        //host-visible or imported buffers, resources without both transfer usages and textures with pending uploads.
+        bool MoveBuffer(std::shared_ptr<Buffer> slice, VmaAllocation allocation);
+        bool MoveTexture(std::shared_ptr<Texture> slice, VmaAllocation allocation);
 
         template<typename T>
         std::shared_ptr<T> CreateTexture(const std::string& name, bool transient = true) {
@@ -69,6 +271,8 @@ namespace Vurl {
         }
         
         std::shared_ptr<GraphicsPass> CreateGraphicsPass(const std::string& name, std::shared_ptr<GraphicsPipeline> pipeline);
+        std::shared_ptr<ComputePass> CreateComputePass(const std::string& name, std::shared_ptr<ComputePipeline> pipeline);
+        std::shared_ptr<TransferPass> CreateTransferPass(const std::string& name);
         std::shared_ptr<Pass> GetPassByName(const std::string& name);
         template<typename T>
         inline std::shared_ptr<T> GetPassByName(const std::string& name) {
@@ -76,35 +280,105 @@ namespace Vurl {
         }
 
         void Build();
+        //Everything Build created is retired with the frame being recorded, a rebuild never waits for the device
         void Destroy();
         void Execute();
+        //Wait for the frames in flight, then destroy everything retired and the frame synchronization objects.
+        //Call once after the last Destroy, before the device goes away.
+        void DestroyFrameResources();
 
         void CreatePipelineCache();
         void DestroyPipelineCache();
 
+        inline void SetUseGraphicsPipelineLibrary(bool use) { useGraphicsPipelineLibrary = use; }
+        inline bool IsGraphicsPipelineLibraryUsed() const { return pipelineLibrary != nullptr; }
+
+        //Compile shaders into VK_EXT_shader_object instead of pipelines, ignored if the device lacks it
+        inline void SetUseShaderObjects(bool use) { useShaderObjects = use; }
+        inline bool IsShaderObjectUsed() const { return useShaderObjects && context->IsDeviceExtensionEnabled(DEVICE_EXTENSION_SHADER_OBJECT); }
+
         void CreateTransientCommandPool();
         void DestroyTransientCommandPool();
     private:
         bool BuildDirectedPassesGraph();
+        void CollectPassResourceAccesses(uint32_t passIndex, std::vector<PassResourceAccess>& accesses);
+        void AddPassResourceAccess(std::vector<PassResourceAccess>& accesses, const PassResourceAccess& access);
+        static void GetPassResourceAccess(PassType passType, const ResourceAccess& resourceAccess, PassResourceAccess& access);
+        bool SortPasses();
         bool BuildGraphicsPassGroups();
         bool BuildGraphicsPassGroup(uint32_t firstPass);
+        bool BuildGraphicsPassGroupAttachments(GraphicsPassGroup* group);
+        bool AddGraphicsPassGroupAttachment(GraphicsPassGroup* group, TextureHandle h, VkImageLayout layout, 
+                const VkAttachmentDescription& defaultAttachmentDescription);
         bool BuildGraphicsPassGroupRenderPass(GraphicsPassGroup* group);
         bool BuildGraphicsPassGroupFramebuffers(GraphicsPassGroup* group);
         bool BuildGraphicsPassGroupGraphicsPipelines(GraphicsPassGroup* group);
+        bool LinkGraphicsPassGroupGraphicsPipelines(GraphicsPassGroup* group, std::vector<GraphicsPipelineCreateInfo>& createInfos);
+        bool CreateGraphicsPipelineVariant(GraphicsPassGroup* group, uint32_t passIndex, const VkGraphicsPipelineCreateInfo& createInfo);
+        void FillGraphicsPipelineCreateInfo(GraphicsPassGroup* group, uint32_t passIndex, GraphicsPipelineCreateInfo& createInfo);
+        DynamicStateFlags GetSupportedDynamicStateFlags() const;
+        bool GetSpecializationInfo(std::shared_ptr<GraphicsPipeline> pipeline, VkShaderStageFlagBits stage, SpecializationData& specialization);
+        std::string GetGraphicsPipelineVariantKey(GraphicsPassGroup* group, uint32_t passIndex);
+        bool UpdateGraphicsPassPipelineVariant(GraphicsPassGroup* group, uint32_t passIndex);
+        bool BuildGraphicsPassGroupShaderObjects(GraphicsPassGroup* group);
+        bool BuildComputePasses();
+        bool BuildPassDescriptorSets(const std::vector<StorageBinding<BufferHandle>>& storageBuffers, 
+                const std::vector<StorageBinding<TextureHandle>>& storageImages, VkDescriptorSetLayout setLayout, 
+                const std::function<const ShaderDescriptorBinding*(uint32_t)>& findBinding, PassDescriptorSets& descriptorSets);
+        void FillComputePipelineCreateInfo(ComputePassData* computePass, SpecializationData& specialization, VkComputePipelineCreateInfo& createInfo);
+        std::string GetComputePipelineVariantKey(ComputePassData* computePass);
+        bool UpdateComputePassPipelineVariant(ComputePassData* computePass);
+        bool BuildPassBarriers();
+        void UpdateResourceState(const PassResourceAccess& access, ResourceState& state, bool firstUse, PassExecutionStep* step);
+        uint32_t GetTransferPassBatchStep(uint32_t passIndex);
+        bool CanJoinTransferPassBatch(const TransferPassBatch& batch, uint32_t passIndex);
+        bool IsAsyncTransferPass(uint32_t passIndex);
         bool BuildCommandBuffers();
         bool BuildSynchronizationObjects();
         //bool BuildTransientResource();
 
         void DestroyGraphicsPassGroups();
+        void DestroyComputePasses();
+        void DestroyDescriptorSetAllocator();
         void DestroyCommandBuffers();
         void DestroySynchronizationObjects();
+        StagingBuffer CreateStagingBuffer(const uint8_t* data, VkDeviceSize size);
+        bool HasPendingBufferCopy(VkBuffer buffer);
+        void RetireTexture(const Texture& texture);
+        void RetireBuffer(const Buffer& buffer);
+        bool CreateTextureImage(std::shared_ptr<Texture> slice, VmaAllocation allocation = VK_NULL_HANDLE);
+        //droppedLevelCount is negative when levels are added on top
+        bool ReplaceTextureImage(std::shared_ptr<Resource<Texture>> texture, VkExtent3D extent, int32_t droppedLevelCount);
+        PendingTextureUpload& GetPendingTextureUpload(std::shared_ptr<Texture> slice);
+        VkImageLayout GetTextureUploadLayout(std::shared_ptr<Texture> slice);
+        bool CanGenerateMips(std::shared_ptr<Texture> slice);
+        bool CanHostCopyTexture(std::shared_ptr<Texture> slice, VkDeviceSize size);
+        //Transition the new image to its upload layout and copy the regions, bufferOffset is relative to data
+        void CopyMemoryToTexture(std::shared_ptr<Texture> slice, const uint8_t* data, VkDeviceSize size, const VkBufferImageCopy* regions, uint32_t regionCount);
 
         bool ExecuteGraphicsPassGroup(GraphicsPassGroup* group, VkCommandBuffer commandBuffer, uint32_t swapchainImageIndex);
+        void SetGraphicsPassDynamicState(GraphicsPassGroup* group, uint32_t passIndex);
+        bool ExecuteGraphicsPassGroupShaderObjects(GraphicsPassGroup* group, VkCommandBuffer commandBuffer, uint32_t swapchainImageIndex);
+        void SetGraphicsPassShaderObjectState(GraphicsPassGroup* group, uint32_t passIndex, VkCommandBuffer commandBuffer);
+        void RecordGraphicsPass(GraphicsPassGroup* group, uint32_t passIndex, uint32_t swapchainImageIndex);
+        bool ExecuteComputePass(ComputePassData* computePass, uint32_t swapchainImageIndex);
+        bool ExecuteTransferPassBatch(TransferPassBatch* batch, VkCommandBuffer commandBuffer, uint32_t swapchainImageIndex);
+        bool SubmitAsyncTransferPassBatch(uint32_t inFlightFrameIndex, uint32_t swapchainImageIndex, VkSemaphore waitSemaphore);
+        void RecordPendingBufferCopies(VkCommandBuffer commandBuffer);
+        void RecordPendingTextureCopies(VkCommandBuffer commandBuffer);
+        void RecordPendingTextureUploads(VkCommandBuffer commandBuffer);
+        VkImageLayout GetPassTextureLayout(uint32_t passIndex, TextureHandle h);
+        void RecordPassBarriers(const PassExecutionStep& step, VkCommandBuffer commandBuffer, uint32_t swapchainImageIndex);
+        std::shared_ptr<Buffer> GetBufferSlice(BufferHandle h);
+        VkImageLayout GetAttachmentLayout(TextureHandle h, bool inputAttachment);
+        std::shared_ptr<Texture> GetAttachmentSlice(TextureHandle h, uint32_t swapchainImageIndex);
+        VkImageMemoryBarrier GetAttachmentBarrier(std::shared_ptr<Texture> slice, VkImageLayout oldLayout, VkImageLayout newLayout);
         VkCommandBuffer BeginTransientCommandBuffer();
         void SubmitAndEndTransientCommandBuffer(VkCommandBuffer commandBuffer);
 
     private:
         bool complete = false;
+        bool hasHostVisibleBuffers = false;
 
         std::shared_ptr<RenderingContext> context = nullptr;
         uint64_t frameIndex = 0;
@@ -112,12 +386,41 @@ namespace Vurl {
         std::shared_ptr<Surface> surface = nullptr;
         
         VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+        std::shared_ptr<GraphicsPipelineLibrary> pipelineLibrary = nullptr;
+        std::unordered_map<std::string, VkPipeline> pipelineVariants{};
+        std::shared_ptr<DescriptorSetAllocator> descriptorSetAllocator = nullptr;
+        bool useGraphicsPipelineLibrary = true;
+        bool useShaderObjects = false;
+        const VkShaderStageFlagBits graphicsShaderStages[VURL_GRAPHICS_SHADER_STAGE_COUNT] = { VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT };
         VkCommandPool transientCommandPool = VK_NULL_HANDLE;
         VkCommandPool commandPool = VK_NULL_HANDLE;
-        VkCommandBuffer primaryCommandBuffers[VURL_MAX_FRAMES_IN_FLIGHT];
-        VkSemaphore availableSwapchainImageSemaphores[VURL_MAX_FRAMES_IN_FLIGHT];
-        VkSemaphore renderFinishedSemaphores[VURL_MAX_FRAMES_IN_FLIGHT];
-        VkFence inFlightFences[VURL_MAX_FRAMES_IN_FLIGHT];
+        VkCommandBuffer primaryCommandBuffers[VURL_MAX_FRAMES_IN_FLIGHT]{};
+        VkSemaphore availableSwapchainImageSemaphores[VURL_MAX_FRAMES_IN_FLIGHT]{};
+        VkSemaphore renderFinishedSemaphores[VURL_MAX_FRAMES_IN_FLIGHT]{};
+        VkFence inFlightFences[VURL_MAX_FRAMES_IN_FLIGHT]{};
+        //Wraps the primary command buffer of the frame being recorded
+        CommandEncoder commandEncoder{};
+        VkCommandPool transferCommandPool = VK_NULL_HANDLE;
+        VkCommandBuffer transferCommandBuffers[VURL_MAX_FRAMES_IN_FLIGHT]{};
+        VkSemaphore transferFinishedSemaphores[VURL_MAX_FRAMES_IN_FLIGHT]{};
+        //Signaled by frames whose buffer updates the async batch has to wait for
+        VkSemaphore uploadFinishedSemaphores[VURL_MAX_FRAMES_IN_FLIGHT]{};
+        VkFence transferFences[VURL_MAX_FRAMES_IN_FLIGHT]{};
+        //Slots whose last transfer queue submission hasn't been waited on yet
+        bool transferSubmitted[VURL_MAX_FRAMES_IN_FLIGHT]{};
+        int pendingTransferSemaphoreIndex = VURL_NULL_HANDLE;
+
+        std::vector<PendingBufferCopy> pendingBufferCopies{};
+        std::vector<PendingTextureUpload> pendingTextureUploads{};
+        std::vector<PendingTextureCopy> pendingTextureCopies{};
+        std::shared_ptr<DeletionQueue> deletionQueue = nullptr;
+        VkDeviceSize hostImageCopySizeLimit = VK_WHOLE_SIZE;
+        //Host copies may run on loader threads
+        std::atomic<uint64_t> hostCopyBytes{ 0 };
+        std::atomic<uint32_t> hostCopyCount{ 0 };
+        std::atomic<uint64_t> hostCopyNanoseconds{ 0 };
+        std::atomic<uint64_t> stagedTextureBytes{ 0 };
+        std::atomic<uint32_t> stagedTextureCount{ 0 };
 
         std::vector<std::shared_ptr<Resource<Buffer>>> buffers{};
         std::vector<std::shared_ptr<Resource<Texture>>> textures{};
@@ -126,7 +429,13 @@ namespace Vurl {
         std::vector<std::shared_ptr<Pass>> passes{};
         std::vector<std::vector<uint32_t>> culledDirectedPassesGraph{};
         std::vector<uint32_t> beginPasses{};
+        std::vector<uint32_t> sortedPasses{};
+        std::vector<std::vector<PassResourceAccess>> passResourceAccesses{};
 
         std::vector<GraphicsPassGroup> graphicsPassGroups{};
+        std::vector<ComputePassData> computePasses{};
+        std::vector<TransferPassBatch> transferPassBatches{};
+        int asyncTransferPassBatch = VURL_NULL_HANDLE;
+        std::vector<PassExecutionStep> executionSteps{};
     };
 }
\ No newline at end of file
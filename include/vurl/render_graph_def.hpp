@@ -1,6 +1,8 @@
 #pragma once
+#include <cstdint>
 
 #define VURL_NULL_HANDLE -1
+#define VURL_INVALID_PASS_INDEX UINT32_MAX
 #define VURL_MAX_ATTACHMENT_COUNT 8
 #define VURL_MAX_FRAMES_IN_FLIGHT 3
 
@@ -2,7 +2,9 @@
 
 #include <vurl/vulkan_header.hpp>
 #include <vurl/error.hpp>
+#include <vurl/memory_pool.hpp>
 #include <vector>
+#include <mutex>
 
 namespace Vurl {
     enum QueueIndices {
@@ -14,6 +16,34 @@ namespace Vurl {
         QUEUE_INDEX_MAX
     };
 
+    enum DeviceExtension {
+        DEVICE_EXTENSION_GRAPHICS_PIPELINE_LIBRARY = 0,
+        DEVICE_EXTENSION_EXTENDED_DYNAMIC_STATE,
+        DEVICE_EXTENSION_EXTENDED_DYNAMIC_STATE_2,
+        DEVICE_EXTENSION_SHADER_OBJECT,
+        DEVICE_EXTENSION_MULTI_DRAW,
+        DEVICE_EXTENSION_HOST_IMAGE_COPY,
+        DEVICE_EXTENSION_EXTERNAL_MEMORY_HOST,
+        DEVICE_EXTENSION_MEMORY_BUDGET,
+        DEVICE_EXTENSION_MAX
+    };
+
+    //Core features enabled when the device supports them
+    enum DeviceFeature {
+        DEVICE_FEATURE_MULTI_DRAW_INDIRECT = 0,
+        DEVICE_FEATURE_DRAW_INDIRECT_COUNT,
+        DEVICE_FEATURE_MAX
+    };
+
+    //usage and budget come from VK_EXT_memory_budget when it is enabled, otherwise they are VMA's own estimates
+    struct MemoryHeapBudget {
+        VkDeviceSize usage = 0;
+        VkDeviceSize budget = 0;
+        VkDeviceSize allocationBytes = 0;
+        VkDeviceSize blockBytes = 0;
+        bool deviceLocal = false;
+    };
+
     struct QueueInfo {
         VkQueue queues[QUEUE_INDEX_MAX];
         uint32_t familyIndices[QUEUE_INDEX_MAX];
@@ -22,7 +52,7 @@ namespace Vurl {
 
     class RenderingContext {
     public:
-        RenderingContext() = default;
+        RenderingContext() { InitMemoryPoolSettings(); }
         ~RenderingContext() = default;
 
         VurlResult CreateInstance(const VkApplicationInfo* applicationInfo, const char** instanceExtensions, 
@@ -37,12 +67,44 @@ namespace Vurl {
         inline VkDevice GetDevice() const { return vkDevice; }
         inline VmaAllocator GetAllocator() const { return vmaAllocator; }
         inline const QueueInfo& GetQueueInfo() const { return queueInfo; }
+        inline bool HasDedicatedTransferQueue() const { return queueInfo.familyIndices[QUEUE_INDEX_TRANSFER] != queueInfo.familyIndices[QUEUE_INDEX_GRAPHICS]; }
+        inline bool IsDeviceExtensionEnabled(DeviceExtension extension) const { return enabledOptionalDeviceExtensions[extension]; }
+        inline bool IsDeviceFeatureEnabled(DeviceFeature feature) const { return enabledDeviceFeatures[feature]; }
+        //0 when VK_EXT_multi_draw is not enabled
+        inline uint32_t GetMaxMultiDrawCount() const { return maxMultiDrawCount; }
+        //False for every layout when VK_EXT_host_image_copy is not enabled
+        bool IsHostImageCopyDstLayout(VkImageLayout layout) const;
+        //0 when VK_EXT_external_memory_host is not enabled
+        inline VkDeviceSize GetMinImportedHostPointerAlignment() const { return minImportedHostPointerAlignment; }
+        //One entry per memory heap
+        std::vector<MemoryHeapBudget> GetMemoryHeapBudgets() const;
+        uint32_t GetMemoryHeapIndex(VmaAllocation allocation) const;
+
+        //Set before the first allocation of the class
+        void SetMemoryPoolSettings(ResourceClass resourceClass, const MemoryPoolSettings& settings);
+        inline const MemoryPoolSettings& GetMemoryPoolSettings(ResourceClass resourceClass) const { return memoryPoolSettings[resourceClass]; }
+        //Summed over the pools of every memory type, allocations that fell back to the allocator's blocks are not counted
+        VmaStatistics GetMemoryPoolStatistics(ResourceClass resourceClass) const;
+        //Pools the class created so far, one per memory type it allocated from
+        std::vector<VmaPool> GetMemoryPools(ResourceClass resourceClass) const;
+        //vmaCreateBuffer and vmaCreateImage with the strategy and pool of the class applied
+        VkResult AllocateBuffer(ResourceClass resourceClass, const VkBufferCreateInfo& bufferCreateInfo, const VmaAllocationCreateInfo& allocationCreateInfo, 
+                VkBuffer* buffer, VmaAllocation* allocation, VmaAllocationInfo* allocationInfo = nullptr);
+        VkResult AllocateImage(ResourceClass resourceClass, const VkImageCreateInfo& imageCreateInfo, const VmaAllocationCreateInfo& allocationCreateInfo, 
+                VkImage* image, VmaAllocation* allocation, VmaAllocationInfo* allocationInfo = nullptr);
 
     private:
         bool HasExtension(VkExtensionProperties* extensions, uint32_t extensionCount, const char* extension);
         bool HasLayer(VkLayerProperties* layers, uint32_t layerCount, const char* layer);
         QueueInfo GetPhysicalDeviceQueueInfo(VkSurfaceKHR surface, VkPhysicalDevice device);
         int RatePhysicalDevice(VkSurfaceKHR surface, VkPhysicalDevice device, const char** extensions, uint32_t extensionCount);
+        void GetOptionalDeviceExtensionNames(DeviceExtension extension, std::vector<const char*>& names);
+        void* ChainOptionalDeviceExtensionFeatures(DeviceExtension extension, void* pNext);
+        bool HasOptionalDeviceExtensionFeatures(DeviceExtension extension);
+        void InitMemoryPoolSettings();
+        void FillMemoryPoolAllocationCreateInfo(ResourceClass resourceClass, VmaAllocationCreateInfo& allocationCreateInfo);
+        VmaPool GetMemoryPool(ResourceClass resourceClass, uint32_t memoryTypeIndex);
+        void DestroyMemoryPools();
         
     private:
         VkInstance vkInstance = VK_NULL_HANDLE;
@@ -55,6 +117,25 @@ namespace Vurl {
         std::vector<const char*> enabledValidationLayers{};
         std::vector<const char*> enabledInstanceExtensions{};
         std::vector<const char*> enabledDeviceExtensions{};
+        bool enabledOptionalDeviceExtensions[DEVICE_EXTENSION_MAX]{};
+        bool enabledDeviceFeatures[DEVICE_FEATURE_MAX]{};
+        uint32_t maxMultiDrawCount = 0;
+        std::vector<VkImageLayout> hostImageCopyDstLayouts{};
+        VkDeviceSize minImportedHostPointerAlignment = 0;
+
+        MemoryPoolSettings memoryPoolSettings[RESOURCE_CLASS_MAX]{};
+        VmaPool memoryPools[RESOURCE_CLASS_MAX][VK_MAX_MEMORY_TYPES]{};
+        //Textures may be committed from loader threads
+        std::mutex memoryPoolMutex{};
+
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures{};
+        VkPhysicalDeviceExtendedDynamicStateFeaturesEXT extendedDynamicStateFeatures{};
+        VkPhysicalDeviceExtendedDynamicState2FeaturesEXT extendedDynamicState2Features{};
+        VkPhysicalDeviceShaderObjectFeaturesEXT shaderObjectFeatures{};
+        VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+        VkPhysicalDeviceMultiDrawFeaturesEXT multiDrawFeatures{};
+        VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures{};
+        VkPhysicalDeviceVulkan12Features vulkan12Features{};
     };
 
 }
\ No newline at end of file
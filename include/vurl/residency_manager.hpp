@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vurl/render_graph.hpp>
+#include <vurl/resource.hpp>
+#include <vurl/texture.hpp>
+#include <vurl/buffer.hpp>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Vurl {
+    enum class ResidencyAction {
+        DroppedMips,
+        Evicted
+    };
+
+    //Exactly one of texture and buffer is set
+    struct ResidencyEvent {
+        ResidencyAction action = ResidencyAction::Evicted;
+        std::shared_ptr<Resource<Texture>> texture = nullptr;
+        std::shared_ptr<Resource<Buffer>> buffer = nullptr;
+        uint32_t heapIndex = 0;
+        VkDeviceSize releasedBytes = 0;
+    };
+
+    struct ResidencyStatistics {
+        uint32_t droppedMipCount = 0;
+        uint32_t evictedTextureCount = 0;
+        uint32_t evictedBufferCount = 0;
+        uint64_t releasedBytes = 0;
+        uint32_t overBudgetUpdates = 0;
+    };
+
+    //Keeps registered textures and buffers under the budget of their device-local heap. Once a heap's usage passes
+    //the threshold, the least recently touched textures drop their top mip levels, then the least recently touched
+    //resources are evicted. Only resources idle for minIdleFrames are touched. Never register attachments or storage
+    //bindings, passes have their handles baked into descriptors and framebuffers.
+    class ResidencyManager {
+    private:
+        struct ResidentResource {
+            std::shared_ptr<Resource<Texture>> texture = nullptr;
+            std::shared_ptr<Resource<Buffer>> buffer = nullptr;
+            uint32_t minMipLevels = 1;
+            uint64_t lastUsedFrame = 0;
+        };
+
+        //Released memory stays allocated until frames in flight are done with it
+        struct PendingRelease {
+            uint64_t frameIndex = 0;
+            uint32_t heapIndex = 0;
+            VkDeviceSize size = 0;
+        };
+
+    public:
+        ResidencyManager() = delete;
+        ResidencyManager(std::shared_ptr<RenderGraph> graph) : graph{ graph } {}
+        ~ResidencyManager() = default;
+
+        //Textures never drop below minMipLevels levels, they are evicted instead
+        void AddTexture(std::shared_ptr<Resource<Texture>> texture, uint32_t minMipLevels = 1);
+        void AddBuffer(std::shared_ptr<Resource<Buffer>> buffer);
+        void Remove(std::shared_ptr<Resource<Texture>> texture);
+        void Remove(std::shared_ptr<Resource<Buffer>> buffer);
+        //Mark a resource as used by the frame being recorded
+        void Touch(std::shared_ptr<Resource<Texture>> texture);
+        void Touch(std::shared_ptr<Resource<Buffer>> buffer);
+
+        //Call once per frame before RenderGraph::Execute
+        void Update();
+
+        //Fraction of each heap's budget usage is kept under
+        inline void SetBudgetThreshold(float threshold) { budgetThreshold = threshold; }
+        inline void SetMinIdleFrames(uint32_t frames) { minIdleFrames = frames; }
+        //Called after every downgrade or eviction, descriptors holding the old handles must be rebuilt
+        inline void SetEvictionCallback(std::function<void(const ResidencyEvent&)> callback) { evictionCallback = callback; }
+
+        inline const ResidencyStatistics& GetStatistics() const { return statistics; }
+        inline void ResetStatistics() { statistics = {}; }
+
+    private:
+        bool IsResident(const ResidentResource& resource) const;
+        VkDeviceSize GetResidentSize(const ResidentResource& resource) const;
+        uint32_t GetHeapIndex(const ResidentResource& resource) const;
+        VkDeviceSize GetPendingReleaseSize(uint32_t heapIndex) const;
+        VkDeviceSize DropMips(ResidentResource& resource, uint32_t heapIndex);
+        VkDeviceSize Evict(ResidentResource& resource, uint32_t heapIndex);
+
+    private:
+        std::shared_ptr<RenderGraph> graph = nullptr;
+        std::vector<ResidentResource> resources{};
+        std::vector<PendingRelease> pendingReleases{};
+        std::function<void(const ResidencyEvent&)> evictionCallback = nullptr;
+        float budgetThreshold = 0.9f;
+        uint32_t minIdleFrames = VURL_MAX_FRAMES_IN_FLIGHT;
+        ResidencyStatistics statistics{};
+    };
+}
\ No newline at end of file
@@ -3,8 +3,40 @@
 #include <vurl/vulkan_header.hpp>
 #include <vurl/error.hpp>
 #include <string>
+#include <vector>
+#include <memory>
 
 namespace Vurl {
+    enum class SpecializationConstantType {
+        Bool,
+        Int,
+        UInt,
+        Float,
+        Unsupported
+    };
+
+    struct SpecializationConstantInfo {
+        uint32_t constantId = 0;
+        SpecializationConstantType type = SpecializationConstantType::Unsupported;
+        std::string name{};
+    };
+
+    struct ShaderDescriptorBinding {
+        uint32_t set = 0;
+        uint32_t binding = 0;
+        VkDescriptorType descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+        uint32_t descriptorCount = 1;
+    };
+
+    //The subset of SPIRV-Reflect output the library consumes, small enough to serialize
+    struct ShaderReflection {
+        VkShaderStageFlagBits stage = VK_SHADER_STAGE_VERTEX_BIT;
+        std::vector<ShaderDescriptorBinding> descriptorBindings{};
+        std::vector<VkPushConstantRange> pushConstantRanges{};
+        std::vector<SpecializationConstantInfo> specializationConstants{};
+        uint32_t localSize[3]{};
+    };
+
     class Shader {
     public:
         Shader() = delete;
@@ -12,18 +44,39 @@ namespace Vurl {
         ~Shader();
 
         VurlResult CreateShaderModule(const uint32_t* source, uint32_t size);
+        //Use already reflected code, codeStorage keeps the memory source points to alive.
+        VurlResult CreateShaderModule(const uint32_t* source, uint32_t size, const ShaderReflection& reflection, std::shared_ptr<const void> codeStorage);
         void DestroyShaderModule();
         inline VkShaderModule GetShaderModule() const { return vkShaderModule; }
-        inline SpvReflectShaderModule GetReflectShaderModule() const { return spvReflectShaderModule; }
+        //Only valid for modules reflected at creation, prefer GetReflection
+        inline const SpvReflectShaderModule& GetReflectShaderModule() const { return spvReflectShaderModule; }
+        inline const ShaderReflection& GetReflection() const { return reflection; }
+
+        //SPIR-V is retained for backends that compile straight from code like shader objects
+        inline const uint32_t* GetCode() const { return code; }
+        inline size_t GetCodeSize() const { return codeSize; }
+
+        inline uint32_t GetSpecializationConstantCount() const { return (uint32_t)reflection.specializationConstants.size(); }
+        inline const SpecializationConstantInfo& GetSpecializationConstant(uint32_t idx) const { return reflection.specializationConstants[idx]; }
+        const SpecializationConstantInfo* FindSpecializationConstant(uint32_t constantId) const;
+
+        static void Reflect(const SpvReflectShaderModule& module, const uint32_t* code, size_t size, ShaderReflection& reflection);
 
         inline void SetEntryPointName(const std::string& name) { entrypointName = name; }
         inline const char* GetEntryPointName() const { return entrypointName.c_str(); }
     
+    private:
+        static void ReflectSpecializationConstants(const SpvReflectShaderModule& module, const uint32_t* code, size_t size, ShaderReflection& reflection);
+
     private:
         VkDevice vkDevice = VK_NULL_HANDLE;
 
         VkShaderModule vkShaderModule = VK_NULL_HANDLE;
         SpvReflectShaderModule spvReflectShaderModule = {};
+        const uint32_t* code = nullptr;
+        size_t codeSize = 0;
+        std::shared_ptr<const void> codeStorage = nullptr;
+        ShaderReflection reflection{};
         std::string entrypointName = "main";
     };
 }
\ No newline at end of file
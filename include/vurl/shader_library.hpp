@@ -0,0 +1,93 @@
+#pragma once
+
+#include <vurl/vulkan_header.hpp>
+#include <vurl/error.hpp>
+#include <vurl/shader.hpp>
+#include <vurl/mapped_file.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+
+#define VURL_SHADER_LIBRARY_MAGIC 0x42494C53 //"SLIB"
+#define VURL_SHADER_LIBRARY_VERSION 1
+
+namespace Vurl {
+    //File layout: header, entries sorted by name hash, blobs, then names, SPIR-V and reflection data.
+    //Every field is a little-endian uint32_t and every section is 4 byte aligned.
+    struct ShaderLibraryHeader {
+        uint32_t magic = VURL_SHADER_LIBRARY_MAGIC;
+        uint32_t version = VURL_SHADER_LIBRARY_VERSION;
+        uint32_t entryCount = 0;
+        uint32_t blobCount = 0;
+    };
+
+    struct ShaderLibraryEntry {
+        uint32_t nameHash = 0;
+        uint32_t nameOffset = 0;
+        uint32_t nameSize = 0;
+        uint32_t blobIndex = 0;
+    };
+
+    struct ShaderLibraryBlob {
+        uint32_t contentHash = 0;
+        uint32_t codeOffset = 0;
+        uint32_t codeSize = 0;
+        uint32_t reflectionOffset = 0;
+        uint32_t reflectionSize = 0;
+    };
+
+    //Memory-mapped pack of deduplicated SPIR-V with pre-serialized reflection, modules are created on first use.
+    class ShaderLibrary {
+    public:
+        ShaderLibrary() = delete;
+        ShaderLibrary(VkDevice device) : vkDevice{ device } {}
+        ~ShaderLibrary() { Close(); }
+
+        VurlResult Open(const std::string& path);
+        //Destroy every module created from the library, shaders handed out must not be used after.
+        void Close();
+
+        //Return nullptr if the library has no shader with this name.
+        std::shared_ptr<Shader> GetShader(const std::string& name);
+
+        inline uint32_t GetShaderCount() const { return header ? header->entryCount : 0; }
+        inline uint32_t GetBlobCount() const { return header ? header->blobCount : 0; }
+
+    private:
+        const ShaderLibraryEntry* FindEntry(const std::string& name) const;
+        bool ReadReflection(const ShaderLibraryBlob& blob, ShaderReflection& reflection) const;
+
+    private:
+        VkDevice vkDevice = VK_NULL_HANDLE;
+
+        std::shared_ptr<MappedFile> file = nullptr;
+        const ShaderLibraryHeader* header = nullptr;
+        const ShaderLibraryEntry* entries = nullptr;
+        const ShaderLibraryBlob* blobs = nullptr;
+        std::vector<std::shared_ptr<Shader>> shaders{};
+    };
+
+    class ShaderLibraryWriter {
+    private:
+        struct PendingEntry {
+            std::string name{};
+            uint32_t nameHash = 0;
+            uint32_t blobIndex = 0;
+        };
+
+        struct PendingBlob {
+            uint32_t contentHash = 0;
+            std::vector<uint32_t> code{};
+            std::vector<uint32_t> reflection{};
+        };
+
+    public:
+        //Reflect and add SPIR-V under name, identical code is only stored once.
+        VurlResult AddShader(const std::string& name, const uint32_t* code, uint32_t size);
+        bool Write(const std::string& path) const;
+
+    private:
+        std::vector<PendingEntry> entries{};
+        std::vector<PendingBlob> blobs{};
+    };
+}
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <vurl/wsi/wsi.hpp>
 #include <vurl/texture.hpp>
 #include <vurl/error.hpp>
+#include <vurl/deletion_queue.hpp>
 #include <memory>
 
 namespace Vurl {
@@ -18,6 +19,9 @@ namespace Vurl {
 
         VurlResult CreateSwapchain(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t width, uint32_t height);
         void DestroySwapchain();
+        //Frames in flight may still present to the old swapchain, it is retired and handed to the next
+        //CreateSwapchain as the old one. Create the new swapchain before the graph executes again.
+        void DestroySwapchain(std::shared_ptr<DeletionQueue> deletionQueue);
 
         inline VkSurfaceKHR GetSurfaceKHR() const { return vkSurface; }
         inline VkSwapchainKHR GetSwapchainKHR() const { return vkSwapchain; }
@@ -45,6 +49,7 @@ namespace Vurl {
 
         VkSurfaceKHR vkSurface = VK_NULL_HANDLE;
         VkSwapchainKHR vkSwapchain = VK_NULL_HANDLE;
+        VkSwapchainKHR retiredSwapchain = VK_NULL_HANDLE;
         uint32_t swapchainImageCount = 0;
         uint32_t width = 0;
         uint32_t height = 0;
@@ -2,6 +2,8 @@
 
 #include <vurl/vulkan_header.hpp>
 #include <vurl/resource.hpp>
+#include <vurl/memory_pool.hpp>
+#include <algorithm>
 
 namespace Vurl {
     enum class TextureSizeClass {
@@ -22,6 +24,33 @@ namespace Vurl {
         uint32_t width = 1;
         uint32_t height = 1;
         uint32_t depth = 1;
+        uint32_t mipLevels = 1;
+        uint32_t arrayLayers = 1;
         TextureSizeClass sizeClass = TextureSizeClass::Absolute;
+        //Default gives attachments dedicated allocations as render targets
+        ResourceClass resourceClass = RESOURCE_CLASS_DEFAULT;
     };
+
+    //Texture data written straight to images with VK_EXT_host_image_copy against data that went through staging buffers
+    struct TextureUploadStatistics {
+        uint64_t hostCopyBytes = 0;
+        uint32_t hostCopyCount = 0;
+        double hostCopySeconds = 0.0;
+        uint64_t stagedBytes = 0;
+        uint32_t stagedCount = 0;
+
+        //Bytes per second of host copies, 0 before the first one
+        inline double GetHostCopyThroughput() const { return hostCopySeconds > 0.0 ? (double)hostCopyBytes / hostCopySeconds : 0.0; }
+    };
+
+    //Levels of a full mip chain down to 1x1x1
+    inline uint32_t GetMipLevelCount(uint32_t width, uint32_t height, uint32_t depth = 1) {
+        uint32_t size = std::max(std::max(width, height), depth);
+        uint32_t levels = 1;
+        while (size > 1) {
+            size >>= 1;
+            ++levels;
+        }
+        return levels;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <vurl/vulkan_header.hpp>
+#include <vurl/ktx2_file.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace Vurl {
+    //Bytes per 4x4 block of a compressed format DecompressImage can decode, 0 for any other format.
+    //Covers BC1-BC5 and the ETC2 RGB/RGBA formats, ASTC and BC6H/BC7 have no CPU fallback.
+    uint32_t GetDecompressibleBlockSize(VkFormat format);
+    inline bool CanDecompressFormat(VkFormat format) { return GetDecompressibleBlockSize(format) != 0; }
+    //RGBA8 format decoded texels are uploaded as, keeps sRGB encoding
+    VkFormat GetDecompressedFormat(VkFormat format);
+
+    //Bytes of one tightly packed image of width x height x depth texels, 0 for formats without a fixed texel
+    //block size such as depth/stencil and multi-planar formats
+    uint64_t GetImageSize(VkFormat format, uint32_t width, uint32_t height, uint32_t depth);
+
+    //Decode one image of width x height x depth texels into tightly packed RGBA8.
+    //One and two channel formats fill red and green, the remaining channels get 0 and alpha 255.
+    bool DecompressImage(VkFormat format, const uint8_t* blocks, uint64_t size, uint32_t width, uint32_t height, uint32_t depth, uint8_t* texels);
+    //Decode every layer and face of one level of a KTX2 file and append the texels, in the order the file stores them
+    bool DecompressKtx2Level(const Ktx2File& file, uint32_t level, std::vector<uint8_t>& texels);
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vurl/vulkan_header.hpp>
+#include <vurl/error.hpp>
+#include <vurl/ktx2_file.hpp>
+#include <string>
+#include <cstdint>
+
+namespace Vurl {
+    enum class TextureEncodeQuality {
+        //Bounding box endpoints
+        Fast,
+        //Principal axis endpoints
+        Normal,
+        //Principal axis endpoints refined by least squares, and every BC7 p-bit and BC4 mode tried
+        High
+    };
+
+    //Bytes per 4x4 block of a format the encoder can produce, 0 for any other format.
+    //Covers BC1, BC3, BC5 and BC7, BC7 blocks are always mode 6.
+    uint32_t GetEncodableBlockSize(VkFormat format);
+    inline bool CanEncodeFormat(VkFormat format) { return GetEncodableBlockSize(format) != 0; }
+
+    //Compress RGBA8 images to BC formats on the CPU, spread across worker threads by block row.
+    //Encoded mip chains are written to a cache directory as KTX2 files named after a 128 bit hash of the source key.
+    //The key is stored in the file as well and compared on lookup, a colliding entry is encoded again.
+    class TextureEncoder {
+    public:
+        TextureEncoder() = delete;
+        //threadCount 0 uses every hardware thread
+        TextureEncoder(const std::string& cacheDirectory, uint32_t threadCount = 0);
+
+        //Look up the encoded texture in the cache, encode and store it on a miss, then open the cached file.
+        //The file can be committed with RenderGraph::CommitTexture.
+        VurlResult Encode(const uint8_t* rgba, uint32_t width, uint32_t height, VkFormat format, Ktx2File& file, bool generateMips = true);
+        //Compress one tightly packed RGBA8 image into blocks, row by row
+        bool EncodeImage(const uint8_t* rgba, uint32_t width, uint32_t height, VkFormat format, uint8_t* blocks);
+
+        inline void SetQuality(TextureEncodeQuality quality) { this->quality = quality; }
+        inline TextureEncodeQuality GetQuality() const { return quality; }
+        inline uint32_t GetThreadCount() const { return threadCount; }
+        inline uint32_t GetCacheHitCount() const { return cacheHitCount; }
+        inline uint32_t GetCacheMissCount() const { return cacheMissCount; }
+
+    private:
+        std::string GetCacheKey(const uint8_t* rgba, uint32_t width, uint32_t height, VkFormat format, bool generateMips) const;
+        std::string GetCachePath(const std::string& key) const;
+        bool WriteCacheFile(const std::string& path, const std::string& key, const uint8_t* rgba, uint32_t width, uint32_t height, 
+                VkFormat format, bool generateMips);
+
+    private:
+        std::string cacheDirectory{};
+        uint32_t threadCount = 1;
+        TextureEncodeQuality quality = TextureEncodeQuality::Normal;
+        uint32_t cacheHitCount = 0;
+        uint32_t cacheMissCount = 0;
+    };
+}
\ No newline at end of file
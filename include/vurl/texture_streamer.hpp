@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vurl/render_graph.hpp>
+#include <vurl/resource.hpp>
+#include <vurl/texture.hpp>
+#include <vurl/buffer.hpp>
+#include <vurl/ktx2_file.hpp>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace Vurl {
+    typedef int StreamedTextureHandle;
+
+    struct TextureStreamingStatistics {
+        uint64_t loadedBytes = 0;
+        uint64_t uploadedBytes = 0;
+        uint32_t uploadedLevelCount = 0;
+        //Updates that left loaded levels waiting because the upload budget ran out
+        uint32_t budgetLimitedUpdates = 0;
+    };
+
+    //Commits KTX2 textures with only their smallest levels and streams the larger ones in as they are requested.
+    //Levels are read, and decompressed when needed, on background threads. Each Update uploads what is loaded
+    //within the per-frame budget by swapping in an image with more levels. Levels are file levels, 0 is the largest.
+    class TextureStreamer {
+    private:
+        struct LoadedLevel {
+            uint32_t level = 0;
+            std::vector<uint8_t> data{};
+            bool valid = false;
+        };
+
+        struct StreamedTexture {
+            std::shared_ptr<Resource<Texture>> texture = nullptr;
+            std::shared_ptr<Ktx2File> file = nullptr;
+            bool decompress = false;
+            uint32_t tailLevel = 0;
+            uint32_t requestedLevel = 0;
+            //Lowest level requested since the last Update
+            uint32_t frameRequestedLevel = UINT32_MAX;
+            std::future<LoadedLevel> pendingLoad{};
+            //Loaded and waiting for upload, largest level last
+            std::vector<LoadedLevel> loadedLevels{};
+        };
+
+    public:
+        TextureStreamer() = delete;
+        TextureStreamer(std::shared_ptr<RenderGraph> graph, uint32_t maxPendingLoads = 0);
+        ~TextureStreamer() = default;
+
+        //Commit the smallest residentLevelCount levels of the file, the texture streams toward level 0 from there.
+        //Files storing only a base level are committed whole. Returns VURL_NULL_HANDLE when the commit fails.
+        StreamedTextureHandle AddTexture(std::shared_ptr<Resource<Texture>> texture, std::shared_ptr<Ktx2File> file, uint32_t residentLevelCount = 1);
+        //Stop streaming, levels already uploaded stay
+        void Remove(StreamedTextureHandle handle);
+
+        //Ask for the texture to be streamed up to level, the lowest request between two updates wins.
+        //Requests only raise detail, ResidencyManager is the one to lower it again.
+        void RequestMipLevel(StreamedTextureHandle handle, uint32_t level);
+        //Host-visible buffer of one uint per handle that shaders lower with atomicMin, read and reset by Update.
+        //Frames in flight may still write the slice being read, requests are hints and lag by a few frames.
+        inline void SetFeedbackBuffer(std::shared_ptr<Resource<Buffer>> buffer) { feedbackBuffer = buffer; }
+        //0 uploads everything loaded every frame
+        inline void SetUploadBudget(VkDeviceSize bytesPerFrame) { uploadBudget = bytesPerFrame; }
+
+        //Call once per frame before RenderGraph::Execute
+        void Update();
+
+        //Largest file level currently resident, UINT32_MAX for evicted textures
+        uint32_t GetResidentMipLevel(StreamedTextureHandle handle) const;
+        inline const TextureStreamingStatistics& GetStatistics() const { return statistics; }
+        inline void ResetStatistics() { statistics = {}; }
+
+    private:
+        void ReadFeedback();
+        uint32_t GetResidentMipLevel(const StreamedTexture& streamed) const;
+        void CollectLoadedLevels(StreamedTexture& streamed);
+        VkDeviceSize UploadLoadedLevels(StreamedTexture& streamed, VkDeviceSize budget, bool uploadOversized);
+        void StartLoad(StreamedTexture& streamed);
+        static LoadedLevel LoadLevel(std::shared_ptr<Ktx2File> file, uint32_t level, bool decompress);
+
+    private:
+        std::shared_ptr<RenderGraph> graph = nullptr;
+        std::vector<StreamedTexture> textures{};
+        std::shared_ptr<Resource<Buffer>> feedbackBuffer = nullptr;
+        VkDeviceSize uploadBudget = 16 * 1024 * 1024;
+        uint32_t maxPendingLoads = 0;
+        TextureStreamingStatistics statistics{};
+    };
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <vurl/pass.hpp>
+#include <vurl/render_graph_def.hpp>
+#include <vurl/resource.hpp>
+#include <vurl/texture.hpp>
+#include <vurl/buffer.hpp>
+#include <vector>
+#include <string>
+
+namespace Vurl {
+    class RenderGraph;
+
+    enum class TransferOperationType {
+        CopyBuffer,
+        CopyBufferToImage,
+        CopyImage,
+        BlitImage,
+        FillBuffer,
+        ClearImage
+    };
+
+    //src and dst are buffer or texture handles depending on the operation type
+    struct TransferOperation {
+        TransferOperationType type = TransferOperationType::CopyBuffer;
+        int src = VURL_NULL_HANDLE;
+        int dst = VURL_NULL_HANDLE;
+        VkDeviceSize srcOffset = 0;
+        VkDeviceSize dstOffset = 0;
+        VkDeviceSize size = VK_WHOLE_SIZE;
+        uint32_t fillData = 0;
+        VkClearColorValue clearColor{};
+        VkFilter filter = VK_FILTER_LINEAR;
+    };
+
+    //Operations of one pass run unordered, put dependent copies into separate passes
+    class TransferPass : public Pass, public HashedObject {
+    public:
+        TransferPass() = delete;
+        TransferPass(const std::string& name, RenderGraph* graph) : Pass::Pass(name, graph) {}
+        ~TransferPass() = default;
+
+        inline PassType GetPassType() const override { return PassType::Transfer; }
+
+        void CopyBuffer(std::shared_ptr<Resource<Buffer>> src, std::shared_ptr<Resource<Buffer>> dst, 
+                VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0);
+        //Fills the base level of every layer from tightly packed texels at srcOffset
+        void CopyBufferToImage(std::shared_ptr<Resource<Buffer>> src, std::shared_ptr<Resource<Texture>> dst, VkDeviceSize srcOffset = 0);
+        void CopyImage(std::shared_ptr<Resource<Texture>> src, std::shared_ptr<Resource<Texture>> dst);
+        void BlitImage(std::shared_ptr<Resource<Texture>> src, std::shared_ptr<Resource<Texture>> dst, VkFilter filter = VK_FILTER_LINEAR);
+        //Size and offset must be multiples of 4
+        void FillBuffer(std::shared_ptr<Resource<Buffer>> dst, uint32_t data, VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize dstOffset = 0);
+        void ClearImage(std::shared_ptr<Resource<Texture>> dst, VkClearColorValue color);
+
+        inline uint32_t GetOperationCount() const { return operations.size(); }
+        inline const TransferOperation& GetOperation(uint32_t idx) const { return operations[idx]; }
+
+        //Only touches buffers, so it can run on a dedicated transfer queue
+        bool IsBufferOnly() const;
+
+        inline uint32_t GetHash() const {
+            Hasher hasher{};
+            for (uint32_t i = 0; i < operations.size(); ++i) {
+                hasher.U32((uint32_t)operations[i].type);
+                hasher.U32(operations[i].src);
+                hasher.U32(operations[i].dst);
+            }
+            return hasher.Get();
+        };
+
+    private:
+        void AddOperation(const TransferOperation& operation, bool srcIsTexture, bool dstIsTexture);
+
+    private:
+        std::vector<TransferOperation> operations{};
+    };
+}
\ No newline at end of file
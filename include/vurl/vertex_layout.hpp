@@ -0,0 +1,96 @@
+#pragma once
+
+#include <vurl/graphics_pipeline.hpp>
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace Vurl {
+    //Map a vertex member type to its attribute format. Specialize for math library types,
+    //e.g. template<> struct VertexAttributeFormatTraits<glm::vec3> : VertexAttributeFormatOf<VertexInputAttributeFormat::Vector3> {};
+    template<VertexInputAttributeFormat Format>
+    struct VertexAttributeFormatOf {
+        static constexpr VertexInputAttributeFormat format = Format;
+    };
+
+    template<typename T>
+    struct VertexAttributeFormatTraits;
+
+    template<> struct VertexAttributeFormatTraits<float> : VertexAttributeFormatOf<VertexInputAttributeFormat::Float> {};
+    template<> struct VertexAttributeFormatTraits<float[2]> : VertexAttributeFormatOf<VertexInputAttributeFormat::Vector2> {};
+    template<> struct VertexAttributeFormatTraits<float[3]> : VertexAttributeFormatOf<VertexInputAttributeFormat::Vector3> {};
+    template<> struct VertexAttributeFormatTraits<float[4]> : VertexAttributeFormatOf<VertexInputAttributeFormat::Vector4> {};
+
+    struct VertexAttribute {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+        VertexInputAttributeFormat format = VertexInputAttributeFormat::Float;
+    };
+
+    //Packed members (uint16_t[2], uint32_t, ...) are ambiguous, name their format explicitly
+    #define VURL_VERTEX_ATTRIBUTE_FORMAT(type, member, attributeFormat) ::Vurl::VertexAttribute{ \
+            (uint32_t)offsetof(type, member), (uint32_t)sizeof(type::member), attributeFormat }
+    #define VURL_VERTEX_ATTRIBUTE(type, member) VURL_VERTEX_ATTRIBUTE_FORMAT(type, member, \
+            ::Vurl::VertexAttributeFormatTraits<std::remove_cv_t<decltype(type::member)>>::format)
+
+    //Vertex input description derived from a vertex struct at compile time. Attributes get consecutive
+    //locations in declaration order, offsets come from offsetof and the stride is sizeof(Vertex), so a
+    //typed mesh and the pipeline reading it can't drift apart:
+    //  using MeshLayout = VertexLayout<MeshVertex, VURL_VERTEX_ATTRIBUTE(MeshVertex, position), VURL_VERTEX_ATTRIBUTE(MeshVertex, normal)>;
+    template<typename Vertex, VertexAttribute... Attributes>
+    class VertexLayout {
+    public:
+        static constexpr uint32_t attributeCount = sizeof...(Attributes);
+        static constexpr uint32_t stride = sizeof(Vertex);
+
+        static_assert(attributeCount > 0, "Vertex layout needs at least one attribute");
+        static_assert(std::is_standard_layout_v<Vertex>, "Vertex layout requires a standard layout struct");
+
+    private:
+        static constexpr std::array<VertexAttribute, attributeCount> vertexAttributes{ Attributes... };
+
+        static constexpr bool AttributeSizesMatch() {
+            for (const VertexAttribute& attribute : vertexAttributes) {
+                if (attribute.size != GetVertexInputAttributeFormatSize(attribute.format))
+                    return false;
+            }
+            return true;
+        }
+
+        static constexpr bool AttributesFit() {
+            for (const VertexAttribute& attribute : vertexAttributes) {
+                if (attribute.offset + attribute.size > sizeof(Vertex))
+                    return false;
+            }
+            return true;
+        }
+
+        static constexpr bool AttributesDisjoint() {
+            for (uint32_t i = 0; i < attributeCount; i++) {
+                for (uint32_t j = i + 1; j < attributeCount; j++) {
+                    const VertexAttribute& a = vertexAttributes[i];
+                    const VertexAttribute& b = vertexAttributes[j];
+                    if (a.offset < b.offset + b.size && b.offset < a.offset + a.size)
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        template<size_t... I>
+        static constexpr std::array<VertexInputAttributeDescription, attributeCount> MakeAttributes(std::index_sequence<I...>) {
+            return { VertexInputAttributeDescription{ (uint32_t)I, vertexAttributes[I].format, vertexAttributes[I].offset }... };
+        }
+
+        static_assert(AttributeSizesMatch(), "Vertex member size doesn't match its attribute format");
+        static_assert(AttributesFit(), "Vertex attribute exceeds the vertex struct");
+        static_assert(AttributesDisjoint(), "Vertex attributes overlap");
+
+    public:
+        static constexpr std::array<VertexInputAttributeDescription, attributeCount> attributes = MakeAttributes(std::make_index_sequence<attributeCount>{});
+
+        static inline VertexInputDescription GetDescription(VkVertexInputRate rate = VK_VERTEX_INPUT_RATE_VERTEX) {
+            return VertexInputDescription(attributes.data(), attributeCount, stride, rate);
+        }
+    };
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+//Helpers to encode vertex data on the CPU into the packed VertexInputAttributeFormat layouts
+namespace Vurl {
+    inline uint16_t PackHalf(float value) {
+        uint32_t bits = 0;
+        memcpy(&bits, &value, sizeof(bits));
+
+        uint32_t sign = (bits >> 16) & 0x8000;
+        int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+        uint32_t mantissa = bits & 0x007FFFFF;
+
+        if (((bits >> 23) & 0xFF) == 0xFF)
+            return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x0200 : 0));
+        if (exponent >= 31)
+            return (uint16_t)(sign | 0x7C00);
+        if (exponent <= 0) {
+            if (exponent < -10)
+                return (uint16_t)sign;
+            mantissa |= 0x00800000;
+            uint32_t shift = (uint32_t)(14 - exponent);
+            uint32_t half = mantissa >> shift;
+            //Round to nearest even
+            uint32_t remainder = mantissa & ((1u << shift) - 1);
+            uint32_t halfway = 1u << (shift - 1);
+            if (remainder > halfway || (remainder == halfway && (half & 1)))
+                ++half;
+            return (uint16_t)(sign | half);
+        }
+
+        uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+        uint32_t remainder = mantissa & 0x1FFF;
+        if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+            ++half;
+        return (uint16_t)half;
+    }
+
+    inline int8_t PackSnorm8(float value) {
+        return (int8_t)std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f);
+    }
+
+    inline uint8_t PackUnorm8(float value) {
+        return (uint8_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+    }
+
+    inline int16_t PackSnorm16(float value) {
+        return (int16_t)std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+    }
+
+    inline uint16_t PackUnorm16(float value) {
+        return (uint16_t)std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f);
+    }
+
+    //Matches VK_FORMAT_A2B10G10R10_UNORM_PACK32, x lands in the lowest bits
+    inline uint32_t PackUnorm1010102(float x, float y, float z, float w) {
+        uint32_t r = (uint32_t)std::lround(std::clamp(x, 0.0f, 1.0f) * 1023.0f);
+        uint32_t g = (uint32_t)std::lround(std::clamp(y, 0.0f, 1.0f) * 1023.0f);
+        uint32_t b = (uint32_t)std::lround(std::clamp(z, 0.0f, 1.0f) * 1023.0f);
+        uint32_t a = (uint32_t)std::lround(std::clamp(w, 0.0f, 1.0f) * 3.0f);
+        return r | (g << 10) | (b << 20) | (a << 30);
+    }
+
+    //Fold a unit vector onto the octahedron, u and v end up in [-1, 1].
+    //Decode in the shader with n = vec3(u, v, 1 - |u| - |v|); if (n.z < 0) n.xy = (1 - abs(n.yx)) * sign(n.xy); normalize(n).
+    inline void EncodeOctahedral(float x, float y, float z, float& u, float& v) {
+        float invL1 = 1.0f / (std::fabs(x) + std::fabs(y) + std::fabs(z));
+        u = x * invL1;
+        v = y * invL1;
+        if (z < 0.0f) {
+            float foldedU = (1.0f - std::fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+            float foldedV = (1.0f - std::fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+            u = foldedU;
+            v = foldedV;
+        }
+    }
+
+    //Layout of VertexInputAttributeFormat::OctahedralNormal8
+    inline uint16_t PackOctahedralNormal8(float x, float y, float z) {
+        float u = 0.0f, v = 0.0f;
+        EncodeOctahedral(x, y, z, u, v);
+        return (uint16_t)((uint8_t)PackSnorm8(u) | ((uint16_t)(uint8_t)PackSnorm8(v) << 8));
+    }
+
+    //Layout of VertexInputAttributeFormat::OctahedralNormal16
+    inline uint32_t PackOctahedralNormal16(float x, float y, float z) {
+        float u = 0.0f, v = 0.0f;
+        EncodeOctahedral(x, y, z, u, v);
+        return (uint32_t)(uint16_t)PackSnorm16(u) | ((uint32_t)(uint16_t)PackSnorm16(v) << 16);
+    }
+}
\ No newline at end of file
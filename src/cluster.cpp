@@ -0,0 +1,115 @@
+#include <vurl/cluster.hpp>
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+    struct Vector3 {
+        float x = 0.0f;
+        float y = 0.0f;
+        float z = 0.0f;
+    };
+
+    inline Vector3 Sub(Vector3 a, Vector3 b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    inline Vector3 Add(Vector3 a, Vector3 b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+    inline Vector3 Scale(Vector3 a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+    inline float Dot(Vector3 a, Vector3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    inline Vector3 Cross(Vector3 a, Vector3 b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    inline float Length(Vector3 a) { return std::sqrt(Dot(a, a)); }
+
+    inline Vector3 GetPosition(const float* positions, uint32_t positionStride, uint32_t index) {
+        const float* p = (const float*)((const uint8_t*)positions + (size_t)index * positionStride);
+        return { p[0], p[1], p[2] };
+    }
+}
+
+void Vurl::BuildClusters(const float* positions, uint32_t positionStride, const uint32_t* indices, uint32_t indexCount, 
+        uint32_t maxTrianglesPerCluster, std::vector<Cluster>& clusters, bool counterClockwise) {
+    if (maxTrianglesPerCluster == 0)
+        return;
+
+    uint32_t triangleCount = indexCount / 3;
+    std::vector<Vector3> normals{};
+    normals.reserve(maxTrianglesPerCluster);
+
+    for (uint32_t firstTriangle = 0; firstTriangle < triangleCount; firstTriangle += maxTrianglesPerCluster) {
+        Cluster& cluster = clusters.emplace_back();
+        cluster.firstIndex = firstTriangle * 3;
+        cluster.triangleCount = std::min(maxTrianglesPerCluster, triangleCount - firstTriangle);
+
+        //Sphere around the bounding box center
+        Vector3 min = GetPosition(positions, positionStride, indices[cluster.firstIndex]);
+        Vector3 max = min;
+        for (uint32_t i = 0; i < cluster.triangleCount * 3; ++i) {
+            Vector3 p = GetPosition(positions, positionStride, indices[cluster.firstIndex + i]);
+            min = { std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z) };
+            max = { std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z) };
+        }
+
+        Vector3 center = Scale(Add(min, max), 0.5f);
+        float radius = 0.0f;
+        for (uint32_t i = 0; i < cluster.triangleCount * 3; ++i)
+            radius = std::max(radius, Length(Sub(GetPosition(positions, positionStride, indices[cluster.firstIndex + i]), center)));
+
+        cluster.boundingSphere[0] = center.x;
+        cluster.boundingSphere[1] = center.y;
+        cluster.boundingSphere[2] = center.z;
+        cluster.boundingSphere[3] = radius;
+        cluster.coneApex[0] = center.x;
+        cluster.coneApex[1] = center.y;
+        cluster.coneApex[2] = center.z;
+
+        //Normal cone around the average face normal, degenerate triangles don't constrain it
+        normals.clear();
+        Vector3 axis{};
+        for (uint32_t i = 0; i < cluster.triangleCount; ++i) {
+            const uint32_t* triangle = &indices[cluster.firstIndex + i * 3];
+            Vector3 p0 = GetPosition(positions, positionStride, triangle[0]);
+            Vector3 normal = Cross(Sub(GetPosition(positions, positionStride, triangle[1]), p0), Sub(GetPosition(positions, positionStride, triangle[2]), p0));
+            float length = Length(normal);
+            if (length == 0.0f)
+                continue;
+
+            normal = Scale(normal, counterClockwise ? 1.0f / length : -1.0f / length);
+            normals.push_back(normal);
+            axis = Add(axis, normal);
+        }
+
+        float axisLength = Length(axis);
+        if (normals.empty() || axisLength == 0.0f)
+            continue;
+        axis = Scale(axis, 1.0f / axisLength);
+
+        float minDot = 1.0f;
+        for (const Vector3& normal : normals)
+            minDot = std::min(minDot, Dot(axis, normal));
+
+        cluster.coneAxis[0] = axis.x;
+        cluster.coneAxis[1] = axis.y;
+        cluster.coneAxis[2] = axis.z;
+
+        //Normals spread over more than a hemisphere (with some margin), the cone never culls
+        if (minDot <= 0.1f)
+            continue;
+
+        //Move the apex back along the axis until it lies behind every triangle plane
+        float maxDistance = 0.0f;
+        uint32_t normalIndex = 0;
+        for (uint32_t i = 0; i < cluster.triangleCount; ++i) {
+            const uint32_t* triangle = &indices[cluster.firstIndex + i * 3];
+            Vector3 p0 = GetPosition(positions, positionStride, triangle[0]);
+            Vector3 normal = Cross(Sub(GetPosition(positions, positionStride, triangle[1]), p0), Sub(GetPosition(positions, positionStride, triangle[2]), p0));
+            if (Length(normal) == 0.0f)
+                continue;
+
+            const Vector3& n = normals[normalIndex++];
+            maxDistance = std::max(maxDistance, Dot(Sub(center, p0), n) / Dot(axis, n));
+        }
+
+        Vector3 apex = Sub(center, Scale(axis, maxDistance));
+        cluster.coneApex[0] = apex.x;
+        cluster.coneApex[1] = apex.y;
+        cluster.coneApex[2] = apex.z;
+        cluster.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include <vurl/command_encoder.hpp>
+#include <cstring>
+
+
+void Vurl::CommandEncoder::Begin(VkCommandBuffer commandBuffer) {
+    vkCommandBuffer = commandBuffer;
+    Invalidate();
+}
+
+void Vurl::CommandEncoder::Invalidate() {
+    for (uint32_t i = 0; i < 2; ++i) {
+        pipelines[i] = VK_NULL_HANDLE;
+        descriptorSets[i] = {};
+    }
+
+    for (uint32_t i = 0; i < VURL_MAX_VERTEX_BUFFER_BINDING_COUNT; ++i) {
+        vertexBuffers[i] = VK_NULL_HANDLE;
+        vertexBufferOffsets[i] = 0;
+    }
+    indexBuffer = VK_NULL_HANDLE;
+
+    pushConstantLayout = VK_NULL_HANDLE;
+    validDynamicStates = 0;
+}
+
+void Vurl::CommandEncoder::BindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline) {
+    uint32_t bindPointIndex = GetBindPointIndex(bindPoint);
+    if (pipelines[bindPointIndex] == pipeline) {
+        ++statistics.elidedCallCount;
+        return;
+    }
+
+    vkCmdBindPipeline(vkCommandBuffer, bindPoint, pipeline);
+    pipelines[bindPointIndex] = pipeline;
+    ++statistics.pipelineBindCount;
+
+    //State the new pipeline doesn't declare dynamic is undefined once it is bound
+    if (bindPointIndex == 0)
+        validDynamicStates = 0;
+}
+
+void Vurl::CommandEncoder::BindDescriptorSets(VkPipelineBindPoint bindPoint, VkPipelineLayout layout, uint32_t firstSet, 
+        uint32_t setCount, const VkDescriptorSet* sets) {
+    BoundDescriptorSets& boundSets = descriptorSets[GetBindPointIndex(bindPoint)];
+
+    bool bound = firstSet + setCount <= VURL_MAX_DESCRIPTOR_SET_COUNT;
+    for (uint32_t i = 0; bound && i < setCount; ++i)
+        bound = boundSets.layouts[firstSet + i] == layout && boundSets.sets[firstSet + i] == sets[i];
+
+    if (bound) {
+        ++statistics.elidedCallCount;
+        return;
+    }
+
+    vkCmdBindDescriptorSets(vkCommandBuffer, bindPoint, layout, firstSet, setCount, sets, 0, nullptr);
+    ++statistics.descriptorSetBindCount;
+
+    for (uint32_t i = 0; i < setCount && firstSet + i < VURL_MAX_DESCRIPTOR_SET_COUNT; ++i) {
+        boundSets.layouts[firstSet + i] = layout;
+        boundSets.sets[firstSet + i] = sets[i];
+    }
+}
+
+void Vurl::CommandEncoder::BindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const VkBuffer* buffers, const VkDeviceSize* offsets) {
+    bool bound = firstBinding + bindingCount <= VURL_MAX_VERTEX_BUFFER_BINDING_COUNT;
+    for (uint32_t i = 0; bound && i < bindingCount; ++i)
+        bound = vertexBuffers[firstBinding + i] == buffers[i] && vertexBufferOffsets[firstBinding + i] == offsets[i];
+
+    if (bound) {
+        ++statistics.elidedCallCount;
+        return;
+    }
+
+    vkCmdBindVertexBuffers(vkCommandBuffer, firstBinding, bindingCount, buffers, offsets);
+    ++statistics.vertexBufferBindCount;
+
+    for (uint32_t i = 0; i < bindingCount && firstBinding + i < VURL_MAX_VERTEX_BUFFER_BINDING_COUNT; ++i) {
+        vertexBuffers[firstBinding + i] = buffers[i];
+        vertexBufferOffsets[firstBinding + i] = offsets[i];
+    }
+}
+
+void Vurl::CommandEncoder::BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType) {
+    if (indexBuffer == buffer && indexBufferOffset == offset && this->indexType == indexType) {
+        ++statistics.elidedCallCount;
+        return;
+    }
+
+    vkCmdBindIndexBuffer(vkCommandBuffer, buffer, offset, indexType);
+    indexBuffer = buffer;
+    indexBufferOffset = offset;
+    this->indexType = indexType;
+    ++statistics.indexBufferBindCount;
+}
+
+void Vurl::CommandEncoder::PushConstants(VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset, uint32_t size, const void* values) {
+    if (layout != pushConstantLayout) {
+        memset(pushConstantStages, 0, sizeof(pushConstantStages));
+        pushConstantLayout = layout;
+    }
+
+    //Ranges past the shadow copy are always recorded
+    bool tracked = offset + size <= VURL_MAX_PUSH_CONSTANT_SIZE;
+
+    bool pushed = tracked && memcmp(pushConstantData + offset, values, size) == 0;
+    for (uint32_t i = 0; pushed && i < size; ++i)
+        pushed = pushConstantStages[offset + i] == stageFlags;
+
+    if (pushed) {
+        ++statistics.elidedCallCount;
+        return;
+    }
+
+    vkCmdPushConstants(vkCommandBuffer, layout, stageFlags, offset, size, values);
+    ++statistics.pushConstantCount;
+
+    if (tracked) {
+        memcpy(pushConstantData + offset, values, size);
+        for (uint32_t i = 0; i < size; ++i)
+            pushConstantStages[offset + i] = stageFlags;
+    }
+}
+
+bool Vurl::CommandEncoder::IsDynamicStateSet(DynamicStateFlags flag, bool equal) {
+    if ((validDynamicStates & flag) && equal) {
+        ++statistics.elidedCallCount;
+        return true;
+    }
+
+    validDynamicStates |= flag;
+    ++statistics.dynamicStateCount;
+    return false;
+}
+
+void Vurl::CommandEncoder::SetViewport(const VkViewport& viewport) {
+    if (IsDynamicStateSet(DYNAMIC_STATE_VIEWPORT_BIT, memcmp(&dynamicState.viewport, &viewport, sizeof(VkViewport)) == 0))
+        return;
+    dynamicState.viewport = viewport;
+    vkCmdSetViewport(vkCommandBuffer, 0, 1, &viewport);
+}
+
+void Vurl::CommandEncoder::SetScissor(const VkRect2D& scissor) {
+    if (IsDynamicStateSet(DYNAMIC_STATE_SCISSOR_BIT, memcmp(&dynamicState.scissor, &scissor, sizeof(VkRect2D)) == 0))
+        return;
+    dynamicState.scissor = scissor;
+    vkCmdSetScissor(vkCommandBuffer, 0, 1, &scissor);
+}
+
+void Vurl::CommandEncoder::SetPrimitiveTopology(VkPrimitiveTopology primitiveTopology) {
+    if (IsDynamicStateSet(DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_BIT, dynamicState.primitiveTopology == primitiveTopology))
+        return;
+    dynamicState.primitiveTopology = primitiveTopology;
+    vkCmdSetPrimitiveTopologyEXT(vkCommandBuffer, primitiveTopology);
+}
+
+void Vurl::CommandEncoder::SetPrimitiveRestartEnable(VkBool32 enable) {
+    if (IsDynamicStateSet(DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_BIT, dynamicState.primitiveRestartEnable == enable))
+        return;
+    dynamicState.primitiveRestartEnable = enable;
+    vkCmdSetPrimitiveRestartEnableEXT(vkCommandBuffer, enable);
+}
+
+void Vurl::CommandEncoder::SetCullMode(VkCullModeFlags cullMode) {
+    if (IsDynamicStateSet(DYNAMIC_STATE_CULL_MODE_BIT, dynamicState.cullMode == cullMode))
+        return;
+    dynamicState.cullMode = cullMode;
+    vkCmdSetCullModeEXT(vkCommandBuffer, cullMode);
+}
+
+void Vurl::CommandEncoder::SetFrontFace(VkFrontFace frontFace) {
+    if (IsDynamicStateSet(DYNAMIC_STATE_FRONT_FACE_BIT, dynamicState.frontFace == frontFace))
+        return;
+    dynamicState.frontFace = frontFace;
+    vkCmdSetFrontFaceEXT(vkCommandBuffer, frontFace);
+}
+
+void Vurl::CommandEncoder::SetDepthTestEnable(VkBool32 enable) {
+    if (IsDynamicStateSet(DYNAMIC_STATE_DEPTH_TEST_ENABLE_BIT, dynamicState.depthTestEnable == enable))
+        return;
+    dynamicState.depthTestEnable = enable;
+    vkCmdSetDepthTestEnableEXT(vkCommandBuffer, enable);
+}
+
+void Vurl::CommandEncoder::SetDepthWriteEnable(VkBool32 enable) {
+    if (IsDynamicStateSet(DYNAMIC_STATE_DEPTH_WRITE_ENABLE_BIT, dynamicState.depthWriteEnable == enable))
+        return;
+    dynamicState.depthWriteEnable = enable;
+    vkCmdSetDepthWriteEnableEXT(vkCommandBuffer, enable);
+}
+
+void Vurl::CommandEncoder::SetDepthCompareOp(VkCompareOp compareOp) {
+    if (IsDynamicStateSet(DYNAMIC_STATE_DEPTH_COMPARE_OP_BIT, dynamicState.depthCompareOp == compareOp))
+        return;
+    dynamicState.depthCompareOp = compareOp;
+    vkCmdSetDepthCompareOpEXT(vkCommandBuffer, compareOp);
+}
+
+void Vurl::CommandEncoder::Draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) {
+    vkCmdDraw(vkCommandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+    ++statistics.drawCount;
+}
+
+void Vurl::CommandEncoder::DrawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) {
+    vkCmdDrawIndexed(vkCommandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+    ++statistics.drawCount;
+}
+
+void Vurl::CommandEncoder::DrawMultiIndexed(uint32_t drawCount, const VkMultiDrawIndexedInfoEXT* draws, uint32_t instanceCount, uint32_t firstInstance) {
+    vkCmdDrawMultiIndexedEXT(vkCommandBuffer, drawCount, draws, instanceCount, firstInstance, sizeof(VkMultiDrawIndexedInfoEXT), nullptr);
+    ++statistics.drawCount;
+}
+
+void Vurl::CommandEncoder::DrawIndexedIndirect(VkBuffer buffer, VkDeviceSize offset, uint32_t drawCount, uint32_t stride) {
+    vkCmdDrawIndexedIndirect(vkCommandBuffer, buffer, offset, drawCount, stride);
+    ++statistics.drawCount;
+}
+
+void Vurl::CommandEncoder::DrawIndexedIndirectCount(VkBuffer buffer, VkDeviceSize offset, VkBuffer countBuffer, VkDeviceSize countBufferOffset, 
+        uint32_t maxDrawCount, uint32_t stride) {
+    vkCmdDrawIndexedIndirectCount(vkCommandBuffer, buffer, offset, countBuffer, countBufferOffset, maxDrawCount, stride);
+    ++statistics.drawCount;
+}
+
+void Vurl::CommandEncoder::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) {
+    vkCmdDispatch(vkCommandBuffer, groupCountX, groupCountY, groupCountZ);
+    ++statistics.dispatchCount;
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#include <vurl/compute_pass.hpp>
+#include <vurl/render_graph.hpp>
+
+
+Vurl::ComputePass::ComputePass(const std::string& name, std::shared_ptr<ComputePipeline> pipeline, RenderGraph* graph) : 
+        Pass::Pass(name, graph), computePipeline{ pipeline } {
+
+}
+
+void Vurl::ComputePass::AddStorageBuffer(std::shared_ptr<Resource<Buffer>> buffer, uint32_t binding, ResourceAccessType access) {
+    BufferHandle handle = graph->GetBufferHandle(buffer);
+    if (handle == VURL_NULL_HANDLE || !IsStorageAccessType(access))
+        return;
+    storageBuffers.push_back(StorageBinding<BufferHandle>{ handle, binding, access });
+    AddResourceAccess(false, handle, access);
+}
+
+void Vurl::ComputePass::AddStorageImage(std::shared_ptr<Resource<Texture>> texture, uint32_t binding, ResourceAccessType access) {
+    TextureHandle handle = graph->GetTextureHandle(texture);
+    if (handle == VURL_NULL_HANDLE || !IsStorageAccessType(access))
+        return;
+    storageImages.push_back(StorageBinding<TextureHandle>{ handle, binding, access });
+    AddResourceAccess(true, handle, access);
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include <vurl/compute_pipeline.hpp>
+#include <algorithm>
+
+
+bool Vurl::ComputePipeline::CreatePipelineLayout() {
+    if (!computeShader)
+        return false;
+
+    const ShaderReflection& reflection = computeShader->GetReflection();
+
+    uint32_t setCount = 0;
+    for (const ShaderDescriptorBinding& binding : reflection.descriptorBindings)
+        setCount = std::max(setCount, binding.set + 1);
+
+    //Sets the shader skips still need a (empty) layout to keep set numbers stable
+    descriptorSetLayouts.resize(setCount, VK_NULL_HANDLE);
+    for (uint32_t set = 0; set < setCount; ++set) {
+        std::vector<VkDescriptorSetLayoutBinding> layoutBindings{};
+        for (const ShaderDescriptorBinding& binding : reflection.descriptorBindings) {
+            if (binding.set != set)
+                continue;
+
+            VkDescriptorSetLayoutBinding& layoutBinding = layoutBindings.emplace_back();
+            layoutBinding.binding = binding.binding;
+            layoutBinding.descriptorType = binding.descriptorType;
+            layoutBinding.descriptorCount = binding.descriptorCount;
+            layoutBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+
+        VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo{};
+        setLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        setLayoutCreateInfo.bindingCount = (uint32_t)layoutBindings.size();
+        setLayoutCreateInfo.pBindings = layoutBindings.data();
+
+        if (vkCreateDescriptorSetLayout(vkDevice, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts[set]) != VK_SUCCESS)
+            return false;
+    }
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = (uint32_t)descriptorSetLayouts.size();
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = (uint32_t)reflection.pushConstantRanges.size();
+    pipelineLayoutInfo.pPushConstantRanges = reflection.pushConstantRanges.data();
+
+    if (vkCreatePipelineLayout(vkDevice, &pipelineLayoutInfo, nullptr, &vkPipelineLayout) != VK_SUCCESS)
+        return false;
+
+    return true;
+}
+
+void Vurl::ComputePipeline::DestroyPipelineLayout() {
+    vkDestroyPipelineLayout(vkDevice, vkPipelineLayout, nullptr);
+    for (VkDescriptorSetLayout setLayout : descriptorSetLayouts)
+        vkDestroyDescriptorSetLayout(vkDevice, setLayout, nullptr);
+    vkPipelineLayout = VK_NULL_HANDLE;
+    descriptorSetLayouts.clear();
+}
+
+const Vurl::ShaderDescriptorBinding* Vurl::ComputePipeline::FindDescriptorBinding(uint32_t set, uint32_t binding) const {
+    if (!computeShader)
+        return nullptr;
+
+    for (const ShaderDescriptorBinding& descriptorBinding : computeShader->GetReflection().descriptorBindings)
+        if (descriptorBinding.set == set && descriptorBinding.binding == binding)
+            return &descriptorBinding;
+    return nullptr;
+}
+
+bool Vurl::ComputePipeline::SetSpecializationConstant(uint32_t constantId, SpecializationConstantType type, uint32_t data) {
+    if (!computeShader)
+        return false;
+
+    const SpecializationConstantInfo* info = computeShader->FindSpecializationConstant(constantId);
+    if (!info || info->type != type)
+        return false;
+
+    //Keep constants sorted so the same value set always hashes the same
+    auto it = std::lower_bound(specializationConstants.begin(), specializationConstants.end(), constantId,
+            [](const SpecializationConstant& c, uint32_t id) { return c.constantId < id; });
+
+    if (it != specializationConstants.end() && it->constantId == constantId)
+        it->data = data;
+    else
+        specializationConstants.insert(it, SpecializationConstant{ VK_SHADER_STAGE_COMPUTE_BIT, constantId, data });
+
+    return true;
+}
+
+void Vurl::ComputePipeline::GetSpecializationData(std::vector<VkSpecializationMapEntry>& mapEntries, std::vector<uint32_t>& data) const {
+    for (const SpecializationConstant& constant : specializationConstants) {
+        VkSpecializationMapEntry mapEntry{};
+        mapEntry.constantID = constant.constantId;
+        mapEntry.offset = (uint32_t)(data.size() * sizeof(uint32_t));
+        mapEntry.size = sizeof(uint32_t);
+
+        mapEntries.push_back(mapEntry);
+        data.push_back(constant.data);
+    }
+}
\ No newline at end of file
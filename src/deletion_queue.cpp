@@ -0,0 +1,108 @@
+#include <vurl/deletion_queue.hpp>
+
+
+void Vurl::DeletionQueue::Push(std::function<void()> destroy) {
+    entries.push_back({ frameIndex, std::move(destroy) });
+}
+
+void Vurl::DeletionQueue::DestroyBuffer(VkBuffer buffer, VmaAllocation allocation) {
+    if (buffer == VK_NULL_HANDLE)
+        return;
+
+    //Without an allocation the memory lives on elsewhere, only the handle goes
+    VkDevice device = vkDevice;
+    VmaAllocator allocator = vmaAllocator;
+    if (allocation != VK_NULL_HANDLE)
+        Push([allocator, buffer, allocation]() { vmaDestroyBuffer(allocator, buffer, allocation); });
+    else
+        Push([device, buffer]() { vkDestroyBuffer(device, buffer, nullptr); });
+}
+
+void Vurl::DeletionQueue::DestroyImage(VkImage image, VmaAllocation allocation) {
+    if (image == VK_NULL_HANDLE)
+        return;
+
+    VkDevice device = vkDevice;
+    VmaAllocator allocator = vmaAllocator;
+    if (allocation != VK_NULL_HANDLE)
+        Push([allocator, image, allocation]() { vmaDestroyImage(allocator, image, allocation); });
+    else
+        Push([device, image]() { vkDestroyImage(device, image, nullptr); });
+}
+
+void Vurl::DeletionQueue::DestroyImageView(VkImageView imageView) {
+    if (imageView == VK_NULL_HANDLE)
+        return;
+    VkDevice device = vkDevice;
+    Push([device, imageView]() { vkDestroyImageView(device, imageView, nullptr); });
+}
+
+void Vurl::DeletionQueue::FreeMemory(VkDeviceMemory memory) {
+    if (memory == VK_NULL_HANDLE)
+        return;
+    VkDevice device = vkDevice;
+    Push([device, memory]() { vkFreeMemory(device, memory, nullptr); });
+}
+
+void Vurl::DeletionQueue::DestroyPipeline(VkPipeline pipeline) {
+    if (pipeline == VK_NULL_HANDLE)
+        return;
+    VkDevice device = vkDevice;
+    Push([device, pipeline]() { vkDestroyPipeline(device, pipeline, nullptr); });
+}
+
+void Vurl::DeletionQueue::DestroyFramebuffer(VkFramebuffer framebuffer) {
+    if (framebuffer == VK_NULL_HANDLE)
+        return;
+    VkDevice device = vkDevice;
+    Push([device, framebuffer]() { vkDestroyFramebuffer(device, framebuffer, nullptr); });
+}
+
+void Vurl::DeletionQueue::DestroyRenderPass(VkRenderPass renderPass) {
+    if (renderPass == VK_NULL_HANDLE)
+        return;
+    VkDevice device = vkDevice;
+    Push([device, renderPass]() { vkDestroyRenderPass(device, renderPass, nullptr); });
+}
+
+void Vurl::DeletionQueue::DestroyShader(VkShaderEXT shader) {
+    if (shader == VK_NULL_HANDLE)
+        return;
+    VkDevice device = vkDevice;
+    Push([device, shader]() { vkDestroyShaderEXT(device, shader, nullptr); });
+}
+
+void Vurl::DeletionQueue::DestroyCommandPool(VkCommandPool commandPool) {
+    if (commandPool == VK_NULL_HANDLE)
+        return;
+    VkDevice device = vkDevice;
+    Push([device, commandPool]() { vkDestroyCommandPool(device, commandPool, nullptr); });
+}
+
+void Vurl::DeletionQueue::DestroySwapchain(VkSwapchainKHR swapchain) {
+    if (swapchain == VK_NULL_HANDLE)
+        return;
+    VkDevice device = vkDevice;
+    Push([device, swapchain]() { vkDestroySwapchainKHR(device, swapchain, nullptr); });
+}
+
+void Vurl::DeletionQueue::Collect(uint64_t completedFrameIndex) {
+    //Entries of later frames stay queued in their retire order
+    uint32_t keptCount = 0;
+    for (uint32_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].frameIndex <= completedFrameIndex) {
+            entries[i].destroy();
+            continue;
+        }
+        if (keptCount != i)
+            entries[keptCount] = std::move(entries[i]);
+        ++keptCount;
+    }
+    entries.resize(keptCount);
+}
+
+void Vurl::DeletionQueue::Flush() {
+    for (Entry& entry : entries)
+        entry.destroy();
+    entries.clear();
+}
\ No newline at end of file
@@ -22,13 +22,14 @@ void Vurl::DescriptorSetAllocator::Destroy() {
     freePools.clear();
 }
 
-VkDescriptionSet Vurl::DescriptorSetAllocator::Allocate(VkDescriptionSetLayout layout) {
-    VkDescriptionSet descriptionSet = VK_NULL_HANDLE;
-    Allocate(&descriptionSet, &layout, 1);
-    return descriptionSet;
+VkDescriptorSet Vurl::DescriptorSetAllocator::Allocate(VkDescriptorSetLayout layout) {
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+    if (!Allocate(&descriptorSet, &layout, 1))
+        return VK_NULL_HANDLE;
+    return descriptorSet;
 }
 
-void Vurl::DescriptorSetAllocator::Allocate(VkDescriptionSet* descriptionSets, VkDescriptionSetLayout* layouts, uint32_t count) {
+bool Vurl::DescriptorSetAllocator::Allocate(VkDescriptorSet* descriptorSets, const VkDescriptorSetLayout* layouts, uint32_t count) {
     if (currentPool == VK_NULL_HANDLE) {
         currentPool = GetPool();
         usedPools.push_back(currentPool);
@@ -40,19 +41,19 @@ void Vurl::DescriptorSetAllocator::Allocate(VkDescriptionSet* descriptionSets, V
     allocInfo.descriptorSetCount = count;
     allocInfo.pSetLayouts = layouts;
 
-    VkResult r = vkAllocateDescriptorSets(vkDevice, &allocInfo, descriptionSets);
+    VkResult r = vkAllocateDescriptorSets(vkDevice, &allocInfo, descriptorSets);
 
     switch (r) {
         case VK_SUCCESS:
-            return;
+            return true;
         case VK_ERROR_FRAGMENTED_POOL:
         case VK_ERROR_OUT_OF_POOL_MEMORY:
             currentPool = GetPool();
             usedPools.push_back(currentPool);
-            vkAllocateDescriptorSets(vkDevice, &allocInfo, descriptionSets);
-            return;
+            allocInfo.descriptorPool = currentPool;
+            return vkAllocateDescriptorSets(vkDevice, &allocInfo, descriptorSets) == VK_SUCCESS;
         default:
-            return;
+            return false;
     }
 }
 
@@ -67,9 +68,10 @@ VkDescriptorPool Vurl::DescriptorSetAllocator::GetPool() {
 }
 
 VkDescriptorPool Vurl::DescriptorSetAllocator::CreatePool(uint32_t count, VkDescriptorPoolCreateFlags flags) {
-    std::vector<VkDescriptorPoolSize> sizes(descriptorPoolSize.sizes.size());
+    std::vector<VkDescriptorPoolSize> sizes{};
+    sizes.reserve(descriptorPoolSize.sizes.size());
     for (auto size : descriptorPoolSize.sizes)
-        sizes.emplace_back(size.first, (uint32_t)(size.second * count));
+        sizes.push_back(VkDescriptorPoolSize{ size.first, (uint32_t)(size.second * count) });
 
     VkDescriptorPoolCreateInfo poolCreateInfo{};
     poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -78,7 +80,7 @@ VkDescriptorPool Vurl::DescriptorSetAllocator::CreatePool(uint32_t count, VkDesc
     poolCreateInfo.poolSizeCount = (uint32_t)sizes.size();
     poolCreateInfo.pPoolSizes = sizes.data();
 
-    VkDescriptorPool pool;
+    VkDescriptorPool pool = VK_NULL_HANDLE;
     vkCreateDescriptorPool(vkDevice, &poolCreateInfo, nullptr, &pool);
 
     return pool;
@@ -0,0 +1,24 @@
+#include <vurl/draw_batch.hpp>
+#include <algorithm>
+
+
+uint32_t Vurl::DrawBatch::Flush(CommandEncoder& encoder, uint32_t instanceCount, uint32_t firstInstance) {
+    uint32_t commandCount = 0;
+    uint32_t maxMultiDrawCount = context->GetMaxMultiDrawCount();
+
+    if (maxMultiDrawCount > 0) {
+        for (uint32_t i = 0; i < draws.size(); i += maxMultiDrawCount) {
+            uint32_t drawCount = std::min((uint32_t)draws.size() - i, maxMultiDrawCount);
+            encoder.DrawMultiIndexed(drawCount, &draws[i], instanceCount, firstInstance);
+            ++commandCount;
+        }
+    } else {
+        for (const VkMultiDrawIndexedInfoEXT& draw : draws) {
+            encoder.DrawIndexed(draw.indexCount, instanceCount, draw.firstIndex, draw.vertexOffset, firstInstance);
+            ++commandCount;
+        }
+    }
+
+    draws.clear();
+    return commandCount;
+}
\ No newline at end of file
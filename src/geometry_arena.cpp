@@ -0,0 +1,194 @@
+#include <vurl/geometry_arena.hpp>
+#include <algorithm>
+
+
+void Vurl::RangeAllocator::Reset(uint32_t capacity) {
+    this->capacity = capacity;
+    freeCount = capacity;
+    freeRanges.clear();
+    if (capacity > 0)
+        freeRanges[0] = capacity;
+}
+
+bool Vurl::RangeAllocator::Allocate(uint32_t count, uint32_t& offset) {
+    if (count == 0) {
+        offset = 0;
+        return true;
+    }
+
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+        if (it->second < count)
+            continue;
+
+        offset = it->first;
+        uint32_t remaining = it->second - count;
+        freeRanges.erase(it);
+        if (remaining > 0)
+            freeRanges[offset + count] = remaining;
+        freeCount -= count;
+        return true;
+    }
+
+    return false;
+}
+
+void Vurl::RangeAllocator::Free(uint32_t offset, uint32_t count) {
+    if (count == 0)
+        return;
+
+    freeCount += count;
+    auto it = freeRanges.emplace(offset, count).first;
+
+    auto next = std::next(it);
+    if (next != freeRanges.end() && it->first + it->second == next->first) {
+        it->second += next->second;
+        freeRanges.erase(next);
+    }
+
+    if (it != freeRanges.begin()) {
+        auto previous = std::prev(it);
+        if (previous->first + previous->second == it->first) {
+            previous->second += it->second;
+            freeRanges.erase(it);
+        }
+    }
+}
+
+uint32_t Vurl::RangeAllocator::GetLargestFreeRange() const {
+    uint32_t largest = 0;
+    for (const auto& range : freeRanges)
+        largest = std::max(largest, range.second);
+    return largest;
+}
+
+Vurl::GeometryArena::GeometryArena(std::shared_ptr<RenderGraph> graph, const std::string& name, uint32_t vertexStride, 
+        uint32_t vertexCapacity, uint32_t indexCapacity, VkBufferUsageFlags additionalUsage) : graph{ graph }, vertexStride{ vertexStride } {
+    vertexBuffer = graph->CreateBuffer<Resource<Buffer>>(name + " Vertices", false);
+    indexBuffer = graph->CreateBuffer<Resource<Buffer>>(name + " Indices", false);
+
+    std::shared_ptr<Buffer> vertexBufferSlice = std::make_shared<Buffer>();
+    std::shared_ptr<Buffer> indexBufferSlice = std::make_shared<Buffer>();
+
+    //Transfer source and destination for uploads and for moves during defragmentation
+    VkBufferUsageFlags usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | additionalUsage;
+    vertexBufferSlice->usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | usage;
+    vertexBufferSlice->size = (VkDeviceSize)vertexCapacity * vertexStride;
+    indexBufferSlice->usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | usage;
+    indexBufferSlice->size = (VkDeviceSize)indexCapacity * sizeof(uint32_t);
+
+    vertexBuffer->SetSliceCount(1);
+    indexBuffer->SetSliceCount(1);
+    vertexBuffer->SetResourceSlice(vertexBufferSlice, 0);
+    indexBuffer->SetResourceSlice(indexBufferSlice, 0);
+
+    vertexAllocator.Reset(vertexCapacity);
+    indexAllocator.Reset(indexCapacity);
+}
+
+void Vurl::GeometryArena::Create() {
+    graph->CommitBuffer(vertexBuffer);
+    graph->CommitBuffer(indexBuffer);
+
+    vertexAllocator.Reset(vertexAllocator.GetCapacity());
+    indexAllocator.Reset(indexAllocator.GetCapacity());
+    allocations.clear();
+    liveAllocations.clear();
+    freeHandles.clear();
+}
+
+Vurl::GeometryHandle Vurl::GeometryArena::Allocate(const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount) {
+    GeometryAllocation allocation{};
+    allocation.vertexCount = vertexCount;
+    allocation.indexCount = indexCount;
+
+    if (!vertexAllocator.Allocate(vertexCount, allocation.vertexOffset))
+        return VURL_NULL_HANDLE;
+    if (!indexAllocator.Allocate(indexCount, allocation.firstIndex)) {
+        vertexAllocator.Free(allocation.vertexOffset, vertexCount);
+        return VURL_NULL_HANDLE;
+    }
+
+    if (vertices && vertexCount > 0)
+        graph->UpdateBuffer(vertexBuffer, (const uint8_t*)vertices, vertexCount * vertexStride, (VkDeviceSize)allocation.vertexOffset * vertexStride);
+    if (indices && indexCount > 0)
+        graph->UpdateBuffer(indexBuffer, (const uint8_t*)indices, indexCount * sizeof(uint32_t), (VkDeviceSize)allocation.firstIndex * sizeof(uint32_t));
+
+    GeometryHandle handle = VURL_NULL_HANDLE;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+        allocations[handle] = allocation;
+        liveAllocations[handle] = true;
+    } else {
+        handle = (GeometryHandle)allocations.size();
+        allocations.push_back(allocation);
+        liveAllocations.push_back(true);
+    }
+
+    return handle;
+}
+
+void Vurl::GeometryArena::Free(GeometryHandle handle) {
+    if (handle < 0 || handle >= (GeometryHandle)allocations.size() || !liveAllocations[handle])
+        return;
+
+    //Draws recorded before this still read the range, it is only overwritten by copies recorded in a later frame
+    const GeometryAllocation& allocation = allocations[handle];
+    vertexAllocator.Free(allocation.vertexOffset, allocation.vertexCount);
+    indexAllocator.Free(allocation.firstIndex, allocation.indexCount);
+    liveAllocations[handle] = false;
+    freeHandles.push_back(handle);
+}
+
+uint32_t Vurl::GeometryArena::Defragment() {
+    std::vector<GeometryHandle> handles{};
+    for (uint32_t i = 0; i < allocations.size(); ++i)
+        if (liveAllocations[i])
+            handles.push_back((GeometryHandle)i);
+
+    std::vector<bool> moved(allocations.size(), false);
+
+    //Vertices and indices are packed independently, in offset order so every range moves towards the start
+    std::sort(handles.begin(), handles.end(), [this](GeometryHandle a, GeometryHandle b) { return allocations[a].vertexOffset < allocations[b].vertexOffset; });
+    uint32_t vertexOffset = 0;
+    for (GeometryHandle handle : handles) {
+        GeometryAllocation& allocation = allocations[handle];
+        if (allocation.vertexOffset != vertexOffset) {
+            graph->MoveBufferRange(vertexBuffer, (VkDeviceSize)allocation.vertexOffset * vertexStride, 
+                    (VkDeviceSize)vertexOffset * vertexStride, (VkDeviceSize)allocation.vertexCount * vertexStride);
+            allocation.vertexOffset = vertexOffset;
+            moved[handle] = true;
+        }
+        vertexOffset += allocation.vertexCount;
+    }
+
+    std::sort(handles.begin(), handles.end(), [this](GeometryHandle a, GeometryHandle b) { return allocations[a].firstIndex < allocations[b].firstIndex; });
+    uint32_t firstIndex = 0;
+    for (GeometryHandle handle : handles) {
+        GeometryAllocation& allocation = allocations[handle];
+        if (allocation.firstIndex != firstIndex) {
+            graph->MoveBufferRange(indexBuffer, (VkDeviceSize)allocation.firstIndex * sizeof(uint32_t), 
+                    (VkDeviceSize)firstIndex * sizeof(uint32_t), (VkDeviceSize)allocation.indexCount * sizeof(uint32_t));
+            allocation.firstIndex = firstIndex;
+            moved[handle] = true;
+        }
+        firstIndex += allocation.indexCount;
+    }
+
+    //Everything past the packed allocations is one free range again
+    vertexAllocator.Reset(vertexAllocator.GetCapacity());
+    indexAllocator.Reset(indexAllocator.GetCapacity());
+    uint32_t offset = 0;
+    vertexAllocator.Allocate(vertexOffset, offset);
+    indexAllocator.Allocate(firstIndex, offset);
+
+    return (uint32_t)std::count(moved.begin(), moved.end(), true);
+}
+
+float Vurl::GeometryArena::GetFragmentation() const {
+    float vertexFragmentation = vertexAllocator.GetFreeCount() > 0 ? 
+            1.0f - (float)vertexAllocator.GetLargestFreeRange() / (float)vertexAllocator.GetFreeCount() : 0.0f;
+    float indexFragmentation = indexAllocator.GetFreeCount() > 0 ? 
+            1.0f - (float)indexAllocator.GetLargestFreeRange() / (float)indexAllocator.GetFreeCount() : 0.0f;
+    return std::max(vertexFragmentation, indexFragmentation);
+}
\ No newline at end of file
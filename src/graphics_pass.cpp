@@ -34,9 +34,53 @@ void Vurl::GraphicsPass::ClearAttachment(uint32_t attachmentIdx, VkClearColorVal
     clearAttachmentInfo.emplace_back(attachmentIdx, color);
 }   
 
-void Vurl::GraphicsPass::AddBufferInput(std::shared_ptr<Resource<Buffer>> buffer) {
+bool Vurl::GraphicsPass::IsColorAttachmentCleared(uint32_t attachmentIdx) const {
+    for (uint32_t i = 0; i < clearAttachmentInfo.size(); ++i)
+        if (clearAttachmentInfo[i].first == attachmentIdx)
+            return true;
+    return false;
+}
+
+void Vurl::GraphicsPass::AddStorageBuffer(std::shared_ptr<Resource<Buffer>> buffer, uint32_t binding, ResourceAccessType access) {
     BufferHandle handle = graph->GetBufferHandle(buffer);
-    if (handle == VURL_NULL_HANDLE)
+    if (handle == VURL_NULL_HANDLE || !IsStorageAccessType(access))
+        return;
+    storageBuffers.push_back(StorageBinding<BufferHandle>{ handle, binding, access });
+    AddResourceAccess(false, handle, access);
+}
+
+void Vurl::GraphicsPass::AddStorageImage(std::shared_ptr<Resource<Texture>> texture, uint32_t binding, ResourceAccessType access) {
+    TextureHandle handle = graph->GetTextureHandle(texture);
+    if (handle == VURL_NULL_HANDLE || !IsStorageAccessType(access))
         return;
-    inputBuffers.push_back(handle);
+    storageImages.push_back(StorageBinding<TextureHandle>{ handle, binding, access });
+    AddResourceAccess(true, handle, access);
+}
+
+void Vurl::GraphicsPass::SetIndexedIndirectDraw(std::shared_ptr<Resource<Buffer>> indirectBuffer, std::shared_ptr<Resource<Buffer>> countBuffer, 
+        std::shared_ptr<Resource<Buffer>> vertexBuffer, std::shared_ptr<Resource<Buffer>> indexBuffer, uint32_t maxDrawCount, VkIndexType indexType) {
+    IndexedIndirectDraw draw{};
+    draw.indirectBuffer = graph->GetBufferHandle(indirectBuffer);
+    draw.countBuffer = countBuffer ? graph->GetBufferHandle(countBuffer) : VURL_NULL_HANDLE;
+    draw.vertexBuffer = graph->GetBufferHandle(vertexBuffer);
+    draw.indexBuffer = graph->GetBufferHandle(indexBuffer);
+    draw.maxDrawCount = maxDrawCount;
+    draw.indexType = indexType;
+
+    if (draw.indirectBuffer == VURL_NULL_HANDLE || (countBuffer && draw.countBuffer == VURL_NULL_HANDLE) || 
+            draw.vertexBuffer == VURL_NULL_HANDLE || draw.indexBuffer == VURL_NULL_HANDLE)
+        return;
+
+    //Setting the same buffers again only updates the draw parameters
+    bool sameBuffers = indexedIndirectDraw.indirectBuffer == draw.indirectBuffer && indexedIndirectDraw.countBuffer == draw.countBuffer &&
+            indexedIndirectDraw.vertexBuffer == draw.vertexBuffer && indexedIndirectDraw.indexBuffer == draw.indexBuffer;
+    indexedIndirectDraw = draw;
+    if (sameBuffers)
+        return;
+
+    AddResourceAccess(false, draw.indirectBuffer, ResourceAccessType::IndirectBuffer);
+    if (draw.countBuffer != VURL_NULL_HANDLE)
+        AddResourceAccess(false, draw.countBuffer, ResourceAccessType::IndirectBuffer);
+    AddResourceAccess(false, draw.vertexBuffer, ResourceAccessType::VertexBuffer);
+    AddResourceAccess(false, draw.indexBuffer, ResourceAccessType::IndexBuffer);
 }
\ No newline at end of file
@@ -1,12 +1,62 @@
 #include <vurl/graphics_pipeline.hpp>
 #include <iostream>
+#include <algorithm>
 
 
 bool Vurl::GraphicsPipeline::CreatePipelineLayout() {
+    const VkShaderStageFlagBits stages[] = { VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, 
+            VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT, VK_SHADER_STAGE_GEOMETRY_BIT, VK_SHADER_STAGE_FRAGMENT_BIT };
+
+    //Bindings used by several stages become one binding visible to all of them
+    std::vector<std::pair<uint32_t, VkDescriptorSetLayoutBinding>> layoutBindings{};
+    uint32_t setCount = 0;
+
+    for (VkShaderStageFlagBits stage : stages) {
+        std::shared_ptr<Shader> shader = GetShader(stage);
+        if (!shader)
+            continue;
+
+        for (const ShaderDescriptorBinding& binding : shader->GetReflection().descriptorBindings) {
+            setCount = std::max(setCount, binding.set + 1);
+
+            auto it = std::find_if(layoutBindings.begin(), layoutBindings.end(), [&binding](const auto& e) { 
+                return e.first == binding.set && e.second.binding == binding.binding; 
+            });
+            if (it != layoutBindings.end()) {
+                it->second.stageFlags |= stage;
+                continue;
+            }
+
+            VkDescriptorSetLayoutBinding layoutBinding{};
+            layoutBinding.binding = binding.binding;
+            layoutBinding.descriptorType = binding.descriptorType;
+            layoutBinding.descriptorCount = binding.descriptorCount;
+            layoutBinding.stageFlags = stage;
+            layoutBindings.emplace_back(binding.set, layoutBinding);
+        }
+    }
+
+    //Sets the shaders skip still need a (empty) layout to keep set numbers stable
+    descriptorSetLayouts.resize(setCount, VK_NULL_HANDLE);
+    for (uint32_t set = 0; set < setCount; ++set) {
+        std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
+        for (const auto& e : layoutBindings)
+            if (e.first == set)
+                setLayoutBindings.push_back(e.second);
+
+        VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo{};
+        setLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        setLayoutCreateInfo.bindingCount = (uint32_t)setLayoutBindings.size();
+        setLayoutCreateInfo.pBindings = setLayoutBindings.data();
+
+        if (vkCreateDescriptorSetLayout(vkDevice, &setLayoutCreateInfo, nullptr, &descriptorSetLayouts[set]) != VK_SUCCESS)
+            return false;
+    }
+
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;
-    pipelineLayoutInfo.pSetLayouts = nullptr;
+    pipelineLayoutInfo.setLayoutCount = (uint32_t)descriptorSetLayouts.size();
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
     pipelineLayoutInfo.pushConstantRangeCount = (uint32_t)pushConstantRanges.size();
     pipelineLayoutInfo.pPushConstantRanges = pushConstantRanges.data();
 
@@ -18,4 +68,106 @@ bool Vurl::GraphicsPipeline::CreatePipelineLayout() {
 
 void Vurl::GraphicsPipeline::DestroyPipelineLayout() {
     vkDestroyPipelineLayout(vkDevice, vkPipelineLayout, nullptr);
+    for (VkDescriptorSetLayout setLayout : descriptorSetLayouts)
+        vkDestroyDescriptorSetLayout(vkDevice, setLayout, nullptr);
+    vkPipelineLayout = VK_NULL_HANDLE;
+    descriptorSetLayouts.clear();
+}
+
+const Vurl::ShaderDescriptorBinding* Vurl::GraphicsPipeline::FindDescriptorBinding(uint32_t set, uint32_t binding) const {
+    for (std::shared_ptr<Shader> shader : { vertexShader, tessellationControlShader, tessellationEvaluationShader, geometryShader, fragmentShader }) {
+        if (!shader)
+            continue;
+        for (const ShaderDescriptorBinding& descriptorBinding : shader->GetReflection().descriptorBindings)
+            if (descriptorBinding.set == set && descriptorBinding.binding == binding)
+                return &descriptorBinding;
+    }
+    return nullptr;
+}
+
+bool Vurl::GraphicsPipeline::SetSpecializationConstant(VkShaderStageFlagBits stage, uint32_t constantId, SpecializationConstantType type, uint32_t data) {
+    std::shared_ptr<Shader> shader = GetShader(stage);
+    if (!shader)
+        return false;
+
+    const SpecializationConstantInfo* info = shader->FindSpecializationConstant(constantId);
+    if (!info || info->type != type)
+        return false;
+
+    //Keep constants sorted so the same value set always hashes the same
+    auto it = std::lower_bound(specializationConstants.begin(), specializationConstants.end(), std::make_pair(stage, constantId),
+            [](const SpecializationConstant& c, const std::pair<VkShaderStageFlagBits, uint32_t>& key) {
+                return c.stage != key.first ? c.stage < key.first : c.constantId < key.second;
+            });
+
+    if (it != specializationConstants.end() && it->stage == stage && it->constantId == constantId)
+        it->data = data;
+    else
+        specializationConstants.insert(it, SpecializationConstant{ stage, constantId, data });
+
+    return true;
+}
+
+void Vurl::GraphicsPipeline::GetSpecializationData(VkShaderStageFlagBits stage, std::vector<VkSpecializationMapEntry>& mapEntries, std::vector<uint32_t>& data) const {
+    for (const SpecializationConstant& constant : specializationConstants) {
+        if (constant.stage != stage)
+            continue;
+
+        VkSpecializationMapEntry mapEntry{};
+        mapEntry.constantID = constant.constantId;
+        mapEntry.offset = (uint32_t)(data.size() * sizeof(uint32_t));
+        mapEntry.size = sizeof(uint32_t);
+
+        mapEntries.push_back(mapEntry);
+        data.push_back(constant.data);
+    }
+}
+
+std::shared_ptr<Vurl::Shader> Vurl::GraphicsPipeline::GetShader(VkShaderStageFlagBits stage) const {
+    switch (stage) {
+        case VK_SHADER_STAGE_VERTEX_BIT:                  return vertexShader;
+        case VK_SHADER_STAGE_FRAGMENT_BIT:                return fragmentShader;
+        case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:    return tessellationControlShader;
+        case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT: return tessellationEvaluationShader;
+        case VK_SHADER_STAGE_GEOMETRY_BIT:                return geometryShader;
+        default: return nullptr;
+    }
+}
+
+void Vurl::GraphicsPipeline::GetVkDynamicStates(DynamicStateFlags flags, std::vector<VkDynamicState>& dynamicStates) {
+    if (flags & DYNAMIC_STATE_VIEWPORT_BIT)
+        dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
+    if (flags & DYNAMIC_STATE_SCISSOR_BIT)
+        dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
+    if (flags & DYNAMIC_STATE_CULL_MODE_BIT)
+        dynamicStates.push_back(VK_DYNAMIC_STATE_CULL_MODE_EXT);
+    if (flags & DYNAMIC_STATE_FRONT_FACE_BIT)
+        dynamicStates.push_back(VK_DYNAMIC_STATE_FRONT_FACE_EXT);
+    if (flags & DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_BIT)
+        dynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_EXT);
+    if (flags & DYNAMIC_STATE_DEPTH_TEST_ENABLE_BIT)
+        dynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE_EXT);
+    if (flags & DYNAMIC_STATE_DEPTH_WRITE_ENABLE_BIT)
+        dynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE_EXT);
+    if (flags & DYNAMIC_STATE_DEPTH_COMPARE_OP_BIT)
+        dynamicStates.push_back(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP_EXT);
+    if (flags & DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_BIT)
+        dynamicStates.push_back(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_EXT);
+}
+
+VkPrimitiveTopology Vurl::GraphicsPipeline::GetPrimitiveTopologyClass(VkPrimitiveTopology topology) {
+    //Dynamic topology must stay in the topology class the pipeline was created with
+    switch (topology) {
+        case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+            return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+        case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+        case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+        case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+        case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+            return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+        case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+            return VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+        default:
+            return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,315 @@
+#include <vurl/graphics_pipeline_library.hpp>
+#include <vector>
+#include <array>
+#include <chrono>
+#include <cstring>
+
+
+uint32_t Vurl::GraphicsPipelineLibrary::Link(const VkGraphicsPipelineCreateInfo& createInfo, const std::string& renderPassKey) {
+    std::array<VkPipeline, GRAPHICS_PIPELINE_LIBRARY_PART_MAX> libraries{};
+
+    //Parts are only destroyed together with the links using them, their handles can't be reused under a live key
+    HashKey key{};
+    for (uint32_t i = 0; i < GRAPHICS_PIPELINE_LIBRARY_PART_MAX; ++i) {
+        libraries[i] = GetPart((GraphicsPipelineLibraryPart)i, createInfo, renderPassKey);
+        if (libraries[i] == VK_NULL_HANDLE)
+            return 0;
+        key.Ptr(libraries[i]);
+    }
+    key.Ptr(createInfo.layout);
+
+    auto it = linkedPipelineIds.find(key.Get());
+    if (it != linkedPipelineIds.end()) {
+        linkedPipelines[it->second].generation = generation;
+        return it->second;
+    }
+
+    VkPipelineLayout layout = createInfo.layout;
+    VkPipeline fastLinked = CreateLinkedPipeline(layout, libraries.data(), false);
+    if (fastLinked == VK_NULL_HANDLE)
+        return 0;
+
+    uint32_t id = nextLinkedPipelineId++;
+    linkedPipelineIds[key.Get()] = id;
+    LinkedPipeline& linkedPipeline = linkedPipelines[id];
+    linkedPipeline.fastLinked = fastLinked;
+    linkedPipeline.key = key.Get();
+    linkedPipeline.generation = generation;
+    linkedPipeline.pendingOptimized = std::async(std::launch::async, [this, layout, libraries]() {
+        return CreateLinkedPipeline(layout, libraries.data(), true);
+    });
+
+    return id;
+}
+
+VkPipeline Vurl::GraphicsPipelineLibrary::GetLinkedPipeline(uint32_t id) {
+    auto it = linkedPipelines.find(id);
+    if (it == linkedPipelines.end())
+        return VK_NULL_HANDLE;
+
+    LinkedPipeline& linkedPipeline = it->second;
+    if (linkedPipeline.pendingOptimized.valid() &&
+            linkedPipeline.pendingOptimized.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+        linkedPipeline.optimized = linkedPipeline.pendingOptimized.get();
+
+    return linkedPipeline.optimized != VK_NULL_HANDLE ? linkedPipeline.optimized : linkedPipeline.fastLinked;
+}
+
+void Vurl::GraphicsPipelineLibrary::EvictUnused(DeletionQueue& deletionQueue) {
+    //A link in use keeps its parts in use, evicting a part never leaves a link without it
+    for (auto it = linkedPipelines.begin(); it != linkedPipelines.end();) {
+        LinkedPipeline& linkedPipeline = it->second;
+        if (linkedPipeline.generation == generation) {
+            ++it;
+            continue;
+        }
+
+        if (linkedPipeline.pendingOptimized.valid())
+            linkedPipeline.optimized = linkedPipeline.pendingOptimized.get();
+        deletionQueue.DestroyPipeline(linkedPipeline.optimized);
+        deletionQueue.DestroyPipeline(linkedPipeline.fastLinked);
+        linkedPipelineIds.erase(linkedPipeline.key);
+        it = linkedPipelines.erase(it);
+    }
+
+    for (uint32_t i = 0; i < GRAPHICS_PIPELINE_LIBRARY_PART_MAX; ++i) {
+        for (auto it = parts[i].begin(); it != parts[i].end();) {
+            if (it->second.generation == generation) {
+                ++it;
+                continue;
+            }
+            deletionQueue.DestroyPipeline(it->second.pipeline);
+            it = parts[i].erase(it);
+        }
+    }
+
+    ++generation;
+}
+
+void Vurl::GraphicsPipelineLibrary::Destroy() {
+    for (auto& e : linkedPipelines) {
+        LinkedPipeline& linkedPipeline = e.second;
+        if (linkedPipeline.pendingOptimized.valid())
+            linkedPipeline.optimized = linkedPipeline.pendingOptimized.get();
+        vkDestroyPipeline(vkDevice, linkedPipeline.optimized, nullptr);
+        vkDestroyPipeline(vkDevice, linkedPipeline.fastLinked, nullptr);
+    }
+    linkedPipelines.clear();
+    linkedPipelineIds.clear();
+
+    for (uint32_t i = 0; i < GRAPHICS_PIPELINE_LIBRARY_PART_MAX; ++i) {
+        for (auto& e : parts[i])
+            vkDestroyPipeline(vkDevice, e.second.pipeline, nullptr);
+        parts[i].clear();
+    }
+}
+
+VkPipeline Vurl::GraphicsPipelineLibrary::GetPart(GraphicsPipelineLibraryPart part, const VkGraphicsPipelineCreateInfo& createInfo, 
+        const std::string& renderPassKey) {
+    HashKey key{};
+    HashPart(key, part, createInfo, renderPassKey);
+
+    auto it = parts[part].find(key.Get());
+    if (it != parts[part].end()) {
+        it->second.generation = generation;
+        return it->second.pipeline;
+    }
+
+    VkPipeline pipeline = CreatePart(part, createInfo);
+    if (pipeline != VK_NULL_HANDLE)
+        parts[part][key.Get()] = { pipeline, generation };
+    return pipeline;
+}
+
+VkPipeline Vurl::GraphicsPipelineLibrary::CreatePart(GraphicsPipelineLibraryPart part, const VkGraphicsPipelineCreateInfo& createInfo) {
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo{};
+    libraryCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+
+    VkGraphicsPipelineCreateInfo partCreateInfo{};
+    partCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    partCreateInfo.pNext = &libraryCreateInfo;
+    partCreateInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+    partCreateInfo.pDynamicState = createInfo.pDynamicState;
+    partCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+    partCreateInfo.basePipelineIndex = -1;
+
+    std::vector<VkPipelineShaderStageCreateInfo> stages{};
+
+    switch (part) {
+        case GRAPHICS_PIPELINE_LIBRARY_PART_VERTEX_INPUT_INTERFACE:
+            libraryCreateInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+            partCreateInfo.pVertexInputState = createInfo.pVertexInputState;
+            partCreateInfo.pInputAssemblyState = createInfo.pInputAssemblyState;
+            break;
+        case GRAPHICS_PIPELINE_LIBRARY_PART_PRE_RASTERIZATION_SHADERS:
+            libraryCreateInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+            for (uint32_t i = 0; i < createInfo.stageCount; ++i)
+                if (createInfo.pStages[i].stage != VK_SHADER_STAGE_FRAGMENT_BIT)
+                    stages.push_back(createInfo.pStages[i]);
+            partCreateInfo.pViewportState = createInfo.pViewportState;
+            partCreateInfo.pRasterizationState = createInfo.pRasterizationState;
+            partCreateInfo.pTessellationState = createInfo.pTessellationState;
+            partCreateInfo.layout = createInfo.layout;
+            partCreateInfo.renderPass = createInfo.renderPass;
+            partCreateInfo.subpass = createInfo.subpass;
+            break;
+        case GRAPHICS_PIPELINE_LIBRARY_PART_FRAGMENT_SHADER:
+            libraryCreateInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+            for (uint32_t i = 0; i < createInfo.stageCount; ++i)
+                if (createInfo.pStages[i].stage == VK_SHADER_STAGE_FRAGMENT_BIT)
+                    stages.push_back(createInfo.pStages[i]);
+            partCreateInfo.pDepthStencilState = createInfo.pDepthStencilState;
+            partCreateInfo.pMultisampleState = createInfo.pMultisampleState;
+            partCreateInfo.layout = createInfo.layout;
+            partCreateInfo.renderPass = createInfo.renderPass;
+            partCreateInfo.subpass = createInfo.subpass;
+            break;
+        case GRAPHICS_PIPELINE_LIBRARY_PART_FRAGMENT_OUTPUT_INTERFACE:
+            libraryCreateInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+            partCreateInfo.pColorBlendState = createInfo.pColorBlendState;
+            partCreateInfo.pMultisampleState = createInfo.pMultisampleState;
+            partCreateInfo.renderPass = createInfo.renderPass;
+            partCreateInfo.subpass = createInfo.subpass;
+            break;
+        default:
+            return VK_NULL_HANDLE;
+    }
+
+    partCreateInfo.stageCount = (uint32_t)stages.size();
+    partCreateInfo.pStages = stages.data();
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(vkDevice, vkPipelineCache, 1, &partCreateInfo, nullptr, &pipeline) != VK_SUCCESS)
+        return VK_NULL_HANDLE;
+    return pipeline;
+}
+
+void Vurl::GraphicsPipelineLibrary::HashPart(HashKey& hasher, GraphicsPipelineLibraryPart part, const VkGraphicsPipelineCreateInfo& createInfo, 
+        const std::string& renderPassKey) {
+    hasher.U32(part);
+    HashDynamicState(hasher, createInfo.pDynamicState);
+
+    switch (part) {
+        case GRAPHICS_PIPELINE_LIBRARY_PART_VERTEX_INPUT_INTERFACE: {
+            const VkPipelineVertexInputStateCreateInfo* vertexInput = createInfo.pVertexInputState;
+            hasher.Data(vertexInput->pVertexBindingDescriptions, vertexInput->vertexBindingDescriptionCount);
+            hasher.Data(vertexInput->pVertexAttributeDescriptions, vertexInput->vertexAttributeDescriptionCount);
+            hasher.U32(createInfo.pInputAssemblyState->topology);
+            hasher.U32(createInfo.pInputAssemblyState->primitiveRestartEnable);
+            break;
+        }
+        case GRAPHICS_PIPELINE_LIBRARY_PART_PRE_RASTERIZATION_SHADERS: {
+            for (uint32_t i = 0; i < createInfo.stageCount; ++i)
+                if (createInfo.pStages[i].stage != VK_SHADER_STAGE_FRAGMENT_BIT)
+                    HashShaderStage(hasher, createInfo.pStages[i]);
+
+            const VkPipelineViewportStateCreateInfo* viewport = createInfo.pViewportState;
+            hasher.U32(viewport->viewportCount);
+            hasher.U32(viewport->scissorCount);
+            if (viewport->pViewports)
+                hasher.Data(viewport->pViewports, viewport->viewportCount);
+            if (viewport->pScissors)
+                hasher.Data(viewport->pScissors, viewport->scissorCount);
+
+            const VkPipelineRasterizationStateCreateInfo* rasterizer = createInfo.pRasterizationState;
+            hasher.U32(rasterizer->depthClampEnable);
+            hasher.U32(rasterizer->rasterizerDiscardEnable);
+            hasher.U32(rasterizer->polygonMode);
+            hasher.U32(rasterizer->cullMode);
+            hasher.U32(rasterizer->frontFace);
+            hasher.U32(rasterizer->depthBiasEnable);
+            hasher.F32(rasterizer->depthBiasConstantFactor);
+            hasher.F32(rasterizer->depthBiasClamp);
+            hasher.F32(rasterizer->depthBiasSlopeFactor);
+            hasher.F32(rasterizer->lineWidth);
+
+            if (createInfo.pTessellationState)
+                hasher.U32(createInfo.pTessellationState->patchControlPoints);
+
+            hasher.Ptr(createInfo.layout);
+            hasher.String(renderPassKey.data(), renderPassKey.size());
+            hasher.U32(createInfo.subpass);
+            break;
+        }
+        case GRAPHICS_PIPELINE_LIBRARY_PART_FRAGMENT_SHADER: {
+            for (uint32_t i = 0; i < createInfo.stageCount; ++i)
+                if (createInfo.pStages[i].stage == VK_SHADER_STAGE_FRAGMENT_BIT)
+                    HashShaderStage(hasher, createInfo.pStages[i]);
+
+            const VkPipelineDepthStencilStateCreateInfo* depthStencil = createInfo.pDepthStencilState;
+            hasher.U32(depthStencil->depthTestEnable);
+            hasher.U32(depthStencil->depthWriteEnable);
+            hasher.U32(depthStencil->depthCompareOp);
+            hasher.U32(depthStencil->depthBoundsTestEnable);
+            hasher.U32(depthStencil->stencilTestEnable);
+            hasher.Data(&depthStencil->front, 1);
+            hasher.Data(&depthStencil->back, 1);
+            hasher.F32(depthStencil->minDepthBounds);
+            hasher.F32(depthStencil->maxDepthBounds);
+
+            hasher.U32(createInfo.pMultisampleState->rasterizationSamples);
+            hasher.U32(createInfo.pMultisampleState->sampleShadingEnable);
+            hasher.F32(createInfo.pMultisampleState->minSampleShading);
+
+            hasher.Ptr(createInfo.layout);
+            hasher.String(renderPassKey.data(), renderPassKey.size());
+            hasher.U32(createInfo.subpass);
+            break;
+        }
+        case GRAPHICS_PIPELINE_LIBRARY_PART_FRAGMENT_OUTPUT_INTERFACE: {
+            const VkPipelineColorBlendStateCreateInfo* colorBlend = createInfo.pColorBlendState;
+            hasher.U32(colorBlend->logicOpEnable);
+            hasher.U32(colorBlend->logicOp);
+            hasher.Data(colorBlend->pAttachments, colorBlend->attachmentCount);
+            hasher.Data(colorBlend->blendConstants, 4);
+
+            hasher.U32(createInfo.pMultisampleState->rasterizationSamples);
+            hasher.U32(createInfo.pMultisampleState->alphaToCoverageEnable);
+            hasher.U32(createInfo.pMultisampleState->alphaToOneEnable);
+
+            hasher.String(renderPassKey.data(), renderPassKey.size());
+            hasher.U32(createInfo.subpass);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void Vurl::GraphicsPipelineLibrary::HashShaderStage(HashKey& hasher, const VkPipelineShaderStageCreateInfo& stage) {
+    hasher.U32(stage.stage);
+    hasher.Ptr(stage.module);
+    hasher.String(stage.pName, strlen(stage.pName));
+
+    if (stage.pSpecializationInfo) {
+        const VkSpecializationInfo* specializationInfo = stage.pSpecializationInfo;
+        hasher.Data(specializationInfo->pMapEntries, specializationInfo->mapEntryCount);
+        hasher.String((const char*)specializationInfo->pData, specializationInfo->dataSize);
+    }
+}
+
+void Vurl::GraphicsPipelineLibrary::HashDynamicState(HashKey& hasher, const VkPipelineDynamicStateCreateInfo* dynamicState) {
+    if (!dynamicState)
+        return;
+    hasher.Data(dynamicState->pDynamicStates, dynamicState->dynamicStateCount);
+}
+
+VkPipeline Vurl::GraphicsPipelineLibrary::CreateLinkedPipeline(VkPipelineLayout layout, const VkPipeline* libraries, bool optimized) {
+    VkPipelineLibraryCreateInfoKHR libraryCreateInfo{};
+    libraryCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+    libraryCreateInfo.libraryCount = GRAPHICS_PIPELINE_LIBRARY_PART_MAX;
+    libraryCreateInfo.pLibraries = libraries;
+
+    VkGraphicsPipelineCreateInfo linkCreateInfo{};
+    linkCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    linkCreateInfo.pNext = &libraryCreateInfo;
+    linkCreateInfo.flags = optimized ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+    linkCreateInfo.layout = layout;
+    linkCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+    linkCreateInfo.basePipelineIndex = -1;
+
+    VkPipeline pipeline = VK_NULL_HANDLE;
+    if (vkCreateGraphicsPipelines(vkDevice, vkPipelineCache, 1, &linkCreateInfo, nullptr, &pipeline) != VK_SUCCESS)
+        return VK_NULL_HANDLE;
+    return pipeline;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include <vurl/ktx2_file.hpp>
+#include <cstring>
+
+
+namespace {
+    const uint8_t ktx2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+}
+
+Vurl::VurlResult Vurl::Ktx2File::Open(const std::string& path) {
+    Close();
+
+    file = std::make_shared<MappedFile>();
+    if (!file->Open(path)) {
+        file = nullptr;
+        return VURL_ERROR_KTX2_OPEN_FAILED;
+    }
+
+    const uint8_t* data = file->GetData();
+    size_t size = file->GetSize();
+
+    header = (const Ktx2Header*)data;
+    if (size < sizeof(Ktx2Header) || memcmp(header->identifier, ktx2Identifier, sizeof(ktx2Identifier)) != 0 || header->pixelWidth == 0 ||
+            (header->faceCount != 1 && header->faceCount != 6) || header->levelCount > 32) {
+        Close();
+        return VURL_ERROR_INVALID_KTX2;
+    }
+
+    uint32_t levelCount = std::max(header->levelCount, 1u);
+    if (size < sizeof(Ktx2Header) + levelCount * sizeof(Ktx2Level)) {
+        Close();
+        return VURL_ERROR_INVALID_KTX2;
+    }
+
+    levels = (const Ktx2Level*)(data + sizeof(Ktx2Header));
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        if (levels[i].byteOffset > size || levels[i].byteLength > size - levels[i].byteOffset) {
+            Close();
+            return VURL_ERROR_INVALID_KTX2;
+        }
+    }
+
+    if (header->kvdByteOffset > size || header->kvdByteLength > size - header->kvdByteOffset) {
+        Close();
+        return VURL_ERROR_INVALID_KTX2;
+    }
+
+    //Supercompressed levels and Basis Universal payloads need a transcoder
+    if (header->supercompressionScheme != 0 || header->vkFormat == VK_FORMAT_UNDEFINED) {
+        Close();
+        return VURL_ERROR_UNSUPPORTED_KTX2;
+    }
+
+    return VURL_SUCCESS;
+}
+
+bool Vurl::Ktx2File::GetKeyValue(const std::string& key, const uint8_t*& value, uint32_t& size) const {
+    if (header == nullptr)
+        return false;
+
+    //Each entry is its length, the key with its terminator, the value, then padding to 4 bytes
+    const uint8_t* data = file->GetData() + header->kvdByteOffset;
+    uint32_t offset = 0;
+    while (offset + sizeof(uint32_t) <= header->kvdByteLength) {
+        uint32_t length = 0;
+        memcpy(&length, data + offset, sizeof(length));
+        offset += sizeof(uint32_t);
+        if (length > header->kvdByteLength - offset)
+            return false;
+
+        const char* entry = (const char*)(data + offset);
+        size_t keyLength = strnlen(entry, length);
+        if (keyLength < length && key.compare(0, std::string::npos, entry, keyLength) == 0) {
+            value = data + offset + keyLength + 1;
+            size = length - (uint32_t)keyLength - 1;
+            return true;
+        }
+        offset += (length + 3) & ~3u;
+    }
+    return false;
+}
+
+void Vurl::Ktx2File::Close() {
+    header = nullptr;
+    levels = nullptr;
+    file = nullptr;
+}
\ No newline at end of file
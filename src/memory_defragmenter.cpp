@@ -0,0 +1,152 @@
+#include <vurl/memory_defragmenter.hpp>
+#include <algorithm>
+
+
+void Vurl::MemoryDefragmenter::AddTexture(std::shared_ptr<Resource<Texture>> texture) {
+    if (texture->IsTransient())
+        return;
+    for (const MovableResource& resource : resources)
+        if (resource.texture == texture)
+            return;
+    resources.push_back({ texture, nullptr });
+}
+
+void Vurl::MemoryDefragmenter::AddBuffer(std::shared_ptr<Resource<Buffer>> buffer) {
+    if (buffer->IsTransient())
+        return;
+    for (const MovableResource& resource : resources)
+        if (resource.buffer == buffer)
+            return;
+    resources.push_back({ nullptr, buffer });
+}
+
+void Vurl::MemoryDefragmenter::Remove(std::shared_ptr<Resource<Texture>> texture) {
+    std::erase_if(resources, [&texture](const MovableResource& resource) { return resource.texture == texture; });
+}
+
+void Vurl::MemoryDefragmenter::Remove(std::shared_ptr<Resource<Buffer>> buffer) {
+    std::erase_if(resources, [&buffer](const MovableResource& resource) { return resource.buffer == buffer; });
+}
+
+void Vurl::MemoryDefragmenter::Start(ResourceClass resourceClass) {
+    std::shared_ptr<RenderingContext> context = graph->GetContext();
+    if (resourceClass == RESOURCE_CLASS_DEFAULT) {
+        pendingPools.push_back(VK_NULL_HANDLE);
+        return;
+    }
+
+    if (context->GetMemoryPoolSettings(resourceClass).linear)
+        return;
+    for (VmaPool pool : context->GetMemoryPools(resourceClass))
+        pendingPools.push_back(pool);
+}
+
+void Vurl::MemoryDefragmenter::Stop() {
+    if (passActive) {
+        vmaEndDefragmentationPass(graph->GetContext()->GetAllocator(), defragmentationContext, &passInfo);
+        passActive = false;
+    }
+    if (defragmentationContext != VK_NULL_HANDLE)
+        EndDefragmentation();
+    pendingPools.clear();
+}
+
+void Vurl::MemoryDefragmenter::Update() {
+    if (passActive) {
+        //The copies are recorded by the frame the pass began in, its fence was waited once that slot came around again
+        if (graph->GetFrameIndex() <= passFrameIndex + VURL_MAX_FRAMES_IN_FLIGHT)
+            return;
+
+        VkResult result = vmaEndDefragmentationPass(graph->GetContext()->GetAllocator(), defragmentationContext, &passInfo);
+        passActive = false;
+        if (result == VK_SUCCESS) {
+            EndDefragmentation();
+            return;
+        }
+    }
+
+    if (defragmentationContext == VK_NULL_HANDLE && !BeginDefragmentation())
+        return;
+    BeginPass();
+}
+
+bool Vurl::MemoryDefragmenter::BeginDefragmentation() {
+    while (!pendingPools.empty()) {
+        VmaDefragmentationInfo defragmentationInfo{};
+        defragmentationInfo.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT;
+        defragmentationInfo.pool = pendingPools.front();
+        defragmentationInfo.maxBytesPerPass = maxBytesPerPass;
+        defragmentationInfo.maxAllocationsPerPass = maxAllocationsPerPass;
+        pendingPools.erase(pendingPools.begin());
+
+        if (vmaBeginDefragmentation(graph->GetContext()->GetAllocator(), &defragmentationInfo, &defragmentationContext) == VK_SUCCESS)
+            return true;
+        defragmentationContext = VK_NULL_HANDLE;
+    }
+    return false;
+}
+
+void Vurl::MemoryDefragmenter::EndDefragmentation() {
+    //Blocks left empty are freed here
+    VmaDefragmentationStats defragmentationStats{};
+    vmaEndDefragmentation(graph->GetContext()->GetAllocator(), defragmentationContext, &defragmentationStats);
+    defragmentationContext = VK_NULL_HANDLE;
+
+    statistics.movedAllocationCount += defragmentationStats.allocationsMoved;
+    statistics.movedBytes += defragmentationStats.bytesMoved;
+    statistics.freedBlockCount += defragmentationStats.deviceMemoryBlocksFreed;
+    statistics.freedBytes += defragmentationStats.bytesFreed;
+}
+
+void Vurl::MemoryDefragmenter::BeginPass() {
+    VmaAllocator allocator = graph->GetContext()->GetAllocator();
+    passInfo = {};
+    if (vmaBeginDefragmentationPass(allocator, defragmentationContext, &passInfo) != VK_INCOMPLETE) {
+        EndDefragmentation();
+        return;
+    }
+    ++statistics.passCount;
+
+    //Moves are reported by allocation, find the slice each one belongs to
+    movableAllocations.clear();
+    for (const MovableResource& resource : resources) {
+        uint32_t sliceCount = resource.texture != nullptr ? resource.texture->GetSliceCount() : resource.buffer->GetSliceCount();
+        for (uint32_t i = 0; i < sliceCount; ++i) {
+            VmaAllocation allocation = resource.texture != nullptr ? resource.texture->GetResourceSlice(i)->allocation : 
+                    resource.buffer->GetResourceSlice(i)->allocation;
+            if (allocation != VK_NULL_HANDLE)
+                movableAllocations[allocation] = { resource.texture, resource.buffer, i };
+        }
+    }
+
+    uint32_t movedCount = 0;
+    for (uint32_t i = 0; i < passInfo.moveCount; ++i) {
+        if (MoveAllocation(passInfo.pMoves[i]))
+            ++movedCount;
+        else
+            passInfo.pMoves[i].operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+    }
+
+    //Nothing to wait for when every move was refused
+    if (movedCount == 0) {
+        if (vmaEndDefragmentationPass(allocator, defragmentationContext, &passInfo) == VK_SUCCESS)
+            EndDefragmentation();
+        return;
+    }
+
+    passActive = true;
+    passFrameIndex = graph->GetFrameIndex();
+}
+
+bool Vurl::MemoryDefragmenter::MoveAllocation(const VmaDefragmentationMove& move) {
+    auto it = movableAllocations.find(move.srcAllocation);
+    if (it == movableAllocations.end())
+        return false;
+
+    const DefragmentationMove& target = it->second;
+    bool moved = target.texture != nullptr ? graph->MoveTexture(target.texture->GetResourceSlice(target.sliceIndex), move.dstTmpAllocation) : 
+            graph->MoveBuffer(target.buffer->GetResourceSlice(target.sliceIndex), move.dstTmpAllocation);
+    if (moved && moveCallback)
+        moveCallback(target);
+    return moved;
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include <vurl/pass.hpp>
+#include <vurl/render_graph.hpp>
+
+
+void Vurl::Pass::AddBufferAccess(std::shared_ptr<Resource<Buffer>> buffer, ResourceAccessType type) {
+    BufferHandle handle = graph->GetBufferHandle(buffer);
+    if (handle == VURL_NULL_HANDLE || !IsBufferAccessType(type))
+        return;
+    AddResourceAccess(false, handle, type);
+}
+
+void Vurl::Pass::AddTextureAccess(std::shared_ptr<Resource<Texture>> texture, ResourceAccessType type) {
+    TextureHandle handle = graph->GetTextureHandle(texture);
+    if (handle == VURL_NULL_HANDLE || !IsTextureAccessType(type))
+        return;
+    AddResourceAccess(true, handle, type);
+}
+
+void Vurl::Pass::AddResourceAccess(bool isTexture, int handle, ResourceAccessType type) {
+    resourceAccesses.push_back(ResourceAccess{ isTexture, handle, type });
+}
+
+bool Vurl::Pass::IsBufferAccessType(ResourceAccessType type) {
+    return type != ResourceAccessType::SampledImage;
+}
+
+bool Vurl::Pass::IsTextureAccessType(ResourceAccessType type) {
+    switch (type) {
+        case ResourceAccessType::SampledImage:
+        case ResourceAccessType::StorageRead:
+        case ResourceAccessType::StorageWrite:
+        case ResourceAccessType::StorageReadWrite:
+        case ResourceAccessType::TransferRead:
+        case ResourceAccessType::TransferWrite:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool Vurl::Pass::IsReadAccessType(ResourceAccessType type) {
+    return type != ResourceAccessType::StorageWrite && type != ResourceAccessType::TransferWrite;
+}
+
+bool Vurl::Pass::IsStorageAccessType(ResourceAccessType type) {
+    return type == ResourceAccessType::StorageRead || type == ResourceAccessType::StorageWrite || 
+            type == ResourceAccessType::StorageReadWrite;
+}
+
+bool Vurl::Pass::IsWriteAccessType(ResourceAccessType type) {
+    switch (type) {
+        case ResourceAccessType::StorageWrite:
+        case ResourceAccessType::StorageReadWrite:
+        case ResourceAccessType::TransferWrite:
+            return true;
+        default:
+            return false;
+    }
+}
\ No newline at end of file
@@ -1,14 +1,30 @@
 #include <vurl/render_graph.hpp>
+#include <vurl/texture_decoder.hpp>
 #include <iostream>
 #include <numeric>
+#include <algorithm>
+#include <map>
+#include <chrono>
+#include <bit>
 
 
 Vurl::RenderGraph::RenderGraph(std::shared_ptr<RenderingContext> context) : context{ context } {
-    
+    deletionQueue = std::make_shared<DeletionQueue>(context->GetDevice(), context->GetAllocator());
 }
 
 Vurl::RenderGraph::~RenderGraph() {
+    //A graph dropped without the explicit teardown still releases what it owns. Every step is a no-op when it
+    //already ran, nothing can be released once the device is gone.
+    if (context->GetDevice() == VK_NULL_HANDLE) {
+        if (deletionQueue->GetPendingCount() > 0 || inFlightFences[0] != VK_NULL_HANDLE)
+            std::cout << "Render graph destroyed after its device, call DestroyFrameResources first." << std::endl;
+        return;
+    }
 
+    Destroy();
+    DestroyFrameResources();
+    DestroyTransientCommandPool();
+    DestroyPipelineCache();
 }
 
 void Vurl::RenderGraph::SetSurface(std::shared_ptr<Surface> surface) {
@@ -34,54 +50,295 @@ void Vurl::RenderGraph::CommitBuffer(std::shared_ptr<Resource<Buffer>> buffer, c
     if (buffer->IsTransient())
         return;
     
-    VkBuffer stagingBuffer = VK_NULL_HANDLE;
-    VmaAllocation stagingBufferAllocation = VK_NULL_HANDLE;
-    VkCommandBuffer transferTransientCommandBuffer = VK_NULL_HANDLE;
-    VkBufferCopy copyRegion{};
-    copyRegion.srcOffset = 0;
-    copyRegion.dstOffset = 0;
-
-    if (initialData != nullptr) {
-        VkBufferCreateInfo stagingBufferCreateInfo{};
-        stagingBufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-        stagingBufferCreateInfo.size = size;
-        stagingBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-        stagingBufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    StagingBuffer staging{};
+    if (initialData != nullptr)
+        staging = CreateStagingBuffer(initialData, size);
 
-        VmaAllocationCreateInfo stagingAllocCreateInfo{};
-        stagingAllocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
-        stagingAllocCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
-
-        vmaCreateBuffer(context->GetAllocator(), &stagingBufferCreateInfo, &stagingAllocCreateInfo, &stagingBuffer, &stagingBufferAllocation, nullptr);
-        vmaCopyMemoryToAllocation(context->GetAllocator(), initialData, stagingBufferAllocation, 0, size);
-
-        transferTransientCommandBuffer = BeginTransientCommandBuffer();
-    }
+    //Buffers are shared with the transfer queue so buffer-only transfer passes can run there without ownership transfers
+    const QueueInfo& queueInfo = context->GetQueueInfo();
+    uint32_t queueFamilyIndices[] = { queueInfo.familyIndices[QUEUE_INDEX_GRAPHICS], queueInfo.familyIndices[QUEUE_INDEX_TRANSFER] };
 
     for (uint32_t i = 0; i < buffer->GetSliceCount(); ++i) {
         std::shared_ptr<Buffer> slice = buffer->GetResourceSlice(i);
+        slice->sharingMode = context->HasDedicatedTransferQueue() ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+
+        //Committing again replaces the buffer, frames in flight keep reading the old one
+        if (slice->vkBuffer != VK_NULL_HANDLE) {
+            RetireBuffer(*slice);
+            slice->importedMemory = VK_NULL_HANDLE;
+            slice->hostImportOffset = 0;
+            slice->hostMemoryOwner = nullptr;
+        }
 
         VkBufferCreateInfo bufferCreateInfo{};
         bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
         bufferCreateInfo.size = slice->size;
         bufferCreateInfo.usage = slice->usage;
-        bufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        bufferCreateInfo.sharingMode = slice->sharingMode;
+        if (slice->sharingMode == VK_SHARING_MODE_CONCURRENT) {
+            bufferCreateInfo.queueFamilyIndexCount = 2;
+            bufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices;
+        }
 
         VmaAllocationCreateInfo allocCreateInfo{};
         allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+        if (slice->hostVisible) {
+            allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+            allocCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+            hasHostVisibleBuffers = true;
+        }
 
-        vmaCreateBuffer(context->GetAllocator(), &bufferCreateInfo, &allocCreateInfo, &slice->vkBuffer, &slice->allocation, nullptr);
+        //Vertex and index buffers are often rebuilt, only those the caller marks as static go to the linear geometry pools
+        VmaAllocationInfo allocInfo{};
+        context->AllocateBuffer(slice->resourceClass, bufferCreateInfo, allocCreateInfo, &slice->vkBuffer, &slice->allocation, &allocInfo);
+        slice->mappedData = allocInfo.pMappedData;
         
+        //Recorded at the start of the next frame instead of waiting on the queue here
         if (initialData != nullptr) {
-            copyRegion.size = std::min((VkDeviceSize)slice->size, (VkDeviceSize)size);
-            vkCmdCopyBuffer(transferTransientCommandBuffer, stagingBuffer, slice->vkBuffer, 1, &copyRegion);
+            PendingBufferCopy& copy = pendingBufferCopies.emplace_back();
+            copy.srcBuffer = staging.vkBuffer;
+            copy.dstBuffer = slice->vkBuffer;
+            copy.region.size = std::min((VkDeviceSize)slice->size, (VkDeviceSize)size);
+        }
+    }
+}
+
+void Vurl::RenderGraph::UpdateBuffer(std::shared_ptr<Resource<Buffer>> buffer, const uint8_t* data, uint32_t size, VkDeviceSize offset) {
+    if (buffer->IsTransient() || data == nullptr || size == 0)
+        return;
+
+    StagingBuffer staging = CreateStagingBuffer(data, size);
+
+    for (uint32_t i = 0; i < buffer->GetSliceCount(); ++i) {
+        std::shared_ptr<Buffer> slice = buffer->GetResourceSlice(i);
+        if (slice->vkBuffer == VK_NULL_HANDLE || offset >= slice->size)
+            continue;
+
+        //A buffer moved this frame is written by the move first
+        bool barrierBefore = HasPendingBufferCopy(slice->vkBuffer);
+        PendingBufferCopy& copy = pendingBufferCopies.emplace_back();
+        copy.srcBuffer = staging.vkBuffer;
+        copy.dstBuffer = slice->vkBuffer;
+        copy.region.dstOffset = slice->hostImportOffset + offset;
+        copy.region.size = std::min((VkDeviceSize)size, slice->size - offset);
+        copy.barrierBefore = barrierBefore;
+    }
+}
+
+void Vurl::RenderGraph::MoveBufferRange(std::shared_ptr<Resource<Buffer>> buffer, VkDeviceSize srcOffset, VkDeviceSize dstOffset, VkDeviceSize size) {
+    if (buffer->IsTransient() || srcOffset == dstOffset || size == 0)
+        return;
+
+    //Overlapping ranges go through a scratch buffer, two copies and a barrier instead of one copy per move distance
+    bool overlap = srcOffset < dstOffset + size && dstOffset < srcOffset + size;
+    StagingBuffer scratch{};
+    if (overlap) {
+        VkBufferCreateInfo scratchBufferCreateInfo{};
+        scratchBufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        scratchBufferCreateInfo.size = size;
+        scratchBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        scratchBufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VmaAllocationCreateInfo scratchAllocCreateInfo{};
+        scratchAllocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+        if (context->AllocateBuffer(RESOURCE_CLASS_PER_FRAME, scratchBufferCreateInfo, scratchAllocCreateInfo, 
+                &scratch.vkBuffer, &scratch.allocation) != VK_SUCCESS)
+            return;
+        //Only used by the copies recorded into the next frame
+        deletionQueue->DestroyBuffer(scratch.vkBuffer, scratch.allocation);
+    }
+
+    for (uint32_t i = 0; i < buffer->GetSliceCount(); ++i) {
+        std::shared_ptr<Buffer> slice = buffer->GetResourceSlice(i);
+        if (slice->vkBuffer == VK_NULL_HANDLE)
+            continue;
+
+        //Every slice reuses the scratch buffer, each copy waits for the one before
+        PendingBufferCopy& copy = pendingBufferCopies.emplace_back();
+        copy.srcBuffer = slice->vkBuffer;
+        copy.dstBuffer = overlap ? scratch.vkBuffer : slice->vkBuffer;
+        copy.region.srcOffset = slice->hostImportOffset + srcOffset;
+        copy.region.dstOffset = overlap ? 0 : slice->hostImportOffset + dstOffset;
+        copy.region.size = size;
+        copy.barrierBefore = true;
+
+        if (overlap) {
+            PendingBufferCopy& scratchCopy = pendingBufferCopies.emplace_back();
+            scratchCopy.srcBuffer = scratch.vkBuffer;
+            scratchCopy.dstBuffer = slice->vkBuffer;
+            scratchCopy.region.dstOffset = slice->hostImportOffset + dstOffset;
+            scratchCopy.region.size = size;
+            scratchCopy.barrierBefore = true;
+        }
+    }
+}
+
+void Vurl::RenderGraph::CopyBuffer(std::shared_ptr<Resource<Buffer>> dst, VkDeviceSize dstOffset, std::shared_ptr<Resource<Buffer>> src, 
+        VkDeviceSize srcOffset, VkDeviceSize size) {
+    if (dst->IsTransient() || src->IsTransient() || size == 0)
+        return;
+
+    for (uint32_t i = 0; i < dst->GetSliceCount(); ++i) {
+        std::shared_ptr<Buffer> dstSlice = dst->GetResourceSlice(i);
+        std::shared_ptr<Buffer> srcSlice = src->GetResourceSlice(std::min(i, src->GetSliceCount() - 1));
+        if (dstSlice->vkBuffer == VK_NULL_HANDLE || srcSlice->vkBuffer == VK_NULL_HANDLE || dstOffset >= dstSlice->size)
+            continue;
+
+        bool barrierBefore = dstSlice == srcSlice || HasPendingBufferCopy(dstSlice->vkBuffer) || HasPendingBufferCopy(srcSlice->vkBuffer);
+        PendingBufferCopy& copy = pendingBufferCopies.emplace_back();
+        copy.srcBuffer = srcSlice->vkBuffer;
+        copy.dstBuffer = dstSlice->vkBuffer;
+        copy.region.srcOffset = srcSlice->hostImportOffset + srcOffset;
+        copy.region.dstOffset = dstSlice->hostImportOffset + dstOffset;
+        copy.region.size = std::min(size, dstSlice->size - dstOffset);
+        copy.barrierBefore = barrierBefore;
+    }
+}
+
+bool Vurl::RenderGraph::ImportHostBuffer(std::shared_ptr<Resource<Buffer>> buffer, const void* hostPointer, VkDeviceSize size, std::shared_ptr<void> owner) {
+    VkDeviceSize alignment = context->GetMinImportedHostPointerAlignment();
+    if (buffer->IsTransient() || hostPointer == nullptr || size == 0 || alignment == 0)
+        return false;
+
+    //The import covers the aligned range around the data, a page-aligned mapping of a whole file needs no adjustment
+    uintptr_t address = (uintptr_t)hostPointer;
+    uintptr_t alignedAddress = address & ~(uintptr_t)(alignment - 1);
+    VkDeviceSize offset = (VkDeviceSize)(address - alignedAddress);
+    VkDeviceSize alignedSize = (offset + size + alignment - 1) & ~(alignment - 1);
+    void* importPointer = (void*)alignedAddress;
+
+    VkMemoryHostPointerPropertiesEXT hostPointerProperties{};
+    hostPointerProperties.sType = VK_STRUCTURE_TYPE_MEMORY_HOST_POINTER_PROPERTIES_EXT;
+    if (vkGetMemoryHostPointerPropertiesEXT(context->GetDevice(), VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT, 
+            importPointer, &hostPointerProperties) != VK_SUCCESS)
+        return false;
+
+    //Bound and copied from the imported data, descriptors, index and indirect reads need it aligned for them
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(context->GetPhysicalDevice(), &properties);
+
+    const QueueInfo& queueInfo = context->GetQueueInfo();
+    uint32_t queueFamilyIndices[] = { queueInfo.familyIndices[QUEUE_INDEX_GRAPHICS], queueInfo.familyIndices[QUEUE_INDEX_TRANSFER] };
+    VkSharingMode sharingMode = context->HasDedicatedTransferQueue() ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+
+    //Every slice is imported before any is replaced, a failure leaves the buffer as it was
+    std::vector<std::pair<VkBuffer, VkDeviceMemory>> imports{};
+    auto DestroyImports = [this, &imports]() {
+        for (const auto& [vkBuffer, memory] : imports) {
+            vkDestroyBuffer(context->GetDevice(), vkBuffer, nullptr);
+            vkFreeMemory(context->GetDevice(), memory, nullptr);
+        }
+        return false;
+    };
+
+    for (uint32_t i = 0; i < buffer->GetSliceCount(); ++i) {
+        std::shared_ptr<Buffer> slice = buffer->GetResourceSlice(i);
+        VkBufferUsageFlags usage = slice->usage | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+        VkDeviceSize offsetAlignment = 1;
+        if (usage & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)
+            offsetAlignment = std::max(offsetAlignment, properties.limits.minStorageBufferOffsetAlignment);
+        if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+            offsetAlignment = std::max(offsetAlignment, properties.limits.minUniformBufferOffsetAlignment);
+        if (usage & (VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT))
+            offsetAlignment = std::max(offsetAlignment, (VkDeviceSize)4);
+        if (offset % offsetAlignment != 0)
+            return DestroyImports();
+
+        VkExternalMemoryBufferCreateInfo externalMemoryCreateInfo{};
+        externalMemoryCreateInfo.sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_BUFFER_CREATE_INFO;
+        externalMemoryCreateInfo.handleTypes = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+
+        VkBufferCreateInfo bufferCreateInfo{};
+        bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferCreateInfo.pNext = &externalMemoryCreateInfo;
+        bufferCreateInfo.size = alignedSize;
+        bufferCreateInfo.usage = usage;
+        bufferCreateInfo.sharingMode = sharingMode;
+        if (sharingMode == VK_SHARING_MODE_CONCURRENT) {
+            bufferCreateInfo.queueFamilyIndexCount = 2;
+            bufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices;
+        }
+
+        VkBuffer vkBuffer = VK_NULL_HANDLE;
+        if (vkCreateBuffer(context->GetDevice(), &bufferCreateInfo, nullptr, &vkBuffer) != VK_SUCCESS)
+            return DestroyImports();
+
+        VkMemoryRequirements memoryRequirements{};
+        vkGetBufferMemoryRequirements(context->GetDevice(), vkBuffer, &memoryRequirements);
+        uint32_t memoryTypeBits = memoryRequirements.memoryTypeBits & hostPointerProperties.memoryTypeBits;
+        if (memoryTypeBits == 0) {
+            vkDestroyBuffer(context->GetDevice(), vkBuffer, nullptr);
+            return DestroyImports();
+        }
+
+        VkImportMemoryHostPointerInfoEXT importInfo{};
+        importInfo.sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_HOST_POINTER_INFO_EXT;
+        importInfo.handleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_HOST_ALLOCATION_BIT_EXT;
+        importInfo.pHostPointer = importPointer;
+
+        VkMemoryAllocateInfo allocateInfo{};
+        allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocateInfo.pNext = &importInfo;
+        allocateInfo.allocationSize = alignedSize;
+        allocateInfo.memoryTypeIndex = (uint32_t)std::countr_zero(memoryTypeBits);
+
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        if (vkAllocateMemory(context->GetDevice(), &allocateInfo, nullptr, &memory) != VK_SUCCESS) {
+            vkDestroyBuffer(context->GetDevice(), vkBuffer, nullptr);
+            return DestroyImports();
         }
+        imports.push_back({ vkBuffer, memory });
+        if (vkBindBufferMemory(context->GetDevice(), vkBuffer, memory, 0) != VK_SUCCESS)
+            return DestroyImports();
     }
 
-    if (initialData != nullptr) {
-        SubmitAndEndTransientCommandBuffer(transferTransientCommandBuffer);
-        vmaDestroyBuffer(context->GetAllocator(), stagingBuffer, stagingBufferAllocation);
+    for (uint32_t i = 0; i < buffer->GetSliceCount(); ++i) {
+        std::shared_ptr<Buffer> slice = buffer->GetResourceSlice(i);
+        if (slice->vkBuffer != VK_NULL_HANDLE)
+            RetireBuffer(*slice);
+        slice->sharingMode = sharingMode;
+        slice->usage |= VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+        slice->vkBuffer = imports[i].first;
+        slice->allocation = VK_NULL_HANDLE;
+        slice->mappedData = nullptr;
+        slice->importedMemory = imports[i].second;
+        //The data the caller imported, the buffer itself spans the aligned range around it
+        slice->size = size;
+        slice->hostImportOffset = offset;
+        slice->hostMemoryOwner = owner;
     }
+
+    return true;
+}
+
+bool Vurl::RenderGraph::HasPendingBufferCopy(VkBuffer buffer) {
+    for (const PendingBufferCopy& copy : pendingBufferCopies)
+        if (copy.dstBuffer == buffer)
+            return true;
+    return false;
+}
+
+Vurl::RenderGraph::StagingBuffer Vurl::RenderGraph::CreateStagingBuffer(const uint8_t* data, VkDeviceSize size) {
+    StagingBuffer staging{};
+
+    VkBufferCreateInfo stagingBufferCreateInfo{};
+    stagingBufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    stagingBufferCreateInfo.size = size;
+    stagingBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    stagingBufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo stagingAllocCreateInfo{};
+    stagingAllocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+    stagingAllocCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+
+    context->AllocateBuffer(RESOURCE_CLASS_STAGING, stagingBufferCreateInfo, stagingAllocCreateInfo, &staging.vkBuffer, &staging.allocation);
+    vmaCopyMemoryToAllocation(context->GetAllocator(), data, staging.allocation, 0, size);
+    //Only read by the copies recorded into the next frame
+    deletionQueue->DestroyBuffer(staging.vkBuffer, staging.allocation);
+
+    return staging;
 }
 
 Vurl::TextureHandle Vurl::RenderGraph::GetTextureHandle(std::shared_ptr<Resource<Texture>> texture) {
@@ -101,6 +358,10 @@ void Vurl::RenderGraph::CommitTexture(std::shared_ptr<Resource<Texture>> texture
     if (texture->IsTransient())
         return;
 
+    //Every staged slice copies from the same staging buffer, created for the first one
+    bool hasInitialData = initialData != nullptr && size > 0;
+    StagingBuffer staging{};
+
     for (uint32_t i = 0; i < texture->GetSliceCount(); ++i) {
         std::shared_ptr<Texture> slice = texture->GetResourceSlice(i);
         
@@ -112,45 +373,615 @@ void Vurl::RenderGraph::CommitTexture(std::shared_ptr<Resource<Texture>> texture
             slice->depth = 1;
         }
 
+        slice->mipLevels = std::max(slice->mipLevels, 1u);
+        slice->arrayLayers = std::max(slice->arrayLayers, 1u);
+        bool hostCopy = hasInitialData && CanHostCopyTexture(slice, size);
+        if (hostCopy)
+            slice->usage |= VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+        else if (hasInitialData)
+            slice->usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        if (slice->mipLevels > 1)
+            slice->usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
         extent.width = slice->width;
         extent.height = slice->height;
         extent.depth = slice->depth;
 
-        VkImageCreateInfo imageCreateInfo{};
-        imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
-        imageCreateInfo.imageType = slice->vkImageType;
-        imageCreateInfo.format = slice->vkFormat;
-        imageCreateInfo.extent = extent;
-        imageCreateInfo.mipLevels = 1;
-        imageCreateInfo.arrayLayers = 1;
-        imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
-        imageCreateInfo.tiling = slice->vkImageTiling;
-        imageCreateInfo.usage = slice->usage;
-        imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-        imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        //Committing again replaces the image, whatever was queued for the old one is dropped
+        if (slice->vkImage != VK_NULL_HANDLE) {
+            std::erase_if(pendingTextureUploads, [&slice](const PendingTextureUpload& upload) { return upload.slice == slice; });
+            std::erase_if(pendingTextureCopies, [&slice](const PendingTextureCopy& copy) { return copy.dstSlice == slice; });
+            RetireTexture(*slice);
+        }
+
+        CreateTextureImage(slice);
 
-        VmaAllocationCreateInfo allocCreateInfo{};
-        allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+        if (!hasInitialData)
+            continue;
+
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = slice->aspectMask;
+        region.imageSubresource.layerCount = slice->arrayLayers;
+        region.imageExtent = extent;
+
+        //Host copied images are already in their upload layout, only the mip chain is left for the GPU
+        if (hostCopy) {
+            CopyMemoryToTexture(slice, initialData, size, &region, 1);
+            if (slice->mipLevels > 1)
+                GetPendingTextureUpload(slice).generateMips = true;
+            continue;
+        }
+
+        if (staging.vkBuffer == VK_NULL_HANDLE)
+            staging = CreateStagingBuffer(initialData, size);
+        stagedTextureBytes += size;
+        ++stagedTextureCount;
+
+        //The new image has no contents to keep, the upload starts from an undefined layout
+        PendingTextureUpload& upload = GetPendingTextureUpload(slice);
+        upload.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        upload.generateMips = slice->mipLevels > 1;
+        upload.copies.push_back({ staging.vkBuffer, region });
+    }
+}
+
+Vurl::VurlResult Vurl::RenderGraph::CommitTexture(std::shared_ptr<Resource<Texture>> texture, const Ktx2File& file, uint32_t baseLevel) {
+    if (!file.IsOpen())
+        return VURL_ERROR_KTX2_OPEN_FAILED;
+    if (texture->IsTransient())
+        return VURL_ERROR_TRANSIENT_RESOURCE;
+
+    VkFormat format = file.GetFormat();
+    uint32_t layerCount = file.GetLayerCount() * file.GetFaceCount();
+    uint32_t fileLevelCount = std::max(file.GetLevelCount(), 1u);
+    //Files without a level count only store the base level
+    baseLevel = file.GetLevelCount() == 0 ? 0 : std::min(baseLevel, fileLevelCount - 1);
+    uint32_t levelCount = fileLevelCount - baseLevel;
+
+    VkFormatProperties formatProperties{};
+    vkGetPhysicalDeviceFormatProperties(context->GetPhysicalDevice(), format, &formatProperties);
+    bool decompress = (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0;
+    if (decompress && !CanDecompressFormat(format))
+        return VURL_ERROR_UNSUPPORTED_TEXTURE_FORMAT;
+
+    //Level data comes straight from the mapping, or from the decompressed levels back to back
+    const uint8_t* data = nullptr;
+    VkDeviceSize dataSize = 0;
+    std::vector<VkDeviceSize> levelOffsets(levelCount);
+    std::vector<uint8_t> texels{};
+    if (!decompress) {
+        //The copies read every layer of a level, a short level would read past it
+        for (uint32_t level = baseLevel; level < fileLevelCount; ++level) {
+            uint64_t imageSize = GetImageSize(format, std::max(file.GetWidth() >> level, 1u), std::max(file.GetHeight() >> level, 1u), 
+                    std::max(file.GetDepth() >> level, 1u));
+            if (imageSize == 0)
+                return VURL_ERROR_UNSUPPORTED_TEXTURE_FORMAT;
+            if (file.GetLevelSize(level) < imageSize * layerCount)
+                return VURL_ERROR_INVALID_KTX2;
+        }
+
+        //Smaller levels usually come first in the file, take the whole range they span
+        const uint8_t* begin = file.GetLevelData(baseLevel);
+        const uint8_t* end = begin + file.GetLevelSize(baseLevel);
+        for (uint32_t level = baseLevel + 1; level < fileLevelCount; ++level) {
+            begin = std::min(begin, file.GetLevelData(level));
+            end = std::max(end, file.GetLevelData(level) + file.GetLevelSize(level));
+        }
+        for (uint32_t level = baseLevel; level < fileLevelCount; ++level)
+            levelOffsets[level - baseLevel] = (VkDeviceSize)(file.GetLevelData(level) - begin);
+        data = begin;
+        dataSize = (VkDeviceSize)(end - begin);
+    } else {
+        for (uint32_t level = baseLevel; level < fileLevelCount; ++level) {
+            levelOffsets[level - baseLevel] = texels.size();
+            if (!DecompressKtx2Level(file, level, texels))
+                return VURL_ERROR_INVALID_KTX2;
+        }
+        data = texels.data();
+        dataSize = texels.size();
+    }
+
+    bool hostCopy = false;
+    for (uint32_t i = 0; i < texture->GetSliceCount(); ++i) {
+        std::shared_ptr<Texture> slice = texture->GetResourceSlice(i);
+        slice->vkFormat = decompress ? GetDecompressedFormat(format) : format;
+        slice->width = std::max(file.GetWidth() >> baseLevel, 1u);
+        slice->height = std::max(file.GetHeight() >> baseLevel, 1u);
+        slice->depth = std::max(file.GetDepth() >> baseLevel, 1u);
+        slice->sizeClass = TextureSizeClass::Absolute;
+        slice->mipLevels = file.GetLevelCount() == 0 ? GetMipLevelCount(slice->width, slice->height, slice->depth) : levelCount;
+        slice->arrayLayers = layerCount;
+        slice->vkImageType = file.GetDepth() > 1 ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D;
+        if (file.GetFaceCount() == 6)
+            slice->vkImageViewType = file.GetLayerCount() > 1 ? VK_IMAGE_VIEW_TYPE_CUBE_ARRAY : VK_IMAGE_VIEW_TYPE_CUBE;
+        else if (file.GetDepth() > 1)
+            slice->vkImageViewType = VK_IMAGE_VIEW_TYPE_3D;
+        else
+            slice->vkImageViewType = layerCount > 1 ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+        slice->vkImageTiling = VK_IMAGE_TILING_OPTIMAL;
+        slice->aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        slice->usage |= VK_IMAGE_USAGE_SAMPLED_BIT;
+        //Textures committed without their top levels get them later through AddTextureMips
+        if (baseLevel > 0)
+            slice->usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+        //Every slice is described the same way
+        if (i == 0)
+            hostCopy = CanHostCopyTexture(slice, dataSize);
+        slice->usage |= hostCopy ? VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT : VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    }
+
+    CommitTexture(texture);
+
+    std::vector<VkBufferImageCopy> regions(levelCount);
+    std::shared_ptr<Texture> firstSlice = texture->GetResourceSlice(0);
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        regions[level].bufferOffset = levelOffsets[level];
+        regions[level].imageSubresource.aspectMask = firstSlice->aspectMask;
+        regions[level].imageSubresource.mipLevel = level;
+        regions[level].imageSubresource.layerCount = firstSlice->arrayLayers;
+        regions[level].imageExtent = { std::max(firstSlice->width >> level, 1u), std::max(firstSlice->height >> level, 1u), 
+                std::max(firstSlice->depth >> level, 1u) };
+    }
+
+    StagingBuffer staging{};
+    for (uint32_t i = 0; i < texture->GetSliceCount(); ++i) {
+        std::shared_ptr<Texture> slice = texture->GetResourceSlice(i);
+        bool generateMips = file.GetLevelCount() == 0 && slice->mipLevels > 1;
+
+        if (hostCopy) {
+            CopyMemoryToTexture(slice, data, dataSize, regions.data(), (uint32_t)regions.size());
+            if (generateMips)
+                GetPendingTextureUpload(slice).generateMips = true;
+            continue;
+        }
+
+        if (staging.vkBuffer == VK_NULL_HANDLE)
+            staging = CreateStagingBuffer(data, dataSize);
+        stagedTextureBytes += dataSize;
+        ++stagedTextureCount;
+
+        PendingTextureUpload& upload = GetPendingTextureUpload(slice);
+        upload.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        upload.generateMips = generateMips;
+        for (const VkBufferImageCopy& region : regions)
+            upload.copies.push_back({ staging.vkBuffer, region });
+    }
+
+    return VURL_SUCCESS;
+}
+
+void Vurl::RenderGraph::UpdateTexture(std::shared_ptr<Resource<Texture>> texture, const uint8_t* data, uint32_t size, 
+        uint32_t mipLevel, uint32_t baseArrayLayer, uint32_t layerCount) {
+    if (texture->IsTransient() || data == nullptr || size == 0)
+        return;
+
+    //Always staged, frames in flight may still read the image and a host copy would race them
+    StagingBuffer staging = CreateStagingBuffer(data, size);
+
+    for (uint32_t i = 0; i < texture->GetSliceCount(); ++i) {
+        std::shared_ptr<Texture> slice = texture->GetResourceSlice(i);
+        if (slice->vkImage == VK_NULL_HANDLE || mipLevel >= slice->mipLevels || baseArrayLayer + layerCount > slice->arrayLayers)
+            continue;
+        stagedTextureBytes += size;
+        ++stagedTextureCount;
+
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = slice->aspectMask;
+        region.imageSubresource.mipLevel = mipLevel;
+        region.imageSubresource.baseArrayLayer = baseArrayLayer;
+        region.imageSubresource.layerCount = layerCount;
+        region.imageExtent = { std::max(slice->width >> mipLevel, 1u), std::max(slice->height >> mipLevel, 1u), std::max(slice->depth >> mipLevel, 1u) };
+        GetPendingTextureUpload(slice).copies.push_back({ staging.vkBuffer, region });
+    }
+}
+
+void Vurl::RenderGraph::GenerateMips(std::shared_ptr<Resource<Texture>> texture) {
+    if (texture->IsTransient())
+        return;
+
+    for (uint32_t i = 0; i < texture->GetSliceCount(); ++i) {
+        std::shared_ptr<Texture> slice = texture->GetResourceSlice(i);
+        if (slice->vkImage != VK_NULL_HANDLE && slice->mipLevels > 1)
+            GetPendingTextureUpload(slice).generateMips = true;
+    }
+}
+
+void Vurl::RenderGraph::EvictTexture(std::shared_ptr<Resource<Texture>> texture) {
+    if (texture->IsTransient())
+        return;
+
+    for (uint32_t i = 0; i < texture->GetSliceCount(); ++i) {
+        std::shared_ptr<Texture> slice = texture->GetResourceSlice(i);
+        if (slice->vkImage == VK_NULL_HANDLE)
+            continue;
 
-        vmaCreateImage(context->GetAllocator(), &imageCreateInfo, &allocCreateInfo, &slice->vkImage, &slice->allocation, nullptr);
+        std::erase_if(pendingTextureUploads, [&slice](const PendingTextureUpload& upload) { return upload.slice == slice; });
+        std::erase_if(pendingTextureCopies, [&slice](const PendingTextureCopy& copy) { return copy.dstSlice == slice; });
 
-        VkImageViewCreateInfo imageViewCreateInfo{};
-        imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
-        imageViewCreateInfo.image = slice->vkImage;
-        imageViewCreateInfo.viewType = slice->vkImageViewType;
-        imageViewCreateInfo.format = slice->vkFormat;
-        imageViewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
-        imageViewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
-        imageViewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-        imageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
-        imageViewCreateInfo.subresourceRange.aspectMask = slice->aspectMask;
-        imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
-        imageViewCreateInfo.subresourceRange.levelCount = 1;
-        imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
-        imageViewCreateInfo.subresourceRange.layerCount = 1;
+        //Frames in flight may still sample the image
+        RetireTexture(*slice);
+        slice->vkImage = VK_NULL_HANDLE;
+        slice->allocation = VK_NULL_HANDLE;
+        slice->vkImageView = VK_NULL_HANDLE;
+    }
+}
+
+void Vurl::RenderGraph::EvictBuffer(std::shared_ptr<Resource<Buffer>> buffer) {
+    if (buffer->IsTransient())
+        return;
+
+    for (uint32_t i = 0; i < buffer->GetSliceCount(); ++i) {
+        std::shared_ptr<Buffer> slice = buffer->GetResourceSlice(i);
+        if (slice->vkBuffer == VK_NULL_HANDLE)
+            continue;
+
+        VkBuffer vkBuffer = slice->vkBuffer;
+        std::erase_if(pendingBufferCopies, [vkBuffer](const PendingBufferCopy& copy) { return copy.srcBuffer == vkBuffer || copy.dstBuffer == vkBuffer; });
+
+        RetireBuffer(*slice);
+        slice->vkBuffer = VK_NULL_HANDLE;
+        slice->allocation = VK_NULL_HANDLE;
+        slice->importedMemory = VK_NULL_HANDLE;
+        slice->mappedData = nullptr;
+        slice->hostImportOffset = 0;
+        slice->hostMemoryOwner = nullptr;
+    }
+}
+
+bool Vurl::RenderGraph::DropTextureMips(std::shared_ptr<Resource<Texture>> texture, uint32_t levelCount) {
+    if (texture->IsTransient() || levelCount == 0)
+        return false;
+
+    std::shared_ptr<Texture> firstSlice = texture->GetResourceSlice(0);
+    if (firstSlice->mipLevels <= levelCount)
+        return false;
+
+    VkExtent3D extent = { std::max(firstSlice->width >> levelCount, 1u), std::max(firstSlice->height >> levelCount, 1u), 
+            std::max(firstSlice->depth >> levelCount, 1u) };
+    return ReplaceTextureImage(texture, extent, (int32_t)levelCount);
+}
+
+bool Vurl::RenderGraph::AddTextureMips(std::shared_ptr<Resource<Texture>> texture, uint32_t levelCount, VkExtent3D extent) {
+    if (texture->IsTransient() || levelCount == 0)
+        return false;
+
+    //The current base level has to be exactly levelCount levels below the new one and a copy source
+    std::shared_ptr<Texture> firstSlice = texture->GetResourceSlice(0);
+    if ((firstSlice->usage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) == 0)
+        return false;
+    if (std::max(extent.width >> levelCount, 1u) != firstSlice->width || std::max(extent.height >> levelCount, 1u) != firstSlice->height || 
+            std::max(extent.depth >> levelCount, 1u) != firstSlice->depth)
+        return false;
+
+    return ReplaceTextureImage(texture, extent, -(int32_t)levelCount);
+}
+
+bool Vurl::RenderGraph::ReplaceTextureImage(std::shared_ptr<Resource<Texture>> texture, VkExtent3D extent, int32_t droppedLevelCount) {
+    //Uploads and copies still queued for the old image would land in the wrong levels of the new one
+    for (uint32_t i = 0; i < texture->GetSliceCount(); ++i) {
+        std::shared_ptr<Texture> slice = texture->GetResourceSlice(i);
+        if (slice->vkImage == VK_NULL_HANDLE)
+            return false;
+        for (const PendingTextureUpload& upload : pendingTextureUploads)
+            if (upload.slice == slice)
+                return false;
+        for (const PendingTextureCopy& copy : pendingTextureCopies)
+            if (copy.dstSlice == slice)
+                return false;
+    }
+
+    //Every new image is created before any copy is queued or old image retired, a failure restores the slices
+    std::vector<std::shared_ptr<Texture>> srcSlices;
+    srcSlices.reserve(texture->GetSliceCount());
+    for (uint32_t i = 0; i < texture->GetSliceCount(); ++i) {
+        std::shared_ptr<Texture> slice = texture->GetResourceSlice(i);
+        srcSlices.push_back(std::make_shared<Texture>(*slice));
+
+        slice->width = extent.width;
+        slice->height = extent.height;
+        slice->depth = extent.depth;
+        slice->mipLevels = (uint32_t)((int32_t)slice->mipLevels - droppedLevelCount);
+        if (!CreateTextureImage(slice)) {
+            //Images that were never recorded can be destroyed right away
+            for (uint32_t j = 0; j < i; ++j) {
+                std::shared_ptr<Texture> createdSlice = texture->GetResourceSlice(j);
+                vkDestroyImageView(context->GetDevice(), createdSlice->vkImageView, nullptr);
+                vmaDestroyImage(context->GetAllocator(), createdSlice->vkImage, createdSlice->allocation);
+            }
+            for (uint32_t j = 0; j <= i; ++j)
+                *texture->GetResourceSlice(j) = *srcSlices[j];
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < texture->GetSliceCount(); ++i) {
+        std::shared_ptr<Texture> slice = texture->GetResourceSlice(i);
+        PendingTextureCopy& copy = pendingTextureCopies.emplace_back();
+        copy.srcSlice = srcSlices[i];
+        copy.dstSlice = slice;
+
+        //Levels only the new image has are left undefined
+        for (uint32_t level = 0; level < slice->mipLevels; ++level) {
+            int32_t srcLevel = (int32_t)level + droppedLevelCount;
+            if (srcLevel < 0 || srcLevel >= (int32_t)copy.srcSlice->mipLevels)
+                continue;
+
+            VkImageCopy& region = copy.regions.emplace_back();
+            region.srcSubresource.aspectMask = slice->aspectMask;
+            region.srcSubresource.mipLevel = (uint32_t)srcLevel;
+            region.srcSubresource.layerCount = slice->arrayLayers;
+            region.dstSubresource.aspectMask = slice->aspectMask;
+            region.dstSubresource.mipLevel = level;
+            region.dstSubresource.layerCount = slice->arrayLayers;
+            region.extent = { std::max(slice->width >> level, 1u), std::max(slice->height >> level, 1u), std::max(slice->depth >> level, 1u) };
+        }
+
+        RetireTexture(*copy.srcSlice);
+    }
+
+    return true;
+}
+
+bool Vurl::RenderGraph::MoveBuffer(std::shared_ptr<Buffer> slice, VmaAllocation allocation) {
+    VkBufferUsageFlags copyUsage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    if (slice->vkBuffer == VK_NULL_HANDLE || slice->hostVisible || slice->importedMemory != VK_NULL_HANDLE || (slice->usage & copyUsage) != copyUsage)
+        return false;
+
+    const QueueInfo& queueInfo = context->GetQueueInfo();
+    uint32_t queueFamilyIndices[] = { queueInfo.familyIndices[QUEUE_INDEX_GRAPHICS], queueInfo.familyIndices[QUEUE_INDEX_TRANSFER] };
+
+    VkBufferCreateInfo bufferCreateInfo{};
+    bufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferCreateInfo.size = slice->size;
+    bufferCreateInfo.usage = slice->usage;
+    bufferCreateInfo.sharingMode = slice->sharingMode;
+    if (slice->sharingMode == VK_SHARING_MODE_CONCURRENT) {
+        bufferCreateInfo.queueFamilyIndexCount = 2;
+        bufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices;
+    }
+
+    VkBuffer vkBuffer = VK_NULL_HANDLE;
+    if (vkCreateBuffer(context->GetDevice(), &bufferCreateInfo, nullptr, &vkBuffer) != VK_SUCCESS)
+        return false;
+    if (vmaBindBufferMemory(context->GetAllocator(), allocation, vkBuffer) != VK_SUCCESS) {
+        vkDestroyBuffer(context->GetDevice(), vkBuffer, nullptr);
+        return false;
+    }
+
+    //Updates queued before the move land in the old buffer and are carried over by the copy
+    PendingBufferCopy& copy = pendingBufferCopies.emplace_back();
+    copy.srcBuffer = slice->vkBuffer;
+    copy.dstBuffer = vkBuffer;
+    copy.region.size = slice->size;
+    copy.barrierBefore = true;
+
+    //Only the handle is retired, the allocation moves with the slice
+    deletionQueue->DestroyBuffer(slice->vkBuffer);
+    slice->vkBuffer = vkBuffer;
+    return true;
+}
+
+bool Vurl::RenderGraph::MoveTexture(std::shared_ptr<Texture> slice, VmaAllocation allocation) {
+    VkImageUsageFlags copyUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (slice->vkImage == VK_NULL_HANDLE || (slice->usage & copyUsage) != copyUsage)
+        return false;
+    for (const PendingTextureUpload& upload : pendingTextureUploads)
+        if (upload.slice == slice)
+            return false;
+    for (const PendingTextureCopy& copy : pendingTextureCopies)
+        if (copy.dstSlice == slice)
+            return false;
+
+    //The defragmenter leaves the allocation where it is when the new image cannot be created
+    std::shared_ptr<Texture> srcSlice = std::make_shared<Texture>(*slice);
+    if (!CreateTextureImage(slice, allocation))
+        return false;
+
+    PendingTextureCopy& copy = pendingTextureCopies.emplace_back();
+    copy.srcSlice = srcSlice;
+    copy.dstSlice = slice;
+
+    for (uint32_t level = 0; level < slice->mipLevels; ++level) {
+        VkImageCopy& region = copy.regions.emplace_back();
+        region.srcSubresource.aspectMask = slice->aspectMask;
+        region.srcSubresource.mipLevel = level;
+        region.srcSubresource.layerCount = slice->arrayLayers;
+        region.dstSubresource = region.srcSubresource;
+        region.extent = { std::max(slice->width >> level, 1u), std::max(slice->height >> level, 1u), std::max(slice->depth >> level, 1u) };
+    }
+
+    deletionQueue->DestroyImageView(copy.srcSlice->vkImageView);
+    deletionQueue->DestroyImage(copy.srcSlice->vkImage);
+    return true;
+}
+
+bool Vurl::RenderGraph::CreateTextureImage(std::shared_ptr<Texture> slice, VmaAllocation allocation) {
+    VkImageCreateInfo imageCreateInfo{};
+    imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageCreateInfo.imageType = slice->vkImageType;
+    imageCreateInfo.format = slice->vkFormat;
+    imageCreateInfo.extent = { slice->width, slice->height, slice->depth };
+    imageCreateInfo.mipLevels = slice->mipLevels;
+    imageCreateInfo.arrayLayers = slice->arrayLayers;
+    imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageCreateInfo.tiling = slice->vkImageTiling;
+    imageCreateInfo.usage = slice->usage;
+    imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (slice->vkImageViewType == VK_IMAGE_VIEW_TYPE_CUBE || slice->vkImageViewType == VK_IMAGE_VIEW_TYPE_CUBE_ARRAY)
+        imageCreateInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+
+    VmaAllocationCreateInfo allocCreateInfo{};
+    allocCreateInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+    ResourceClass resourceClass = slice->resourceClass;
+    if (resourceClass == RESOURCE_CLASS_DEFAULT && (slice->usage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)) != 0)
+        resourceClass = RESOURCE_CLASS_RENDER_TARGET;
+
+    //Moved images are bound to memory the allocator already set aside, the slice keeps its allocation.
+    //The slice only takes the new handles once both exist, a failed move leaves it as it was. Otherwise the
+    //caller already retired the old image and a failure leaves the slice without one.
+    VkImage vkImage = VK_NULL_HANDLE;
+    if (allocation != VK_NULL_HANDLE) {
+        if (vkCreateImage(context->GetDevice(), &imageCreateInfo, nullptr, &vkImage) != VK_SUCCESS)
+            return false;
+        if (vmaBindImageMemory(context->GetAllocator(), allocation, vkImage) != VK_SUCCESS) {
+            vkDestroyImage(context->GetDevice(), vkImage, nullptr);
+            return false;
+        }
+    } else {
+        slice->vkImage = VK_NULL_HANDLE;
+        slice->vkImageView = VK_NULL_HANDLE;
+        if (context->AllocateImage(resourceClass, imageCreateInfo, allocCreateInfo, &vkImage, &slice->allocation) != VK_SUCCESS)
+            return false;
+    }
+
+    VkImageViewCreateInfo imageViewCreateInfo{};
+    imageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    imageViewCreateInfo.image = vkImage;
+    imageViewCreateInfo.viewType = slice->vkImageViewType;
+    imageViewCreateInfo.format = slice->vkFormat;
+    imageViewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+    imageViewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+    imageViewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+    imageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
+    imageViewCreateInfo.subresourceRange.aspectMask = slice->aspectMask;
+    imageViewCreateInfo.subresourceRange.baseMipLevel = 0;
+    imageViewCreateInfo.subresourceRange.levelCount = slice->mipLevels;
+    imageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
+    imageViewCreateInfo.subresourceRange.layerCount = slice->arrayLayers;
+
+    VkImageView vkImageView = VK_NULL_HANDLE;
+    if (vkCreateImageView(context->GetDevice(), &imageViewCreateInfo, nullptr, &vkImageView) != VK_SUCCESS) {
+        if (allocation != VK_NULL_HANDLE) {
+            vkDestroyImage(context->GetDevice(), vkImage, nullptr);
+        } else {
+            vmaDestroyImage(context->GetAllocator(), vkImage, slice->allocation);
+            slice->allocation = VK_NULL_HANDLE;
+        }
+        return false;
+    }
+
+    slice->vkImage = vkImage;
+    slice->vkImageView = vkImageView;
+    return true;
+}
+
+Vurl::RenderGraph::PendingTextureUpload& Vurl::RenderGraph::GetPendingTextureUpload(std::shared_ptr<Texture> slice) {
+    for (PendingTextureUpload& upload : pendingTextureUploads)
+        if (upload.slice == slice)
+            return upload;
+
+    PendingTextureUpload& upload = pendingTextureUploads.emplace_back();
+    upload.slice = slice;
+    upload.oldLayout = GetTextureUploadLayout(slice);
+    return upload;
+}
+
+VkImageLayout Vurl::RenderGraph::GetTextureUploadLayout(std::shared_ptr<Texture> slice) {
+    //The layout of the first access of a texture the graph only reads
+    return (slice->usage & VK_IMAGE_USAGE_SAMPLED_BIT) ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+}
+
+bool Vurl::RenderGraph::CanGenerateMips(std::shared_ptr<Texture> slice) {
+    VkFormatProperties formatProperties{};
+    vkGetPhysicalDeviceFormatProperties(context->GetPhysicalDevice(), slice->vkFormat, &formatProperties);
+    VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | 
+            VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    return (formatProperties.optimalTilingFeatures & requiredFeatures) == requiredFeatures;
+}
+
+bool Vurl::RenderGraph::CanHostCopyTexture(std::shared_ptr<Texture> slice, VkDeviceSize size) {
+    if (!context->IsDeviceExtensionEnabled(DEVICE_EXTENSION_HOST_IMAGE_COPY) || size > hostImageCopySizeLimit || 
+            slice->vkImageTiling != VK_IMAGE_TILING_OPTIMAL || !context->IsHostImageCopyDstLayout(GetTextureUploadLayout(slice)))
+        return false;
+
+    VkFormatProperties3 formatProperties3{};
+    formatProperties3.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3;
+    VkFormatProperties2 formatProperties{};
+    formatProperties.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2;
+    formatProperties.pNext = &formatProperties3;
+    vkGetPhysicalDeviceFormatProperties2(context->GetPhysicalDevice(), slice->vkFormat, &formatProperties);
+    if ((formatProperties3.optimalTilingFeatures & VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT) == 0)
+        return false;
+
+    //Host transfer usage can cost the image its compressed layout, staged copies keep it
+    VkHostImageCopyDevicePerformanceQueryEXT performanceQuery{};
+    performanceQuery.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_COPY_DEVICE_PERFORMANCE_QUERY_EXT;
+    VkImageFormatProperties2 imageFormatProperties{};
+    imageFormatProperties.sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2;
+    imageFormatProperties.pNext = &performanceQuery;
+
+    VkPhysicalDeviceImageFormatInfo2 imageFormatInfo{};
+    imageFormatInfo.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2;
+    imageFormatInfo.format = slice->vkFormat;
+    imageFormatInfo.type = slice->vkImageType;
+    imageFormatInfo.tiling = slice->vkImageTiling;
+    imageFormatInfo.usage = slice->usage | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT;
+    if (slice->vkImageViewType == VK_IMAGE_VIEW_TYPE_CUBE || slice->vkImageViewType == VK_IMAGE_VIEW_TYPE_CUBE_ARRAY)
+        imageFormatInfo.flags = VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT;
+
+    if (vkGetPhysicalDeviceImageFormatProperties2(context->GetPhysicalDevice(), &imageFormatInfo, &imageFormatProperties) != VK_SUCCESS)
+        return false;
+    return performanceQuery.optimalDeviceAccess == VK_TRUE;
+}
 
-        vkCreateImageView(context->GetDevice(), &imageViewCreateInfo, nullptr, &slice->vkImageView);
+void Vurl::RenderGraph::CopyMemoryToTexture(std::shared_ptr<Texture> slice, const uint8_t* data, VkDeviceSize size, const VkBufferImageCopy* regions, uint32_t regionCount) {
+    auto start = std::chrono::steady_clock::now();
+    VkImageLayout layout = GetTextureUploadLayout(slice);
+
+    VkHostImageLayoutTransitionInfoEXT transition{};
+    transition.sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT;
+    transition.image = slice->vkImage;
+    transition.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    transition.newLayout = layout;
+    transition.subresourceRange.aspectMask = slice->aspectMask;
+    transition.subresourceRange.levelCount = VK_REMAINING_MIP_LEVELS;
+    transition.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+    vkTransitionImageLayoutEXT(context->GetDevice(), 1, &transition);
+
+    std::vector<VkMemoryToImageCopyEXT> copies(regionCount);
+    for (uint32_t i = 0; i < regionCount; ++i) {
+        copies[i].sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT;
+        copies[i].pHostPointer = data + regions[i].bufferOffset;
+        copies[i].memoryRowLength = regions[i].bufferRowLength;
+        copies[i].memoryImageHeight = regions[i].bufferImageHeight;
+        copies[i].imageSubresource = regions[i].imageSubresource;
+        copies[i].imageOffset = regions[i].imageOffset;
+        copies[i].imageExtent = regions[i].imageExtent;
     }
+
+    VkCopyMemoryToImageInfoEXT copyInfo{};
+    copyInfo.sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT;
+    copyInfo.dstImage = slice->vkImage;
+    copyInfo.dstImageLayout = layout;
+    copyInfo.regionCount = regionCount;
+    copyInfo.pRegions = copies.data();
+    vkCopyMemoryToImageEXT(context->GetDevice(), &copyInfo);
+
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    hostCopyBytes += size;
+    ++hostCopyCount;
+    hostCopyNanoseconds += (uint64_t)duration.count();
+}
+
+Vurl::TextureUploadStatistics Vurl::RenderGraph::GetTextureUploadStatistics() const {
+    TextureUploadStatistics statistics{};
+    statistics.hostCopyBytes = hostCopyBytes;
+    statistics.hostCopyCount = hostCopyCount;
+    statistics.hostCopySeconds = (double)hostCopyNanoseconds / 1e9;
+    statistics.stagedBytes = stagedTextureBytes;
+    statistics.stagedCount = stagedTextureCount;
+    return statistics;
+}
+
+void Vurl::RenderGraph::ResetTextureUploadStatistics() {
+    hostCopyBytes = 0;
+    hostCopyCount = 0;
+    hostCopyNanoseconds = 0;
+    stagedTextureBytes = 0;
+    stagedTextureCount = 0;
 }
 
 std::shared_ptr<Vurl::GraphicsPass> Vurl::RenderGraph::CreateGraphicsPass(const std::string& name, std::shared_ptr<GraphicsPipeline> pipeline) {
@@ -159,6 +990,18 @@ std::shared_ptr<Vurl::GraphicsPass> Vurl::RenderGraph::CreateGraphicsPass(const
     return pass;
 }
 
+std::shared_ptr<Vurl::ComputePass> Vurl::RenderGraph::CreateComputePass(const std::string& name, std::shared_ptr<ComputePipeline> pipeline) {
+    std::shared_ptr<ComputePass> pass = std::make_shared<ComputePass>(name, pipeline, this);
+    passes.push_back(pass);
+    return pass;
+}
+
+std::shared_ptr<Vurl::TransferPass> Vurl::RenderGraph::CreateTransferPass(const std::string& name) {
+    std::shared_ptr<TransferPass> pass = std::make_shared<TransferPass>(name, this);
+    passes.push_back(pass);
+    return pass;
+}
+
 std::shared_ptr<Vurl::Pass> Vurl::RenderGraph::GetPassByName(const std::string& name) {
     for (uint32_t i = 0; i < passes.size(); ++i) {
         if (passes[i]->GetName().compare(name) == 0)
@@ -173,12 +1016,32 @@ void Vurl::RenderGraph::Build() {
         return;
     }
 
-    complete = BuildGraphicsPassGroups() & BuildCommandBuffers() & BuildSynchronizationObjects();
+    complete = BuildGraphicsPassGroups() & BuildComputePasses() & BuildPassBarriers() & BuildCommandBuffers() & BuildSynchronizationObjects();
+
+    //Parts and links the rebuilt graph no longer uses would otherwise pile up with every rebuild
+    if (pipelineLibrary)
+        pipelineLibrary->EvictUnused(*deletionQueue);
 }
 
 void Vurl::RenderGraph::Destroy() {
+    DestroyComputePasses();
     DestroyGraphicsPassGroups();
+    DestroyDescriptorSetAllocator();
     DestroyCommandBuffers();
+
+    //Pending uploads survive a rebuild, they are recorded by the next Execute. The synchronization objects
+    //survive it too, their fences tell when the frames that used the retired objects completed.
+}
+
+void Vurl::RenderGraph::DestroyFrameResources() {
+    for (uint32_t i = 0; i < VURL_MAX_FRAMES_IN_FLIGHT; ++i) {
+        if (inFlightFences[i] != VK_NULL_HANDLE)
+            vkWaitForFences(context->GetDevice(), 1, &inFlightFences[i], VK_TRUE, UINT64_MAX);
+        if (transferFences[i] != VK_NULL_HANDLE)
+            vkWaitForFences(context->GetDevice(), 1, &transferFences[i], VK_TRUE, UINT64_MAX);
+    }
+
+    deletionQueue->Flush();
     DestroySynchronizationObjects();
 }
 
@@ -189,6 +1052,17 @@ void Vurl::RenderGraph::Execute() {
     uint32_t inFlightFrameIndex = frameIndex % VURL_MAX_FRAMES_IN_FLIGHT;
 
     vkWaitForFences(context->GetDevice(), 1, &inFlightFences[inFlightFrameIndex], VK_TRUE, UINT64_MAX);
+    //A rebuild may have removed the async batch, a submission made before it still has to complete
+    if (transferSubmitted[inFlightFrameIndex]) {
+        vkWaitForFences(context->GetDevice(), 1, &transferFences[inFlightFrameIndex], VK_TRUE, UINT64_MAX);
+        transferSubmitted[inFlightFrameIndex] = false;
+    }
+
+    //The fence of this slot signaled for the frame submitted VURL_MAX_FRAMES_IN_FLIGHT frames ago and all before it
+    if (frameIndex >= VURL_MAX_FRAMES_IN_FLIGHT)
+        deletionQueue->Collect(frameIndex - VURL_MAX_FRAMES_IN_FLIGHT);
+    //Refreshes the heap budgets once per frame
+    vmaSetCurrentFrameIndex(context->GetAllocator(), (uint32_t)frameIndex);
 
     uint32_t swapchainImageIndex = 0;
     VkResult result = vkAcquireNextImageKHR(context->GetDevice(), surface->GetSwapchainKHR(), 
@@ -207,8 +1081,47 @@ void Vurl::RenderGraph::Execute() {
     if (vkBeginCommandBuffer(primaryCommandBuffers[inFlightFrameIndex], &beginInfo) != VK_SUCCESS)
         return;
 
-    for (auto& group : graphicsPassGroups) {
-        ExecuteGraphicsPassGroup(&group, primaryCommandBuffers[inFlightFrameIndex], swapchainImageIndex);
+    commandEncoder.Begin(primaryCommandBuffers[inFlightFrameIndex]);
+
+    //The async batch may read buffers updated at the start of this frame, it then waits for the graphics queue
+    bool transferWaitsForUploads = asyncTransferPassBatch != VURL_NULL_HANDLE && !pendingBufferCopies.empty();
+
+    RecordPendingBufferCopies(primaryCommandBuffers[inFlightFrameIndex]);
+    RecordPendingTextureCopies(primaryCommandBuffers[inFlightFrameIndex]);
+    RecordPendingTextureUploads(primaryCommandBuffers[inFlightFrameIndex]);
+
+    for (const PassExecutionStep& step : executionSteps) {
+        //The async batch goes to the transfer queue below
+        if (step.passType == PassType::Transfer && transferPassBatches[step.index].async)
+            continue;
+
+        RecordPassBarriers(step, primaryCommandBuffers[inFlightFrameIndex], swapchainImageIndex);
+
+        if (step.passType == PassType::Transfer) {
+            ExecuteTransferPassBatch(&transferPassBatches[step.index], primaryCommandBuffers[inFlightFrameIndex], swapchainImageIndex);
+            continue;
+        }
+
+        if (step.passType == PassType::Compute) {
+            ExecuteComputePass(&computePasses[step.index], swapchainImageIndex);
+            continue;
+        }
+
+        GraphicsPassGroup& group = graphicsPassGroups[step.index];
+        if (group.useShaderObjects)
+            ExecuteGraphicsPassGroupShaderObjects(&group, primaryCommandBuffers[inFlightFrameIndex], swapchainImageIndex);
+        else
+            ExecuteGraphicsPassGroup(&group, primaryCommandBuffers[inFlightFrameIndex], swapchainImageIndex);
+    }
+
+    //Results are read back through mapped buffers once the frame fence signals
+    if (hasHostVisibleBuffers) {
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        vkCmdPipelineBarrier(primaryCommandBuffers[inFlightFrameIndex], VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_HOST_BIT, 
+                0, 1, &barrier, 0, nullptr, 0, nullptr);
     }
 
     if (vkEndCommandBuffer(primaryCommandBuffers[inFlightFrameIndex]) != VK_SUCCESS)
@@ -216,21 +1129,34 @@ void Vurl::RenderGraph::Execute() {
     
     vkResetFences(context->GetDevice(), 1, &inFlightFences[inFlightFrameIndex]);
     
-    VkSemaphore waitSemaphores[] = { availableSwapchainImageSemaphores[inFlightFrameIndex] };
-    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    //Transfers submitted last frame land before anything of this frame runs
+    VkSemaphore waitSemaphores[] = { availableSwapchainImageSemaphores[inFlightFrameIndex], VK_NULL_HANDLE };
+    VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+    uint32_t waitSemaphoreCount = 1;
+    if (pendingTransferSemaphoreIndex != VURL_NULL_HANDLE)
+        waitSemaphores[waitSemaphoreCount++] = transferFinishedSemaphores[pendingTransferSemaphoreIndex];
+
+    bool transferSubmitted = !transferWaitsForUploads && SubmitAsyncTransferPassBatch(inFlightFrameIndex, swapchainImageIndex, VK_NULL_HANDLE);
+
+    VkSemaphore signalSemaphores[] = { renderFinishedSemaphores[inFlightFrameIndex], uploadFinishedSemaphores[inFlightFrameIndex] };
     
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.waitSemaphoreCount = 1;
+    submitInfo.waitSemaphoreCount = waitSemaphoreCount;
     submitInfo.pWaitSemaphores = waitSemaphores;
     submitInfo.pWaitDstStageMask = waitStages;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &primaryCommandBuffers[inFlightFrameIndex];
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = &renderFinishedSemaphores[inFlightFrameIndex];
+    submitInfo.signalSemaphoreCount = transferWaitsForUploads ? 2 : 1;
+    submitInfo.pSignalSemaphores = signalSemaphores;
 
     if (vkQueueSubmit(context->GetQueueInfo().queues[QUEUE_INDEX_GRAPHICS], 1, &submitInfo, inFlightFences[inFlightFrameIndex]) != VK_SUCCESS)
         return;
+
+    if (transferWaitsForUploads)
+        transferSubmitted = SubmitAsyncTransferPassBatch(inFlightFrameIndex, swapchainImageIndex, uploadFinishedSemaphores[inFlightFrameIndex]);
+
+    pendingTransferSemaphoreIndex = transferSubmitted ? (int)inFlightFrameIndex : VURL_NULL_HANDLE;
     
     VkSwapchainKHR swapchain = surface->GetSwapchainKHR();
 
@@ -246,6 +1172,7 @@ void Vurl::RenderGraph::Execute() {
     vkQueuePresentKHR(context->GetQueueInfo().queues[QUEUE_INDEX_GRAPHICS], &presentInfo);
 
     ++frameIndex;
+    deletionQueue->SetFrameIndex(frameIndex);
 }
 
 void Vurl::RenderGraph::CreatePipelineCache() {
@@ -255,10 +1182,18 @@ void Vurl::RenderGraph::CreatePipelineCache() {
     pipelineCacheCreateInfo.pInitialData = nullptr;
 
     vkCreatePipelineCache(context->GetDevice(), &pipelineCacheCreateInfo, nullptr, &pipelineCache);
+
+    if (useGraphicsPipelineLibrary && context->IsDeviceExtensionEnabled(DEVICE_EXTENSION_GRAPHICS_PIPELINE_LIBRARY))
+        pipelineLibrary = std::make_shared<GraphicsPipelineLibrary>(context->GetDevice(), pipelineCache);
 }
 
 void Vurl::RenderGraph::DestroyPipelineCache() {
+    if (pipelineLibrary) {
+        pipelineLibrary->Destroy();
+        pipelineLibrary = nullptr;
+    }
     vkDestroyPipelineCache(context->GetDevice(), pipelineCache, nullptr);
+    pipelineCache = VK_NULL_HANDLE;
 }
 
 void Vurl::RenderGraph::CreateTransientCommandPool() {
@@ -272,74 +1207,259 @@ void Vurl::RenderGraph::CreateTransientCommandPool() {
 
 void Vurl::RenderGraph::DestroyTransientCommandPool() {
     vkDestroyCommandPool(context->GetDevice(), transientCommandPool, nullptr);
+    transientCommandPool = VK_NULL_HANDLE;
 }
 
 bool Vurl::RenderGraph::BuildDirectedPassesGraph() {
-    std::vector<std::unordered_set<uint32_t>> dependencyGraph(passes.size());
-    
+    //Reads depend on the pass that produced the version they read, this data flow decides what survives culling.
+    //A write also has to wait for the readers (WAR) and the writer (WAW) of the version it replaces.
+    std::vector<std::unordered_set<uint32_t>> dataDependencies(passes.size());
+    std::vector<std::unordered_set<uint32_t>> orderDependencies(passes.size());
+    std::unordered_map<TextureHandle, ResourceVersion> textureVersions{};
+    std::unordered_map<BufferHandle, ResourceVersion> bufferVersions{};
+    std::vector<uint32_t> openPasses{};
+
+    passResourceAccesses.clear();
+    passResourceAccesses.resize(passes.size());
+
     for (uint32_t i = 0; i < passes.size(); ++i) {
-        if (passes[i]->GetPassType() == PassType::Graphics) {
-            std::shared_ptr<GraphicsPass> graphicsPass = std::static_pointer_cast<GraphicsPass>(passes[i]);
-            for (uint32_t j = 0; j < graphicsPass->GetColorAttachmentCount(); ++j) {
-                TextureHandle h = graphicsPass->GetColorAttachment(j);
-                std::shared_ptr<Resource<Texture>> attachment = textures[h];
-                attachment->SetLastWriteOperationPassIndex(i);
+        CollectPassResourceAccesses(i, passResourceAccesses[i]);
+        bool open = false;
+
+        for (PassResourceAccess& access : passResourceAccesses[i]) {
+            ResourceVersion& resourceVersion = access.isTexture ? textureVersions[access.handle] : bufferVersions[access.handle];
+
+            if (access.read) {
+                if (resourceVersion.writerPassIndex != VURL_INVALID_PASS_INDEX)
+                    dataDependencies[i].insert(resourceVersion.writerPassIndex);
+                resourceVersion.readerPassIndices.push_back(i);
             }
 
-            for (uint32_t j = 0; j < graphicsPass->GetInputAttachmentCount(); ++j) {
-                TextureHandle h = graphicsPass->GetInputAttachment(j);
-                std::shared_ptr<Resource<Texture>> attachment = textures[h];
-                attachment->SetLastReadOperationPassIndex(i);
+            if (access.write) {
+                for (uint32_t readerPassIndex : resourceVersion.readerPassIndices)
+                    if (readerPassIndex != i)
+                        orderDependencies[i].insert(readerPassIndex);
+                if (resourceVersion.writerPassIndex != VURL_INVALID_PASS_INDEX)
+                    orderDependencies[i].insert(resourceVersion.writerPassIndex);
+
+                ++resourceVersion.version;
+                resourceVersion.writerPassIndex = i;
+                resourceVersion.readerPassIndices.clear();
             }
+
+            access.version = resourceVersion.version;
+
+            auto trackOperation = [i, &access](auto resource) {
+                if (access.read && resource->GetFirstReadOperationPassIndex() == VURL_INVALID_PASS_INDEX)
+                    resource->SetFirstReadOperationPassIndex(i);
+                if (access.write && resource->GetFirstWriteOperationPassIndex() == VURL_INVALID_PASS_INDEX)
+                    resource->SetFirstWriteOperationPassIndex(i);
+                if (access.read)
+                    resource->SetLastReadOperationPassIndex(i);
+                if (access.write)
+                    resource->SetLastWriteOperationPassIndex(i);
+                return access.write && resource->IsExternal();
+            };
+
+            //Passes writing resources visible outside the graph are kept with everything they depend on
+            if (access.isTexture)
+                open |= trackOperation(textures[access.handle]);
+            else
+                open |= trackOperation(buffers[access.handle]);
         }
+
+        if (open)
+            openPasses.push_back(i);
     }
 
-    for (int i = passes.size() - 1; i >= 0; --i) {
-        if (passes[i]->GetPassType() == PassType::Graphics) {
-            std::shared_ptr<GraphicsPass> graphicsPass = std::static_pointer_cast<GraphicsPass>(passes[i]);
-            for (uint32_t j = 0; j < graphicsPass->GetColorAttachmentCount(); ++j) {
-                TextureHandle h = graphicsPass->GetColorAttachment(j);
-                std::shared_ptr<Resource<Texture>> attachment = textures[h];
-                uint32_t passDependency = attachment->GetFirstReadOperationPassIndex();
-                if (passDependency != -1)
-                    dependencyGraph[passDependency].insert(i);
-                attachment->SetFirstWriteOperationPassIndex(i);
-            }
+    std::vector<bool> culled(passes.size(), true);
+    for (uint32_t i = 0; i < openPasses.size(); ++i) {
+        uint32_t currentPassIndex = openPasses[i];
+        if (!culled[currentPassIndex])
+            continue;
+        culled[currentPassIndex] = false;
 
-            for (uint32_t j = 0; j < graphicsPass->GetInputAttachmentCount(); ++j) {
-                TextureHandle h = graphicsPass->GetInputAttachment(j);
-                std::shared_ptr<Resource<Texture>> attachment = textures[h];
-                attachment->SetFirstReadOperationPassIndex(i);
-            }
-        }
+        for (uint32_t dependencyIndex : dataDependencies[currentPassIndex])
+            openPasses.push_back(dependencyIndex);
     }
-    
+
     culledDirectedPassesGraph.clear();
     culledDirectedPassesGraph.resize(passes.size());
-    std::vector<uint32_t> openPasses{};
+    beginPasses.clear();
 
-    for (int i = passes.size() - 1; i >= 0; --i) {
-        if (passes[i]->GetPassType() == PassType::Graphics) {
-            std::shared_ptr<GraphicsPass> graphicsPass = std::static_pointer_cast<GraphicsPass>(passes[i]);
-            for (uint32_t j = 0; j < graphicsPass->GetColorAttachmentCount(); ++j) {
-                TextureHandle h = graphicsPass->GetColorAttachment(j);
-                std::shared_ptr<Resource<Texture>> attachment = textures[h];
-                if (attachment->IsExternal())
-                    openPasses.push_back(i);
-            }
+    //Dependencies always point to earlier passes, so ordering through a culled pass can be resolved in one sweep
+    std::vector<std::unordered_set<uint32_t>> keptDependencies(passes.size());
+    for (uint32_t i = 0; i < passes.size(); ++i) {
+        orderDependencies[i].insert(dataDependencies[i].begin(), dataDependencies[i].end());
+        for (uint32_t dependencyIndex : orderDependencies[i]) {
+            if (culled[dependencyIndex])
+                keptDependencies[i].insert(keptDependencies[dependencyIndex].begin(), keptDependencies[dependencyIndex].end());
+            else
+                keptDependencies[i].insert(dependencyIndex);
         }
+
+        if (culled[i])
+            continue;
+
+        if (keptDependencies[i].empty())
+            beginPasses.push_back(i);
+
+        for (uint32_t dependencyIndex : keptDependencies[i])
+            culledDirectedPassesGraph[dependencyIndex].push_back(i);
     }
 
-    for (uint32_t i = 0; i < openPasses.size(); ++i) {
-        uint32_t currentPassIndex = openPasses[i];
+    return SortPasses();
+}
 
-        if (dependencyGraph[currentPassIndex].size() == 0)
-            beginPasses.push_back(currentPassIndex);
+void Vurl::RenderGraph::CollectPassResourceAccesses(uint32_t passIndex, std::vector<PassResourceAccess>& accesses) {
+    std::shared_ptr<Pass> pass = passes[passIndex];
+
+    if (pass->GetPassType() == PassType::Graphics) {
+        std::shared_ptr<GraphicsPass> graphicsPass = std::static_pointer_cast<GraphicsPass>(pass);
+
+        for (uint32_t j = 0; j < graphicsPass->GetColorAttachmentCount(); ++j) {
+            PassResourceAccess access{};
+            access.isTexture = true;
+            access.handle = graphicsPass->GetColorAttachment(j);
+            //Attachments the pass doesn't clear keep what earlier passes drew
+            access.read = !graphicsPass->IsColorAttachmentCleared(j);
+            access.write = true;
+            access.stageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            access.accessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+            access.layout = GetAttachmentLayout(access.handle, false);
+            AddPassResourceAccess(accesses, access);
+        }
 
-        for (uint32_t dependencyIndex : dependencyGraph[currentPassIndex]) {
-            culledDirectedPassesGraph[dependencyIndex].push_back(currentPassIndex);
-            openPasses.push_back(dependencyIndex);
+        for (uint32_t j = 0; j < graphicsPass->GetInputAttachmentCount(); ++j) {
+            PassResourceAccess access{};
+            access.isTexture = true;
+            access.handle = graphicsPass->GetInputAttachment(j);
+            access.read = true;
+            access.stageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            access.accessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+            access.layout = GetAttachmentLayout(access.handle, true);
+            AddPassResourceAccess(accesses, access);
         }
+
+        if (graphicsPass->GetDepthStencilAttachment() != VURL_NULL_HANDLE) {
+            PassResourceAccess access{};
+            access.isTexture = true;
+            access.handle = graphicsPass->GetDepthStencilAttachment();
+            access.read = true;
+            access.write = true;
+            access.stageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            access.accessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            access.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            AddPassResourceAccess(accesses, access);
+        }
+    }
+
+    for (uint32_t j = 0; j < pass->GetResourceAccessCount(); ++j) {
+        PassResourceAccess access{};
+        GetPassResourceAccess(pass->GetPassType(), pass->GetResourceAccess(j), access);
+        AddPassResourceAccess(accesses, access);
+    }
+}
+
+void Vurl::RenderGraph::AddPassResourceAccess(std::vector<PassResourceAccess>& accesses, const PassResourceAccess& access) {
+    //One entry per resource, a pass using it several ways needs all of them satisfied at once
+    for (PassResourceAccess& mergedAccess : accesses) {
+        if (mergedAccess.isTexture != access.isTexture || mergedAccess.handle != access.handle)
+            continue;
+
+        mergedAccess.read |= access.read;
+        mergedAccess.write |= access.write;
+        mergedAccess.stageMask |= access.stageMask;
+        mergedAccess.accessMask |= access.accessMask;
+        if (mergedAccess.layout != access.layout)
+            mergedAccess.layout = VK_IMAGE_LAYOUT_GENERAL;
+        return;
+    }
+
+    accesses.push_back(access);
+}
+
+void Vurl::RenderGraph::GetPassResourceAccess(PassType passType, const ResourceAccess& resourceAccess, PassResourceAccess& access) {
+    VkPipelineStageFlags shaderStages = passType == PassType::Compute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VURL_GRAPHICS_SHADER_STAGES;
+
+    access.isTexture = resourceAccess.isTexture;
+    access.handle = resourceAccess.handle;
+    access.read = Pass::IsReadAccessType(resourceAccess.type);
+    access.write = Pass::IsWriteAccessType(resourceAccess.type);
+
+    switch (resourceAccess.type) {
+        case ResourceAccessType::VertexBuffer:
+            access.stageMask = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+            access.accessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+            break;
+        case ResourceAccessType::IndexBuffer:
+            access.stageMask = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+            access.accessMask = VK_ACCESS_INDEX_READ_BIT;
+            break;
+        case ResourceAccessType::IndirectBuffer:
+            access.stageMask = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
+            access.accessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+            break;
+        case ResourceAccessType::UniformBuffer:
+            access.stageMask = shaderStages;
+            access.accessMask = VK_ACCESS_UNIFORM_READ_BIT;
+            break;
+        case ResourceAccessType::SampledImage:
+            access.stageMask = shaderStages;
+            access.accessMask = VK_ACCESS_SHADER_READ_BIT;
+            access.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            break;
+        case ResourceAccessType::StorageRead:
+            access.stageMask = shaderStages;
+            access.accessMask = VK_ACCESS_SHADER_READ_BIT;
+            access.layout = VK_IMAGE_LAYOUT_GENERAL;
+            break;
+        case ResourceAccessType::StorageWrite:
+            access.stageMask = shaderStages;
+            access.accessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            access.layout = VK_IMAGE_LAYOUT_GENERAL;
+            break;
+        case ResourceAccessType::StorageReadWrite:
+            access.stageMask = shaderStages;
+            access.accessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+            access.layout = VK_IMAGE_LAYOUT_GENERAL;
+            break;
+        case ResourceAccessType::TransferRead:
+            access.stageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            access.accessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            access.layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+            break;
+        case ResourceAccessType::TransferWrite:
+            access.stageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            access.accessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            access.layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            break;
+    }
+
+    if (!access.isTexture)
+        access.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+}
+
+bool Vurl::RenderGraph::SortPasses() {
+    //Kahn's algorithm over the culled graph, ties go to the pass declared first so the order is stable.
+    //Dependencies always point to earlier declared passes, the graph can't have cycles.
+    std::vector<uint32_t> dependencyCounts(passes.size(), 0);
+    for (uint32_t i = 0; i < culledDirectedPassesGraph.size(); ++i)
+        for (uint32_t dependentIndex : culledDirectedPassesGraph[i])
+            ++dependencyCounts[dependentIndex];
+
+    std::vector<uint32_t> readyPasses(beginPasses);
+    sortedPasses.clear();
+
+    while (!readyPasses.empty()) {
+        auto it = std::min_element(readyPasses.begin(), readyPasses.end());
+        uint32_t passIndex = *it;
+        readyPasses.erase(it);
+        sortedPasses.push_back(passIndex);
+
+        for (uint32_t dependentIndex : culledDirectedPassesGraph[passIndex])
+            if (--dependencyCounts[dependentIndex] == 0)
+                readyPasses.push_back(dependentIndex);
     }
 
     return true;
@@ -347,42 +1467,68 @@ bool Vurl::RenderGraph::BuildDirectedPassesGraph() {
 
 bool Vurl::RenderGraph::BuildGraphicsPassGroups() {
     graphicsPassGroups.clear();
-    for (uint32_t beginPass : beginPasses) {
-        if (passes[beginPass]->GetPassType() == PassType::Graphics)
-            BuildGraphicsPassGroup(beginPass);
+    for (uint32_t passIndex : sortedPasses) {
+        if (passes[passIndex]->GetPassType() == PassType::Graphics)
+            BuildGraphicsPassGroup(passIndex);
     }
 
     for (auto& group : graphicsPassGroups) {
-        BuildGraphicsPassGroupRenderPass(&group);
-        BuildGraphicsPassGroupFramebuffers(&group);
-        BuildGraphicsPassGroupGraphicsPipelines(&group);
+        BuildGraphicsPassGroupAttachments(&group);
+
+        group.descriptorSets.resize(group.passes.size());
+        for (uint32_t i = 0; i < group.passes.size(); ++i) {
+            //Commands past the GPU count may hold anything, they can't be drawn without drawIndirectCount
+            if (group.passes[i]->HasIndexedIndirectDraw() && group.passes[i]->GetIndexedIndirectDraw().countBuffer != VURL_NULL_HANDLE && 
+                    !context->IsDeviceFeatureEnabled(DEVICE_FEATURE_DRAW_INDIRECT_COUNT))
+                return false;
+
+            std::shared_ptr<GraphicsPipeline> graphicsPipeline = group.passes[i]->GetGraphicsPipeline();
+            if (!BuildPassDescriptorSets(group.passes[i]->GetStorageBuffers(), group.passes[i]->GetStorageImages(), 
+                    graphicsPipeline->GetDescriptorSetLayout(0), [&graphicsPipeline](uint32_t binding) { 
+                        return graphicsPipeline->FindDescriptorBinding(0, binding); 
+                    }, group.descriptorSets[i]))
+                return false;
+        }
+
+        //Input attachments need a render pass, those groups stay on the pipeline path
+        bool hasInputAttachments = false;
+        for (const auto& pass : group.passes)
+            hasInputAttachments |= pass->GetInputAttachmentCount() > 0;
+
+        //Groups whose shaders can't be created fall back to the pipeline path, DestroyGraphicsPassGroups frees the ones that were
+        if (IsShaderObjectUsed() && !hasInputAttachments) {
+            group.useShaderObjects = BuildGraphicsPassGroupShaderObjects(&group);
+            if (group.useShaderObjects)
+                continue;
+        }
+
+        if (!BuildGraphicsPassGroupRenderPass(&group) || !BuildGraphicsPassGroupFramebuffers(&group) || 
+                !BuildGraphicsPassGroupGraphicsPipelines(&group))
+            return false;
     }
 
     return true;
 }
 
 bool Vurl::RenderGraph::BuildGraphicsPassGroup(uint32_t firstPass) {
-    //TODO: Actual Implementation
+    //One pass per group, the graph records the barriers between groups like between any other passes
     GraphicsPassGroup& group = graphicsPassGroups.emplace_back();
     std::shared_ptr<GraphicsPass> graphicsPass = std::static_pointer_cast<GraphicsPass>(passes[firstPass]);
     group.passes.push_back(graphicsPass);
-    for (uint32_t passIndex : culledDirectedPassesGraph[firstPass])
-        if (passes[passIndex]->GetPassType() == PassType::Graphics)
-            BuildGraphicsPassGroup(passIndex);
     return true;
 }
 
-bool Vurl::RenderGraph::BuildGraphicsPassGroupRenderPass(GraphicsPassGroup* group) {
+bool Vurl::RenderGraph::BuildGraphicsPassGroupAttachments(GraphicsPassGroup* group) {
     uint32_t i = 0;
-    std::unordered_map<TextureHandle, VkClearValue> clearValues{};
+    std::unordered_map<TextureHandle, VkClearValue>& clearValues = group->attachmentClearValues;
 
+    //The graph's barriers move attachments into the layout of each access before the render pass begins and
+    //expect them left in it, so contents later passes read are loaded and stored instead of discarded
     VkAttachmentDescription defaultAttachmentDescription{};
-    defaultAttachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-    defaultAttachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    defaultAttachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    defaultAttachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     defaultAttachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     defaultAttachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    defaultAttachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    defaultAttachmentDescription.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
     for (const auto& pass : group->passes) {
         for (uint32_t j = 0; j < pass->GetColorAttachmentCount(); ++j) {
@@ -390,32 +1536,24 @@ bool Vurl::RenderGraph::BuildGraphicsPassGroupRenderPass(GraphicsPassGroup* grou
             if (h == backBufferTexture)
                 group->minSwapchainColorAttachmentSubpassIndex = std::min(group->minSwapchainColorAttachmentSubpassIndex, i);
 
-            auto r = group->attachmentDescriptions.emplace(h, defaultAttachmentDescription);
+            AddGraphicsPassGroupAttachment(group, h, GetAttachmentLayout(h, false), defaultAttachmentDescription);
         }
 
         for (uint32_t j = 0; j < pass->GetInputAttachmentCount(); ++j) {
             TextureHandle h = pass->GetInputAttachment(j);
-            auto r = group->attachmentDescriptions.emplace(h, defaultAttachmentDescription);
-            VkAttachmentDescription& description = r.first->second;
-
-            if ((r.second || description.loadOp == VK_ATTACHMENT_LOAD_OP_DONT_CARE) &&
-                description.initialLayout != VK_IMAGE_LAYOUT_UNDEFINED)
-                description.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+            AddGraphicsPassGroupAttachment(group, h, GetAttachmentLayout(h, true), defaultAttachmentDescription);
         }
 
         if (pass->GetDepthStencilAttachment() != VURL_NULL_HANDLE) {
             TextureHandle h = pass->GetDepthStencilAttachment();
-            auto r = group->attachmentDescriptions.emplace(h, defaultAttachmentDescription);
-            VkAttachmentDescription& description = r.first->second;
+            bool added = AddGraphicsPassGroupAttachment(group, h, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, defaultAttachmentDescription);
             
             VkClearValue clearValue{};
             clearValue.depthStencil = { 1.0f, 0 };
             clearValues[h] = clearValue;
 
-            if (r.second) {
-                description.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-                description.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-            }
+            if (added)
+                group->attachmentDescriptions[h].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
         }
 
         for (uint32_t j = 0; j < pass->GetClearAttachmentInfoCount(); ++j) {
@@ -430,13 +1568,9 @@ bool Vurl::RenderGraph::BuildGraphicsPassGroupRenderPass(GraphicsPassGroup* grou
         ++i;
     }
 
-    std::vector<VkAttachmentDescription> vkAttachmentDescriptions{};
-    std::unordered_map<TextureHandle, uint32_t> handleToAttachmentIndex{};
-
     uint32_t minWidth = UINT32_MAX;
     uint32_t minHeight = UINT32_MAX;
 
-    i = 0;
     for (auto& e : group->attachmentDescriptions) {
         TextureHandle h = e.first;
         VkAttachmentDescription& description = e.second;
@@ -455,13 +1589,6 @@ bool Vurl::RenderGraph::BuildGraphicsPassGroupRenderPass(GraphicsPassGroup* grou
 
         description.format = slice->vkFormat;
         description.samples = VK_SAMPLE_COUNT_1_BIT;
-
-        if (h == backBufferTexture)
-            description.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-        vkAttachmentDescriptions.push_back(description);
-        handleToAttachmentIndex[h] = i;
-        ++i;
     }
 
     group->viewport.x + 0.0f;
@@ -474,10 +1601,36 @@ bool Vurl::RenderGraph::BuildGraphicsPassGroupRenderPass(GraphicsPassGroup* grou
     group->scissor.offset = { 0, 0 };
     group->scissor.extent = { minWidth, minHeight };
 
+    return true;
+}
+
+bool Vurl::RenderGraph::AddGraphicsPassGroupAttachment(GraphicsPassGroup* group, TextureHandle h, VkImageLayout layout, 
+        const VkAttachmentDescription& defaultAttachmentDescription) {
+    auto r = group->attachmentDescriptions.emplace(h, defaultAttachmentDescription);
+    VkAttachmentDescription& description = r.first->second;
+    if (r.second)
+        description.initialLayout = layout;
+    description.finalLayout = layout;
+    return r.second;
+}
+
+bool Vurl::RenderGraph::BuildGraphicsPassGroupRenderPass(GraphicsPassGroup* group) {
+    std::vector<VkAttachmentDescription> vkAttachmentDescriptions{};
+    std::unordered_map<TextureHandle, uint32_t> handleToAttachmentIndex{};
+
+    uint32_t i = 0;
+    for (auto& e : group->attachmentDescriptions) {
+        vkAttachmentDescriptions.push_back(e.second);
+        handleToAttachmentIndex[e.first] = i;
+        ++i;
+    }
+
     std::vector<std::vector<VkAttachmentReference>> subpassesAttachmentReferences{};
     std::vector<VkAttachmentReference> subpassesDepthStencilAttachmentReferences{};
     std::vector<VkSubpassDependency> subpassDependencies{};
     std::vector<VkSubpassDescription> subpassDescriptions{};
+    //Subpasses point into it, it must not reallocate
+    subpassesDepthStencilAttachmentReferences.reserve(group->passes.size());
 
     i = 0;
     for (const auto& pass : group->passes) {
@@ -494,7 +1647,7 @@ bool Vurl::RenderGraph::BuildGraphicsPassGroupRenderPass(GraphicsPassGroup* grou
             TextureHandle h = pass->GetInputAttachment(i);
             VkAttachmentReference attachmentReference{};
             attachmentReference.attachment = handleToAttachmentIndex[h];
-            attachmentReference.layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            attachmentReference.layout = GetAttachmentLayout(h, true);
             attachmentReferences.push_back(attachmentReference);
         }
 
@@ -506,39 +1659,56 @@ bool Vurl::RenderGraph::BuildGraphicsPassGroupRenderPass(GraphicsPassGroup* grou
         subpass.pInputAttachments = attachmentReferences.data() + pass->GetColorAttachmentCount();
 
         if (pass->GetDepthStencilAttachment() != VURL_NULL_HANDLE) {
-            VkAttachmentReference depthStencilAttachmentReference = subpassesDepthStencilAttachmentReferences.emplace_back();
+            VkAttachmentReference& depthStencilAttachmentReference = subpassesDepthStencilAttachmentReferences.emplace_back();
             depthStencilAttachmentReference.attachment = handleToAttachmentIndex[pass->GetDepthStencilAttachment()];
             depthStencilAttachmentReference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
             subpass.pDepthStencilAttachment = &depthStencilAttachmentReference;
-            
-            VkSubpassDependency dependency{};
-            dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-            dependency.dstSubpass = i;
-            dependency.srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-            dependency.srcAccessMask = 0;
-            dependency.dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-            dependency.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-            subpassDependencies.push_back(dependency);
         }
 
-        if (group->minSwapchainColorAttachmentSubpassIndex == i) {
-            VkSubpassDependency dependency{};
-            dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-            dependency.dstSubpass = i;
-            dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            dependency.srcAccessMask = 0;
-            dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-            dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-
-            subpassDependencies.push_back(dependency);
+        //The graph's barrier before the render pass already waits for earlier accesses and ends in the stages of
+        //this pass, chaining onto it orders the render pass's own layout transitions and the swapchain acquire
+        VkSubpassDependency dependency{};
+        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependency.dstSubpass = i;
+        if (pass->GetColorAttachmentCount() > 0) {
+            dependency.dstStageMask |= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+            dependency.dstAccessMask |= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        }
+        if (pass->GetInputAttachmentCount() > 0) {
+            dependency.dstStageMask |= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+            dependency.dstAccessMask |= VK_ACCESS_INPUT_ATTACHMENT_READ_BIT;
+        }
+        if (pass->GetDepthStencilAttachment() != VURL_NULL_HANDLE) {
+            dependency.dstStageMask |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+            dependency.dstAccessMask |= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
         }
+        dependency.srcStageMask = dependency.dstStageMask;
+        dependency.srcAccessMask = 0;
+        if (dependency.dstStageMask != 0)
+            subpassDependencies.push_back(dependency);
 
         subpassDescriptions.push_back(subpass);
         ++i;
     }
 
+    //Render passes are compatible when their attachment formats and samples and their subpass references match
+    HashKey renderPassKey{};
+    for (const VkAttachmentDescription& description : vkAttachmentDescriptions) {
+        renderPassKey.U32(description.format);
+        renderPassKey.U32(description.samples);
+    }
+    for (const VkSubpassDescription& subpass : subpassDescriptions) {
+        renderPassKey.U32(subpass.colorAttachmentCount);
+        for (uint32_t j = 0; j < subpass.colorAttachmentCount; ++j)
+            renderPassKey.U32(subpass.pColorAttachments[j].attachment);
+        renderPassKey.U32(subpass.inputAttachmentCount);
+        for (uint32_t j = 0; j < subpass.inputAttachmentCount; ++j)
+            renderPassKey.U32(subpass.pInputAttachments[j].attachment);
+        renderPassKey.U32(subpass.pDepthStencilAttachment ? subpass.pDepthStencilAttachment->attachment : VK_ATTACHMENT_UNUSED);
+    }
+    group->renderPassKey = renderPassKey.Get();
+
     VkRenderPassCreateInfo renderPassCreateInfo{};
     renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassCreateInfo.attachmentCount = (uint32_t)vkAttachmentDescriptions.size();
@@ -605,180 +1775,712 @@ bool Vurl::RenderGraph::BuildGraphicsPassGroupFramebuffers(GraphicsPassGroup* gr
 }
 
 bool Vurl::RenderGraph::BuildGraphicsPassGroupGraphicsPipelines(GraphicsPassGroup* group) {
-    struct GraphicsPipelineCreateInfo {
-        VkPipelineDynamicStateCreateInfo dynamicState{};
-        std::vector<VkVertexInputBindingDescription> bindingDescriptions{};
-        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
-        VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-        VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-        VkPipelineViewportStateCreateInfo viewportState{};
-        VkPipelineRasterizationStateCreateInfo rasterizer{};
-        VkPipelineMultisampleStateCreateInfo multisampling{};
-        VkPipelineDepthStencilStateCreateInfo depthStencil{};
-        std::vector<VkPipelineColorBlendAttachmentState> blendAttachmentStates{};
-        VkPipelineColorBlendStateCreateInfo colorBlending{};
-        VkPipelineLayout pipelineLayout{};
-        std::vector<VkPipelineShaderStageCreateInfo> stages{};
-    };
-
-    std::vector<GraphicsPipelineCreateInfo> graphicsPipelineCreateInfos{};
+    std::vector<GraphicsPipelineCreateInfo> graphicsPipelineCreateInfos(group->passes.size());
     std::vector<VkGraphicsPipelineCreateInfo> vkGraphicsPipelineCreateInfo{};
+    std::vector<std::string> missingVariantKeys{};
+    group->dynamicStateFlags.resize(group->passes.size());
+    group->specializationHashes.resize(group->passes.size());
 
-    uint32_t i = 0;
-    for (const auto& pass : group->passes) {
-        GraphicsPipelineCreateInfo& graphicsPipelineCreateInfo = graphicsPipelineCreateInfos.emplace_back();
-        std::shared_ptr<GraphicsPipeline> graphicsPipeline = pass->GetGraphicsPipeline();
+    for (uint32_t i = 0; i < group->passes.size(); ++i) {
+        FillGraphicsPipelineCreateInfo(group, i, graphicsPipelineCreateInfos[i]);
+        group->specializationHashes[i] = group->passes[i]->GetGraphicsPipeline()->GetSpecializationHash();
+    }
+
+    if (pipelineLibrary)
+        return LinkGraphicsPassGroupGraphicsPipelines(group, graphicsPipelineCreateInfos);
+
+    //Only compile variants that aren't cached yet
+    for (uint32_t i = 0; i < group->passes.size(); ++i) {
+        std::string key = GetGraphicsPipelineVariantKey(group, i);
+        if (pipelineVariants.count(key) || std::find(missingVariantKeys.begin(), missingVariantKeys.end(), key) != missingVariantKeys.end())
+            continue;
+        missingVariantKeys.push_back(key);
+        vkGraphicsPipelineCreateInfo.push_back(graphicsPipelineCreateInfos[i].pipelineCreateInfo);
+    }
 
-        graphicsPipelineCreateInfo.dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-        graphicsPipelineCreateInfo.dynamicState.dynamicStateCount = graphicsPipeline->GetDynamicStatesCount();
-        graphicsPipelineCreateInfo.dynamicState.pDynamicStates = graphicsPipeline->GetDynamicStates();
+    std::vector<VkPipeline> createdPipelines(vkGraphicsPipelineCreateInfo.size());
+    if (!createdPipelines.empty() && vkCreateGraphicsPipelines(context->GetDevice(), pipelineCache, (uint32_t)vkGraphicsPipelineCreateInfo.size(), 
+            vkGraphicsPipelineCreateInfo.data(), nullptr, createdPipelines.data()) != VK_SUCCESS)
+        return false;
 
-        for (uint32_t i = 0; i < graphicsPipeline->GetVertexInputCount(); ++i) {
-            const VertexInputDescription& description = graphicsPipeline->GetVertexInput(i);
+    for (uint32_t i = 0; i < createdPipelines.size(); ++i)
+        pipelineVariants[missingVariantKeys[i]] = createdPipelines[i];
 
-            VkVertexInputBindingDescription vertexInputBindingDescription{};
-            vertexInputBindingDescription.binding = 0;
-            vertexInputBindingDescription.stride = description.GetStride();
-            vertexInputBindingDescription.inputRate = description.GetInputRate();
+    group->pipelines.resize(group->passes.size());
+    for (uint32_t i = 0; i < group->passes.size(); ++i)
+        group->pipelines[i] = pipelineVariants[GetGraphicsPipelineVariantKey(group, i)];
 
-            graphicsPipelineCreateInfo.bindingDescriptions.push_back(vertexInputBindingDescription);
+    return true;
+}
 
-            for (uint32_t j = 0; j < description.GetAttributeCount(); ++j) {
-                const VertexInputAttributeDescription& attributeDescription = description.GetAttribute(j);
+std::string Vurl::RenderGraph::GetGraphicsPipelineVariantKey(GraphicsPassGroup* group, uint32_t passIndex) {
+    HashKey key{};
+    key.String(group->renderPassKey.data(), group->renderPassKey.size());
+    key.U32(passIndex);
+    group->passes[passIndex]->GetGraphicsPipeline()->Hash(key, GetSupportedDynamicStateFlags());
+    return key.Get();
+}
 
-                VkVertexInputAttributeDescription vertexInputAttributeDescription{};
-                vertexInputAttributeDescription.binding = i;
-                vertexInputAttributeDescription.location = attributeDescription.location;
-                vertexInputAttributeDescription.format = attributeDescription.GetVkFormat();
-                vertexInputAttributeDescription.offset = attributeDescription.offset;
+bool Vurl::RenderGraph::UpdateGraphicsPassPipelineVariant(GraphicsPassGroup* group, uint32_t passIndex) {
+    std::shared_ptr<GraphicsPipeline> graphicsPipeline = group->passes[passIndex]->GetGraphicsPipeline();
+    group->specializationHashes[passIndex] = graphicsPipeline->GetSpecializationHash();
 
-                graphicsPipelineCreateInfo.attributeDescriptions.push_back(vertexInputAttributeDescription);
-            }
+    GraphicsPipelineCreateInfo createInfo{};
+    FillGraphicsPipelineCreateInfo(group, passIndex, createInfo);
+
+    if (!group->linkedPipelineIds.empty()) {
+        uint32_t id = pipelineLibrary->Link(createInfo.pipelineCreateInfo, group->renderPassKey);
+        group->linkedPipelineIds[passIndex] = id;
+        if (id != 0) {
+            group->pipelines[passIndex] = pipelineLibrary->GetLinkedPipeline(id);
+            return true;
         }
+    }
 
-        graphicsPipelineCreateInfo.vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        graphicsPipelineCreateInfo.vertexInputInfo.vertexBindingDescriptionCount = (uint32_t)graphicsPipelineCreateInfo.bindingDescriptions.size();
-        graphicsPipelineCreateInfo.vertexInputInfo.pVertexBindingDescriptions = graphicsPipelineCreateInfo.bindingDescriptions.data();
-        graphicsPipelineCreateInfo.vertexInputInfo.vertexAttributeDescriptionCount = (uint32_t)graphicsPipelineCreateInfo.attributeDescriptions.size();
-        graphicsPipelineCreateInfo.vertexInputInfo.pVertexAttributeDescriptions = graphicsPipelineCreateInfo.attributeDescriptions.data();
+    return CreateGraphicsPipelineVariant(group, passIndex, createInfo.pipelineCreateInfo);
+}
 
-        graphicsPipelineCreateInfo.inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-        graphicsPipelineCreateInfo.inputAssembly.topology = graphicsPipeline->GetPipelinePrimitiveTopology();
-        graphicsPipelineCreateInfo.inputAssembly.primitiveRestartEnable = VK_FALSE;
+bool Vurl::RenderGraph::CreateGraphicsPipelineVariant(GraphicsPassGroup* group, uint32_t passIndex, const VkGraphicsPipelineCreateInfo& createInfo) {
+    std::string key = GetGraphicsPipelineVariantKey(group, passIndex);
+    auto it = pipelineVariants.find(key);
+    if (it == pipelineVariants.end()) {
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (vkCreateGraphicsPipelines(context->GetDevice(), pipelineCache, 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS)
+            return false;
+        it = pipelineVariants.emplace(key, pipeline).first;
+    }
+
+    group->pipelines[passIndex] = it->second;
+    return true;
+}
+
+bool Vurl::RenderGraph::LinkGraphicsPassGroupGraphicsPipelines(GraphicsPassGroup* group, std::vector<GraphicsPipelineCreateInfo>& createInfos) {
+    group->linkedPipelineIds.resize(createInfos.size());
+    group->pipelines.resize(createInfos.size());
+
+    for (uint32_t i = 0; i < createInfos.size(); ++i) {
+        //Passes whose parts or link fail get a monolithic pipeline from the variant cache, their id stays 0
+        uint32_t id = pipelineLibrary->Link(createInfos[i].pipelineCreateInfo, group->renderPassKey);
+        group->linkedPipelineIds[i] = id;
+        if (id != 0)
+            group->pipelines[i] = pipelineLibrary->GetLinkedPipeline(id);
+        else if (!CreateGraphicsPipelineVariant(group, i, createInfos[i].pipelineCreateInfo))
+            return false;
+    }
+
+    return true;
+}
+
+void Vurl::RenderGraph::FillGraphicsPipelineCreateInfo(GraphicsPassGroup* group, uint32_t passIndex, GraphicsPipelineCreateInfo& graphicsPipelineCreateInfo) {
+    std::shared_ptr<GraphicsPass> pass = group->passes[passIndex];
+    std::shared_ptr<GraphicsPipeline> graphicsPipeline = pass->GetGraphicsPipeline();
+
+    DynamicStateFlags dynamicStateFlags = graphicsPipeline->GetDynamicStateFlags() & GetSupportedDynamicStateFlags();
+    group->dynamicStateFlags[passIndex] = dynamicStateFlags;
+    GraphicsPipeline::GetVkDynamicStates(dynamicStateFlags, graphicsPipelineCreateInfo.dynamicStates);
+
+    graphicsPipelineCreateInfo.dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    graphicsPipelineCreateInfo.dynamicState.dynamicStateCount = (uint32_t)graphicsPipelineCreateInfo.dynamicStates.size();
+    graphicsPipelineCreateInfo.dynamicState.pDynamicStates = graphicsPipelineCreateInfo.dynamicStates.data();
+
+    bool hasDepthStencilAttachment = pass->GetDepthStencilAttachment() != VURL_NULL_HANDLE;
+
+    for (uint32_t i = 0; i < graphicsPipeline->GetVertexInputCount(); ++i) {
+        const VertexInputDescription& description = graphicsPipeline->GetVertexInput(i);
+
+        VkVertexInputBindingDescription vertexInputBindingDescription{};
+        vertexInputBindingDescription.binding = i;
+        vertexInputBindingDescription.stride = description.GetStride();
+        vertexInputBindingDescription.inputRate = description.GetInputRate();
+
+        graphicsPipelineCreateInfo.bindingDescriptions.push_back(vertexInputBindingDescription);
 
-        graphicsPipelineCreateInfo.viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-        graphicsPipelineCreateInfo.viewportState.viewportCount = 1;
-        graphicsPipelineCreateInfo.viewportState.pViewports = &group->viewport;
-        graphicsPipelineCreateInfo.viewportState.scissorCount = 1;
-        graphicsPipelineCreateInfo.viewportState.pScissors = &group->scissor;
-
-        graphicsPipelineCreateInfo.rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-        graphicsPipelineCreateInfo.rasterizer.depthClampEnable = VK_FALSE;
-        graphicsPipelineCreateInfo.rasterizer.rasterizerDiscardEnable = VK_FALSE;
-        graphicsPipelineCreateInfo.rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-        graphicsPipelineCreateInfo.rasterizer.lineWidth = 1.0f;
-        graphicsPipelineCreateInfo.rasterizer.cullMode = graphicsPipeline->GetPipelineCullMode();
-        graphicsPipelineCreateInfo.rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-        graphicsPipelineCreateInfo.rasterizer.depthBiasEnable = VK_FALSE;
-        graphicsPipelineCreateInfo.rasterizer.depthBiasConstantFactor = 0.0f;
-        graphicsPipelineCreateInfo.rasterizer.depthBiasClamp = 0.0f;
-        graphicsPipelineCreateInfo.rasterizer.depthBiasSlopeFactor = 0.0f;
-
-        graphicsPipelineCreateInfo.multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-        graphicsPipelineCreateInfo.multisampling.sampleShadingEnable = VK_FALSE;
-        graphicsPipelineCreateInfo.multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-        graphicsPipelineCreateInfo.multisampling.minSampleShading = 1.0f;
-        graphicsPipelineCreateInfo.multisampling.pSampleMask = nullptr;
-        graphicsPipelineCreateInfo.multisampling.alphaToCoverageEnable = VK_FALSE;
-        graphicsPipelineCreateInfo.multisampling.alphaToOneEnable = VK_FALSE;
-
-        graphicsPipelineCreateInfo.depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        for (uint32_t j = 0; j < description.GetAttributeCount(); ++j) {
+            const VertexInputAttributeDescription& attributeDescription = description.GetAttribute(j);
+
+            VkVertexInputAttributeDescription vertexInputAttributeDescription{};
+            vertexInputAttributeDescription.binding = i;
+            vertexInputAttributeDescription.location = attributeDescription.location;
+            vertexInputAttributeDescription.format = attributeDescription.GetVkFormat();
+            vertexInputAttributeDescription.offset = attributeDescription.offset;
+
+            graphicsPipelineCreateInfo.attributeDescriptions.push_back(vertexInputAttributeDescription);
+        }
+    }
+
+    graphicsPipelineCreateInfo.vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    graphicsPipelineCreateInfo.vertexInputInfo.vertexBindingDescriptionCount = (uint32_t)graphicsPipelineCreateInfo.bindingDescriptions.size();
+    graphicsPipelineCreateInfo.vertexInputInfo.pVertexBindingDescriptions = graphicsPipelineCreateInfo.bindingDescriptions.data();
+    graphicsPipelineCreateInfo.vertexInputInfo.vertexAttributeDescriptionCount = (uint32_t)graphicsPipelineCreateInfo.attributeDescriptions.size();
+    graphicsPipelineCreateInfo.vertexInputInfo.pVertexAttributeDescriptions = graphicsPipelineCreateInfo.attributeDescriptions.data();
+
+    graphicsPipelineCreateInfo.inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    graphicsPipelineCreateInfo.inputAssembly.topology = graphicsPipeline->GetPipelinePrimitiveTopology();
+    graphicsPipelineCreateInfo.inputAssembly.primitiveRestartEnable = graphicsPipeline->IsPipelinePrimitiveRestartEnabled();
+
+    graphicsPipelineCreateInfo.viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    graphicsPipelineCreateInfo.viewportState.viewportCount = 1;
+    graphicsPipelineCreateInfo.viewportState.pViewports = &group->viewport;
+    graphicsPipelineCreateInfo.viewportState.scissorCount = 1;
+    graphicsPipelineCreateInfo.viewportState.pScissors = &group->scissor;
+
+    graphicsPipelineCreateInfo.rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    graphicsPipelineCreateInfo.rasterizer.depthClampEnable = VK_FALSE;
+    graphicsPipelineCreateInfo.rasterizer.rasterizerDiscardEnable = VK_FALSE;
+    graphicsPipelineCreateInfo.rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
+    graphicsPipelineCreateInfo.rasterizer.lineWidth = 1.0f;
+    graphicsPipelineCreateInfo.rasterizer.cullMode = graphicsPipeline->GetPipelineCullMode();
+    graphicsPipelineCreateInfo.rasterizer.frontFace = graphicsPipeline->GetPipelineFrontFace();
+    graphicsPipelineCreateInfo.rasterizer.depthBiasEnable = VK_FALSE;
+    graphicsPipelineCreateInfo.rasterizer.depthBiasConstantFactor = 0.0f;
+    graphicsPipelineCreateInfo.rasterizer.depthBiasClamp = 0.0f;
+    graphicsPipelineCreateInfo.rasterizer.depthBiasSlopeFactor = 0.0f;
+
+    graphicsPipelineCreateInfo.multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    graphicsPipelineCreateInfo.multisampling.sampleShadingEnable = VK_FALSE;
+    graphicsPipelineCreateInfo.multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+    graphicsPipelineCreateInfo.multisampling.minSampleShading = 1.0f;
+    graphicsPipelineCreateInfo.multisampling.pSampleMask = nullptr;
+    graphicsPipelineCreateInfo.multisampling.alphaToCoverageEnable = VK_FALSE;
+    graphicsPipelineCreateInfo.multisampling.alphaToOneEnable = VK_FALSE;
+
+    graphicsPipelineCreateInfo.depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+    graphicsPipelineCreateInfo.depthStencil.depthTestEnable = hasDepthStencilAttachment && graphicsPipeline->IsPipelineDepthTestEnabled();
+    graphicsPipelineCreateInfo.depthStencil.depthWriteEnable = hasDepthStencilAttachment && graphicsPipeline->IsPipelineDepthWriteEnabled();
+    graphicsPipelineCreateInfo.depthStencil.depthCompareOp = graphicsPipeline->GetPipelineDepthCompareOp();
+    graphicsPipelineCreateInfo.depthStencil.depthBoundsTestEnable = VK_FALSE;
+    graphicsPipelineCreateInfo.depthStencil.minDepthBounds = 0.0f;
+    graphicsPipelineCreateInfo.depthStencil.maxDepthBounds = 1.0f;
+    graphicsPipelineCreateInfo.depthStencil.stencilTestEnable = VK_FALSE;
+    graphicsPipelineCreateInfo.depthStencil.front = {};
+    graphicsPipelineCreateInfo.depthStencil.back = {};
+
+    //Bake canonical values for dynamic states so pipelines differing only by them are identical
+    if (dynamicStateFlags & DYNAMIC_STATE_VIEWPORT_BIT)
+        graphicsPipelineCreateInfo.viewportState.pViewports = nullptr;
+    if (dynamicStateFlags & DYNAMIC_STATE_SCISSOR_BIT)
+        graphicsPipelineCreateInfo.viewportState.pScissors = nullptr;
+    if (dynamicStateFlags & DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_BIT)
+        graphicsPipelineCreateInfo.inputAssembly.topology = GraphicsPipeline::GetPrimitiveTopologyClass(graphicsPipeline->GetPipelinePrimitiveTopology());
+    if (dynamicStateFlags & DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_BIT)
+        graphicsPipelineCreateInfo.inputAssembly.primitiveRestartEnable = VK_FALSE;
+    if (dynamicStateFlags & DYNAMIC_STATE_CULL_MODE_BIT)
+        graphicsPipelineCreateInfo.rasterizer.cullMode = VK_CULL_MODE_NONE;
+    if (dynamicStateFlags & DYNAMIC_STATE_FRONT_FACE_BIT)
+        graphicsPipelineCreateInfo.rasterizer.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    if (dynamicStateFlags & DYNAMIC_STATE_DEPTH_TEST_ENABLE_BIT)
         graphicsPipelineCreateInfo.depthStencil.depthTestEnable = VK_FALSE;
+    if (dynamicStateFlags & DYNAMIC_STATE_DEPTH_WRITE_ENABLE_BIT)
         graphicsPipelineCreateInfo.depthStencil.depthWriteEnable = VK_FALSE;
-        graphicsPipelineCreateInfo.depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
-        graphicsPipelineCreateInfo.depthStencil.depthBoundsTestEnable = VK_FALSE;
-        graphicsPipelineCreateInfo.depthStencil.minDepthBounds = 0.0f;
-        graphicsPipelineCreateInfo.depthStencil.maxDepthBounds = 1.0f;
-        graphicsPipelineCreateInfo.depthStencil.stencilTestEnable = VK_FALSE;
-        graphicsPipelineCreateInfo.depthStencil.front = {};
-        graphicsPipelineCreateInfo.depthStencil.back = {};
+    if (dynamicStateFlags & DYNAMIC_STATE_DEPTH_COMPARE_OP_BIT)
+        graphicsPipelineCreateInfo.depthStencil.depthCompareOp = VK_COMPARE_OP_NEVER;
+
+    for (uint32_t i = 0; i < pass->GetColorAttachmentCount(); ++i) {
+        VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+        colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        colorBlendAttachment.blendEnable = VK_FALSE;
+        colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+        colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+        colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+        graphicsPipelineCreateInfo.blendAttachmentStates.push_back(colorBlendAttachment);
+    }
 
-        if (pass->GetDepthStencilAttachment() != VURL_NULL_HANDLE) {
-            graphicsPipelineCreateInfo.depthStencil.depthTestEnable = VK_TRUE;
-            graphicsPipelineCreateInfo.depthStencil.depthWriteEnable = VK_TRUE;
+    graphicsPipelineCreateInfo.colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    graphicsPipelineCreateInfo.colorBlending.logicOpEnable = VK_FALSE;
+    graphicsPipelineCreateInfo.colorBlending.logicOp = VK_LOGIC_OP_COPY; // Optional
+    graphicsPipelineCreateInfo.colorBlending.attachmentCount = (uint32_t)graphicsPipelineCreateInfo.blendAttachmentStates.size();
+    graphicsPipelineCreateInfo.colorBlending.pAttachments = graphicsPipelineCreateInfo.blendAttachmentStates.data();
+    graphicsPipelineCreateInfo.colorBlending.blendConstants[0] = 0.0f; // Optional
+    graphicsPipelineCreateInfo.colorBlending.blendConstants[1] = 0.0f; // Optional
+    graphicsPipelineCreateInfo.colorBlending.blendConstants[2] = 0.0f; // Optional
+    graphicsPipelineCreateInfo.colorBlending.blendConstants[3] = 0.0f; // Optional
+
+    std::shared_ptr<Shader> vertexShader = graphicsPipeline->GetVertexShader();
+    std::shared_ptr<Shader> fragmentShader = graphicsPipeline->GetFragmentShader();
+
+    VkPipelineShaderStageCreateInfo vertexStageCreateInfo{};
+    vertexStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    vertexStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+    vertexStageCreateInfo.module = vertexShader->GetShaderModule();
+    vertexStageCreateInfo.pName = vertexShader->GetEntryPointName();
+
+    VkPipelineShaderStageCreateInfo fragmentStageCreateInfo{};
+    fragmentStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    fragmentStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    fragmentStageCreateInfo.module = fragmentShader->GetShaderModule();
+    fragmentStageCreateInfo.pName = fragmentShader->GetEntryPointName();
+
+    graphicsPipelineCreateInfo.stages.push_back(vertexStageCreateInfo);
+    graphicsPipelineCreateInfo.stages.push_back(fragmentStageCreateInfo);
+
+    for (uint32_t i = 0; i < graphicsPipelineCreateInfo.stages.size(); ++i) {
+        VkPipelineShaderStageCreateInfo& stage = graphicsPipelineCreateInfo.stages[i];
+        SpecializationData& specialization = graphicsPipelineCreateInfo.specializations[i];
+        if (GetSpecializationInfo(graphicsPipeline, stage.stage, specialization))
+            stage.pSpecializationInfo = &specialization.info;
+    }
+
+    graphicsPipelineCreateInfo.pipelineLayout = graphicsPipeline->GetPipelineLayout();
+
+    VkGraphicsPipelineCreateInfo& pipelineCreateInfo = graphicsPipelineCreateInfo.pipelineCreateInfo;
+    pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipelineCreateInfo.stageCount = (uint32_t)graphicsPipelineCreateInfo.stages.size();
+    pipelineCreateInfo.pStages = graphicsPipelineCreateInfo.stages.data();
+    pipelineCreateInfo.pVertexInputState = &graphicsPipelineCreateInfo.vertexInputInfo;
+    pipelineCreateInfo.pInputAssemblyState = &graphicsPipelineCreateInfo.inputAssembly;
+    pipelineCreateInfo.pViewportState = &graphicsPipelineCreateInfo.viewportState;
+    pipelineCreateInfo.pRasterizationState = &graphicsPipelineCreateInfo.rasterizer;
+    pipelineCreateInfo.pMultisampleState = &graphicsPipelineCreateInfo.multisampling;
+    pipelineCreateInfo.pDepthStencilState = &graphicsPipelineCreateInfo.depthStencil;
+    pipelineCreateInfo.pColorBlendState = &graphicsPipelineCreateInfo.colorBlending;
+    pipelineCreateInfo.pDynamicState = &graphicsPipelineCreateInfo.dynamicState;
+    pipelineCreateInfo.layout = graphicsPipelineCreateInfo.pipelineLayout;
+    pipelineCreateInfo.renderPass = group->vkRenderPass;
+    pipelineCreateInfo.subpass = passIndex;
+    pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+    pipelineCreateInfo.basePipelineIndex = -1;
+}
+
+bool Vurl::RenderGraph::GetSpecializationInfo(std::shared_ptr<GraphicsPipeline> pipeline, VkShaderStageFlagBits stage, SpecializationData& specialization) {
+    specialization.mapEntries.clear();
+    specialization.data.clear();
+    pipeline->GetSpecializationData(stage, specialization.mapEntries, specialization.data);
+
+    specialization.info.mapEntryCount = (uint32_t)specialization.mapEntries.size();
+    specialization.info.pMapEntries = specialization.mapEntries.data();
+    specialization.info.dataSize = specialization.data.size() * sizeof(uint32_t);
+    specialization.info.pData = specialization.data.data();
+
+    return !specialization.mapEntries.empty();
+}
+
+Vurl::DynamicStateFlags Vurl::RenderGraph::GetSupportedDynamicStateFlags() const {
+    DynamicStateFlags flags = DYNAMIC_STATE_VIEWPORT_BIT | DYNAMIC_STATE_SCISSOR_BIT;
+    if (context->IsDeviceExtensionEnabled(DEVICE_EXTENSION_EXTENDED_DYNAMIC_STATE))
+        flags |= VURL_EXTENDED_DYNAMIC_STATE_FLAGS;
+    if (context->IsDeviceExtensionEnabled(DEVICE_EXTENSION_EXTENDED_DYNAMIC_STATE_2))
+        flags |= VURL_EXTENDED_DYNAMIC_STATE_2_FLAGS;
+    return flags;
+}
+
+
+bool Vurl::RenderGraph::BuildGraphicsPassGroupShaderObjects(GraphicsPassGroup* group) {
+    group->shaderObjectPasses.resize(group->passes.size());
+
+    for (uint32_t i = 0; i < group->passes.size(); ++i) {
+        std::shared_ptr<GraphicsPipeline> graphicsPipeline = group->passes[i]->GetGraphicsPipeline();
+        ShaderObjectPass& shaderObjectPass = group->shaderObjectPasses[i];
+
+        for (uint32_t j = 0; j < graphicsPipeline->GetVertexInputCount(); ++j) {
+            const VertexInputDescription& description = graphicsPipeline->GetVertexInput(j);
+
+            VkVertexInputBindingDescription2EXT bindingDescription{};
+            bindingDescription.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_BINDING_DESCRIPTION_2_EXT;
+            bindingDescription.binding = j;
+            bindingDescription.stride = description.GetStride();
+            bindingDescription.inputRate = description.GetInputRate();
+            bindingDescription.divisor = 1;
+            shaderObjectPass.vertexBindings.push_back(bindingDescription);
+
+            for (uint32_t k = 0; k < description.GetAttributeCount(); ++k) {
+                const VertexInputAttributeDescription& attribute = description.GetAttribute(k);
+
+                VkVertexInputAttributeDescription2EXT attributeDescription{};
+                attributeDescription.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT;
+                attributeDescription.location = attribute.location;
+                attributeDescription.binding = j;
+                attributeDescription.format = attribute.GetVkFormat();
+                attributeDescription.offset = attribute.offset;
+                shaderObjectPass.vertexAttributes.push_back(attributeDescription);
+            }
         }
 
-        for (uint32_t i = 0; i < pass->GetColorAttachmentCount(); ++i) {
-            VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-            colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-            colorBlendAttachment.blendEnable = VK_FALSE;
-            colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-            colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-            colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-            colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-            colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-            colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-            graphicsPipelineCreateInfo.blendAttachmentStates.push_back(colorBlendAttachment);
-        }
-
-        graphicsPipelineCreateInfo.colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-        graphicsPipelineCreateInfo.colorBlending.logicOpEnable = VK_FALSE;
-        graphicsPipelineCreateInfo.colorBlending.logicOp = VK_LOGIC_OP_COPY; // Optional
-        graphicsPipelineCreateInfo.colorBlending.attachmentCount = (uint32_t)graphicsPipelineCreateInfo.blendAttachmentStates.size();
-        graphicsPipelineCreateInfo.colorBlending.pAttachments = graphicsPipelineCreateInfo.blendAttachmentStates.data();
-        graphicsPipelineCreateInfo.colorBlending.blendConstants[0] = 0.0f; // Optional
-        graphicsPipelineCreateInfo.colorBlending.blendConstants[1] = 0.0f; // Optional
-        graphicsPipelineCreateInfo.colorBlending.blendConstants[2] = 0.0f; // Optional
-        graphicsPipelineCreateInfo.colorBlending.blendConstants[3] = 0.0f; // Optional
-
-        std::shared_ptr<Shader> vertexShader = graphicsPipeline->GetVertexShader();
-        std::shared_ptr<Shader> fragmentShader = graphicsPipeline->GetFragmentShader();
-
-        VkPipelineShaderStageCreateInfo vertexStageCreateInfo{};
-        vertexStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        vertexStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-        vertexStageCreateInfo.module = vertexShader->GetShaderModule();
-        vertexStageCreateInfo.pName = vertexShader->GetEntryPointName();
-
-        VkPipelineShaderStageCreateInfo fragmentStageCreateInfo{};
-        fragmentStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        fragmentStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-        fragmentStageCreateInfo.module = fragmentShader->GetShaderModule();
-        fragmentStageCreateInfo.pName = fragmentShader->GetEntryPointName();
-
-        graphicsPipelineCreateInfo.stages.push_back(vertexStageCreateInfo);
-        graphicsPipelineCreateInfo.stages.push_back(fragmentStageCreateInfo);
-
-        graphicsPipelineCreateInfo.pipelineLayout = graphicsPipeline->GetPipelineLayout();
-
-        VkGraphicsPipelineCreateInfo pipelineCreateInfo{};
-        pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineCreateInfo.stageCount = (uint32_t)graphicsPipelineCreateInfo.stages.size();
-        pipelineCreateInfo.pStages = graphicsPipelineCreateInfo.stages.data();
-        pipelineCreateInfo.pVertexInputState = &graphicsPipelineCreateInfo.vertexInputInfo;
-        pipelineCreateInfo.pInputAssemblyState = &graphicsPipelineCreateInfo.inputAssembly;
-        pipelineCreateInfo.pViewportState = &graphicsPipelineCreateInfo.viewportState;
-        pipelineCreateInfo.pRasterizationState = &graphicsPipelineCreateInfo.rasterizer;
-        pipelineCreateInfo.pMultisampleState = &graphicsPipelineCreateInfo.multisampling;
-        pipelineCreateInfo.pDepthStencilState = &graphicsPipelineCreateInfo.depthStencil;
-        pipelineCreateInfo.pColorBlendState = &graphicsPipelineCreateInfo.colorBlending;
-        pipelineCreateInfo.pDynamicState = &graphicsPipelineCreateInfo.dynamicState;
-        pipelineCreateInfo.layout = graphicsPipelineCreateInfo.pipelineLayout;
-        pipelineCreateInfo.renderPass = group->vkRenderPass;
-        pipelineCreateInfo.subpass = i;
-        pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
-        pipelineCreateInfo.basePipelineIndex = -1;
-
-        vkGraphicsPipelineCreateInfo.push_back(pipelineCreateInfo);
+        std::shared_ptr<Shader> shaders[VURL_GRAPHICS_SHADER_STAGE_COUNT] = { graphicsPipeline->GetVertexShader(), graphicsPipeline->GetFragmentShader() };
+        VkShaderCreateInfoEXT shaderCreateInfos[VURL_GRAPHICS_SHADER_STAGE_COUNT]{};
+        SpecializationData specializations[VURL_GRAPHICS_SHADER_STAGE_COUNT]{};
+
+        for (uint32_t j = 0; j < VURL_GRAPHICS_SHADER_STAGE_COUNT; ++j) {
+            shaderCreateInfos[j].sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT;
+            shaderCreateInfos[j].flags = VK_SHADER_CREATE_LINK_STAGE_BIT_EXT;
+            shaderCreateInfos[j].stage = graphicsShaderStages[j];
+            shaderCreateInfos[j].nextStage = j + 1 < VURL_GRAPHICS_SHADER_STAGE_COUNT ? graphicsShaderStages[j + 1] : 0;
+            shaderCreateInfos[j].codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT;
+            shaderCreateInfos[j].codeSize = shaders[j]->GetCodeSize();
+            shaderCreateInfos[j].pCode = shaders[j]->GetCode();
+            shaderCreateInfos[j].pName = shaders[j]->GetEntryPointName();
+            shaderCreateInfos[j].setLayoutCount = graphicsPipeline->GetDescriptorSetLayoutCount();
+            shaderCreateInfos[j].pSetLayouts = graphicsPipeline->GetDescriptorSetLayouts();
+            shaderCreateInfos[j].pushConstantRangeCount = graphicsPipeline->GetPushConstantRangeCount();
+            shaderCreateInfos[j].pPushConstantRanges = graphicsPipeline->GetPushConstantRanges();
+            if (GetSpecializationInfo(graphicsPipeline, graphicsShaderStages[j], specializations[j]))
+                shaderCreateInfos[j].pSpecializationInfo = &specializations[j].info;
+        }
 
-        ++i;
+        if (vkCreateShadersEXT(context->GetDevice(), VURL_GRAPHICS_SHADER_STAGE_COUNT, shaderCreateInfos, nullptr, shaderObjectPass.shaders) != VK_SUCCESS)
+            return false;
+    }
+
+    return true;
+}
+
+bool Vurl::RenderGraph::BuildComputePasses() {
+    computePasses.clear();
+    for (uint32_t passIndex : sortedPasses) {
+        if (passes[passIndex]->GetPassType() != PassType::Compute)
+            continue;
+        ComputePassData& computePass = computePasses.emplace_back();
+        computePass.pass = std::static_pointer_cast<ComputePass>(passes[passIndex]);
+    }
+
+    if (computePasses.empty())
+        return true;
+
+    std::vector<SpecializationData> specializations(computePasses.size());
+    std::vector<VkComputePipelineCreateInfo> vkComputePipelineCreateInfos{};
+    std::vector<std::string> missingVariantKeys{};
+
+    //Only compile variants that aren't cached yet, all in one call
+    for (uint32_t i = 0; i < computePasses.size(); ++i) {
+        std::shared_ptr<ComputePipeline> computePipeline = computePasses[i].pass->GetComputePipeline();
+        if (!BuildPassDescriptorSets(computePasses[i].pass->GetStorageBuffers(), computePasses[i].pass->GetStorageImages(), 
+                computePipeline->GetDescriptorSetLayout(0), [&computePipeline](uint32_t binding) { 
+                    return computePipeline->FindDescriptorBinding(0, binding); 
+                }, computePasses[i].descriptorSets))
+            return false;
+
+        computePasses[i].specializationHash = computePasses[i].pass->GetComputePipeline()->GetSpecializationHash();
+
+        std::string key = GetComputePipelineVariantKey(&computePasses[i]);
+        if (pipelineVariants.count(key) || std::find(missingVariantKeys.begin(), missingVariantKeys.end(), key) != missingVariantKeys.end())
+            continue;
+        missingVariantKeys.push_back(key);
+        FillComputePipelineCreateInfo(&computePasses[i], specializations[i], vkComputePipelineCreateInfos.emplace_back());
+    }
+
+    std::vector<VkPipeline> createdPipelines(vkComputePipelineCreateInfos.size());
+    if (!createdPipelines.empty() && vkCreateComputePipelines(context->GetDevice(), pipelineCache, (uint32_t)vkComputePipelineCreateInfos.size(), 
+            vkComputePipelineCreateInfos.data(), nullptr, createdPipelines.data()) != VK_SUCCESS)
+        return false;
+
+    for (uint32_t i = 0; i < createdPipelines.size(); ++i)
+        pipelineVariants[missingVariantKeys[i]] = createdPipelines[i];
+
+    for (auto& computePass : computePasses)
+        computePass.pipeline = pipelineVariants[GetComputePipelineVariantKey(&computePass)];
+
+    return true;
+}
+
+bool Vurl::RenderGraph::BuildPassDescriptorSets(const std::vector<StorageBinding<BufferHandle>>& storageBuffers, 
+        const std::vector<StorageBinding<TextureHandle>>& storageImages, VkDescriptorSetLayout setLayout, 
+        const std::function<const ShaderDescriptorBinding*(uint32_t)>& findBinding, PassDescriptorSets& descriptorSets) {
+    uint32_t bindingCount = (uint32_t)(storageBuffers.size() + storageImages.size());
+    if (bindingCount == 0)
+        return true;
+
+    if (setLayout == VK_NULL_HANDLE)
+        return false;
+
+    if (!descriptorSetAllocator)
+        descriptorSetAllocator = std::make_shared<DescriptorSetAllocator>(context->GetDevice());
+
+    //One descriptor set per combination of resource slices, like framebuffers
+    uint32_t descriptorSetCount = 1;
+    for (const StorageBinding<BufferHandle>& storageBuffer : storageBuffers) {
+        const ShaderDescriptorBinding* binding = findBinding(storageBuffer.binding);
+        if (!binding || binding->descriptorType != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+            return false;
+        descriptorSetCount = std::lcm(descriptorSetCount, buffers[storageBuffer.handle]->GetSliceCount());
+    }
+
+    for (const StorageBinding<TextureHandle>& storageImage : storageImages) {
+        const ShaderDescriptorBinding* binding = findBinding(storageImage.binding);
+        if (!binding || binding->descriptorType != VK_DESCRIPTOR_TYPE_STORAGE_IMAGE)
+            return false;
+        descriptorSetCount = std::lcm(descriptorSetCount, textures[storageImage.handle]->GetSliceCount());
+        descriptorSets.usesBackBuffer |= storageImage.handle == backBufferTexture;
+    }
+
+    std::vector<VkDescriptorSetLayout> setLayouts(descriptorSetCount, setLayout);
+    descriptorSets.sets.resize(descriptorSetCount);
+    if (!descriptorSetAllocator->Allocate(descriptorSets.sets.data(), setLayouts.data(), descriptorSetCount))
+        return false;
+
+    std::vector<VkDescriptorBufferInfo> bufferInfos(storageBuffers.size());
+    std::vector<VkDescriptorImageInfo> imageInfos(storageImages.size());
+    std::vector<VkWriteDescriptorSet> descriptorWrites(bindingCount);
+
+    for (uint32_t i = 0; i < descriptorSetCount; ++i) {
+        for (uint32_t j = 0; j < storageBuffers.size(); ++j) {
+            const StorageBinding<BufferHandle>& storageBuffer = storageBuffers[j];
+
+            std::shared_ptr<Buffer> slice = buffers[storageBuffer.handle]->GetResourceSlice(i);
+            bufferInfos[j].buffer = slice->vkBuffer;
+            bufferInfos[j].offset = slice->hostImportOffset;
+            bufferInfos[j].range = slice->importedMemory != VK_NULL_HANDLE ? slice->size : VK_WHOLE_SIZE;
+
+            descriptorWrites[j] = {};
+            descriptorWrites[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[j].dstSet = descriptorSets.sets[i];
+            descriptorWrites[j].dstBinding = storageBuffer.binding;
+            descriptorWrites[j].descriptorCount = 1;
+            descriptorWrites[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[j].pBufferInfo = &bufferInfos[j];
+        }
+
+        for (uint32_t j = 0; j < storageImages.size(); ++j) {
+            const StorageBinding<TextureHandle>& storageImage = storageImages[j];
+            VkWriteDescriptorSet& descriptorWrite = descriptorWrites[storageBuffers.size() + j];
+
+            imageInfos[j].sampler = VK_NULL_HANDLE;
+            imageInfos[j].imageView = textures[storageImage.handle]->GetResourceSlice(i)->vkImageView;
+            imageInfos[j].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            descriptorWrite = {};
+            descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrite.dstSet = descriptorSets.sets[i];
+            descriptorWrite.dstBinding = storageImage.binding;
+            descriptorWrite.descriptorCount = 1;
+            descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            descriptorWrite.pImageInfo = &imageInfos[j];
+        }
+
+        vkUpdateDescriptorSets(context->GetDevice(), (uint32_t)descriptorWrites.size(), descriptorWrites.data(), 0, nullptr);
+    }
+
+    return true;
+}
+
+void Vurl::RenderGraph::FillComputePipelineCreateInfo(ComputePassData* computePass, SpecializationData& specialization, VkComputePipelineCreateInfo& createInfo) {
+    std::shared_ptr<ComputePipeline> computePipeline = computePass->pass->GetComputePipeline();
+    std::shared_ptr<Shader> computeShader = computePipeline->GetComputeShader();
+
+    specialization.mapEntries.clear();
+    specialization.data.clear();
+    computePipeline->GetSpecializationData(specialization.mapEntries, specialization.data);
+
+    specialization.info.mapEntryCount = (uint32_t)specialization.mapEntries.size();
+    specialization.info.pMapEntries = specialization.mapEntries.data();
+    specialization.info.dataSize = specialization.data.size() * sizeof(uint32_t);
+    specialization.info.pData = specialization.data.data();
+
+    createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    createInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    createInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    createInfo.stage.module = computeShader->GetShaderModule();
+    createInfo.stage.pName = computeShader->GetEntryPointName();
+    createInfo.stage.pSpecializationInfo = specialization.mapEntries.empty() ? nullptr : &specialization.info;
+    createInfo.layout = computePipeline->GetPipelineLayout();
+}
+
+std::string Vurl::RenderGraph::GetComputePipelineVariantKey(ComputePassData* computePass) {
+    HashKey key{};
+    key.U32((uint32_t)PassType::Compute);
+    computePass->pass->GetComputePipeline()->Hash(key);
+    return key.Get();
+}
+
+bool Vurl::RenderGraph::UpdateComputePassPipelineVariant(ComputePassData* computePass) {
+    computePass->specializationHash = computePass->pass->GetComputePipeline()->GetSpecializationHash();
+
+    std::string key = GetComputePipelineVariantKey(computePass);
+    auto it = pipelineVariants.find(key);
+    if (it == pipelineVariants.end()) {
+        SpecializationData specialization{};
+        VkComputePipelineCreateInfo createInfo{};
+        FillComputePipelineCreateInfo(computePass, specialization, createInfo);
+
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        if (vkCreateComputePipelines(context->GetDevice(), pipelineCache, 1, &createInfo, nullptr, &pipeline) != VK_SUCCESS)
+            return false;
+        it = pipelineVariants.emplace(key, pipeline).first;
+    }
+
+    computePass->pipeline = it->second;
+    return true;
+}
+
+bool Vurl::RenderGraph::BuildPassBarriers() {
+    std::unordered_map<TextureHandle, ResourceState> textureStates{};
+    std::unordered_map<BufferHandle, ResourceState> bufferStates{};
+    std::unordered_set<TextureHandle> writtenTextures{};
+    std::unordered_set<TextureHandle> usedTextures{};
+    std::unordered_set<BufferHandle> usedBuffers{};
+    std::unordered_map<TextureHandle, VkImageLayout> initialLayouts{};
+    uint32_t graphicsPassGroupIndex = 0;
+    uint32_t computePassIndex = 0;
+
+    //Resources enter a frame in the state the previous frame left them in, a dry run finds it
+    for (uint32_t passIndex : sortedPasses) {
+        for (const PassResourceAccess& access : passResourceAccesses[passIndex]) {
+            UpdateResourceState(access, (access.isTexture ? textureStates : bufferStates)[access.handle], false, nullptr);
+            if (access.isTexture && access.write)
+                writtenTextures.insert(access.handle);
+        }
+    }
+
+    executionSteps.clear();
+    transferPassBatches.clear();
+    asyncTransferPassBatch = VURL_NULL_HANDLE;
+    for (uint32_t passIndex : sortedPasses) {
+        PassType passType = passes[passIndex]->GetPassType();
+        uint32_t stepIndex = executionSteps.size();
+
+        if (passType == PassType::Transfer) {
+            stepIndex = GetTransferPassBatchStep(passIndex);
+        } else {
+            PassExecutionStep& step = executionSteps.emplace_back();
+            step.passIndex = passIndex;
+            step.passType = passType;
+            step.index = passType == PassType::Compute ? computePassIndex++ : graphicsPassGroupIndex++;
+        }
+
+        for (const PassResourceAccess& access : passResourceAccesses[passIndex]) {
+            ResourceState& state = access.isTexture ? textureStates[access.handle] : bufferStates[access.handle];
+            bool firstUse = access.isTexture ? usedTextures.insert(access.handle).second : usedBuffers.insert(access.handle).second;
+
+            //The very first frame has nothing to wrap around from, images the graph writes start in the wrapped layout.
+            //Images it only reads are expected in the layout of their first access.
+            if (firstUse && access.isTexture && access.read && writtenTextures.count(access.handle) && state.layout != VK_IMAGE_LAYOUT_UNDEFINED && access.handle != backBufferTexture)
+                initialLayouts[access.handle] = state.layout;
+
+            UpdateResourceState(access, state, firstUse, &executionSteps[stepIndex]);
+        }
+    }
+
+    if (initialLayouts.empty())
+        return true;
+
+    std::vector<VkImageMemoryBarrier> barriers{};
+    for (auto& e : initialLayouts) {
+        std::shared_ptr<Resource<Texture>> texture = textures[e.first];
+        for (uint32_t i = 0; i < texture->GetSliceCount(); ++i) {
+            VkImageMemoryBarrier barrier = GetAttachmentBarrier(texture->GetResourceSlice(i), VK_IMAGE_LAYOUT_UNDEFINED, e.second);
+            barrier.srcAccessMask = 0;
+            barrier.dstAccessMask = 0;
+            barriers.push_back(barrier);
+        }
+    }
+
+    VkCommandBuffer commandBuffer = BeginTransientCommandBuffer();
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 
+            (uint32_t)barriers.size(), barriers.data());
+    SubmitAndEndTransientCommandBuffer(commandBuffer);
+
+    return true;
+}
+
+void Vurl::RenderGraph::UpdateResourceState(const PassResourceAccess& access, ResourceState& state, bool firstUse, PassExecutionStep* step) {
+    VkImageLayout oldLayout = firstUse && !access.read ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+    bool layoutTransition = access.isTexture && oldLayout != access.layout;
+    bool needsBarrier = false;
+    VkPipelineStageFlags srcStageMask = 0;
+    VkAccessFlags srcAccessMask = 0;
+
+    if (access.write || layoutTransition) {
+        //Replacing the version or its layout waits for its writer and every reader
+        srcStageMask = state.writeStageMask | state.readStageMask;
+        srcAccessMask = state.writeAccessMask;
+        needsBarrier = true;
+
+        state.writeStageMask = access.stageMask;
+        state.writeAccessMask = access.write ? access.accessMask : 0;
+        state.readStageMask = access.write ? 0 : access.stageMask;
+        state.readAccessMask = access.write ? 0 : access.accessMask;
+    } else if (access.read && ((access.stageMask & ~state.readStageMask) || (access.accessMask & ~state.readAccessMask))) {
+        //First read of this version from these stages, reads already made visible need nothing
+        if (state.writeStageMask != 0) {
+            srcStageMask = state.writeStageMask;
+            srcAccessMask = state.writeAccessMask;
+            needsBarrier = true;
+        }
+        state.readStageMask |= access.stageMask;
+        state.readAccessMask |= access.accessMask;
+    }
+
+    state.layout = access.layout;
+
+    if (!needsBarrier || step == nullptr)
+        return;
+
+    step->srcStageMask |= srcStageMask != 0 ? srcStageMask : (VkPipelineStageFlags)VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+    step->dstStageMask |= access.stageMask;
+
+    PassBarrier& barrier = step->barriers.emplace_back();
+    barrier.isTexture = access.isTexture;
+    barrier.handle = access.handle;
+    barrier.srcAccessMask = srcAccessMask;
+    barrier.dstAccessMask = access.accessMask;
+    barrier.oldLayout = access.isTexture ? oldLayout : VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = access.layout;
+}
+
+uint32_t Vurl::RenderGraph::GetTransferPassBatchStep(uint32_t passIndex) {
+    bool async = IsAsyncTransferPass(passIndex);
+
+    //Async passes share each other's resources with nobody, they always fit into the one async batch
+    if (async && asyncTransferPassBatch != VURL_NULL_HANDLE) {
+        transferPassBatches[asyncTransferPassBatch].passIndices.push_back(passIndex);
+        return transferPassBatches[asyncTransferPassBatch].stepIndex;
+    }
+
+    //Others only join the batch right before them
+    if (!async && !executionSteps.empty() && executionSteps.back().passType == PassType::Transfer) {
+        TransferPassBatch& previousBatch = transferPassBatches[executionSteps.back().index];
+        if (!previousBatch.async && CanJoinTransferPassBatch(previousBatch, passIndex)) {
+            previousBatch.passIndices.push_back(passIndex);
+            return previousBatch.stepIndex;
+        }
     }
 
-    group->pipelines.resize(vkGraphicsPipelineCreateInfo.size());
-    return (vkCreateGraphicsPipelines(context->GetDevice(), pipelineCache, (uint32_t)vkGraphicsPipelineCreateInfo.size(), 
-            vkGraphicsPipelineCreateInfo.data(), nullptr, group->pipelines.data()) == VK_SUCCESS);
+    TransferPassBatch& batch = transferPassBatches.emplace_back();
+    batch.passIndices.push_back(passIndex);
+    batch.stepIndex = executionSteps.size();
+    batch.async = async;
+    if (async)
+        asyncTransferPassBatch = (int)transferPassBatches.size() - 1;
+
+    PassExecutionStep& step = executionSteps.emplace_back();
+    step.passIndex = passIndex;
+    step.passType = PassType::Transfer;
+    step.index = transferPassBatches.size() - 1;
+
+    return batch.stepIndex;
 }
 
+bool Vurl::RenderGraph::CanJoinTransferPassBatch(const TransferPassBatch& batch, uint32_t passIndex) {
+    //The batch records all barriers up front, so no pass in it may touch what another one writes
+    for (uint32_t batchPassIndex : batch.passIndices)
+        for (const PassResourceAccess& batchAccess : passResourceAccesses[batchPassIndex])
+            for (const PassResourceAccess& access : passResourceAccesses[passIndex])
+                if (batchAccess.isTexture == access.isTexture && batchAccess.handle == access.handle && (batchAccess.write || access.write))
+                    return false;
+    return true;
+}
+
+bool Vurl::RenderGraph::IsAsyncTransferPass(uint32_t passIndex) {
+    //Nothing in the frame waits on the pass and it waits on nothing, so it may overlap the whole frame
+    if (!context->HasDedicatedTransferQueue() || !culledDirectedPassesGraph[passIndex].empty() || 
+            std::find(beginPasses.begin(), beginPasses.end(), passIndex) == beginPasses.end())
+        return false;
+
+    //Images and exclusive buffers would need queue family ownership transfers
+    if (!std::static_pointer_cast<TransferPass>(passes[passIndex])->IsBufferOnly())
+        return false;
+
+    for (const PassResourceAccess& access : passResourceAccesses[passIndex]) {
+        std::shared_ptr<Resource<Buffer>> buffer = buffers[access.handle];
+        for (uint32_t i = 0; i < buffer->GetSliceCount(); ++i)
+            if (buffer->GetResourceSlice(i)->sharingMode != VK_SHARING_MODE_CONCURRENT)
+                return false;
+    }
+
+    return true;
+}
 
 bool Vurl::RenderGraph::BuildCommandBuffers() {
     VkCommandPoolCreateInfo poolCreateInfo{};
@@ -798,6 +2500,17 @@ bool Vurl::RenderGraph::BuildCommandBuffers() {
     if (vkAllocateCommandBuffers(context->GetDevice(), &bufferAllocInfo, primaryCommandBuffers) != VK_SUCCESS)
         return false;
 
+    if (asyncTransferPassBatch == VURL_NULL_HANDLE)
+        return true;
+
+    poolCreateInfo.queueFamilyIndex = context->GetQueueInfo().familyIndices[QUEUE_INDEX_TRANSFER];
+    if (vkCreateCommandPool(context->GetDevice(), &poolCreateInfo, nullptr, &transferCommandPool) != VK_SUCCESS)
+        return false;
+
+    bufferAllocInfo.commandPool = transferCommandPool;
+    if (vkAllocateCommandBuffers(context->GetDevice(), &bufferAllocInfo, transferCommandBuffers) != VK_SUCCESS)
+        return false;
+
     return true;
 }
 
@@ -809,10 +2522,19 @@ bool Vurl::RenderGraph::BuildSynchronizationObjects() {
     inFlightFenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     inFlightFenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
+    //Kept across rebuilds, only the first build and the first one with an async transfer batch create them
     for (uint32_t i = 0; i < VURL_MAX_FRAMES_IN_FLIGHT; ++i) {
-        vkCreateSemaphore(context->GetDevice(), &semaphoreCreateInfo, nullptr, &availableSwapchainImageSemaphores[i]);
-        vkCreateSemaphore(context->GetDevice(), &semaphoreCreateInfo, nullptr, &renderFinishedSemaphores[i]);
-        vkCreateFence(context->GetDevice(), &inFlightFenceCreateInfo, nullptr, &inFlightFences[i]);
+        if (inFlightFences[i] == VK_NULL_HANDLE) {
+            vkCreateSemaphore(context->GetDevice(), &semaphoreCreateInfo, nullptr, &availableSwapchainImageSemaphores[i]);
+            vkCreateSemaphore(context->GetDevice(), &semaphoreCreateInfo, nullptr, &renderFinishedSemaphores[i]);
+            vkCreateFence(context->GetDevice(), &inFlightFenceCreateInfo, nullptr, &inFlightFences[i]);
+        }
+
+        if (asyncTransferPassBatch != VURL_NULL_HANDLE && transferFences[i] == VK_NULL_HANDLE) {
+            vkCreateSemaphore(context->GetDevice(), &semaphoreCreateInfo, nullptr, &transferFinishedSemaphores[i]);
+            vkCreateSemaphore(context->GetDevice(), &semaphoreCreateInfo, nullptr, &uploadFinishedSemaphores[i]);
+            vkCreateFence(context->GetDevice(), &inFlightFenceCreateInfo, nullptr, &transferFences[i]);
+        }
     }
 
     return true;
@@ -820,18 +2542,43 @@ bool Vurl::RenderGraph::BuildSynchronizationObjects() {
 
 void Vurl::RenderGraph::DestroyGraphicsPassGroups() {
     for (auto& group : graphicsPassGroups) {
-        for (uint32_t i = 0; i < group.pipelines.size(); ++i)
-            vkDestroyPipeline(context->GetDevice(), group.pipelines[i], nullptr);
         for (uint32_t i = 0; i < group.framebuffers.size(); ++i)
-            vkDestroyFramebuffer(context->GetDevice(), group.framebuffers[i], nullptr);
-        vkDestroyRenderPass(context->GetDevice(), group.vkRenderPass, nullptr);
+            deletionQueue->DestroyFramebuffer(group.framebuffers[i]);
+        for (auto& shaderObjectPass : group.shaderObjectPasses)
+            for (uint32_t i = 0; i < VURL_GRAPHICS_SHADER_STAGE_COUNT; ++i)
+                deletionQueue->DestroyShader(shaderObjectPass.shaders[i]);
+        deletionQueue->DestroyRenderPass(group.vkRenderPass);
     }
 
     graphicsPassGroups.clear();
+
+    //Linked pipelines are owned by the pipeline library, the rest by the variant cache
+    for (auto& e : pipelineVariants)
+        deletionQueue->DestroyPipeline(e.second);
+    pipelineVariants.clear();
+}
+
+void Vurl::RenderGraph::DestroyComputePasses() {
+    //Compute pipelines live in the variant cache with the graphics ones
+    computePasses.clear();
+    executionSteps.clear();
+}
+
+void Vurl::RenderGraph::DestroyDescriptorSetAllocator() {
+    //Graphics and compute pass descriptor sets all come from here, freeing the pools frees them
+    if (descriptorSetAllocator) {
+        std::shared_ptr<DescriptorSetAllocator> allocator = descriptorSetAllocator;
+        deletionQueue->Push([allocator]() { allocator->Destroy(); });
+        descriptorSetAllocator = nullptr;
+    }
 }
 
 void Vurl::RenderGraph::DestroyCommandBuffers() {
-    vkDestroyCommandPool(context->GetDevice(), commandPool, nullptr);
+    //Frees the command buffers of the frames in flight along with the pools
+    deletionQueue->DestroyCommandPool(commandPool);
+    commandPool = VK_NULL_HANDLE;
+    deletionQueue->DestroyCommandPool(transferCommandPool);
+    transferCommandPool = VK_NULL_HANDLE;
 }
 
 void Vurl::RenderGraph::DestroySynchronizationObjects() {
@@ -839,14 +2586,48 @@ void Vurl::RenderGraph::DestroySynchronizationObjects() {
         vkDestroySemaphore(context->GetDevice(), availableSwapchainImageSemaphores[i], nullptr);
         vkDestroySemaphore(context->GetDevice(), renderFinishedSemaphores[i], nullptr);
         vkDestroyFence(context->GetDevice(), inFlightFences[i], nullptr);
+        vkDestroySemaphore(context->GetDevice(), transferFinishedSemaphores[i], nullptr);
+        vkDestroySemaphore(context->GetDevice(), uploadFinishedSemaphores[i], nullptr);
+        vkDestroyFence(context->GetDevice(), transferFences[i], nullptr);
+        availableSwapchainImageSemaphores[i] = VK_NULL_HANDLE;
+        renderFinishedSemaphores[i] = VK_NULL_HANDLE;
+        inFlightFences[i] = VK_NULL_HANDLE;
+        transferFinishedSemaphores[i] = VK_NULL_HANDLE;
+        uploadFinishedSemaphores[i] = VK_NULL_HANDLE;
+        transferFences[i] = VK_NULL_HANDLE;
+        transferSubmitted[i] = false;
     }
+
+    pendingTransferSemaphoreIndex = VURL_NULL_HANDLE;
+}
+
+void Vurl::RenderGraph::RetireTexture(const Texture& texture) {
+    deletionQueue->DestroyImageView(texture.vkImageView);
+    deletionQueue->DestroyImage(texture.vkImage, texture.allocation);
+}
+
+void Vurl::RenderGraph::RetireBuffer(const Buffer& buffer) {
+    if (buffer.importedMemory == VK_NULL_HANDLE) {
+        deletionQueue->DestroyBuffer(buffer.vkBuffer, buffer.allocation);
+        return;
+    }
+
+    //Imported buffers own their memory outside of the allocator, the host memory is released after it
+    VkDevice device = context->GetDevice();
+    VkBuffer vkBuffer = buffer.vkBuffer;
+    VkDeviceMemory memory = buffer.importedMemory;
+    std::shared_ptr<void> owner = buffer.hostMemoryOwner;
+    deletionQueue->Push([device, vkBuffer, memory, owner]() {
+        vkDestroyBuffer(device, vkBuffer, nullptr);
+        vkFreeMemory(device, memory, nullptr);
+    });
 }
 
 bool Vurl::RenderGraph::ExecuteGraphicsPassGroup(GraphicsPassGroup* group, VkCommandBuffer commandBuffer, uint32_t swapchainImageIndex) {
     VkRenderPassBeginInfo renderPassBeginInfo{};
     renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
     renderPassBeginInfo.renderPass = group->vkRenderPass;
-    if (group->minSwapchainColorAttachmentSubpassIndex != -1)
+    if (group->minSwapchainColorAttachmentSubpassIndex != VURL_INVALID_PASS_INDEX)
         renderPassBeginInfo.framebuffer = group->framebuffers[swapchainImageIndex];
     else
         renderPassBeginInfo.framebuffer = group->framebuffers[frameIndex % group->framebuffers.size()];
@@ -858,8 +2639,20 @@ bool Vurl::RenderGraph::ExecuteGraphicsPassGroup(GraphicsPassGroup* group, VkCom
     vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
     for (uint32_t i = 0; i < group->passes.size(); ++i) {
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, group->pipelines[i]);
-        group->passes[i]->GetRenderingCallback()(commandBuffer, frameIndex);
+        //Specialization values changed since the last frame, switch to the matching variant
+        if (group->passes[i]->GetGraphicsPipeline()->GetSpecializationHash() != group->specializationHashes[i])
+            UpdateGraphicsPassPipelineVariant(group, i);
+
+        //Swap in the optimized link as soon as the background compilation is done
+        if (!group->linkedPipelineIds.empty() && group->linkedPipelineIds[i] != 0)
+            group->pipelines[i] = pipelineLibrary->GetLinkedPipeline(group->linkedPipelineIds[i]);
+
+        //Consecutive passes sharing a pipeline keep it bound
+        commandEncoder.ResetStatistics();
+        commandEncoder.BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, group->pipelines[i]);
+        SetGraphicsPassDynamicState(group, i);
+        RecordGraphicsPass(group, i, swapchainImageIndex);
+        group->passes[i]->SetCommandStatistics(commandEncoder.GetStatistics());
     }
 
     vkCmdEndRenderPass(commandBuffer);
@@ -867,6 +2660,610 @@ bool Vurl::RenderGraph::ExecuteGraphicsPassGroup(GraphicsPassGroup* group, VkCom
     return true;
 }
 
+void Vurl::RenderGraph::RecordGraphicsPass(GraphicsPassGroup* group, uint32_t passIndex, uint32_t swapchainImageIndex) {
+    std::shared_ptr<GraphicsPass> pass = group->passes[passIndex];
+    const PassDescriptorSets& descriptorSets = group->descriptorSets[passIndex];
+
+    if (!descriptorSets.sets.empty()) {
+        uint64_t sliceIndex = descriptorSets.usesBackBuffer ? swapchainImageIndex : frameIndex;
+        commandEncoder.BindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, pass->GetGraphicsPipeline()->GetPipelineLayout(), 0, 1, 
+                &descriptorSets.sets[sliceIndex % descriptorSets.sets.size()]);
+    }
+
+    if (pass->GetRenderingCallback())
+        pass->GetRenderingCallback()(commandEncoder, frameIndex);
+
+    if (!pass->HasIndexedIndirectDraw())
+        return;
+
+    //The draw count comes from the GPU, the CPU cost doesn't depend on how many draws survive
+    const IndexedIndirectDraw& draw = pass->GetIndexedIndirectDraw();
+    std::shared_ptr<Buffer> vertexSlice = buffers[draw.vertexBuffer]->GetResourceSlice(frameIndex);
+    std::shared_ptr<Buffer> indexSlice = buffers[draw.indexBuffer]->GetResourceSlice(frameIndex);
+    std::shared_ptr<Buffer> indirectSlice = buffers[draw.indirectBuffer]->GetResourceSlice(frameIndex);
+    VkBuffer vertexBuffer = vertexSlice->vkBuffer;
+    VkDeviceSize vertexBufferOffset = vertexSlice->hostImportOffset;
+    commandEncoder.BindVertexBuffers(0, 1, &vertexBuffer, &vertexBufferOffset);
+    commandEncoder.BindIndexBuffer(indexSlice->vkBuffer, indexSlice->hostImportOffset, draw.indexType);
+    VkBuffer indirectBuffer = indirectSlice->vkBuffer;
+    VkDeviceSize indirectOffset = indirectSlice->hostImportOffset;
+
+    if (draw.countBuffer != VURL_NULL_HANDLE) {
+        std::shared_ptr<Buffer> countSlice = buffers[draw.countBuffer]->GetResourceSlice(frameIndex);
+        commandEncoder.DrawIndexedIndirectCount(indirectBuffer, indirectOffset, countSlice->vkBuffer, countSlice->hostImportOffset, 
+                draw.maxDrawCount, sizeof(VkDrawIndexedIndirectCommand));
+        return;
+    }
+
+    //Without a count every command is drawn, the producer zeroes the ones it culls
+    if (context->IsDeviceFeatureEnabled(DEVICE_FEATURE_MULTI_DRAW_INDIRECT)) {
+        commandEncoder.DrawIndexedIndirect(indirectBuffer, indirectOffset, draw.maxDrawCount, sizeof(VkDrawIndexedIndirectCommand));
+        return;
+    }
+
+    for (uint32_t i = 0; i < draw.maxDrawCount; ++i)
+        commandEncoder.DrawIndexedIndirect(indirectBuffer, indirectOffset + i * sizeof(VkDrawIndexedIndirectCommand), 1, 
+                sizeof(VkDrawIndexedIndirectCommand));
+}
+
+void Vurl::RenderGraph::SetGraphicsPassDynamicState(GraphicsPassGroup* group, uint32_t passIndex) {
+    DynamicStateFlags flags = group->dynamicStateFlags[passIndex];
+    if (flags == 0)
+        return;
+
+    std::shared_ptr<GraphicsPass> pass = group->passes[passIndex];
+    std::shared_ptr<GraphicsPipeline> graphicsPipeline = pass->GetGraphicsPipeline();
+    bool hasDepthStencilAttachment = pass->GetDepthStencilAttachment() != VURL_NULL_HANDLE;
+
+    if (flags & DYNAMIC_STATE_VIEWPORT_BIT)
+        commandEncoder.SetViewport(group->viewport);
+    if (flags & DYNAMIC_STATE_SCISSOR_BIT)
+        commandEncoder.SetScissor(group->scissor);
+    if (flags & DYNAMIC_STATE_PRIMITIVE_TOPOLOGY_BIT)
+        commandEncoder.SetPrimitiveTopology(graphicsPipeline->GetPipelinePrimitiveTopology());
+    if (flags & DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE_BIT)
+        commandEncoder.SetPrimitiveRestartEnable(graphicsPipeline->IsPipelinePrimitiveRestartEnabled());
+    if (flags & DYNAMIC_STATE_CULL_MODE_BIT)
+        commandEncoder.SetCullMode(graphicsPipeline->GetPipelineCullMode());
+    if (flags & DYNAMIC_STATE_FRONT_FACE_BIT)
+        commandEncoder.SetFrontFace(graphicsPipeline->GetPipelineFrontFace());
+    if (flags & DYNAMIC_STATE_DEPTH_TEST_ENABLE_BIT)
+        commandEncoder.SetDepthTestEnable(hasDepthStencilAttachment && graphicsPipeline->IsPipelineDepthTestEnabled());
+    if (flags & DYNAMIC_STATE_DEPTH_WRITE_ENABLE_BIT)
+        commandEncoder.SetDepthWriteEnable(hasDepthStencilAttachment && graphicsPipeline->IsPipelineDepthWriteEnabled());
+    if (flags & DYNAMIC_STATE_DEPTH_COMPARE_OP_BIT)
+        commandEncoder.SetDepthCompareOp(graphicsPipeline->GetPipelineDepthCompareOp());
+}
+
+bool Vurl::RenderGraph::ExecuteGraphicsPassGroupShaderObjects(GraphicsPassGroup* group, VkCommandBuffer commandBuffer, uint32_t swapchainImageIndex) {
+    std::unordered_set<TextureHandle> renderedAttachments{};
+
+    for (uint32_t i = 0; i < group->passes.size(); ++i) {
+        std::shared_ptr<GraphicsPass> pass = group->passes[i];
+        std::vector<VkImageMemoryBarrier> barriers{};
+        std::vector<VkRenderingAttachmentInfoKHR> colorAttachments(pass->GetColorAttachmentCount());
+        VkRenderingAttachmentInfoKHR depthStencilAttachment{};
+
+        for (uint32_t j = 0; j < pass->GetColorAttachmentCount(); ++j) {
+            TextureHandle h = pass->GetColorAttachment(j);
+            bool firstUse = renderedAttachments.insert(h).second;
+            std::shared_ptr<Texture> slice = GetAttachmentSlice(h, swapchainImageIndex);
+
+            barriers.push_back(GetAttachmentBarrier(slice, firstUse ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                    VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL));
+
+            colorAttachments[j].sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+            colorAttachments[j].imageView = slice->vkImageView;
+            colorAttachments[j].imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            colorAttachments[j].loadOp = firstUse ? group->attachmentDescriptions[h].loadOp : VK_ATTACHMENT_LOAD_OP_LOAD;
+            colorAttachments[j].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            colorAttachments[j].clearValue = group->attachmentClearValues[h];
+        }
+
+        if (pass->GetDepthStencilAttachment() != VURL_NULL_HANDLE) {
+            TextureHandle h = pass->GetDepthStencilAttachment();
+            bool firstUse = renderedAttachments.insert(h).second;
+            std::shared_ptr<Texture> slice = GetAttachmentSlice(h, swapchainImageIndex);
+
+            barriers.push_back(GetAttachmentBarrier(slice, firstUse ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                    VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL));
+
+            depthStencilAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+            depthStencilAttachment.imageView = slice->vkImageView;
+            depthStencilAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            depthStencilAttachment.loadOp = firstUse ? group->attachmentDescriptions[h].loadOp : VK_ATTACHMENT_LOAD_OP_LOAD;
+            depthStencilAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            depthStencilAttachment.clearValue = group->attachmentClearValues[h];
+        }
+
+        vkCmdPipelineBarrier(commandBuffer, VURL_ATTACHMENT_STAGES, VURL_ATTACHMENT_STAGES, 0, 0, nullptr, 0, nullptr, 
+                (uint32_t)barriers.size(), barriers.data());
+
+        VkRenderingInfoKHR renderingInfo{};
+        renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+        renderingInfo.renderArea = group->scissor;
+        renderingInfo.layerCount = 1;
+        renderingInfo.colorAttachmentCount = (uint32_t)colorAttachments.size();
+        renderingInfo.pColorAttachments = colorAttachments.data();
+        renderingInfo.pDepthAttachment = depthStencilAttachment.imageView != VK_NULL_HANDLE ? &depthStencilAttachment : nullptr;
+
+        vkCmdBeginRenderingKHR(commandBuffer, &renderingInfo);
+        vkCmdBindShadersEXT(commandBuffer, VURL_GRAPHICS_SHADER_STAGE_COUNT, graphicsShaderStages, group->shaderObjectPasses[i].shaders);
+        SetGraphicsPassShaderObjectState(group, i, commandBuffer);
+
+        //Shaders and their state are recorded directly, the encoder can't assume anything it set before
+        commandEncoder.Invalidate();
+        commandEncoder.ResetStatistics();
+        RecordGraphicsPass(group, i, swapchainImageIndex);
+        pass->SetCommandStatistics(commandEncoder.GetStatistics());
+        vkCmdEndRenderingKHR(commandBuffer);
+    }
+
+    if (group->minSwapchainColorAttachmentSubpassIndex != VURL_INVALID_PASS_INDEX) {
+        VkImageMemoryBarrier barrier = GetAttachmentBarrier(GetAttachmentSlice(backBufferTexture, swapchainImageIndex), 
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+        barrier.dstAccessMask = 0;
+        vkCmdPipelineBarrier(commandBuffer, VURL_ATTACHMENT_STAGES, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    return true;
+}
+
+void Vurl::RenderGraph::SetGraphicsPassShaderObjectState(GraphicsPassGroup* group, uint32_t passIndex, VkCommandBuffer commandBuffer) {
+    //Shader objects have no baked state, everything the draw consumes must be set
+    std::shared_ptr<GraphicsPass> pass = group->passes[passIndex];
+    std::shared_ptr<GraphicsPipeline> graphicsPipeline = pass->GetGraphicsPipeline();
+    const ShaderObjectPass& shaderObjectPass = group->shaderObjectPasses[passIndex];
+    bool hasDepthStencilAttachment = pass->GetDepthStencilAttachment() != VURL_NULL_HANDLE;
+
+    vkCmdSetVertexInputEXT(commandBuffer, (uint32_t)shaderObjectPass.vertexBindings.size(), shaderObjectPass.vertexBindings.data(),
+            (uint32_t)shaderObjectPass.vertexAttributes.size(), shaderObjectPass.vertexAttributes.data());
+    vkCmdSetPrimitiveTopologyEXT(commandBuffer, graphicsPipeline->GetPipelinePrimitiveTopology());
+    vkCmdSetPrimitiveRestartEnableEXT(commandBuffer, graphicsPipeline->IsPipelinePrimitiveRestartEnabled());
+
+    vkCmdSetViewportWithCountEXT(commandBuffer, 1, &group->viewport);
+    vkCmdSetScissorWithCountEXT(commandBuffer, 1, &group->scissor);
+
+    vkCmdSetRasterizerDiscardEnableEXT(commandBuffer, VK_FALSE);
+    vkCmdSetPolygonModeEXT(commandBuffer, VK_POLYGON_MODE_FILL);
+    vkCmdSetCullModeEXT(commandBuffer, graphicsPipeline->GetPipelineCullMode());
+    vkCmdSetFrontFaceEXT(commandBuffer, graphicsPipeline->GetPipelineFrontFace());
+    vkCmdSetDepthBiasEnableEXT(commandBuffer, VK_FALSE);
+
+    VkSampleMask sampleMask = ~0u;
+    vkCmdSetRasterizationSamplesEXT(commandBuffer, VK_SAMPLE_COUNT_1_BIT);
+    vkCmdSetSampleMaskEXT(commandBuffer, VK_SAMPLE_COUNT_1_BIT, &sampleMask);
+    vkCmdSetAlphaToCoverageEnableEXT(commandBuffer, VK_FALSE);
+
+    vkCmdSetDepthTestEnableEXT(commandBuffer, hasDepthStencilAttachment && graphicsPipeline->IsPipelineDepthTestEnabled());
+    vkCmdSetDepthWriteEnableEXT(commandBuffer, hasDepthStencilAttachment && graphicsPipeline->IsPipelineDepthWriteEnabled());
+    vkCmdSetDepthCompareOpEXT(commandBuffer, graphicsPipeline->GetPipelineDepthCompareOp());
+    vkCmdSetDepthBoundsTestEnableEXT(commandBuffer, VK_FALSE);
+    vkCmdSetStencilTestEnableEXT(commandBuffer, VK_FALSE);
+
+    uint32_t colorAttachmentCount = pass->GetColorAttachmentCount();
+    if (colorAttachmentCount == 0)
+        return;
+
+    std::vector<VkBool32> blendEnables(colorAttachmentCount, VK_FALSE);
+    std::vector<VkColorComponentFlags> writeMasks(colorAttachmentCount, 
+            VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT);
+    vkCmdSetColorBlendEnableEXT(commandBuffer, 0, colorAttachmentCount, blendEnables.data());
+    vkCmdSetColorWriteMaskEXT(commandBuffer, 0, colorAttachmentCount, writeMasks.data());
+}
+
+bool Vurl::RenderGraph::ExecuteComputePass(ComputePassData* computePass, uint32_t swapchainImageIndex) {
+    std::shared_ptr<ComputePass> pass = computePass->pass;
+    std::shared_ptr<ComputePipeline> computePipeline = pass->GetComputePipeline();
+
+    //Specialization values changed since the last frame, switch to the matching variant
+    if (computePipeline->GetSpecializationHash() != computePass->specializationHash)
+        UpdateComputePassPipelineVariant(computePass);
+
+    commandEncoder.ResetStatistics();
+    commandEncoder.BindPipeline(VK_PIPELINE_BIND_POINT_COMPUTE, computePass->pipeline);
+
+    const PassDescriptorSets& descriptorSets = computePass->descriptorSets;
+    if (!descriptorSets.sets.empty()) {
+        uint64_t sliceIndex = descriptorSets.usesBackBuffer ? swapchainImageIndex : frameIndex;
+        commandEncoder.BindDescriptorSets(VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline->GetPipelineLayout(), 0, 1, 
+                &descriptorSets.sets[sliceIndex % descriptorSets.sets.size()]);
+    }
+
+    if (pass->GetDispatchCallback())
+        pass->GetDispatchCallback()(commandEncoder, frameIndex);
+    else
+        commandEncoder.Dispatch(pass->GetGroupCount(0), pass->GetGroupCount(1), pass->GetGroupCount(2));
+
+    pass->SetCommandStatistics(commandEncoder.GetStatistics());
+
+    return true;
+}
+
+bool Vurl::RenderGraph::ExecuteTransferPassBatch(TransferPassBatch* batch, VkCommandBuffer commandBuffer, uint32_t swapchainImageIndex) {
+    //Copies between the same pair of resources go out as one command for the whole batch
+    std::map<std::pair<VkBuffer, VkBuffer>, std::vector<VkBufferCopy>> bufferCopies{};
+    std::map<std::pair<VkBuffer, VkImage>, std::vector<VkBufferImageCopy>> bufferImageCopies{};
+    std::unordered_map<VkImage, VkImageLayout> bufferImageCopyLayouts{};
+
+    for (uint32_t passIndex : batch->passIndices) {
+        std::shared_ptr<TransferPass> pass = std::static_pointer_cast<TransferPass>(passes[passIndex]);
+
+        for (uint32_t i = 0; i < pass->GetOperationCount(); ++i) {
+            const TransferOperation& operation = pass->GetOperation(i);
+
+            switch (operation.type) {
+                case TransferOperationType::CopyBuffer: {
+                    std::shared_ptr<Buffer> src = GetBufferSlice(operation.src);
+                    std::shared_ptr<Buffer> dst = GetBufferSlice(operation.dst);
+
+                    VkBufferCopy region{};
+                    region.srcOffset = src->hostImportOffset + operation.srcOffset;
+                    region.dstOffset = dst->hostImportOffset + operation.dstOffset;
+                    region.size = operation.size != VK_WHOLE_SIZE ? operation.size : 
+                            std::min(src->size - operation.srcOffset, dst->size - operation.dstOffset);
+                    bufferCopies[{ src->vkBuffer, dst->vkBuffer }].push_back(region);
+                    break;
+                }
+                case TransferOperationType::CopyBufferToImage: {
+                    std::shared_ptr<Buffer> src = GetBufferSlice(operation.src);
+                    std::shared_ptr<Texture> dst = GetAttachmentSlice(operation.dst, swapchainImageIndex);
+
+                    VkBufferImageCopy region{};
+                    region.bufferOffset = src->hostImportOffset + operation.srcOffset;
+                    region.imageSubresource.aspectMask = dst->aspectMask;
+                    region.imageSubresource.layerCount = dst->arrayLayers;
+                    region.imageExtent = { dst->width, dst->height, dst->depth };
+                    bufferImageCopies[{ src->vkBuffer, dst->vkImage }].push_back(region);
+                    bufferImageCopyLayouts[dst->vkImage] = GetPassTextureLayout(passIndex, operation.dst);
+                    break;
+                }
+                case TransferOperationType::CopyImage: {
+                    std::shared_ptr<Texture> src = GetAttachmentSlice(operation.src, swapchainImageIndex);
+                    std::shared_ptr<Texture> dst = GetAttachmentSlice(operation.dst, swapchainImageIndex);
+
+                    VkImageCopy region{};
+                    region.srcSubresource.aspectMask = src->aspectMask;
+                    region.srcSubresource.layerCount = std::min(src->arrayLayers, dst->arrayLayers);
+                    region.dstSubresource.aspectMask = dst->aspectMask;
+                    region.dstSubresource.layerCount = region.srcSubresource.layerCount;
+                    region.extent = { std::min(src->width, dst->width), std::min(src->height, dst->height), std::min(src->depth, dst->depth) };
+                    vkCmdCopyImage(commandBuffer, src->vkImage, GetPassTextureLayout(passIndex, operation.src), 
+                            dst->vkImage, GetPassTextureLayout(passIndex, operation.dst), 1, &region);
+                    break;
+                }
+                case TransferOperationType::BlitImage: {
+                    std::shared_ptr<Texture> src = GetAttachmentSlice(operation.src, swapchainImageIndex);
+                    std::shared_ptr<Texture> dst = GetAttachmentSlice(operation.dst, swapchainImageIndex);
+
+                    VkImageBlit region{};
+                    region.srcSubresource.aspectMask = src->aspectMask;
+                    region.srcSubresource.layerCount = std::min(src->arrayLayers, dst->arrayLayers);
+                    region.srcOffsets[1] = { (int32_t)src->width, (int32_t)src->height, (int32_t)src->depth };
+                    region.dstSubresource.aspectMask = dst->aspectMask;
+                    region.dstSubresource.layerCount = region.srcSubresource.layerCount;
+                    region.dstOffsets[1] = { (int32_t)dst->width, (int32_t)dst->height, (int32_t)dst->depth };
+                    vkCmdBlitImage(commandBuffer, src->vkImage, GetPassTextureLayout(passIndex, operation.src), 
+                            dst->vkImage, GetPassTextureLayout(passIndex, operation.dst), 1, &region, operation.filter);
+                    break;
+                }
+                case TransferOperationType::FillBuffer: {
+                    //The whole size of an imported buffer would run past the imported data to the end of the aligned range
+                    std::shared_ptr<Buffer> dst = GetBufferSlice(operation.dst);
+                    VkDeviceSize size = operation.size == VK_WHOLE_SIZE && dst->importedMemory != VK_NULL_HANDLE ? 
+                            (dst->size - operation.dstOffset) & ~(VkDeviceSize)3 : operation.size;
+                    vkCmdFillBuffer(commandBuffer, dst->vkBuffer, dst->hostImportOffset + operation.dstOffset, size, operation.fillData);
+                    break;
+                }
+                case TransferOperationType::ClearImage: {
+                    std::shared_ptr<Texture> dst = GetAttachmentSlice(operation.dst, swapchainImageIndex);
+
+                    VkImageSubresourceRange range{};
+                    range.aspectMask = dst->aspectMask;
+                    range.levelCount = VK_REMAINING_MIP_LEVELS;
+                    range.layerCount = VK_REMAINING_ARRAY_LAYERS;
+                    vkCmdClearColorImage(commandBuffer, dst->vkImage, GetPassTextureLayout(passIndex, operation.dst), &operation.clearColor, 1, &range);
+                    break;
+                }
+            }
+        }
+    }
+
+    for (auto& e : bufferCopies)
+        vkCmdCopyBuffer(commandBuffer, e.first.first, e.first.second, (uint32_t)e.second.size(), e.second.data());
+
+    for (auto& e : bufferImageCopies)
+        vkCmdCopyBufferToImage(commandBuffer, e.first.first, e.first.second, bufferImageCopyLayouts[e.first.second], 
+                (uint32_t)e.second.size(), e.second.data());
+
+    return true;
+}
+
+bool Vurl::RenderGraph::SubmitAsyncTransferPassBatch(uint32_t inFlightFrameIndex, uint32_t swapchainImageIndex, VkSemaphore waitSemaphore) {
+    if (asyncTransferPassBatch == VURL_NULL_HANDLE)
+        return false;
+
+    TransferPassBatch& batch = transferPassBatches[asyncTransferPassBatch];
+    VkCommandBuffer commandBuffer = transferCommandBuffers[inFlightFrameIndex];
+
+    vkResetCommandBuffer(commandBuffer, 0);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+        return false;
+
+    RecordPassBarriers(executionSteps[batch.stepIndex], commandBuffer, swapchainImageIndex);
+    ExecuteTransferPassBatch(&batch, commandBuffer, swapchainImageIndex);
+
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+        return false;
+
+    VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.waitSemaphoreCount = waitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+    submitInfo.pWaitSemaphores = &waitSemaphore;
+    submitInfo.pWaitDstStageMask = &waitStage;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &transferFinishedSemaphores[inFlightFrameIndex];
+
+    vkResetFences(context->GetDevice(), 1, &transferFences[inFlightFrameIndex]);
+
+    if (vkQueueSubmit(context->GetQueueInfo().queues[QUEUE_INDEX_TRANSFER], 1, &submitInfo, transferFences[inFlightFrameIndex]) != VK_SUCCESS)
+        return false;
+
+    transferSubmitted[inFlightFrameIndex] = true;
+    return true;
+}
+
+void Vurl::RenderGraph::RecordPendingBufferCopies(VkCommandBuffer commandBuffer) {
+    if (pendingBufferCopies.empty())
+        return;
+
+    //Updates may land in buffers earlier frames still read
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    for (const PendingBufferCopy& copy : pendingBufferCopies) {
+        if (copy.barrierBefore) {
+            VkMemoryBarrier copyBarrier{};
+            copyBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            copyBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            copyBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 1, &copyBarrier, 0, nullptr, 0, nullptr);
+        }
+        vkCmdCopyBuffer(commandBuffer, copy.srcBuffer, copy.dstBuffer, 1, &copy.region);
+    }
+
+    //Committed data may be read by any stage of the frame
+    barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    pendingBufferCopies.clear();
+}
+
+void Vurl::RenderGraph::RecordPendingTextureCopies(VkCommandBuffer commandBuffer) {
+    if (pendingTextureCopies.empty())
+        return;
+
+    //Earlier frames may still sample the old images, the new ones have no contents yet
+    std::vector<VkImageMemoryBarrier> barriers{};
+    for (const PendingTextureCopy& copy : pendingTextureCopies) {
+        VkImageMemoryBarrier barrier = GetAttachmentBarrier(copy.srcSlice, GetTextureUploadLayout(copy.srcSlice), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barriers.push_back(barrier);
+
+        barrier = GetAttachmentBarrier(copy.dstSlice, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 
+            (uint32_t)barriers.size(), barriers.data());
+
+    for (const PendingTextureCopy& copy : pendingTextureCopies)
+        vkCmdCopyImage(commandBuffer, copy.srcSlice->vkImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, copy.dstSlice->vkImage, 
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)copy.regions.size(), copy.regions.data());
+
+    barriers.clear();
+    for (const PendingTextureCopy& copy : pendingTextureCopies) {
+        VkImageMemoryBarrier barrier = GetAttachmentBarrier(copy.dstSlice, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, GetTextureUploadLayout(copy.dstSlice));
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        barriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 
+            (uint32_t)barriers.size(), barriers.data());
+
+    pendingTextureCopies.clear();
+}
+
+void Vurl::RenderGraph::RecordPendingTextureUploads(VkCommandBuffer commandBuffer) {
+    if (pendingTextureUploads.empty())
+        return;
+
+    //Barriers of every texture go out together, so the whole batch costs one barrier per step and mip level
+    std::vector<VkImageMemoryBarrier> barriers{};
+    uint32_t maxGeneratedMipLevels = 0;
+
+    for (PendingTextureUpload& upload : pendingTextureUploads) {
+        upload.generateMips = upload.generateMips && upload.slice->mipLevels > 1 && CanGenerateMips(upload.slice);
+        if (upload.generateMips)
+            maxGeneratedMipLevels = std::max(maxGeneratedMipLevels, upload.slice->mipLevels);
+
+        VkImageMemoryBarrier barrier = GetAttachmentBarrier(upload.slice, upload.oldLayout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 
+            (uint32_t)barriers.size(), barriers.data());
+
+    for (const PendingTextureUpload& upload : pendingTextureUploads)
+        for (const auto& copy : upload.copies)
+            vkCmdCopyBufferToImage(commandBuffer, copy.first, upload.slice->vkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy.second);
+
+    //Each level is blitted from the one above it once that one is complete
+    for (uint32_t level = 1; level < maxGeneratedMipLevels; ++level) {
+        barriers.clear();
+        for (const PendingTextureUpload& upload : pendingTextureUploads) {
+            if (!upload.generateMips || level >= upload.slice->mipLevels)
+                continue;
+
+            VkImageMemoryBarrier barrier = GetAttachmentBarrier(upload.slice, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+            barrier.subresourceRange.baseMipLevel = level - 1;
+            barrier.subresourceRange.levelCount = 1;
+            barriers.push_back(barrier);
+        }
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 
+                (uint32_t)barriers.size(), barriers.data());
+
+        for (const PendingTextureUpload& upload : pendingTextureUploads) {
+            if (!upload.generateMips || level >= upload.slice->mipLevels)
+                continue;
+
+            std::shared_ptr<Texture> slice = upload.slice;
+            VkImageBlit region{};
+            region.srcSubresource.aspectMask = slice->aspectMask;
+            region.srcSubresource.mipLevel = level - 1;
+            region.srcSubresource.layerCount = slice->arrayLayers;
+            region.srcOffsets[1] = { (int32_t)std::max(slice->width >> (level - 1), 1u), (int32_t)std::max(slice->height >> (level - 1), 1u), 
+                    (int32_t)std::max(slice->depth >> (level - 1), 1u) };
+            region.dstSubresource.aspectMask = slice->aspectMask;
+            region.dstSubresource.mipLevel = level;
+            region.dstSubresource.layerCount = slice->arrayLayers;
+            region.dstOffsets[1] = { (int32_t)std::max(slice->width >> level, 1u), (int32_t)std::max(slice->height >> level, 1u), 
+                    (int32_t)std::max(slice->depth >> level, 1u) };
+            vkCmdBlitImage(commandBuffer, slice->vkImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slice->vkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 
+                    1, &region, VK_FILTER_LINEAR);
+        }
+    }
+
+    //Generated textures have every level but the last one as a blit source
+    barriers.clear();
+    for (const PendingTextureUpload& upload : pendingTextureUploads) {
+        VkImageLayout layout = GetTextureUploadLayout(upload.slice);
+        uint32_t sourceLevelCount = upload.generateMips ? upload.slice->mipLevels - 1 : 0;
+
+        VkImageMemoryBarrier barrier = GetAttachmentBarrier(upload.slice, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, layout);
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+        barrier.subresourceRange.baseMipLevel = sourceLevelCount;
+        barrier.subresourceRange.levelCount = upload.slice->mipLevels - sourceLevelCount;
+        barriers.push_back(barrier);
+
+        if (sourceLevelCount == 0)
+            continue;
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = 0;
+        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.levelCount = sourceLevelCount;
+        barriers.push_back(barrier);
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 0, nullptr, 0, nullptr, 
+            (uint32_t)barriers.size(), barriers.data());
+
+    pendingTextureUploads.clear();
+}
+
+VkImageLayout Vurl::RenderGraph::GetPassTextureLayout(uint32_t passIndex, TextureHandle h) {
+    for (const PassResourceAccess& access : passResourceAccesses[passIndex])
+        if (access.isTexture && access.handle == h)
+            return access.layout;
+    return VK_IMAGE_LAYOUT_GENERAL;
+}
+
+void Vurl::RenderGraph::RecordPassBarriers(const PassExecutionStep& step, VkCommandBuffer commandBuffer, uint32_t swapchainImageIndex) {
+    if (step.barriers.empty())
+        return;
+
+    std::vector<VkBufferMemoryBarrier> bufferBarriers{};
+    std::vector<VkImageMemoryBarrier> imageBarriers{};
+
+    for (const PassBarrier& passBarrier : step.barriers) {
+        if (passBarrier.isTexture) {
+            VkImageMemoryBarrier barrier = GetAttachmentBarrier(GetAttachmentSlice(passBarrier.handle, swapchainImageIndex), 
+                    passBarrier.oldLayout, passBarrier.newLayout);
+            barrier.srcAccessMask = passBarrier.srcAccessMask;
+            barrier.dstAccessMask = passBarrier.dstAccessMask;
+            imageBarriers.push_back(barrier);
+            continue;
+        }
+
+        VkBufferMemoryBarrier& barrier = bufferBarriers.emplace_back();
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = passBarrier.srcAccessMask;
+        barrier.dstAccessMask = passBarrier.dstAccessMask;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = GetBufferSlice(passBarrier.handle)->vkBuffer;
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+    }
+
+    vkCmdPipelineBarrier(commandBuffer, step.srcStageMask, step.dstStageMask, 0, 0, nullptr, 
+            (uint32_t)bufferBarriers.size(), bufferBarriers.data(), (uint32_t)imageBarriers.size(), imageBarriers.data());
+}
+
+VkImageLayout Vurl::RenderGraph::GetAttachmentLayout(TextureHandle h, bool inputAttachment) {
+    if (!inputAttachment)
+        return h == backBufferTexture ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    return (textures[h]->GetResourceSlice(0)->aspectMask & VK_IMAGE_ASPECT_DEPTH_BIT) ? 
+            VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+}
+
+std::shared_ptr<Vurl::Texture> Vurl::RenderGraph::GetAttachmentSlice(TextureHandle h, uint32_t swapchainImageIndex) {
+    std::shared_ptr<Resource<Texture>> texture = textures[h];
+    if (h == backBufferTexture)
+        return texture->GetResourceSlice(swapchainImageIndex);
+    return texture->GetResourceSlice(frameIndex % texture->GetSliceCount());
+}
+
+std::shared_ptr<Vurl::Buffer> Vurl::RenderGraph::GetBufferSlice(BufferHandle h) {
+    std::shared_ptr<Resource<Buffer>> buffer = buffers[h];
+    return buffer->GetResourceSlice(frameIndex % buffer->GetSliceCount());
+}
+
+VkImageMemoryBarrier Vurl::RenderGraph::GetAttachmentBarrier(std::shared_ptr<Texture> slice, VkImageLayout oldLayout, VkImageLayout newLayout) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | 
+            VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = slice->vkImage;
+    barrier.subresourceRange.aspectMask = slice->aspectMask;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = slice->mipLevels;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = slice->arrayLayers;
+    return barrier;
+}
+
 VkCommandBuffer Vurl::RenderGraph::BeginTransientCommandBuffer() {
     VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
 
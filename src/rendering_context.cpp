@@ -3,6 +3,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <vector>
+#include <algorithm>
 #include <iostream>
 
 Vurl::VurlResult Vurl::RenderingContext::CreateInstance(const VkApplicationInfo* applicationInfo, const char** instanceExtensions, 
@@ -118,23 +119,100 @@ Vurl::VurlResult Vurl::RenderingContext::CreateDevice(VkSurfaceKHR surface, VkPh
 
     enabledDeviceExtensions = requiredDeviceExtensions;
 
+    uint32_t availableExtensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(selectedDevice, nullptr, &availableExtensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(availableExtensionCount);
+    vkEnumerateDeviceExtensionProperties(selectedDevice, nullptr, &availableExtensionCount, availableExtensions.data());
+
+    VkPhysicalDeviceFeatures2 supportedFeatures{};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+
+    for (uint32_t i = 0; i < DEVICE_EXTENSION_MAX; ++i) {
+        std::vector<const char*> names{};
+        GetOptionalDeviceExtensionNames((DeviceExtension)i, names);
+
+        enabledOptionalDeviceExtensions[i] = true;
+        for (const char* name : names)
+            if (!HasExtension(availableExtensions.data(), availableExtensionCount, name))
+                enabledOptionalDeviceExtensions[i] = false;
+
+        if (enabledOptionalDeviceExtensions[i])
+            supportedFeatures.pNext = ChainOptionalDeviceExtensionFeatures((DeviceExtension)i, supportedFeatures.pNext);
+    }
+
+    VkPhysicalDeviceVulkan12Features supportedVulkan12Features{};
+    supportedVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    if (vulkanApiVersion >= VK_API_VERSION_1_2) {
+        supportedVulkan12Features.pNext = supportedFeatures.pNext;
+        supportedFeatures.pNext = &supportedVulkan12Features;
+    }
+
+    vkGetPhysicalDeviceFeatures2(selectedDevice, &supportedFeatures);
+
+    VkPhysicalDeviceFeatures2 enabledFeatures{};
+    enabledFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+
+    for (uint32_t i = 0; i < DEVICE_EXTENSION_MAX; ++i) {
+        if (!enabledOptionalDeviceExtensions[i])
+            continue;
+
+        //Extension is exposed but the feature we need from it is not
+        if (!HasOptionalDeviceExtensionFeatures((DeviceExtension)i)) {
+            enabledOptionalDeviceExtensions[i] = false;
+            continue;
+        }
+
+        std::vector<const char*> names{};
+        GetOptionalDeviceExtensionNames((DeviceExtension)i, names);
+        for (const char* name : names)
+            if (std::find_if(enabledDeviceExtensions.begin(), enabledDeviceExtensions.end(), 
+                    [name](const char* e) { return strcmp(e, name) == 0; }) == enabledDeviceExtensions.end())
+                enabledDeviceExtensions.push_back(name);
+
+        enabledFeatures.pNext = ChainOptionalDeviceExtensionFeatures((DeviceExtension)i, enabledFeatures.pNext);
+    }
+
     QueueInfo selectedDeviceQueueinfo = GetPhysicalDeviceQueueInfo(surface, selectedDevice);
 
     float queuePriority = 1.0f;
 
-    VkDeviceQueueCreateInfo queueCreateInfo{};
-    queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-    queueCreateInfo.queueFamilyIndex = selectedDeviceQueueinfo.familyIndices[QUEUE_INDEX_GRAPHICS];
-    queueCreateInfo.queueCount = 1;
-    queueCreateInfo.pQueuePriorities = &queuePriority;
+    VkDeviceQueueCreateInfo queueCreateInfos[2]{};
+    uint32_t queueCreateInfoCount = 1;
+    queueCreateInfos[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueCreateInfos[0].queueFamilyIndex = selectedDeviceQueueinfo.familyIndices[QUEUE_INDEX_GRAPHICS];
+    queueCreateInfos[0].queueCount = 1;
+    queueCreateInfos[0].pQueuePriorities = &queuePriority;
+
+    //Transfers share the graphics queue unless the device has a separate family for them
+    if (selectedDeviceQueueinfo.familyIndices[QUEUE_INDEX_TRANSFER] != selectedDeviceQueueinfo.familyIndices[QUEUE_INDEX_GRAPHICS]) {
+        queueCreateInfos[1] = queueCreateInfos[0];
+        queueCreateInfos[1].queueFamilyIndex = selectedDeviceQueueinfo.familyIndices[QUEUE_INDEX_TRANSFER];
+        ++queueCreateInfoCount;
+    }
 
     VkPhysicalDeviceFeatures deviceFeatures{};
+    enabledDeviceFeatures[DEVICE_FEATURE_MULTI_DRAW_INDIRECT] = supportedFeatures.features.multiDrawIndirect == VK_TRUE &&
+            supportedFeatures.features.drawIndirectFirstInstance == VK_TRUE;
+    deviceFeatures.multiDrawIndirect = supportedFeatures.features.multiDrawIndirect;
+    deviceFeatures.drawIndirectFirstInstance = supportedFeatures.features.drawIndirectFirstInstance;
+    enabledFeatures.features = deviceFeatures;
+
+    //GPU-driven draws read their draw count from a buffer
+    vulkan12Features = {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    enabledDeviceFeatures[DEVICE_FEATURE_DRAW_INDIRECT_COUNT] = supportedVulkan12Features.drawIndirectCount == VK_TRUE;
+    if (enabledDeviceFeatures[DEVICE_FEATURE_DRAW_INDIRECT_COUNT]) {
+        vulkan12Features.drawIndirectCount = VK_TRUE;
+        vulkan12Features.pNext = enabledFeatures.pNext;
+        enabledFeatures.pNext = &vulkan12Features;
+    }
     
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-    createInfo.pQueueCreateInfos = &queueCreateInfo;
-    createInfo.queueCreateInfoCount = 1;
-    createInfo.pEnabledFeatures = &deviceFeatures;
+    createInfo.pNext = &enabledFeatures;
+    createInfo.pQueueCreateInfos = queueCreateInfos;
+    createInfo.queueCreateInfoCount = queueCreateInfoCount;
+    createInfo.pEnabledFeatures = nullptr;
     createInfo.enabledLayerCount = (uint32_t)enabledValidationLayers.size();
     createInfo.ppEnabledLayerNames = enabledValidationLayers.data();
     createInfo.enabledExtensionCount = (uint32_t)enabledDeviceExtensions.size();
@@ -146,7 +224,46 @@ Vurl::VurlResult Vurl::RenderingContext::CreateDevice(VkSurfaceKHR surface, VkPh
     vkPhysicalDevice = selectedDevice;
     queueInfo = selectedDeviceQueueinfo;
 
+    //Multi draws are split into batches of at most this many draws
+    maxMultiDrawCount = 0;
+    if (enabledOptionalDeviceExtensions[DEVICE_EXTENSION_MULTI_DRAW]) {
+        VkPhysicalDeviceMultiDrawPropertiesEXT multiDrawProperties{};
+        multiDrawProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_PROPERTIES_EXT;
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &multiDrawProperties;
+        vkGetPhysicalDeviceProperties2(vkPhysicalDevice, &properties);
+        maxMultiDrawCount = multiDrawProperties.maxMultiDrawCount;
+    }
+
+    //Layouts host copies can write, queried once for the count and once for the list
+    hostImageCopyDstLayouts.clear();
+    if (enabledOptionalDeviceExtensions[DEVICE_EXTENSION_HOST_IMAGE_COPY]) {
+        VkPhysicalDeviceHostImageCopyPropertiesEXT hostImageCopyProperties{};
+        hostImageCopyProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT;
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &hostImageCopyProperties;
+        vkGetPhysicalDeviceProperties2(vkPhysicalDevice, &properties);
+        hostImageCopyDstLayouts.resize(hostImageCopyProperties.copyDstLayoutCount);
+        hostImageCopyProperties.pCopyDstLayouts = hostImageCopyDstLayouts.data();
+        vkGetPhysicalDeviceProperties2(vkPhysicalDevice, &properties);
+    }
+
+    //Imported host pointers and sizes have to be multiples of this
+    minImportedHostPointerAlignment = 0;
+    if (enabledOptionalDeviceExtensions[DEVICE_EXTENSION_EXTERNAL_MEMORY_HOST]) {
+        VkPhysicalDeviceExternalMemoryHostPropertiesEXT externalMemoryHostProperties{};
+        externalMemoryHostProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_MEMORY_HOST_PROPERTIES_EXT;
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &externalMemoryHostProperties;
+        vkGetPhysicalDeviceProperties2(vkPhysicalDevice, &properties);
+        minImportedHostPointerAlignment = externalMemoryHostProperties.minImportedHostPointerAlignment;
+    }
+
     vkGetDeviceQueue(vkDevice, queueInfo.familyIndices[QUEUE_INDEX_GRAPHICS], 0, &queueInfo.queues[QUEUE_INDEX_GRAPHICS]);
+    vkGetDeviceQueue(vkDevice, queueInfo.familyIndices[QUEUE_INDEX_TRANSFER], 0, &queueInfo.queues[QUEUE_INDEX_TRANSFER]);
 
     volkLoadDevice(vkDevice);
 
@@ -186,6 +303,9 @@ Vurl::VurlResult Vurl::RenderingContext::CreateDevice(VkSurfaceKHR surface, VkPh
 
     VmaAllocatorCreateInfo allocatorCreateInfo{};
     allocatorCreateInfo.flags = 0;
+    //VMA reads the driver's budget instead of estimating it from its own allocations
+    if (enabledOptionalDeviceExtensions[DEVICE_EXTENSION_MEMORY_BUDGET])
+        allocatorCreateInfo.flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
     allocatorCreateInfo.vulkanApiVersion = vulkanApiVersion;
     allocatorCreateInfo.physicalDevice = vkPhysicalDevice;
     allocatorCreateInfo.device = vkDevice;
@@ -198,6 +318,7 @@ Vurl::VurlResult Vurl::RenderingContext::CreateDevice(VkSurfaceKHR surface, VkPh
 }
 
 void Vurl::RenderingContext::DestroyDevice() {
+    DestroyMemoryPools();
     vmaDestroyAllocator(vmaAllocator);
     vkDeviceWaitIdle(vkDevice);
     vkDestroyDevice(vkDevice, nullptr);
@@ -230,6 +351,7 @@ Vurl::QueueInfo Vurl::RenderingContext::GetPhysicalDeviceQueueInfo(VkSurfaceKHR
     std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
     vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
+    bool hasDedicatedTransfer = false;
     for (uint32_t i = 0; i < queueFamilies.size(); ++i) {
         if (queueFamilies[i].queueFlags & VK_QUEUE_GRAPHICS_BIT && queueInfo.counts[QUEUE_INDEX_GRAPHICS] == 0) {
             VkBool32 presentSupport = false;
@@ -246,12 +368,22 @@ Vurl::QueueInfo Vurl::RenderingContext::GetPhysicalDeviceQueueInfo(VkSurfaceKHR
             queueInfo.counts[QUEUE_INDEX_COMPUTE] = queueFamilies[i].queueCount;
         }
 
-        if (queueFamilies[i].queueFlags & VK_QUEUE_TRANSFER_BIT && queueInfo.counts[QUEUE_INDEX_TRANSFER] == 0) {
+        //Prefer a transfer-only family, it maps to the copy engines and runs next to graphics work
+        bool dedicatedTransfer = !(queueFamilies[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+        if (queueFamilies[i].queueFlags & VK_QUEUE_TRANSFER_BIT && (queueInfo.counts[QUEUE_INDEX_TRANSFER] == 0 || 
+                (dedicatedTransfer && !hasDedicatedTransfer))) {
             queueInfo.familyIndices[QUEUE_INDEX_TRANSFER] = i;
             queueInfo.counts[QUEUE_INDEX_TRANSFER] = queueFamilies[i].queueCount;
+            hasDedicatedTransfer = dedicatedTransfer;
         }
     }
 
+    //Graphics families always support transfers even if they don't report it
+    if (queueInfo.counts[QUEUE_INDEX_TRANSFER] == 0) {
+        queueInfo.familyIndices[QUEUE_INDEX_TRANSFER] = queueInfo.familyIndices[QUEUE_INDEX_GRAPHICS];
+        queueInfo.counts[QUEUE_INDEX_TRANSFER] = queueInfo.counts[QUEUE_INDEX_GRAPHICS];
+    }
+
     return queueInfo;
 }
 
@@ -304,4 +436,259 @@ int Vurl::RenderingContext::RatePhysicalDevice(VkSurfaceKHR surface, VkPhysicalD
         score += 100;
 
     return score;
+}
+
+std::vector<Vurl::MemoryHeapBudget> Vurl::RenderingContext::GetMemoryHeapBudgets() const {
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(vmaAllocator, &memoryProperties);
+
+    VmaBudget vmaBudgets[VK_MAX_MEMORY_HEAPS]{};
+    vmaGetHeapBudgets(vmaAllocator, vmaBudgets);
+
+    std::vector<MemoryHeapBudget> budgets(memoryProperties->memoryHeapCount);
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; ++i) {
+        budgets[i].usage = vmaBudgets[i].usage;
+        budgets[i].budget = vmaBudgets[i].budget;
+        budgets[i].allocationBytes = vmaBudgets[i].statistics.allocationBytes;
+        budgets[i].blockBytes = vmaBudgets[i].statistics.blockBytes;
+        budgets[i].deviceLocal = (memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    }
+    return budgets;
+}
+
+uint32_t Vurl::RenderingContext::GetMemoryHeapIndex(VmaAllocation allocation) const {
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(vmaAllocator, &memoryProperties);
+
+    VmaAllocationInfo allocationInfo{};
+    vmaGetAllocationInfo(vmaAllocator, allocation, &allocationInfo);
+    return memoryProperties->memoryTypes[allocationInfo.memoryType].heapIndex;
+}
+
+void Vurl::RenderingContext::SetMemoryPoolSettings(ResourceClass resourceClass, const MemoryPoolSettings& settings) {
+    std::lock_guard<std::mutex> lock(memoryPoolMutex);
+    memoryPoolSettings[resourceClass] = settings;
+}
+
+VmaStatistics Vurl::RenderingContext::GetMemoryPoolStatistics(ResourceClass resourceClass) const {
+    VmaStatistics statistics{};
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_TYPES; ++i) {
+        if (memoryPools[resourceClass][i] == VK_NULL_HANDLE)
+            continue;
+
+        VmaStatistics poolStatistics{};
+        vmaGetPoolStatistics(vmaAllocator, memoryPools[resourceClass][i], &poolStatistics);
+        statistics.blockCount += poolStatistics.blockCount;
+        statistics.allocationCount += poolStatistics.allocationCount;
+        statistics.blockBytes += poolStatistics.blockBytes;
+        statistics.allocationBytes += poolStatistics.allocationBytes;
+    }
+    return statistics;
+}
+
+std::vector<VmaPool> Vurl::RenderingContext::GetMemoryPools(ResourceClass resourceClass) const {
+    std::vector<VmaPool> pools{};
+    for (uint32_t i = 0; i < VK_MAX_MEMORY_TYPES; ++i)
+        if (memoryPools[resourceClass][i] != VK_NULL_HANDLE)
+            pools.push_back(memoryPools[resourceClass][i]);
+    return pools;
+}
+
+VkResult Vurl::RenderingContext::AllocateBuffer(ResourceClass resourceClass, const VkBufferCreateInfo& bufferCreateInfo, 
+        const VmaAllocationCreateInfo& allocationCreateInfo, VkBuffer* buffer, VmaAllocation* allocation, VmaAllocationInfo* allocationInfo) {
+    VmaAllocationCreateInfo createInfo = allocationCreateInfo;
+    FillMemoryPoolAllocationCreateInfo(resourceClass, createInfo);
+
+    uint32_t memoryTypeIndex = 0;
+    if (resourceClass != RESOURCE_CLASS_DEFAULT && !memoryPoolSettings[resourceClass].dedicated && 
+            vmaFindMemoryTypeIndexForBufferInfo(vmaAllocator, &bufferCreateInfo, &createInfo, &memoryTypeIndex) == VK_SUCCESS) {
+        VmaAllocationCreateInfo poolCreateInfo = createInfo;
+        poolCreateInfo.pool = GetMemoryPool(resourceClass, memoryTypeIndex);
+        if (poolCreateInfo.pool != VK_NULL_HANDLE && 
+                vmaCreateBuffer(vmaAllocator, &bufferCreateInfo, &poolCreateInfo, buffer, allocation, allocationInfo) == VK_SUCCESS)
+            return VK_SUCCESS;
+    }
+
+    //Full pools fall back to the allocator's own blocks
+    return vmaCreateBuffer(vmaAllocator, &bufferCreateInfo, &createInfo, buffer, allocation, allocationInfo);
+}
+
+VkResult Vurl::RenderingContext::AllocateImage(ResourceClass resourceClass, const VkImageCreateInfo& imageCreateInfo, 
+        const VmaAllocationCreateInfo& allocationCreateInfo, VkImage* image, VmaAllocation* allocation, VmaAllocationInfo* allocationInfo) {
+    VmaAllocationCreateInfo createInfo = allocationCreateInfo;
+    FillMemoryPoolAllocationCreateInfo(resourceClass, createInfo);
+
+    uint32_t memoryTypeIndex = 0;
+    if (resourceClass != RESOURCE_CLASS_DEFAULT && !memoryPoolSettings[resourceClass].dedicated && 
+            vmaFindMemoryTypeIndexForImageInfo(vmaAllocator, &imageCreateInfo, &createInfo, &memoryTypeIndex) == VK_SUCCESS) {
+        VmaAllocationCreateInfo poolCreateInfo = createInfo;
+        poolCreateInfo.pool = GetMemoryPool(resourceClass, memoryTypeIndex);
+        if (poolCreateInfo.pool != VK_NULL_HANDLE && 
+                vmaCreateImage(vmaAllocator, &imageCreateInfo, &poolCreateInfo, image, allocation, allocationInfo) == VK_SUCCESS)
+            return VK_SUCCESS;
+    }
+
+    return vmaCreateImage(vmaAllocator, &imageCreateInfo, &createInfo, image, allocation, allocationInfo);
+}
+
+void Vurl::RenderingContext::InitMemoryPoolSettings() {
+    //Attachments are large and often resized, their own memory keeps them from splitting shared blocks
+    memoryPoolSettings[RESOURCE_CLASS_RENDER_TARGET].strategy = AllocationStrategy::MinMemory;
+    memoryPoolSettings[RESOURCE_CLASS_RENDER_TARGET].dedicated = true;
+
+    //Loaded once and kept, packed back to back in large blocks
+    memoryPoolSettings[RESOURCE_CLASS_STATIC_GEOMETRY].blockSize = 64ull * 1024 * 1024;
+    memoryPoolSettings[RESOURCE_CLASS_STATIC_GEOMETRY].strategy = AllocationStrategy::MinMemory;
+    memoryPoolSettings[RESOURCE_CLASS_STATIC_GEOMETRY].linear = true;
+
+    memoryPoolSettings[RESOURCE_CLASS_PER_FRAME].blockSize = 16ull * 1024 * 1024;
+    memoryPoolSettings[RESOURCE_CLASS_PER_FRAME].maxBlockCount = 1;
+    memoryPoolSettings[RESOURCE_CLASS_PER_FRAME].strategy = AllocationStrategy::MinTime;
+    memoryPoolSettings[RESOURCE_CLASS_PER_FRAME].linear = true;
+
+    memoryPoolSettings[RESOURCE_CLASS_STAGING].blockSize = 32ull * 1024 * 1024;
+    memoryPoolSettings[RESOURCE_CLASS_STAGING].strategy = AllocationStrategy::MinTime;
+}
+
+void Vurl::RenderingContext::FillMemoryPoolAllocationCreateInfo(ResourceClass resourceClass, VmaAllocationCreateInfo& allocationCreateInfo) {
+    const MemoryPoolSettings& settings = memoryPoolSettings[resourceClass];
+    if (settings.strategy == AllocationStrategy::MinMemory)
+        allocationCreateInfo.flags |= VMA_ALLOCATION_CREATE_STRATEGY_MIN_MEMORY_BIT;
+    else if (settings.strategy == AllocationStrategy::MinTime)
+        allocationCreateInfo.flags |= VMA_ALLOCATION_CREATE_STRATEGY_MIN_TIME_BIT;
+    if (settings.dedicated)
+        allocationCreateInfo.flags |= VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+}
+
+VmaPool Vurl::RenderingContext::GetMemoryPool(ResourceClass resourceClass, uint32_t memoryTypeIndex) {
+    static const char* poolNames[RESOURCE_CLASS_MAX] = { "Default", "Render targets", "Static geometry", "Per frame", "Staging" };
+
+    std::lock_guard<std::mutex> lock(memoryPoolMutex);
+    VmaPool& pool = memoryPools[resourceClass][memoryTypeIndex];
+    if (pool != VK_NULL_HANDLE)
+        return pool;
+
+    const MemoryPoolSettings& settings = memoryPoolSettings[resourceClass];
+    VmaPoolCreateInfo poolCreateInfo{};
+    poolCreateInfo.memoryTypeIndex = memoryTypeIndex;
+    poolCreateInfo.blockSize = settings.blockSize;
+    poolCreateInfo.maxBlockCount = settings.maxBlockCount;
+    if (settings.linear)
+        poolCreateInfo.flags |= VMA_POOL_CREATE_LINEAR_ALGORITHM_BIT;
+
+    if (vmaCreatePool(vmaAllocator, &poolCreateInfo, &pool) != VK_SUCCESS) {
+        pool = VK_NULL_HANDLE;
+        return VK_NULL_HANDLE;
+    }
+    vmaSetPoolName(vmaAllocator, pool, poolNames[resourceClass]);
+    return pool;
+}
+
+void Vurl::RenderingContext::DestroyMemoryPools() {
+    for (uint32_t i = 0; i < RESOURCE_CLASS_MAX; ++i) {
+        for (uint32_t j = 0; j < VK_MAX_MEMORY_TYPES; ++j) {
+            if (memoryPools[i][j] != VK_NULL_HANDLE)
+                vmaDestroyPool(vmaAllocator, memoryPools[i][j]);
+            memoryPools[i][j] = VK_NULL_HANDLE;
+        }
+    }
+}
+
+bool Vurl::RenderingContext::IsHostImageCopyDstLayout(VkImageLayout layout) const {
+    return std::find(hostImageCopyDstLayouts.begin(), hostImageCopyDstLayouts.end(), layout) != hostImageCopyDstLayouts.end();
+}
+
+void Vurl::RenderingContext::GetOptionalDeviceExtensionNames(DeviceExtension extension, std::vector<const char*>& names) {
+    switch (extension) {
+        case DEVICE_EXTENSION_GRAPHICS_PIPELINE_LIBRARY:
+            names.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+            names.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+            break;
+        case DEVICE_EXTENSION_EXTENDED_DYNAMIC_STATE:
+            names.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME);
+            break;
+        case DEVICE_EXTENSION_EXTENDED_DYNAMIC_STATE_2:
+            names.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME);
+            break;
+        case DEVICE_EXTENSION_SHADER_OBJECT:
+            //Shader objects have no render pass, dynamic rendering is required
+            names.push_back(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+            names.push_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+            names.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+            names.push_back(VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+            break;
+        case DEVICE_EXTENSION_MULTI_DRAW:
+            names.push_back(VK_EXT_MULTI_DRAW_EXTENSION_NAME);
+            break;
+        case DEVICE_EXTENSION_HOST_IMAGE_COPY:
+            names.push_back(VK_KHR_COPY_COMMANDS_2_EXTENSION_NAME);
+            names.push_back(VK_KHR_FORMAT_FEATURE_FLAGS_2_EXTENSION_NAME);
+            names.push_back(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+            break;
+        case DEVICE_EXTENSION_EXTERNAL_MEMORY_HOST:
+            names.push_back(VK_KHR_EXTERNAL_MEMORY_EXTENSION_NAME);
+            names.push_back(VK_EXT_EXTERNAL_MEMORY_HOST_EXTENSION_NAME);
+            break;
+        case DEVICE_EXTENSION_MEMORY_BUDGET:
+            names.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+            break;
+        default:
+            break;
+    }
+}
+
+void* Vurl::RenderingContext::ChainOptionalDeviceExtensionFeatures(DeviceExtension extension, void* pNext) {
+    switch (extension) {
+        case DEVICE_EXTENSION_GRAPHICS_PIPELINE_LIBRARY:
+            graphicsPipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+            graphicsPipelineLibraryFeatures.pNext = pNext;
+            return &graphicsPipelineLibraryFeatures;
+        case DEVICE_EXTENSION_EXTENDED_DYNAMIC_STATE:
+            extendedDynamicStateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
+            extendedDynamicStateFeatures.pNext = pNext;
+            return &extendedDynamicStateFeatures;
+        case DEVICE_EXTENSION_EXTENDED_DYNAMIC_STATE_2:
+            extendedDynamicState2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_2_FEATURES_EXT;
+            extendedDynamicState2Features.pNext = pNext;
+            return &extendedDynamicState2Features;
+        case DEVICE_EXTENSION_SHADER_OBJECT:
+            dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+            dynamicRenderingFeatures.pNext = pNext;
+            shaderObjectFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT;
+            shaderObjectFeatures.pNext = &dynamicRenderingFeatures;
+            return &shaderObjectFeatures;
+        case DEVICE_EXTENSION_MULTI_DRAW:
+            multiDrawFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MULTI_DRAW_FEATURES_EXT;
+            multiDrawFeatures.pNext = pNext;
+            return &multiDrawFeatures;
+        case DEVICE_EXTENSION_HOST_IMAGE_COPY:
+            hostImageCopyFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT;
+            hostImageCopyFeatures.pNext = pNext;
+            return &hostImageCopyFeatures;
+        default:
+            return pNext;
+    }
+}
+
+bool Vurl::RenderingContext::HasOptionalDeviceExtensionFeatures(DeviceExtension extension) {
+    switch (extension) {
+        case DEVICE_EXTENSION_GRAPHICS_PIPELINE_LIBRARY:
+            return graphicsPipelineLibraryFeatures.graphicsPipelineLibrary == VK_TRUE;
+        case DEVICE_EXTENSION_EXTENDED_DYNAMIC_STATE:
+            return extendedDynamicStateFeatures.extendedDynamicState == VK_TRUE;
+        case DEVICE_EXTENSION_EXTENDED_DYNAMIC_STATE_2:
+            return extendedDynamicState2Features.extendedDynamicState2 == VK_TRUE;
+        case DEVICE_EXTENSION_SHADER_OBJECT:
+            return shaderObjectFeatures.shaderObject == VK_TRUE && dynamicRenderingFeatures.dynamicRendering == VK_TRUE;
+        case DEVICE_EXTENSION_MULTI_DRAW:
+            return multiDrawFeatures.multiDraw == VK_TRUE;
+        case DEVICE_EXTENSION_HOST_IMAGE_COPY:
+            return hostImageCopyFeatures.hostImageCopy == VK_TRUE;
+        case DEVICE_EXTENSION_EXTERNAL_MEMORY_HOST:
+        case DEVICE_EXTENSION_MEMORY_BUDGET:
+            //No feature struct, the extension is enough
+            return true;
+        default:
+            return false;
+    }
 }
\ No newline at end of file
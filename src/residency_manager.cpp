@@ -0,0 +1,176 @@
+#include <vurl/residency_manager.hpp>
+#include <algorithm>
+
+
+void Vurl::ResidencyManager::AddTexture(std::shared_ptr<Resource<Texture>> texture, uint32_t minMipLevels) {
+    if (texture->IsTransient())
+        return;
+    for (const ResidentResource& resource : resources)
+        if (resource.texture == texture)
+            return;
+
+    ResidentResource& resource = resources.emplace_back();
+    resource.texture = texture;
+    resource.minMipLevels = std::max(minMipLevels, 1u);
+    resource.lastUsedFrame = graph->GetFrameIndex();
+}
+
+void Vurl::ResidencyManager::AddBuffer(std::shared_ptr<Resource<Buffer>> buffer) {
+    if (buffer->IsTransient())
+        return;
+    for (const ResidentResource& resource : resources)
+        if (resource.buffer == buffer)
+            return;
+
+    ResidentResource& resource = resources.emplace_back();
+    resource.buffer = buffer;
+    resource.lastUsedFrame = graph->GetFrameIndex();
+}
+
+void Vurl::ResidencyManager::Remove(std::shared_ptr<Resource<Texture>> texture) {
+    std::erase_if(resources, [&texture](const ResidentResource& resource) { return resource.texture == texture; });
+}
+
+void Vurl::ResidencyManager::Remove(std::shared_ptr<Resource<Buffer>> buffer) {
+    std::erase_if(resources, [&buffer](const ResidentResource& resource) { return resource.buffer == buffer; });
+}
+
+void Vurl::ResidencyManager::Touch(std::shared_ptr<Resource<Texture>> texture) {
+    for (ResidentResource& resource : resources) {
+        if (resource.texture == texture) {
+            resource.lastUsedFrame = graph->GetFrameIndex();
+            return;
+        }
+    }
+}
+
+void Vurl::ResidencyManager::Touch(std::shared_ptr<Resource<Buffer>> buffer) {
+    for (ResidentResource& resource : resources) {
+        if (resource.buffer == buffer) {
+            resource.lastUsedFrame = graph->GetFrameIndex();
+            return;
+        }
+    }
+}
+
+void Vurl::ResidencyManager::Update() {
+    uint64_t frameIndex = graph->GetFrameIndex();
+    std::erase_if(pendingReleases, [frameIndex](const PendingRelease& release) { 
+        return frameIndex > release.frameIndex + VURL_MAX_FRAMES_IN_FLIGHT; 
+    });
+
+    std::vector<MemoryHeapBudget> budgets = graph->GetContext()->GetMemoryHeapBudgets();
+    bool overBudget = false;
+
+    for (uint32_t heapIndex = 0; heapIndex < budgets.size(); ++heapIndex) {
+        const MemoryHeapBudget& budget = budgets[heapIndex];
+        if (!budget.deviceLocal)
+            continue;
+
+        //Memory already on its way out would otherwise be released a second time
+        VkDeviceSize pending = GetPendingReleaseSize(heapIndex);
+        VkDeviceSize usage = budget.usage > pending ? budget.usage - pending : 0;
+        VkDeviceSize target = (VkDeviceSize)((double)budget.budget * budgetThreshold);
+        if (usage <= target)
+            continue;
+        overBudget = true;
+
+        std::vector<uint32_t> candidates{};
+        for (uint32_t i = 0; i < resources.size(); ++i)
+            if (IsResident(resources[i]) && frameIndex - resources[i].lastUsedFrame >= minIdleFrames && GetHeapIndex(resources[i]) == heapIndex)
+                candidates.push_back(i);
+        std::stable_sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b) { 
+            return resources[a].lastUsedFrame < resources[b].lastUsedFrame; 
+        });
+
+        //Lower resolution first, a missing resource costs more than a blurry one
+        for (uint32_t i = 0; i < candidates.size() && usage > target; ++i) {
+            VkDeviceSize released = DropMips(resources[candidates[i]], heapIndex);
+            usage = usage > released ? usage - released : 0;
+        }
+
+        for (uint32_t i = 0; i < candidates.size() && usage > target; ++i) {
+            VkDeviceSize released = Evict(resources[candidates[i]], heapIndex);
+            usage = usage > released ? usage - released : 0;
+        }
+    }
+
+    if (overBudget)
+        ++statistics.overBudgetUpdates;
+}
+
+bool Vurl::ResidencyManager::IsResident(const ResidentResource& resource) const {
+    if (resource.texture != nullptr)
+        return resource.texture->GetResourceSlice(0)->allocation != VK_NULL_HANDLE;
+    return resource.buffer->GetResourceSlice(0)->allocation != VK_NULL_HANDLE;
+}
+
+VkDeviceSize Vurl::ResidencyManager::GetResidentSize(const ResidentResource& resource) const {
+    VmaAllocator allocator = graph->GetContext()->GetAllocator();
+    VkDeviceSize size = 0;
+    uint32_t sliceCount = resource.texture != nullptr ? resource.texture->GetSliceCount() : resource.buffer->GetSliceCount();
+
+    for (uint32_t i = 0; i < sliceCount; ++i) {
+        VmaAllocation allocation = resource.texture != nullptr ? resource.texture->GetResourceSlice(i)->allocation : 
+                resource.buffer->GetResourceSlice(i)->allocation;
+        if (allocation == VK_NULL_HANDLE)
+            continue;
+
+        VmaAllocationInfo allocationInfo{};
+        vmaGetAllocationInfo(allocator, allocation, &allocationInfo);
+        size += allocationInfo.size;
+    }
+    return size;
+}
+
+uint32_t Vurl::ResidencyManager::GetHeapIndex(const ResidentResource& resource) const {
+    VmaAllocation allocation = resource.texture != nullptr ? resource.texture->GetResourceSlice(0)->allocation : 
+            resource.buffer->GetResourceSlice(0)->allocation;
+    return graph->GetContext()->GetMemoryHeapIndex(allocation);
+}
+
+VkDeviceSize Vurl::ResidencyManager::GetPendingReleaseSize(uint32_t heapIndex) const {
+    VkDeviceSize size = 0;
+    for (const PendingRelease& release : pendingReleases)
+        if (release.heapIndex == heapIndex)
+            size += release.size;
+    return size;
+}
+
+VkDeviceSize Vurl::ResidencyManager::DropMips(ResidentResource& resource, uint32_t heapIndex) {
+    if (resource.texture == nullptr || resource.texture->GetResourceSlice(0)->mipLevels <= resource.minMipLevels)
+        return 0;
+
+    VkDeviceSize size = GetResidentSize(resource);
+    if (!graph->DropTextureMips(resource.texture, 1))
+        return 0;
+
+    //The smaller image is allocated right away, the old one is released later
+    VkDeviceSize newSize = GetResidentSize(resource);
+    VkDeviceSize released = size > newSize ? size - newSize : 0;
+    pendingReleases.push_back({ graph->GetFrameIndex(), heapIndex, size });
+    ++statistics.droppedMipCount;
+    statistics.releasedBytes += released;
+
+    if (evictionCallback)
+        evictionCallback({ ResidencyAction::DroppedMips, resource.texture, nullptr, heapIndex, released });
+    return released;
+}
+
+VkDeviceSize Vurl::ResidencyManager::Evict(ResidentResource& resource, uint32_t heapIndex) {
+    VkDeviceSize size = GetResidentSize(resource);
+    if (resource.texture != nullptr) {
+        graph->EvictTexture(resource.texture);
+        ++statistics.evictedTextureCount;
+    } else {
+        graph->EvictBuffer(resource.buffer);
+        ++statistics.evictedBufferCount;
+    }
+
+    pendingReleases.push_back({ graph->GetFrameIndex(), heapIndex, size });
+    statistics.releasedBytes += size;
+
+    if (evictionCallback)
+        evictionCallback({ ResidencyAction::Evicted, resource.texture, resource.buffer, heapIndex, size });
+    return size;
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include <vurl/shader.hpp>
 #include <iostream>
+#include <unordered_map>
 
 
 Vurl::Shader::Shader(VkDevice device) : vkDevice{ device } {
@@ -11,6 +12,18 @@ Vurl::Shader::~Shader() {
 }
 
 Vurl::VurlResult Vurl::Shader::CreateShaderModule(const uint32_t* source, uint32_t size) {
+    std::shared_ptr<std::vector<uint32_t>> ownedCode = std::make_shared<std::vector<uint32_t>>(source, source + size / sizeof(uint32_t));
+
+    if (spvReflectCreateShaderModule(size, ownedCode->data(), &spvReflectShaderModule) != SPV_REFLECT_RESULT_SUCCESS)
+        return VURL_ERROR_REFLECT_SHADER_MODULE_CREATION_FAILD;
+
+    ShaderReflection shaderReflection{};
+    Reflect(spvReflectShaderModule, ownedCode->data(), size, shaderReflection);
+
+    return CreateShaderModule(ownedCode->data(), size, shaderReflection, ownedCode);
+}
+
+Vurl::VurlResult Vurl::Shader::CreateShaderModule(const uint32_t* source, uint32_t size, const ShaderReflection& reflection, std::shared_ptr<const void> codeStorage) {
     VkShaderModuleCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
     createInfo.codeSize = size;
@@ -18,9 +31,11 @@ Vurl::VurlResult Vurl::Shader::CreateShaderModule(const uint32_t* source, uint32
 
     if (vkCreateShaderModule(vkDevice, &createInfo, nullptr, &vkShaderModule) != VK_SUCCESS)
         return VURL_ERROR_SHADER_MODULE_CREATION_FAILED;
-    
-    if (spvReflectCreateShaderModule(size, source, &spvReflectShaderModule) != SPV_REFLECT_RESULT_SUCCESS)
-        return VURL_ERROR_REFLECT_SHADER_MODULE_CREATION_FAILD;
+
+    this->code = source;
+    this->codeSize = size;
+    this->codeStorage = codeStorage;
+    this->reflection = reflection;
     
     return VURL_SUCCESS;
 }
@@ -28,4 +43,100 @@ Vurl::VurlResult Vurl::Shader::CreateShaderModule(const uint32_t* source, uint32
 void Vurl::Shader::DestroyShaderModule() {
     spvReflectDestroyShaderModule(&spvReflectShaderModule);
     vkDestroyShaderModule(vkDevice, vkShaderModule, nullptr);
+    code = nullptr;
+    codeSize = 0;
+    codeStorage = nullptr;
+    reflection = {};
+}
+
+const Vurl::SpecializationConstantInfo* Vurl::Shader::FindSpecializationConstant(uint32_t constantId) const {
+    for (const SpecializationConstantInfo& info : reflection.specializationConstants)
+        if (info.constantId == constantId)
+            return &info;
+    return nullptr;
+}
+
+void Vurl::Shader::Reflect(const SpvReflectShaderModule& module, const uint32_t* code, size_t size, ShaderReflection& reflection) {
+    reflection.stage = (VkShaderStageFlagBits)module.shader_stage;
+
+    for (uint32_t i = 0; i < module.descriptor_binding_count; ++i) {
+        const SpvReflectDescriptorBinding& binding = module.descriptor_bindings[i];
+
+        ShaderDescriptorBinding& descriptorBinding = reflection.descriptorBindings.emplace_back();
+        descriptorBinding.set = binding.set;
+        descriptorBinding.binding = binding.binding;
+        descriptorBinding.descriptorType = (VkDescriptorType)binding.descriptor_type;
+        descriptorBinding.descriptorCount = binding.count;
+    }
+
+    for (uint32_t i = 0; i < module.push_constant_block_count; ++i) {
+        const SpvReflectBlockVariable& block = module.push_constant_blocks[i];
+
+        VkPushConstantRange& range = reflection.pushConstantRanges.emplace_back();
+        range.stageFlags = reflection.stage;
+        range.offset = block.offset;
+        range.size = block.size;
+    }
+
+    if (module.entry_point_count > 0) {
+        reflection.localSize[0] = module.entry_points[0].local_size.x;
+        reflection.localSize[1] = module.entry_points[0].local_size.y;
+        reflection.localSize[2] = module.entry_points[0].local_size.z;
+    }
+
+    ReflectSpecializationConstants(module, code, size, reflection);
+}
+
+void Vurl::Shader::ReflectSpecializationConstants(const SpvReflectShaderModule& module, const uint32_t* code, size_t size, ShaderReflection& reflection) {
+    reflection.specializationConstants.clear();
+    if (module.spec_constant_count == 0)
+        return;
+
+    //SPIRV-Reflect doesn't report the type of spec constants, walk the instructions for it
+    std::unordered_map<uint32_t, SpecializationConstantType> types{};
+    std::unordered_map<uint32_t, SpecializationConstantType> constantTypes{};
+
+    const uint32_t headerWordCount = 5;
+    size_t wordCount = size / sizeof(uint32_t);
+    for (size_t i = headerWordCount; i < wordCount;) {
+        uint32_t instructionWordCount = code[i] >> 16;
+        uint32_t opcode = code[i] & 0xFFFF;
+        if (instructionWordCount == 0 || i + instructionWordCount > wordCount)
+            break;
+
+        switch (opcode) {
+            case SpvOpTypeBool:
+                types[code[i + 1]] = SpecializationConstantType::Bool;
+                break;
+            case SpvOpTypeInt:
+                if (code[i + 2] == 32)
+                    types[code[i + 1]] = code[i + 3] ? SpecializationConstantType::Int : SpecializationConstantType::UInt;
+                break;
+            case SpvOpTypeFloat:
+                if (code[i + 2] == 32)
+                    types[code[i + 1]] = SpecializationConstantType::Float;
+                break;
+            case SpvOpSpecConstantTrue:
+            case SpvOpSpecConstantFalse:
+            case SpvOpSpecConstant:
+                if (types.count(code[i + 1]))
+                    constantTypes[code[i + 2]] = types[code[i + 1]];
+                break;
+            default:
+                break;
+        }
+
+        i += instructionWordCount;
+    }
+
+    for (uint32_t i = 0; i < module.spec_constant_count; ++i) {
+        const SpvReflectSpecializationConstant& constant = module.spec_constants[i];
+
+        SpecializationConstantInfo& info = reflection.specializationConstants.emplace_back();
+        info.constantId = constant.constant_id;
+        if (constantTypes.count(constant.spirv_id))
+            info.type = constantTypes[constant.spirv_id];
+        if (constant.name)
+            info.name = constant.name;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include <vurl/shader_library.hpp>
+#include <vurl/hash.hpp>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+
+
+namespace {
+    uint32_t HashName(const std::string& name) {
+        Hasher hasher{};
+        hasher.String(name.c_str(), name.size());
+        return hasher.Get();
+    }
+
+    void WriteString(std::vector<uint32_t>& words, const std::string& s) {
+        words.push_back((uint32_t)s.size());
+        size_t offset = words.size();
+        words.resize(offset + (s.size() + 3) / 4, 0);
+        memcpy(words.data() + offset, s.data(), s.size());
+    }
+
+    struct ReflectionReader {
+        const uint32_t* words = nullptr;
+        size_t count = 0;
+        size_t position = 0;
+        bool valid = true;
+
+        uint32_t U32() {
+            if (position >= count) {
+                valid = false;
+                return 0;
+            }
+            return words[position++];
+        }
+
+        std::string String() {
+            uint32_t size = U32();
+            size_t wordCount = (size + 3) / 4;
+            if (!valid || position + wordCount > count) {
+                valid = false;
+                return {};
+            }
+            std::string s{ (const char*)(words + position), size };
+            position += wordCount;
+            return s;
+        }
+    };
+}
+
+Vurl::VurlResult Vurl::ShaderLibrary::Open(const std::string& path) {
+    Close();
+
+    file = std::make_shared<MappedFile>();
+    if (!file->Open(path)) {
+        file = nullptr;
+        return VURL_ERROR_SHADER_LIBRARY_OPEN_FAILED;
+    }
+
+    const uint8_t* data = file->GetData();
+    size_t size = file->GetSize();
+
+    header = (const ShaderLibraryHeader*)data;
+    if (size < sizeof(ShaderLibraryHeader) || header->magic != VURL_SHADER_LIBRARY_MAGIC || header->version != VURL_SHADER_LIBRARY_VERSION ||
+            size < sizeof(ShaderLibraryHeader) + header->entryCount * sizeof(ShaderLibraryEntry) + header->blobCount * sizeof(ShaderLibraryBlob)) {
+        Close();
+        return VURL_ERROR_INVALID_SHADER_LIBRARY;
+    }
+
+    entries = (const ShaderLibraryEntry*)(data + sizeof(ShaderLibraryHeader));
+    blobs = (const ShaderLibraryBlob*)(entries + header->entryCount);
+    shaders.resize(header->blobCount);
+
+    return VURL_SUCCESS;
+}
+
+void Vurl::ShaderLibrary::Close() {
+    for (auto& shader : shaders)
+        if (shader)
+            shader->DestroyShaderModule();
+    shaders.clear();
+
+    header = nullptr;
+    entries = nullptr;
+    blobs = nullptr;
+    file = nullptr;
+}
+
+std::shared_ptr<Vurl::Shader> Vurl::ShaderLibrary::GetShader(const std::string& name) {
+    const ShaderLibraryEntry* entry = FindEntry(name);
+    if (!entry || entry->blobIndex >= header->blobCount)
+        return nullptr;
+
+    std::shared_ptr<Shader>& shader = shaders[entry->blobIndex];
+    if (shader)
+        return shader;
+
+    const ShaderLibraryBlob& blob = blobs[entry->blobIndex];
+    if ((size_t)blob.codeOffset + blob.codeSize > file->GetSize())
+        return nullptr;
+
+    ShaderReflection reflection{};
+    if (!ReadReflection(blob, reflection))
+        return nullptr;
+
+    std::shared_ptr<Shader> created = std::make_shared<Shader>(vkDevice);
+    //The shader keeps the mapping alive and reads its SPIR-V straight from it
+    if (created->CreateShaderModule((const uint32_t*)(file->GetData() + blob.codeOffset), blob.codeSize, reflection, file) != VURL_SUCCESS)
+        return nullptr;
+
+    shader = created;
+    return shader;
+}
+
+const Vurl::ShaderLibraryEntry* Vurl::ShaderLibrary::FindEntry(const std::string& name) const {
+    if (!header)
+        return nullptr;
+
+    uint32_t nameHash = HashName(name);
+    const ShaderLibraryEntry* end = entries + header->entryCount;
+    const ShaderLibraryEntry* it = std::lower_bound(entries, end, nameHash, 
+            [](const ShaderLibraryEntry& entry, uint32_t hash) { return entry.nameHash < hash; });
+
+    for (; it != end && it->nameHash == nameHash; ++it) {
+        if ((size_t)it->nameOffset + it->nameSize > file->GetSize())
+            continue;
+        if (it->nameSize == name.size() && memcmp(file->GetData() + it->nameOffset, name.data(), name.size()) == 0)
+            return it;
+    }
+
+    return nullptr;
+}
+
+bool Vurl::ShaderLibrary::ReadReflection(const ShaderLibraryBlob& blob, ShaderReflection& reflection) const {
+    if ((size_t)blob.reflectionOffset + blob.reflectionSize > file->GetSize())
+        return false;
+
+    ReflectionReader reader{};
+    reader.words = (const uint32_t*)(file->GetData() + blob.reflectionOffset);
+    reader.count = blob.reflectionSize / sizeof(uint32_t);
+
+    reflection.stage = (VkShaderStageFlagBits)reader.U32();
+
+    uint32_t descriptorBindingCount = reader.U32();
+    for (uint32_t i = 0; i < descriptorBindingCount && reader.valid; ++i) {
+        ShaderDescriptorBinding& binding = reflection.descriptorBindings.emplace_back();
+        binding.set = reader.U32();
+        binding.binding = reader.U32();
+        binding.descriptorType = (VkDescriptorType)reader.U32();
+        binding.descriptorCount = reader.U32();
+    }
+
+    uint32_t pushConstantRangeCount = reader.U32();
+    for (uint32_t i = 0; i < pushConstantRangeCount && reader.valid; ++i) {
+        VkPushConstantRange& range = reflection.pushConstantRanges.emplace_back();
+        range.stageFlags = reflection.stage;
+        range.offset = reader.U32();
+        range.size = reader.U32();
+    }
+
+    uint32_t specializationConstantCount = reader.U32();
+    for (uint32_t i = 0; i < specializationConstantCount && reader.valid; ++i) {
+        SpecializationConstantInfo& info = reflection.specializationConstants.emplace_back();
+        info.constantId = reader.U32();
+        info.type = (SpecializationConstantType)reader.U32();
+        info.name = reader.String();
+    }
+
+    for (uint32_t i = 0; i < 3; ++i)
+        reflection.localSize[i] = reader.U32();
+
+    return reader.valid;
+}
+
+Vurl::VurlResult Vurl::ShaderLibraryWriter::AddShader(const std::string& name, const uint32_t* code, uint32_t size) {
+    Hasher hasher{};
+    hasher.Data(code, size / sizeof(uint32_t));
+    uint32_t contentHash = hasher.Get();
+
+    uint32_t blobIndex = (uint32_t)blobs.size();
+    for (uint32_t i = 0; i < blobs.size(); ++i) {
+        if (blobs[i].contentHash == contentHash && blobs[i].code.size() * sizeof(uint32_t) == size && 
+                memcmp(blobs[i].code.data(), code, size) == 0) {
+            blobIndex = i;
+            break;
+        }
+    }
+
+    if (blobIndex == blobs.size()) {
+        PendingBlob& blob = blobs.emplace_back();
+        blob.contentHash = contentHash;
+        blob.code.assign(code, code + size / sizeof(uint32_t));
+
+        SpvReflectShaderModule module{};
+        if (spvReflectCreateShaderModule(size, blob.code.data(), &module) != SPV_REFLECT_RESULT_SUCCESS) {
+            blobs.pop_back();
+            return VURL_ERROR_REFLECT_SHADER_MODULE_CREATION_FAILD;
+        }
+
+        ShaderReflection reflection{};
+        Shader::Reflect(module, blob.code.data(), size, reflection);
+        spvReflectDestroyShaderModule(&module);
+
+        std::vector<uint32_t>& words = blob.reflection;
+        words.push_back(reflection.stage);
+        words.push_back((uint32_t)reflection.descriptorBindings.size());
+        for (const ShaderDescriptorBinding& binding : reflection.descriptorBindings) {
+            words.push_back(binding.set);
+            words.push_back(binding.binding);
+            words.push_back(binding.descriptorType);
+            words.push_back(binding.descriptorCount);
+        }
+        words.push_back((uint32_t)reflection.pushConstantRanges.size());
+        for (const VkPushConstantRange& range : reflection.pushConstantRanges) {
+            words.push_back(range.offset);
+            words.push_back(range.size);
+        }
+        words.push_back((uint32_t)reflection.specializationConstants.size());
+        for (const SpecializationConstantInfo& info : reflection.specializationConstants) {
+            words.push_back(info.constantId);
+            words.push_back((uint32_t)info.type);
+            WriteString(words, info.name);
+        }
+        for (uint32_t i = 0; i < 3; ++i)
+            words.push_back(reflection.localSize[i]);
+    }
+
+    PendingEntry& entry = entries.emplace_back();
+    entry.name = name;
+    entry.nameHash = HashName(name);
+    entry.blobIndex = blobIndex;
+
+    return VURL_SUCCESS;
+}
+
+bool Vurl::ShaderLibraryWriter::Write(const std::string& path) const {
+    std::vector<PendingEntry> sortedEntries = entries;
+    std::stable_sort(sortedEntries.begin(), sortedEntries.end(), 
+            [](const PendingEntry& a, const PendingEntry& b) { return a.nameHash < b.nameHash; });
+
+    ShaderLibraryHeader header{};
+    header.entryCount = (uint32_t)sortedEntries.size();
+    header.blobCount = (uint32_t)blobs.size();
+
+    std::vector<ShaderLibraryEntry> fileEntries(sortedEntries.size());
+    std::vector<ShaderLibraryBlob> fileBlobs(blobs.size());
+    std::vector<uint32_t> payload{};
+
+    uint32_t payloadOffset = (uint32_t)(sizeof(ShaderLibraryHeader) + fileEntries.size() * sizeof(ShaderLibraryEntry) + 
+            fileBlobs.size() * sizeof(ShaderLibraryBlob));
+
+    for (uint32_t i = 0; i < sortedEntries.size(); ++i) {
+        const std::string& name = sortedEntries[i].name;
+        fileEntries[i].nameHash = sortedEntries[i].nameHash;
+        fileEntries[i].nameOffset = payloadOffset + (uint32_t)(payload.size() * sizeof(uint32_t));
+        fileEntries[i].nameSize = (uint32_t)name.size();
+        fileEntries[i].blobIndex = sortedEntries[i].blobIndex;
+
+        size_t offset = payload.size();
+        payload.resize(offset + (name.size() + 3) / 4, 0);
+        memcpy(payload.data() + offset, name.data(), name.size());
+    }
+
+    for (uint32_t i = 0; i < blobs.size(); ++i) {
+        fileBlobs[i].contentHash = blobs[i].contentHash;
+        fileBlobs[i].codeOffset = payloadOffset + (uint32_t)(payload.size() * sizeof(uint32_t));
+        fileBlobs[i].codeSize = (uint32_t)(blobs[i].code.size() * sizeof(uint32_t));
+        payload.insert(payload.end(), blobs[i].code.begin(), blobs[i].code.end());
+
+        fileBlobs[i].reflectionOffset = payloadOffset + (uint32_t)(payload.size() * sizeof(uint32_t));
+        fileBlobs[i].reflectionSize = (uint32_t)(blobs[i].reflection.size() * sizeof(uint32_t));
+        payload.insert(payload.end(), blobs[i].reflection.begin(), blobs[i].reflection.end());
+    }
+
+    std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+    if (!file.is_open())
+        return false;
+
+    file.write((const char*)&header, sizeof(header));
+    file.write((const char*)fileEntries.data(), fileEntries.size() * sizeof(ShaderLibraryEntry));
+    file.write((const char*)fileBlobs.data(), fileBlobs.size() * sizeof(ShaderLibraryBlob));
+    file.write((const char*)payload.data(), payload.size() * sizeof(uint32_t));
+
+    return file.good();
+}
\ No newline at end of file
@@ -53,9 +53,11 @@ Vurl::VurlResult Vurl::Surface::CreateSwapchain(VkPhysicalDevice physicalDevice,
     swapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     swapchainCreateInfo.presentMode = selectedPresentMode;
     swapchainCreateInfo.clipped = VK_TRUE;
-    swapchainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
+    swapchainCreateInfo.oldSwapchain = retiredSwapchain;
 
-    if (vkCreateSwapchainKHR(device, &swapchainCreateInfo, nullptr, &vkSwapchain) != VK_SUCCESS)
+    VkResult result = vkCreateSwapchainKHR(device, &swapchainCreateInfo, nullptr, &vkSwapchain);
+    retiredSwapchain = VK_NULL_HANDLE;
+    if (result != VK_SUCCESS)
         return VURL_ERROR_SWAPCHAIN_CREATION_FAILED;
 
     vkGetSwapchainImagesKHR(device, vkSwapchain, &swapchainImageCount, nullptr);
@@ -112,6 +114,16 @@ void Vurl::Surface::DestroySwapchain() {
     vkDestroySwapchainKHR(vkDevice, vkSwapchain, nullptr);
 }
 
+void Vurl::Surface::DestroySwapchain(std::shared_ptr<DeletionQueue> deletionQueue) {
+    for (uint32_t i = 0; i < renderTexture->GetSliceCount(); ++i)
+        deletionQueue->DestroyImageView(renderTexture->GetResourceSlice(i)->vkImageView);
+
+    renderTexture = nullptr;
+    deletionQueue->DestroySwapchain(vkSwapchain);
+    retiredSwapchain = vkSwapchain;
+    vkSwapchain = VK_NULL_HANDLE;
+}
+
 VkSurfaceFormatKHR Vurl::Surface::SelectSwapSurfaceFormat(VkSurfaceFormatKHR* formats, uint32_t formatCount) {
     for (uint32_t i = 0; i < formatCount; ++i) {
         if (formats[i].format == VK_FORMAT_B8G8R8A8_SRGB && formats[i].colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR)
@@ -0,0 +1,496 @@
+#include <vurl/texture_decoder.hpp>
+#include <algorithm>
+#include <cstring>
+
+
+namespace {
+    enum class BlockFormat {
+        None,
+        BC1RGB,
+        BC1RGBA,
+        BC2,
+        BC3,
+        BC4,
+        BC5,
+        ETC2RGB,
+        ETC2RGBA1,
+        ETC2RGBA
+    };
+
+    const int etc1Modifiers[8][4] = {
+        { 2, 8, -2, -8 }, { 5, 17, -5, -17 }, { 9, 29, -9, -29 }, { 13, 42, -13, -42 },
+        { 18, 60, -18, -60 }, { 24, 80, -24, -80 }, { 33, 106, -33, -106 }, { 47, 183, -47, -183 }
+    };
+
+    const int etc2Distances[8] = { 3, 6, 11, 16, 23, 32, 41, 64 };
+
+    const int eacModifiers[16][8] = {
+        { -3, -6, -9, -15, 2, 5, 8, 14 }, { -3, -7, -10, -13, 2, 6, 9, 12 }, { -2, -5, -8, -13, 1, 4, 7, 12 }, { -2, -4, -6, -13, 1, 3, 5, 12 },
+        { -3, -6, -8, -12, 2, 5, 7, 11 }, { -3, -7, -9, -11, 2, 6, 8, 10 }, { -4, -7, -8, -11, 3, 6, 7, 10 }, { -3, -5, -8, -11, 2, 4, 7, 10 },
+        { -2, -6, -8, -10, 1, 5, 7, 9 }, { -2, -5, -8, -10, 1, 4, 7, 9 }, { -2, -4, -8, -10, 1, 3, 7, 9 }, { -2, -5, -7, -10, 1, 4, 6, 9 },
+        { -3, -4, -7, -10, 2, 3, 6, 9 }, { -1, -2, -3, -10, 0, 1, 2, 9 }, { -4, -6, -8, -9, 3, 5, 7, 8 }, { -3, -5, -7, -9, 2, 4, 6, 8 }
+    };
+
+    struct TexelBlock {
+        uint32_t width = 1;
+        uint32_t height = 1;
+        uint32_t size = 0;
+    };
+
+    TexelBlock GetTexelBlock(VkFormat format) {
+        //The core formats are grouped by texel size in enum order
+        const uint32_t astcBlockExtents[14][2] = {
+            { 4, 4 }, { 5, 4 }, { 5, 5 }, { 6, 5 }, { 6, 6 }, { 8, 5 }, { 8, 6 }, { 8, 8 }, { 10, 5 }, { 10, 6 }, { 10, 8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+        };
+        if (format == VK_FORMAT_R4G4_UNORM_PACK8)
+            return { 1, 1, 1 };
+        if (format <= VK_FORMAT_A1R5G5B5_UNORM_PACK16)
+            return { 1, 1, format == VK_FORMAT_UNDEFINED ? 0u : 2u };
+        if (format <= VK_FORMAT_R8_SRGB)
+            return { 1, 1, 1 };
+        if (format <= VK_FORMAT_R8G8_SRGB)
+            return { 1, 1, 2 };
+        if (format <= VK_FORMAT_B8G8R8_SRGB)
+            return { 1, 1, 3 };
+        if (format <= VK_FORMAT_A2B10G10R10_SINT_PACK32)
+            return { 1, 1, 4 };
+        if (format <= VK_FORMAT_R16_SFLOAT)
+            return { 1, 1, 2 };
+        if (format <= VK_FORMAT_R16G16_SFLOAT)
+            return { 1, 1, 4 };
+        if (format <= VK_FORMAT_R16G16B16_SFLOAT)
+            return { 1, 1, 6 };
+        if (format <= VK_FORMAT_R16G16B16A16_SFLOAT)
+            return { 1, 1, 8 };
+        if (format <= VK_FORMAT_R32_SFLOAT)
+            return { 1, 1, 4 };
+        if (format <= VK_FORMAT_R32G32_SFLOAT)
+            return { 1, 1, 8 };
+        if (format <= VK_FORMAT_R32G32B32_SFLOAT)
+            return { 1, 1, 12 };
+        if (format <= VK_FORMAT_R32G32B32A32_SFLOAT)
+            return { 1, 1, 16 };
+        if (format <= VK_FORMAT_R64G64B64A64_SFLOAT)
+            return { 1, 1, 8 * ((uint32_t)(format - VK_FORMAT_R64_UINT) / 3 + 1) };
+        if (format <= VK_FORMAT_E5B9G9R9_UFLOAT_PACK32)
+            return { 1, 1, 4 };
+        if (format <= VK_FORMAT_D32_SFLOAT_S8_UINT)
+            return {};
+        switch (format) {
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+            case VK_FORMAT_BC4_SNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+            case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+            case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+                return { 4, 4, 8 };
+            default:
+                break;
+        }
+        if (format <= VK_FORMAT_EAC_R11G11_SNORM_BLOCK)
+            return { 4, 4, 16 };
+        if (format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK) {
+            const uint32_t* extent = astcBlockExtents[(format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2];
+            return { extent[0], extent[1], 16 };
+        }
+        if (format == VK_FORMAT_A4R4G4B4_UNORM_PACK16 || format == VK_FORMAT_A4B4G4R4_UNORM_PACK16)
+            return { 1, 1, 2 };
+        return {};
+    }
+
+    BlockFormat GetBlockFormat(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                return BlockFormat::BC1RGB;
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                return BlockFormat::BC1RGBA;
+            case VK_FORMAT_BC2_UNORM_BLOCK:
+            case VK_FORMAT_BC2_SRGB_BLOCK:
+                return BlockFormat::BC2;
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+                return BlockFormat::BC3;
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+                return BlockFormat::BC4;
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+                return BlockFormat::BC5;
+            case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+                return BlockFormat::ETC2RGB;
+            case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+                return BlockFormat::ETC2RGBA1;
+            case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+                return BlockFormat::ETC2RGBA;
+            default:
+                return BlockFormat::None;
+        }
+    }
+
+    inline uint8_t Clamp255(int value) { return (uint8_t)std::min(std::max(value, 0), 255); }
+    inline uint64_t ReadBigEndian64(const uint8_t* data) {
+        uint64_t value = 0;
+        for (uint32_t i = 0; i < 8; ++i)
+            value = (value << 8) | data[i];
+        return value;
+    }
+    inline uint64_t ReadLittleEndian64(const uint8_t* data) {
+        uint64_t value = 0;
+        for (uint32_t i = 0; i < 8; ++i)
+            value |= (uint64_t)data[i] << (i * 8);
+        return value;
+    }
+    inline uint32_t Bits(uint64_t value, uint32_t high, uint32_t low) { return (uint32_t)((value >> low) & ((1ull << (high - low + 1)) - 1)); }
+
+    //Texels of a block are written as RGBA8, row by row
+    typedef uint8_t BlockTexels[16][4];
+
+    void DecodeBC1Color(const uint8_t* block, BlockTexels& texels, bool alwaysFourColors, bool transparentBlack) {
+        uint16_t color0 = block[0] | (block[1] << 8);
+        uint16_t color1 = block[2] | (block[3] << 8);
+        uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+
+        int palette[4][4]{};
+        for (uint32_t i = 0; i < 2; ++i) {
+            uint16_t color = i == 0 ? color0 : color1;
+            uint32_t r = (color >> 11) & 0x1F;
+            uint32_t g = (color >> 5) & 0x3F;
+            uint32_t b = color & 0x1F;
+            palette[i][0] = (r << 3) | (r >> 2);
+            palette[i][1] = (g << 2) | (g >> 4);
+            palette[i][2] = (b << 3) | (b >> 2);
+            palette[i][3] = 255;
+        }
+
+        for (uint32_t c = 0; c < 3; ++c) {
+            if (alwaysFourColors || color0 > color1) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            } else {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+        palette[2][3] = 255;
+        palette[3][3] = (alwaysFourColors || color0 > color1 || !transparentBlack) ? 255 : 0;
+
+        for (uint32_t i = 0; i < 16; ++i)
+            for (uint32_t c = 0; c < 4; ++c)
+                texels[i][c] = (uint8_t)palette[(indices >> (i * 2)) & 0x3][c];
+    }
+
+    //BC3 alpha and BC4/BC5 channels share the same 8 value ramp
+    void DecodeBC4Channel(const uint8_t* block, BlockTexels& texels, uint32_t channel) {
+        int values[8]{};
+        values[0] = block[0];
+        values[1] = block[1];
+        if (values[0] > values[1]) {
+            for (uint32_t i = 1; i < 7; ++i)
+                values[i + 1] = ((7 - i) * values[0] + i * values[1]) / 7;
+        } else {
+            for (uint32_t i = 1; i < 5; ++i)
+                values[i + 1] = ((5 - i) * values[0] + i * values[1]) / 5;
+            values[6] = 0;
+            values[7] = 255;
+        }
+
+        uint64_t indices = ReadLittleEndian64(block) >> 16;
+        for (uint32_t i = 0; i < 16; ++i)
+            texels[i][channel] = (uint8_t)values[(indices >> (i * 3)) & 0x7];
+    }
+
+    void DecodeETC2Color(const uint8_t* block, BlockTexels& texels, bool punchThrough) {
+        uint64_t bits = ReadBigEndian64(block);
+        bool differential = Bits(bits, 33, 33) != 0;
+        //Punch-through blocks reuse the differential bit as the opaque flag and are always differential
+        bool opaque = !punchThrough || differential;
+        if (punchThrough)
+            differential = true;
+
+        uint32_t msbs = Bits(bits, 31, 16);
+        uint32_t lsbs = Bits(bits, 15, 0);
+        auto GetIndex = [msbs, lsbs](uint32_t x, uint32_t y) { 
+            uint32_t i = x * 4 + y; 
+            return (((msbs >> i) & 1) << 1) | ((lsbs >> i) & 1); 
+        };
+        auto Write = [&texels](uint32_t x, uint32_t y, int r, int g, int b, int a) {
+            uint8_t* texel = texels[y * 4 + x];
+            texel[0] = Clamp255(r);
+            texel[1] = Clamp255(g);
+            texel[2] = Clamp255(b);
+            texel[3] = (uint8_t)a;
+        };
+
+        int base[2][3]{};
+        if (!differential) {
+            for (uint32_t c = 0; c < 3; ++c) {
+                base[0][c] = Bits(bits, 63 - c * 8, 60 - c * 8) * 17;
+                base[1][c] = Bits(bits, 59 - c * 8, 56 - c * 8) * 17;
+            }
+        } else {
+            int components[3]{};
+            int deltas[3]{};
+            for (uint32_t c = 0; c < 3; ++c) {
+                components[c] = Bits(bits, 63 - c * 8, 59 - c * 8);
+                deltas[c] = (int)Bits(bits, 58 - c * 8, 56 - c * 8);
+                if (deltas[c] >= 4)
+                    deltas[c] -= 8;
+            }
+
+            //An out of range sum selects one of the ETC2 modes
+            if (components[0] + deltas[0] < 0 || components[0] + deltas[0] > 31) {
+                int colors[2][3] = {
+                    { (int)((Bits(bits, 60, 59) << 2) | Bits(bits, 57, 56)) * 17, (int)Bits(bits, 55, 52) * 17, (int)Bits(bits, 51, 48) * 17 },
+                    { (int)Bits(bits, 47, 44) * 17, (int)Bits(bits, 43, 40) * 17, (int)Bits(bits, 39, 36) * 17 }
+                };
+                int distance = etc2Distances[(Bits(bits, 35, 34) << 1) | Bits(bits, 32, 32)];
+                int paint[4][3]{};
+                for (uint32_t c = 0; c < 3; ++c) {
+                    paint[0][c] = colors[0][c];
+                    paint[1][c] = Clamp255(colors[1][c] + distance);
+                    paint[2][c] = colors[1][c];
+                    paint[3][c] = Clamp255(colors[1][c] - distance);
+                }
+                for (uint32_t y = 0; y < 4; ++y) {
+                    for (uint32_t x = 0; x < 4; ++x) {
+                        uint32_t index = GetIndex(x, y);
+                        if (!opaque && index == 2)
+                            Write(x, y, 0, 0, 0, 0);
+                        else
+                            Write(x, y, paint[index][0], paint[index][1], paint[index][2], 255);
+                    }
+                }
+                return;
+            }
+
+            if (components[1] + deltas[1] < 0 || components[1] + deltas[1] > 31) {
+                int colors[2][3] = {
+                    { (int)Bits(bits, 62, 59), (int)((Bits(bits, 58, 56) << 1) | Bits(bits, 52, 52)), (int)((Bits(bits, 51, 51) << 3) | Bits(bits, 49, 47)) },
+                    { (int)Bits(bits, 46, 43), (int)Bits(bits, 42, 39), (int)Bits(bits, 38, 35) }
+                };
+                uint32_t value0 = (colors[0][0] << 8) | (colors[0][1] << 4) | colors[0][2];
+                uint32_t value1 = (colors[1][0] << 8) | (colors[1][1] << 4) | colors[1][2];
+                int distance = etc2Distances[(Bits(bits, 34, 34) << 2) | (Bits(bits, 32, 32) << 1) | (value0 >= value1 ? 1 : 0)];
+                int paint[4][3]{};
+                for (uint32_t c = 0; c < 3; ++c) {
+                    paint[0][c] = Clamp255(colors[0][c] * 17 + distance);
+                    paint[1][c] = Clamp255(colors[0][c] * 17 - distance);
+                    paint[2][c] = Clamp255(colors[1][c] * 17 + distance);
+                    paint[3][c] = Clamp255(colors[1][c] * 17 - distance);
+                }
+                for (uint32_t y = 0; y < 4; ++y) {
+                    for (uint32_t x = 0; x < 4; ++x) {
+                        uint32_t index = GetIndex(x, y);
+                        if (!opaque && index == 2)
+                            Write(x, y, 0, 0, 0, 0);
+                        else
+                            Write(x, y, paint[index][0], paint[index][1], paint[index][2], 255);
+                    }
+                }
+                return;
+            }
+
+            if (components[2] + deltas[2] < 0 || components[2] + deltas[2] > 31) {
+                int origin[3] = { (int)Bits(bits, 62, 57), (int)((Bits(bits, 56, 56) << 6) | Bits(bits, 54, 49)), 
+                        (int)((Bits(bits, 48, 48) << 5) | (Bits(bits, 44, 43) << 3) | Bits(bits, 41, 39)) };
+                int horizontal[3] = { (int)((Bits(bits, 38, 34) << 1) | Bits(bits, 32, 32)), (int)Bits(bits, 31, 25), (int)Bits(bits, 24, 19) };
+                int vertical[3] = { (int)Bits(bits, 18, 13), (int)Bits(bits, 12, 6), (int)Bits(bits, 5, 0) };
+
+                //Red and blue have 6 bits, green 7
+                for (uint32_t c = 0; c < 3; ++c) {
+                    int shift = c == 1 ? 1 : 2;
+                    origin[c] = (origin[c] << shift) | (origin[c] >> (8 - 2 * shift));
+                    horizontal[c] = (horizontal[c] << shift) | (horizontal[c] >> (8 - 2 * shift));
+                    vertical[c] = (vertical[c] << shift) | (vertical[c] >> (8 - 2 * shift));
+                }
+
+                for (uint32_t y = 0; y < 4; ++y) {
+                    for (uint32_t x = 0; x < 4; ++x) {
+                        int color[3]{};
+                        for (uint32_t c = 0; c < 3; ++c)
+                            color[c] = ((int)x * (horizontal[c] - origin[c]) + (int)y * (vertical[c] - origin[c]) + 4 * origin[c] + 2) >> 2;
+                        Write(x, y, color[0], color[1], color[2], 255);
+                    }
+                }
+                return;
+            }
+
+            for (uint32_t c = 0; c < 3; ++c) {
+                base[0][c] = (components[c] << 3) | (components[c] >> 2);
+                int second = components[c] + deltas[c];
+                base[1][c] = (second << 3) | (second >> 2);
+            }
+        }
+
+        bool flip = Bits(bits, 32, 32) != 0;
+        uint32_t tables[2] = { Bits(bits, 39, 37), Bits(bits, 36, 34) };
+        for (uint32_t y = 0; y < 4; ++y) {
+            for (uint32_t x = 0; x < 4; ++x) {
+                uint32_t subblock = flip ? (y >= 2 ? 1 : 0) : (x >= 2 ? 1 : 0);
+                uint32_t index = GetIndex(x, y);
+
+                //Without the opaque flag the small positive step becomes transparent or the base color
+                if (!opaque && index == 2) {
+                    Write(x, y, 0, 0, 0, 0);
+                    continue;
+                }
+
+                int modifier = (!opaque && index == 0) ? 0 : etc1Modifiers[tables[subblock]][index];
+                Write(x, y, base[subblock][0] + modifier, base[subblock][1] + modifier, base[subblock][2] + modifier, 255);
+            }
+        }
+    }
+
+    void DecodeEACAlpha(const uint8_t* block, BlockTexels& texels) {
+        uint64_t bits = ReadBigEndian64(block);
+        int base = (int)Bits(bits, 63, 56);
+        int multiplier = (int)Bits(bits, 55, 52);
+        const int* modifiers = eacModifiers[Bits(bits, 51, 48)];
+
+        for (uint32_t x = 0; x < 4; ++x) {
+            for (uint32_t y = 0; y < 4; ++y) {
+                uint32_t i = x * 4 + y;
+                uint32_t index = Bits(bits, 47 - i * 3, 45 - i * 3);
+                texels[y * 4 + x][3] = Clamp255(base + modifiers[index] * multiplier);
+            }
+        }
+    }
+
+    void DecodeBlock(BlockFormat format, const uint8_t* block, BlockTexels& texels) {
+        memset(texels, 0, sizeof(BlockTexels));
+        for (uint32_t i = 0; i < 16; ++i)
+            texels[i][3] = 255;
+
+        switch (format) {
+            case BlockFormat::BC1RGB:
+                DecodeBC1Color(block, texels, false, false);
+                break;
+            case BlockFormat::BC1RGBA:
+                DecodeBC1Color(block, texels, false, true);
+                break;
+            case BlockFormat::BC2:
+                DecodeBC1Color(block + 8, texels, true, false);
+                for (uint32_t i = 0; i < 16; ++i)
+                    texels[i][3] = ((block[i / 2] >> ((i % 2) * 4)) & 0xF) * 17;
+                break;
+            case BlockFormat::BC3:
+                DecodeBC1Color(block + 8, texels, true, false);
+                DecodeBC4Channel(block, texels, 3);
+                break;
+            case BlockFormat::BC4:
+                DecodeBC4Channel(block, texels, 0);
+                break;
+            case BlockFormat::BC5:
+                DecodeBC4Channel(block, texels, 0);
+                DecodeBC4Channel(block + 8, texels, 1);
+                break;
+            case BlockFormat::ETC2RGB:
+                DecodeETC2Color(block, texels, false);
+                break;
+            case BlockFormat::ETC2RGBA1:
+                DecodeETC2Color(block, texels, true);
+                break;
+            case BlockFormat::ETC2RGBA:
+                DecodeETC2Color(block + 8, texels, false);
+                DecodeEACAlpha(block, texels);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+uint32_t Vurl::GetDecompressibleBlockSize(VkFormat format) {
+    switch (GetBlockFormat(format)) {
+        case BlockFormat::BC1RGB:
+        case BlockFormat::BC1RGBA:
+        case BlockFormat::BC4:
+        case BlockFormat::ETC2RGB:
+        case BlockFormat::ETC2RGBA1:
+            return 8;
+        case BlockFormat::BC2:
+        case BlockFormat::BC3:
+        case BlockFormat::BC5:
+        case BlockFormat::ETC2RGBA:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+VkFormat Vurl::GetDecompressedFormat(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+        case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+        case VK_FORMAT_BC2_SRGB_BLOCK:
+        case VK_FORMAT_BC3_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+        case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+            return VK_FORMAT_R8G8B8A8_SRGB;
+        default:
+            return VK_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+uint64_t Vurl::GetImageSize(VkFormat format, uint32_t width, uint32_t height, uint32_t depth) {
+    TexelBlock block = GetTexelBlock(format);
+    return (uint64_t)((width + block.width - 1) / block.width) * ((height + block.height - 1) / block.height) * depth * block.size;
+}
+
+bool Vurl::DecompressImage(VkFormat format, const uint8_t* blocks, uint64_t size, uint32_t width, uint32_t height, uint32_t depth, uint8_t* texels) {
+    BlockFormat blockFormat = GetBlockFormat(format);
+    uint32_t blockSize = GetDecompressibleBlockSize(format);
+    uint32_t blockCountX = (width + 3) / 4;
+    uint32_t blockCountY = (height + 3) / 4;
+    if (blockFormat == BlockFormat::None || size < (uint64_t)blockCountX * blockCountY * depth * blockSize)
+        return false;
+
+    BlockTexels blockTexels{};
+    for (uint32_t z = 0; z < depth; ++z) {
+        for (uint32_t by = 0; by < blockCountY; ++by) {
+            for (uint32_t bx = 0; bx < blockCountX; ++bx) {
+                DecodeBlock(blockFormat, blocks, blockTexels);
+                blocks += blockSize;
+
+                //Edge blocks cover texels past the image, those are dropped
+                for (uint32_t y = 0; y < 4 && by * 4 + y < height; ++y) {
+                    uint32_t rowWidth = std::min(4u, width - bx * 4);
+                    uint8_t* row = texels + (((uint64_t)z * height + by * 4 + y) * width + bx * 4) * 4;
+                    memcpy(row, blockTexels[y * 4], rowWidth * 4);
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+bool Vurl::DecompressKtx2Level(const Ktx2File& file, uint32_t level, std::vector<uint8_t>& texels) {
+    VkFormat format = file.GetFormat();
+    uint32_t blockSize = GetDecompressibleBlockSize(format);
+    uint32_t layerCount = file.GetLayerCount() * file.GetFaceCount();
+    uint32_t width = std::max(file.GetWidth() >> level, 1u);
+    uint32_t height = std::max(file.GetHeight() >> level, 1u);
+    uint32_t depth = std::max(file.GetDepth() >> level, 1u);
+    uint64_t imageSize = (uint64_t)((width + 3) / 4) * ((height + 3) / 4) * depth * blockSize;
+    uint64_t texelSize = (uint64_t)width * height * depth * 4;
+    if (blockSize == 0 || file.GetLevelSize(level) < imageSize * layerCount)
+        return false;
+
+    size_t offset = texels.size();
+    texels.resize(offset + texelSize * layerCount);
+    for (uint32_t layer = 0; layer < layerCount; ++layer)
+        DecompressImage(format, file.GetLevelData(level) + layer * imageSize, imageSize, width, height, depth, 
+                texels.data() + offset + layer * texelSize);
+    return true;
+}
\ No newline at end of file
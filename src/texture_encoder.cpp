@@ -0,0 +1,820 @@
+#include <vurl/texture_encoder.hpp>
+#include <vurl/texture.hpp>
+#include <vurl/hash.hpp>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+#include <cfloat>
+
+#if defined(__AVX2__)
+#define VURL_TEXTURE_ENCODER_AVX2
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#define VURL_TEXTURE_ENCODER_SSE41
+#include <smmintrin.h>
+#endif
+
+//Bump when the encoded output changes so stale cache entries are not reused
+#define VURL_TEXTURE_ENCODER_VERSION 2
+//Key/value entry holding the source key of a cache file
+#define VURL_TEXTURE_CACHE_KEY "VurlTextureCacheKey"
+
+
+namespace {
+    enum class EncodeFormat {
+        None,
+        BC1RGB,
+        BC1RGBA,
+        BC3,
+        BC5,
+        BC7
+    };
+
+    //Channels of the 16 texels of a block, structure of arrays so the kernels load 4 or 8 texels at once
+    struct BlockTexels {
+        alignas(32) int32_t texels[4][16];
+    };
+
+    struct Endpoints {
+        float values[2][4]{};
+    };
+
+    const int32_t bc7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    EncodeFormat GetEncodeFormat(VkFormat format) {
+        switch (format) {
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+                return EncodeFormat::BC1RGB;
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+                return EncodeFormat::BC1RGBA;
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+                return EncodeFormat::BC3;
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+                return EncodeFormat::BC5;
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+                return EncodeFormat::BC7;
+            default:
+                return EncodeFormat::None;
+        }
+    }
+
+    bool IsSrgbFormat(VkFormat format) {
+        return format == VK_FORMAT_BC1_RGB_SRGB_BLOCK || format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK || 
+                format == VK_FORMAT_BC3_SRGB_BLOCK || format == VK_FORMAT_BC7_SRGB_BLOCK;
+    }
+
+    void LoadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, BlockTexels& block) {
+        //Edge blocks repeat the last row and column
+        for (uint32_t y = 0; y < 4; ++y) {
+            uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+            for (uint32_t x = 0; x < 4; ++x) {
+                uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+                const uint8_t* texel = rgba + ((size_t)sourceY * width + sourceX) * 4;
+                for (uint32_t c = 0; c < 4; ++c)
+                    block.texels[c][y * 4 + x] = texel[c];
+            }
+        }
+    }
+
+    //Write the index of the closest palette entry over channels [firstChannel, firstChannel + channelCount) for every texel.
+    //Ties keep the lower index. Returns the summed squared error of the block.
+    uint32_t SelectIndices(const BlockTexels& block, const int32_t (*palette)[4], uint32_t paletteSize, 
+            uint32_t firstChannel, uint32_t channelCount, uint8_t* indices) {
+        uint32_t totalError = 0;
+#if defined(VURL_TEXTURE_ENCODER_AVX2)
+        for (uint32_t i = 0; i < 16; i += 8) {
+            __m256i bestError = _mm256_set1_epi32(INT32_MAX);
+            __m256i bestIndex = _mm256_setzero_si256();
+            for (uint32_t p = 0; p < paletteSize; ++p) {
+                __m256i error = _mm256_setzero_si256();
+                for (uint32_t c = firstChannel; c < firstChannel + channelCount; ++c) {
+                    __m256i difference = _mm256_sub_epi32(_mm256_load_si256((const __m256i*)&block.texels[c][i]), _mm256_set1_epi32(palette[p][c]));
+                    error = _mm256_add_epi32(error, _mm256_mullo_epi32(difference, difference));
+                }
+                __m256i closer = _mm256_cmpgt_epi32(bestError, error);
+                bestError = _mm256_min_epi32(bestError, error);
+                bestIndex = _mm256_blendv_epi8(bestIndex, _mm256_set1_epi32((int32_t)p), closer);
+            }
+
+            alignas(32) int32_t errors[8];
+            alignas(32) int32_t lanes[8];
+            _mm256_store_si256((__m256i*)errors, bestError);
+            _mm256_store_si256((__m256i*)lanes, bestIndex);
+            for (uint32_t j = 0; j < 8; ++j) {
+                indices[i + j] = (uint8_t)lanes[j];
+                totalError += (uint32_t)errors[j];
+            }
+        }
+#elif defined(VURL_TEXTURE_ENCODER_SSE41)
+        for (uint32_t i = 0; i < 16; i += 4) {
+            __m128i bestError = _mm_set1_epi32(INT32_MAX);
+            __m128i bestIndex = _mm_setzero_si128();
+            for (uint32_t p = 0; p < paletteSize; ++p) {
+                __m128i error = _mm_setzero_si128();
+                for (uint32_t c = firstChannel; c < firstChannel + channelCount; ++c) {
+                    __m128i difference = _mm_sub_epi32(_mm_load_si128((const __m128i*)&block.texels[c][i]), _mm_set1_epi32(palette[p][c]));
+                    error = _mm_add_epi32(error, _mm_mullo_epi32(difference, difference));
+                }
+                __m128i closer = _mm_cmpgt_epi32(bestError, error);
+                bestError = _mm_min_epi32(bestError, error);
+                bestIndex = _mm_blendv_epi8(bestIndex, _mm_set1_epi32((int32_t)p), closer);
+            }
+
+            alignas(16) int32_t errors[4];
+            alignas(16) int32_t lanes[4];
+            _mm_store_si128((__m128i*)errors, bestError);
+            _mm_store_si128((__m128i*)lanes, bestIndex);
+            for (uint32_t j = 0; j < 4; ++j) {
+                indices[i + j] = (uint8_t)lanes[j];
+                totalError += (uint32_t)errors[j];
+            }
+        }
+#else
+        for (uint32_t i = 0; i < 16; ++i) {
+            int32_t bestError = INT32_MAX;
+            uint32_t bestIndex = 0;
+            for (uint32_t p = 0; p < paletteSize; ++p) {
+                int32_t error = 0;
+                for (uint32_t c = firstChannel; c < firstChannel + channelCount; ++c) {
+                    int32_t difference = block.texels[c][i] - palette[p][c];
+                    error += difference * difference;
+                }
+                if (error < bestError) {
+                    bestError = error;
+                    bestIndex = p;
+                }
+            }
+            indices[i] = (uint8_t)bestIndex;
+            totalError += (uint32_t)bestError;
+        }
+#endif
+        return totalError;
+    }
+
+    //Endpoints spanning the texels in mask, along the bounding box diagonal or the principal axis
+    void FitEndpoints(const BlockTexels& block, uint32_t channelCount, uint16_t mask, bool principalAxis, Endpoints& endpoints) {
+        float minimum[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+        float maximum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float mean[4]{};
+        uint32_t count = 0;
+        for (uint32_t i = 0; i < 16; ++i) {
+            if ((mask & (1 << i)) == 0)
+                continue;
+            for (uint32_t c = 0; c < channelCount; ++c) {
+                float value = (float)block.texels[c][i];
+                minimum[c] = std::min(minimum[c], value);
+                maximum[c] = std::max(maximum[c], value);
+                mean[c] += value;
+            }
+            ++count;
+        }
+
+        if (!principalAxis || count < 2) {
+            for (uint32_t c = 0; c < channelCount; ++c) {
+                endpoints.values[0][c] = count > 0 ? minimum[c] : 0.0f;
+                endpoints.values[1][c] = count > 0 ? maximum[c] : 0.0f;
+            }
+            return;
+        }
+
+        for (uint32_t c = 0; c < channelCount; ++c)
+            mean[c] /= (float)count;
+
+        float covariance[4][4]{};
+        for (uint32_t i = 0; i < 16; ++i) {
+            if ((mask & (1 << i)) == 0)
+                continue;
+            for (uint32_t a = 0; a < channelCount; ++a)
+                for (uint32_t b = 0; b < channelCount; ++b)
+                    covariance[a][b] += ((float)block.texels[a][i] - mean[a]) * ((float)block.texels[b][i] - mean[b]);
+        }
+
+        //Power iteration from the bounding box diagonal
+        float axis[4]{};
+        for (uint32_t c = 0; c < channelCount; ++c)
+            axis[c] = maximum[c] - minimum[c];
+        for (uint32_t iteration = 0; iteration < 8; ++iteration) {
+            float next[4]{};
+            float length = 0.0f;
+            for (uint32_t a = 0; a < channelCount; ++a) {
+                for (uint32_t b = 0; b < channelCount; ++b)
+                    next[a] += covariance[a][b] * axis[b];
+                length = std::max(length, std::fabs(next[a]));
+            }
+            if (length < FLT_EPSILON)
+                break;
+            for (uint32_t c = 0; c < channelCount; ++c)
+                axis[c] = next[c] / length;
+        }
+
+        float lengthSquared = 0.0f;
+        for (uint32_t c = 0; c < channelCount; ++c)
+            lengthSquared += axis[c] * axis[c];
+        if (lengthSquared < FLT_EPSILON) {
+            for (uint32_t c = 0; c < channelCount; ++c)
+                endpoints.values[0][c] = endpoints.values[1][c] = mean[c];
+            return;
+        }
+
+        float low = FLT_MAX;
+        float high = -FLT_MAX;
+        for (uint32_t i = 0; i < 16; ++i) {
+            if ((mask & (1 << i)) == 0)
+                continue;
+            float t = 0.0f;
+            for (uint32_t c = 0; c < channelCount; ++c)
+                t += ((float)block.texels[c][i] - mean[c]) * axis[c];
+            low = std::min(low, t);
+            high = std::max(high, t);
+        }
+
+        for (uint32_t c = 0; c < channelCount; ++c) {
+            endpoints.values[0][c] = std::clamp(mean[c] + axis[c] * low / lengthSquared, 0.0f, 255.0f);
+            endpoints.values[1][c] = std::clamp(mean[c] + axis[c] * high / lengthSquared, 0.0f, 255.0f);
+        }
+    }
+
+    //Least squares endpoints for the chosen indices, weights give the position of each index between the endpoints
+    bool RefineEndpoints(const BlockTexels& block, uint32_t channelCount, uint16_t mask, const uint8_t* indices, const float* weights, Endpoints& endpoints) {
+        float a = 0.0f;
+        float b = 0.0f;
+        float c = 0.0f;
+        float x0[4]{};
+        float x1[4]{};
+        for (uint32_t i = 0; i < 16; ++i) {
+            if ((mask & (1 << i)) == 0)
+                continue;
+            float w = weights[indices[i]];
+            a += (1.0f - w) * (1.0f - w);
+            b += (1.0f - w) * w;
+            c += w * w;
+            for (uint32_t channel = 0; channel < channelCount; ++channel) {
+                x0[channel] += (1.0f - w) * (float)block.texels[channel][i];
+                x1[channel] += w * (float)block.texels[channel][i];
+            }
+        }
+
+        float determinant = a * c - b * b;
+        if (std::fabs(determinant) < FLT_EPSILON)
+            return false;
+
+        for (uint32_t channel = 0; channel < channelCount; ++channel) {
+            endpoints.values[0][channel] = std::clamp((c * x0[channel] - b * x1[channel]) / determinant, 0.0f, 255.0f);
+            endpoints.values[1][channel] = std::clamp((a * x1[channel] - b * x0[channel]) / determinant, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    uint16_t QuantizeRGB565(const float* color) {
+        uint32_t r = (uint32_t)std::lround(color[0] * 31.0f / 255.0f);
+        uint32_t g = (uint32_t)std::lround(color[1] * 63.0f / 255.0f);
+        uint32_t b = (uint32_t)std::lround(color[2] * 31.0f / 255.0f);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    void ExpandRGB565(uint16_t color, int32_t* expanded) {
+        uint32_t r = (color >> 11) & 0x1F;
+        uint32_t g = (color >> 5) & 0x3F;
+        uint32_t b = color & 0x1F;
+        expanded[0] = (int32_t)((r << 3) | (r >> 2));
+        expanded[1] = (int32_t)((g << 2) | (g >> 4));
+        expanded[2] = (int32_t)((b << 3) | (b >> 2));
+        expanded[3] = 0;
+    }
+
+    //BC3 color blocks are always decoded with four colors, BC1 with alpha switches to three colors and transparent black
+    void EncodeBC1(const BlockTexels& block, Vurl::TextureEncodeQuality quality, bool punchThrough, uint8_t* output) {
+        uint16_t mask = 0xFFFF;
+        if (punchThrough)
+            for (uint32_t i = 0; i < 16; ++i)
+                if (block.texels[3][i] < 128)
+                    mask &= (uint16_t)~(1 << i);
+        bool threeColors = mask != 0xFFFF;
+
+        Endpoints endpoints{};
+        FitEndpoints(block, 3, mask, quality != Vurl::TextureEncodeQuality::Fast, endpoints);
+
+        const float fourColorWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+        const float threeColorWeights[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+
+        uint32_t bestError = UINT32_MAX;
+        uint16_t bestColors[2]{};
+        uint8_t bestIndices[16]{};
+        uint32_t iterationCount = quality == Vurl::TextureEncodeQuality::High ? 3 : 1;
+        for (uint32_t iteration = 0; iteration < iterationCount; ++iteration) {
+            uint16_t colors[2] = { QuantizeRGB565(endpoints.values[0]), QuantizeRGB565(endpoints.values[1]) };
+            if ((threeColors && colors[0] > colors[1]) || (!threeColors && colors[0] < colors[1]))
+                std::swap(colors[0], colors[1]);
+
+            int32_t palette[4][4]{};
+            ExpandRGB565(colors[0], palette[0]);
+            ExpandRGB565(colors[1], palette[1]);
+            for (uint32_t c = 0; c < 3; ++c) {
+                if (threeColors) {
+                    palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                } else {
+                    palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                    palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+                }
+            }
+
+            uint8_t indices[16]{};
+            uint32_t error = SelectIndices(block, palette, threeColors ? 3 : 4, 0, 3, indices);
+            for (uint32_t i = 0; i < 16; ++i)
+                if ((mask & (1 << i)) == 0)
+                    indices[i] = 3;
+
+            if (error < bestError) {
+                bestError = error;
+                bestColors[0] = colors[0];
+                bestColors[1] = colors[1];
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+
+            if (iteration + 1 < iterationCount) {
+                Endpoints refined{};
+                if (!RefineEndpoints(block, 3, mask, indices, threeColors ? threeColorWeights : fourColorWeights, refined))
+                    break;
+                endpoints = refined;
+            }
+        }
+
+        uint32_t packedIndices = 0;
+        for (uint32_t i = 0; i < 16; ++i)
+            packedIndices |= (uint32_t)bestIndices[i] << (i * 2);
+        output[0] = (uint8_t)(bestColors[0] & 0xFF);
+        output[1] = (uint8_t)(bestColors[0] >> 8);
+        output[2] = (uint8_t)(bestColors[1] & 0xFF);
+        output[3] = (uint8_t)(bestColors[1] >> 8);
+        memcpy(output + 4, &packedIndices, sizeof(packedIndices));
+    }
+
+    uint32_t EncodeBC4Mode(const BlockTexels& block, uint32_t channel, int32_t first, int32_t second, uint8_t* indices) {
+        int32_t values[8]{};
+        values[0] = first;
+        values[1] = second;
+        if (first > second) {
+            for (int32_t i = 1; i < 7; ++i)
+                values[i + 1] = ((7 - i) * first + i * second) / 7;
+        } else {
+            for (int32_t i = 1; i < 5; ++i)
+                values[i + 1] = ((5 - i) * first + i * second) / 5;
+            values[6] = 0;
+            values[7] = 255;
+        }
+
+        int32_t palette[8][4]{};
+        for (uint32_t i = 0; i < 8; ++i)
+            palette[i][channel] = values[i];
+        return SelectIndices(block, palette, 8, channel, 1, indices);
+    }
+
+    //One channel with eight interpolated values, or six plus 0 and 255
+    void EncodeBC4(const BlockTexels& block, uint32_t channel, Vurl::TextureEncodeQuality quality, uint8_t* output) {
+        int32_t minimum = 255;
+        int32_t maximum = 0;
+        int32_t innerMinimum = 255;
+        int32_t innerMaximum = 0;
+        for (uint32_t i = 0; i < 16; ++i) {
+            int32_t value = block.texels[channel][i];
+            minimum = std::min(minimum, value);
+            maximum = std::max(maximum, value);
+            if (value != 0 && value != 255) {
+                innerMinimum = std::min(innerMinimum, value);
+                innerMaximum = std::max(innerMaximum, value);
+            }
+        }
+
+        uint8_t indices[16]{};
+        int32_t endpoints[2] = { maximum, minimum };
+        uint32_t error = EncodeBC4Mode(block, channel, maximum, minimum, indices);
+
+        //Blocks touching 0 or 255 can spend their interpolated values on the rest of the range
+        if (quality == Vurl::TextureEncodeQuality::High && innerMinimum <= innerMaximum && (minimum == 0 || maximum == 255)) {
+            uint8_t sixValueIndices[16]{};
+            uint32_t sixValueError = EncodeBC4Mode(block, channel, innerMinimum, innerMaximum, sixValueIndices);
+            if (sixValueError < error) {
+                error = sixValueError;
+                endpoints[0] = innerMinimum;
+                endpoints[1] = innerMaximum;
+                memcpy(indices, sixValueIndices, sizeof(indices));
+            }
+        }
+
+        uint64_t packedIndices = 0;
+        for (uint32_t i = 0; i < 16; ++i)
+            packedIndices |= (uint64_t)indices[i] << (i * 3);
+        output[0] = (uint8_t)endpoints[0];
+        output[1] = (uint8_t)endpoints[1];
+        for (uint32_t i = 0; i < 6; ++i)
+            output[2 + i] = (uint8_t)(packedIndices >> (i * 8));
+    }
+
+    struct BitWriter {
+        uint64_t words[2]{};
+        uint32_t position = 0;
+
+        void Write(uint32_t value, uint32_t count) {
+            for (uint32_t i = 0; i < count; ++i, ++position)
+                words[position / 64] |= (uint64_t)((value >> i) & 1) << (position % 64);
+        }
+    };
+
+    void QuantizeBC7Endpoint(const float* color, uint32_t pBit, int32_t* quantized, int32_t* expanded) {
+        for (uint32_t c = 0; c < 4; ++c) {
+            quantized[c] = std::clamp((int32_t)std::lround((color[c] - (float)pBit) / 2.0f), 0, 127);
+            expanded[c] = (quantized[c] << 1) | (int32_t)pBit;
+        }
+    }
+
+    uint32_t GetBC7EndpointError(const float* color, uint32_t pBit) {
+        int32_t quantized[4]{};
+        int32_t expanded[4]{};
+        QuantizeBC7Endpoint(color, pBit, quantized, expanded);
+        float error = 0.0f;
+        for (uint32_t c = 0; c < 4; ++c)
+            error += (color[c] - (float)expanded[c]) * (color[c] - (float)expanded[c]);
+        return (uint32_t)error;
+    }
+
+    //Mode 6: one subset, 7 bit RGBA endpoints with a p-bit each and 4 bit indices
+    void EncodeBC7(const BlockTexels& block, Vurl::TextureEncodeQuality quality, uint8_t* output) {
+        Endpoints endpoints{};
+        FitEndpoints(block, 4, 0xFFFF, quality != Vurl::TextureEncodeQuality::Fast, endpoints);
+
+        float weights[16]{};
+        for (uint32_t i = 0; i < 16; ++i)
+            weights[i] = (float)bc7Weights[i] / 64.0f;
+
+        uint32_t bestError = UINT32_MAX;
+        int32_t bestEndpoints[2][4]{};
+        uint32_t bestPBits[2]{};
+        uint8_t bestIndices[16]{};
+        uint32_t iterationCount = quality == Vurl::TextureEncodeQuality::High ? 3 : 1;
+        for (uint32_t iteration = 0; iteration < iterationCount; ++iteration) {
+            //High quality tries every p-bit pair, otherwise each endpoint takes the p-bit closest to it
+            uint32_t pBitCandidates[4][2] = { { 0, 0 }, { 0, 1 }, { 1, 0 }, { 1, 1 } };
+            uint32_t candidateCount = 4;
+            if (quality != Vurl::TextureEncodeQuality::High) {
+                for (uint32_t e = 0; e < 2; ++e)
+                    pBitCandidates[0][e] = GetBC7EndpointError(endpoints.values[e], 1) < GetBC7EndpointError(endpoints.values[e], 0) ? 1 : 0;
+                candidateCount = 1;
+            }
+
+            uint8_t indices[16]{};
+            for (uint32_t candidate = 0; candidate < candidateCount; ++candidate) {
+                int32_t quantized[2][4]{};
+                int32_t expanded[2][4]{};
+                for (uint32_t e = 0; e < 2; ++e)
+                    QuantizeBC7Endpoint(endpoints.values[e], pBitCandidates[candidate][e], quantized[e], expanded[e]);
+
+                int32_t palette[16][4]{};
+                for (uint32_t i = 0; i < 16; ++i)
+                    for (uint32_t c = 0; c < 4; ++c)
+                        palette[i][c] = ((64 - bc7Weights[i]) * expanded[0][c] + bc7Weights[i] * expanded[1][c] + 32) >> 6;
+
+                uint32_t error = SelectIndices(block, palette, 16, 0, 4, indices);
+                if (error < bestError) {
+                    bestError = error;
+                    memcpy(bestEndpoints, quantized, sizeof(quantized));
+                    bestPBits[0] = pBitCandidates[candidate][0];
+                    bestPBits[1] = pBitCandidates[candidate][1];
+                    memcpy(bestIndices, indices, sizeof(indices));
+                }
+            }
+
+            if (iteration + 1 < iterationCount && !RefineEndpoints(block, 4, 0xFFFF, bestIndices, weights, endpoints))
+                break;
+        }
+
+        //The anchor index is stored without its top bit, flip the block if it is set
+        if (bestIndices[0] >= 8) {
+            std::swap(bestEndpoints[0], bestEndpoints[1]);
+            std::swap(bestPBits[0], bestPBits[1]);
+            for (uint32_t i = 0; i < 16; ++i)
+                bestIndices[i] = (uint8_t)(15 - bestIndices[i]);
+        }
+
+        BitWriter writer{};
+        writer.Write(1 << 6, 7);
+        for (uint32_t c = 0; c < 4; ++c) {
+            writer.Write((uint32_t)bestEndpoints[0][c], 7);
+            writer.Write((uint32_t)bestEndpoints[1][c], 7);
+        }
+        writer.Write(bestPBits[0], 1);
+        writer.Write(bestPBits[1], 1);
+        writer.Write(bestIndices[0], 3);
+        for (uint32_t i = 1; i < 16; ++i)
+            writer.Write(bestIndices[i], 4);
+        memcpy(output, writer.words, sizeof(writer.words));
+    }
+
+    void EncodeBlock(EncodeFormat format, const BlockTexels& block, Vurl::TextureEncodeQuality quality, uint8_t* output) {
+        switch (format) {
+            case EncodeFormat::BC1RGB:
+                EncodeBC1(block, quality, false, output);
+                break;
+            case EncodeFormat::BC1RGBA:
+                EncodeBC1(block, quality, true, output);
+                break;
+            case EncodeFormat::BC3:
+                EncodeBC4(block, 3, quality, output);
+                EncodeBC1(block, quality, false, output + 8);
+                break;
+            case EncodeFormat::BC5:
+                EncodeBC4(block, 0, quality, output);
+                EncodeBC4(block, 1, quality, output + 8);
+                break;
+            case EncodeFormat::BC7:
+                EncodeBC7(block, quality, output);
+                break;
+            default:
+                break;
+        }
+    }
+
+    //2x2 box filter, odd edges repeat the last row and column
+    void Downsample(const uint8_t* source, uint32_t width, uint32_t height, uint8_t* destination) {
+        uint32_t nextWidth = std::max(width / 2, 1u);
+        uint32_t nextHeight = std::max(height / 2, 1u);
+        for (uint32_t y = 0; y < nextHeight; ++y) {
+            uint32_t y0 = std::min(y * 2, height - 1);
+            uint32_t y1 = std::min(y * 2 + 1, height - 1);
+            for (uint32_t x = 0; x < nextWidth; ++x) {
+                uint32_t x0 = std::min(x * 2, width - 1);
+                uint32_t x1 = std::min(x * 2 + 1, width - 1);
+                for (uint32_t c = 0; c < 4; ++c) {
+                    uint32_t sum = source[((size_t)y0 * width + x0) * 4 + c] + source[((size_t)y0 * width + x1) * 4 + c] + 
+                            source[((size_t)y1 * width + x0) * 4 + c] + source[((size_t)y1 * width + x1) * 4 + c];
+                    destination[((size_t)y * nextWidth + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+                }
+            }
+        }
+    }
+
+    //Basic data format descriptor of the block compressed formats, see the Khronos Data Format specification
+    std::vector<uint32_t> GetDataFormatDescriptor(VkFormat format) {
+        EncodeFormat encodeFormat = GetEncodeFormat(format);
+        uint32_t blockSize = Vurl::GetEncodableBlockSize(format);
+
+        uint32_t colorModel = 0;
+        std::vector<std::pair<uint32_t, uint32_t>> samples{};
+        switch (encodeFormat) {
+            case EncodeFormat::BC1RGB:
+                colorModel = 128;
+                samples.push_back({ 0, 0 });
+                break;
+            case EncodeFormat::BC1RGBA:
+                colorModel = 128;
+                samples.push_back({ 1, 0 });
+                break;
+            case EncodeFormat::BC3:
+                colorModel = 130;
+                samples.push_back({ 15, 0 });
+                samples.push_back({ 0, 64 });
+                break;
+            case EncodeFormat::BC5:
+                colorModel = 132;
+                samples.push_back({ 0, 0 });
+                samples.push_back({ 1, 64 });
+                break;
+            default:
+                colorModel = 134;
+                samples.push_back({ 0, 0 });
+                break;
+        }
+
+        uint32_t blockLength = 24 + 16 * (uint32_t)samples.size();
+        uint32_t transfer = IsSrgbFormat(format) ? 2 : 1;
+        std::vector<uint32_t> words{};
+        words.push_back(4 + blockLength);
+        words.push_back(0);
+        words.push_back(2 | (blockLength << 16));
+        words.push_back(colorModel | (1 << 8) | (transfer << 16));
+        words.push_back(3 | (3 << 8));
+        words.push_back(blockSize);
+        words.push_back(0);
+        for (const auto& [channel, bitOffset] : samples) {
+            uint32_t bitLength = blockSize * 8 / (uint32_t)samples.size();
+            words.push_back(bitOffset | ((bitLength - 1) << 16) | (channel << 24));
+            words.push_back(0);
+            words.push_back(0);
+            words.push_back(UINT32_MAX);
+        }
+        return words;
+    }
+}
+
+uint32_t Vurl::GetEncodableBlockSize(VkFormat format) {
+    switch (GetEncodeFormat(format)) {
+        case EncodeFormat::BC1RGB:
+        case EncodeFormat::BC1RGBA:
+            return 8;
+        case EncodeFormat::BC3:
+        case EncodeFormat::BC5:
+        case EncodeFormat::BC7:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+Vurl::TextureEncoder::TextureEncoder(const std::string& cacheDirectory, uint32_t threadCount) : cacheDirectory{ cacheDirectory } {
+    this->threadCount = threadCount > 0 ? threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+Vurl::VurlResult Vurl::TextureEncoder::Encode(const uint8_t* rgba, uint32_t width, uint32_t height, VkFormat format, Ktx2File& file, bool generateMips) {
+    if (!CanEncodeFormat(format))
+        return VURL_ERROR_UNSUPPORTED_TEXTURE_FORMAT;
+    if (rgba == nullptr || width == 0 || height == 0)
+        return VURL_ERROR_TEXTURE_ENCODE_FAILED;
+
+    std::string key = GetCacheKey(rgba, width, height, format, generateMips);
+    std::string path = GetCachePath(key);
+    if (file.Open(path) == VURL_SUCCESS) {
+        const uint8_t* storedKey = nullptr;
+        uint32_t storedKeySize = 0;
+        if (file.GetKeyValue(VURL_TEXTURE_CACHE_KEY, storedKey, storedKeySize) && storedKeySize == key.size() && 
+                memcmp(storedKey, key.data(), key.size()) == 0) {
+            ++cacheHitCount;
+            return VURL_SUCCESS;
+        }
+    }
+    //The mapping would keep a colliding entry from being replaced
+    file.Close();
+
+    ++cacheMissCount;
+    if (!WriteCacheFile(path, key, rgba, width, height, format, generateMips))
+        return VURL_ERROR_TEXTURE_ENCODE_FAILED;
+    return file.Open(path);
+}
+
+bool Vurl::TextureEncoder::EncodeImage(const uint8_t* rgba, uint32_t width, uint32_t height, VkFormat format, uint8_t* blocks) {
+    EncodeFormat encodeFormat = GetEncodeFormat(format);
+    if (encodeFormat == EncodeFormat::None || rgba == nullptr || width == 0 || height == 0)
+        return false;
+
+    uint32_t blockSize = GetEncodableBlockSize(format);
+    uint32_t blockCountX = (width + 3) / 4;
+    uint32_t blockCountY = (height + 3) / 4;
+    TextureEncodeQuality encodeQuality = quality;
+
+    //Workers take block rows until none are left
+    std::atomic<uint32_t> nextRow{ 0 };
+    auto EncodeRows = [&]() {
+        BlockTexels block{};
+        for (uint32_t row = nextRow++; row < blockCountY; row = nextRow++) {
+            uint8_t* output = blocks + (size_t)row * blockCountX * blockSize;
+            for (uint32_t column = 0; column < blockCountX; ++column) {
+                LoadBlock(rgba, width, height, column, row, block);
+                EncodeBlock(encodeFormat, block, encodeQuality, output + (size_t)column * blockSize);
+            }
+        }
+    };
+
+    uint32_t workerCount = std::min(threadCount, blockCountY);
+    std::vector<std::future<void>> workers{};
+    for (uint32_t i = 1; i < workerCount; ++i)
+        workers.push_back(std::async(std::launch::async, EncodeRows));
+    EncodeRows();
+    for (auto& worker : workers)
+        worker.wait();
+
+    return true;
+}
+
+std::string Vurl::TextureEncoder::GetCacheKey(const uint8_t* rgba, uint32_t width, uint32_t height, VkFormat format, bool generateMips) const {
+    //The settings are kept as they are, the texels only as their hash
+    WideHasher contentHasher{};
+    contentHasher.Data(rgba, (size_t)width * height * 4);
+
+    HashKey key{};
+    key.U32(VURL_TEXTURE_ENCODER_VERSION);
+    key.U32(width);
+    key.U32(height);
+    key.U32((uint32_t)format);
+    key.U32((uint32_t)quality);
+    key.U32(generateMips ? 1 : 0);
+    for (uint32_t lane = 0; lane < 2; ++lane) {
+        uint64_t hash = contentHasher.Get(lane);
+        key.U32((uint32_t)hash);
+        key.U32((uint32_t)(hash >> 32));
+    }
+    return key.Get();
+}
+
+std::string Vurl::TextureEncoder::GetCachePath(const std::string& key) const {
+    WideHasher hasher{};
+    hasher.Data(key.data(), key.size());
+
+    char name[40]{};
+    snprintf(name, sizeof(name), "%016llx%016llx", (unsigned long long)hasher.Get(0), (unsigned long long)hasher.Get(1));
+    return (std::filesystem::path{ cacheDirectory } / (std::string{ name } + ".ktx2")).string();
+}
+
+bool Vurl::TextureEncoder::WriteCacheFile(const std::string& path, const std::string& key, const uint8_t* rgba, uint32_t width, uint32_t height, 
+        VkFormat format, bool generateMips) {
+    uint32_t blockSize = GetEncodableBlockSize(format);
+    uint32_t levelCount = generateMips ? GetMipLevelCount(width, height) : 1;
+
+    std::vector<std::vector<uint8_t>> levels(levelCount);
+    std::vector<uint8_t> source{ rgba, rgba + (size_t)width * height * 4 };
+    std::vector<uint8_t> next{};
+    for (uint32_t level = 0; level < levelCount; ++level) {
+        uint32_t levelWidth = std::max(width >> level, 1u);
+        uint32_t levelHeight = std::max(height >> level, 1u);
+        levels[level].resize((size_t)((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * blockSize);
+        if (!EncodeImage(source.data(), levelWidth, levelHeight, format, levels[level].data()))
+            return false;
+
+        if (level + 1 < levelCount) {
+            next.resize((size_t)std::max(levelWidth / 2, 1u) * std::max(levelHeight / 2, 1u) * 4);
+            Downsample(source.data(), levelWidth, levelHeight, next.data());
+            std::swap(source, next);
+        }
+    }
+
+    std::vector<uint32_t> dataFormatDescriptor = GetDataFormatDescriptor(format);
+
+    //One key/value entry, its length, the null terminated name and the key padded to 4 bytes
+    uint32_t keyValueLength = (uint32_t)(sizeof(VURL_TEXTURE_CACHE_KEY) + key.size());
+    std::vector<uint8_t> keyValueData((sizeof(uint32_t) + keyValueLength + 3) & ~(size_t)3);
+    memcpy(keyValueData.data(), &keyValueLength, sizeof(keyValueLength));
+    memcpy(keyValueData.data() + sizeof(uint32_t), VURL_TEXTURE_CACHE_KEY, sizeof(VURL_TEXTURE_CACHE_KEY));
+    memcpy(keyValueData.data() + sizeof(uint32_t) + sizeof(VURL_TEXTURE_CACHE_KEY), key.data(), key.size());
+
+    Ktx2Header header{};
+    const uint8_t identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    memcpy(header.identifier, identifier, sizeof(identifier));
+    header.vkFormat = (uint32_t)format;
+    header.typeSize = 1;
+    header.pixelWidth = width;
+    header.pixelHeight = height;
+    header.layerCount = 0;
+    header.faceCount = 1;
+    header.levelCount = levelCount;
+    header.dfdByteOffset = (uint32_t)(sizeof(Ktx2Header) + levelCount * sizeof(Ktx2Level));
+    header.dfdByteLength = (uint32_t)(dataFormatDescriptor.size() * sizeof(uint32_t));
+    header.kvdByteOffset = header.dfdByteOffset + header.dfdByteLength;
+    header.kvdByteLength = (uint32_t)keyValueData.size();
+
+    //Smallest level first, each aligned to the block size
+    std::vector<Ktx2Level> index(levelCount);
+    uint64_t offset = header.kvdByteOffset + header.kvdByteLength;
+    for (uint32_t level = levelCount; level-- > 0;) {
+        offset = (offset + blockSize - 1) / blockSize * blockSize;
+        index[level].byteOffset = offset;
+        index[level].byteLength = levels[level].size();
+        index[level].uncompressedByteLength = levels[level].size();
+        offset += levels[level].size();
+    }
+
+    std::error_code error{};
+    std::filesystem::create_directories(cacheDirectory, error);
+
+    //Written under a name of its own so a concurrent reader never sees a partial file and concurrent writers of
+    //the same entry never write into each other's file
+    std::random_device random{};
+    char suffix[24]{};
+    snprintf(suffix, sizeof(suffix), ".%08x%08x.tmp", (uint32_t)random(), (uint32_t)random());
+    std::string temporaryPath = path + suffix;
+    bool written = false;
+    {
+        std::ofstream stream{ temporaryPath, std::ios::binary | std::ios::trunc };
+        if (!stream)
+            return false;
+
+        stream.write((const char*)&header, sizeof(header));
+        stream.write((const char*)index.data(), index.size() * sizeof(Ktx2Level));
+        stream.write((const char*)dataFormatDescriptor.data(), dataFormatDescriptor.size() * sizeof(uint32_t));
+        stream.write((const char*)keyValueData.data(), (std::streamsize)keyValueData.size());
+        uint64_t position = header.kvdByteOffset + header.kvdByteLength;
+        for (uint32_t level = levelCount; level-- > 0;) {
+            const char padding[16]{};
+            stream.write(padding, (std::streamsize)(index[level].byteOffset - position));
+            stream.write((const char*)levels[level].data(), (std::streamsize)levels[level].size());
+            position = index[level].byteOffset + index[level].byteLength;
+        }
+        written = (bool)stream;
+    }
+
+    if (written)
+        std::filesystem::rename(temporaryPath, path, error);
+    if (!written || error) {
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include <vurl/texture_streamer.hpp>
+#include <vurl/texture_decoder.hpp>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+
+Vurl::TextureStreamer::TextureStreamer(std::shared_ptr<RenderGraph> graph, uint32_t maxPendingLoads) : graph{ graph } {
+    this->maxPendingLoads = maxPendingLoads > 0 ? maxPendingLoads : std::max(std::thread::hardware_concurrency() / 2, 1u);
+}
+
+Vurl::StreamedTextureHandle Vurl::TextureStreamer::AddTexture(std::shared_ptr<Resource<Texture>> texture, std::shared_ptr<Ktx2File> file, 
+        uint32_t residentLevelCount) {
+    if (texture->IsTransient() || file == nullptr || !file->IsOpen())
+        return VURL_NULL_HANDLE;
+
+    uint32_t fileLevelCount = std::max(file->GetLevelCount(), 1u);
+    uint32_t tailLevel = fileLevelCount - std::clamp(residentLevelCount, 1u, fileLevelCount);
+    if (file->GetLevelCount() == 0)
+        tailLevel = 0;
+    if (graph->CommitTexture(texture, *file, tailLevel) != VURL_SUCCESS)
+        return VURL_NULL_HANDLE;
+
+    StreamedTexture& streamed = textures.emplace_back();
+    streamed.texture = texture;
+    streamed.file = file;
+    streamed.decompress = texture->GetResourceSlice(0)->vkFormat != file->GetFormat();
+    streamed.tailLevel = tailLevel;
+    streamed.requestedLevel = tailLevel;
+    return (int)textures.size() - 1;
+}
+
+void Vurl::TextureStreamer::Remove(StreamedTextureHandle handle) {
+    //Waits for a load still running
+    textures[handle] = {};
+}
+
+void Vurl::TextureStreamer::RequestMipLevel(StreamedTextureHandle handle, uint32_t level) {
+    StreamedTexture& streamed = textures[handle];
+    streamed.frameRequestedLevel = std::min(streamed.frameRequestedLevel, level);
+}
+
+uint32_t Vurl::TextureStreamer::GetResidentMipLevel(StreamedTextureHandle handle) const {
+    return GetResidentMipLevel(textures[handle]);
+}
+
+void Vurl::TextureStreamer::Update() {
+    ReadFeedback();
+
+    std::vector<uint32_t> order{};
+    uint32_t pendingLoadCount = 0;
+    for (uint32_t i = 0; i < textures.size(); ++i) {
+        StreamedTexture& streamed = textures[i];
+        if (streamed.texture == nullptr)
+            continue;
+
+        streamed.requestedLevel = std::min(streamed.requestedLevel, streamed.frameRequestedLevel);
+        streamed.frameRequestedLevel = UINT32_MAX;
+        CollectLoadedLevels(streamed);
+        if (streamed.pendingLoad.valid())
+            ++pendingLoadCount;
+
+        //Evicted textures come back with their tail, loaded levels are uploaded on top once it is committed
+        if (streamed.texture->GetResourceSlice(0)->vkImage == VK_NULL_HANDLE) {
+            graph->CommitTexture(streamed.texture, *streamed.file, streamed.tailLevel);
+            continue;
+        }
+
+        if (streamed.requestedLevel < GetResidentMipLevel(streamed))
+            order.push_back(i);
+    }
+
+    //Textures furthest from their request go first
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return GetResidentMipLevel(textures[a]) - textures[a].requestedLevel > GetResidentMipLevel(textures[b]) - textures[b].requestedLevel;
+    });
+
+    //One level always goes through, a level larger than the budget would otherwise never be uploaded
+    VkDeviceSize remaining = uploadBudget > 0 ? uploadBudget : VK_WHOLE_SIZE;
+    bool uploaded = false;
+    bool limited = false;
+    for (uint32_t i : order) {
+        VkDeviceSize size = UploadLoadedLevels(textures[i], remaining, !uploaded);
+        if (size > 0) {
+            uploaded = true;
+            remaining -= std::min(size, remaining);
+        }
+        limited = limited || !textures[i].loadedLevels.empty();
+    }
+    if (limited)
+        ++statistics.budgetLimitedUpdates;
+
+    for (uint32_t i : order) {
+        if (pendingLoadCount >= maxPendingLoads)
+            break;
+        if (textures[i].pendingLoad.valid())
+            continue;
+
+        StartLoad(textures[i]);
+        if (textures[i].pendingLoad.valid())
+            ++pendingLoadCount;
+    }
+}
+
+void Vurl::TextureStreamer::ReadFeedback() {
+    if (feedbackBuffer == nullptr)
+        return;
+
+    std::shared_ptr<Buffer> slice = feedbackBuffer->GetResourceSlice((uint32_t)(graph->GetFrameIndex() % feedbackBuffer->GetSliceCount()));
+    if (slice->mappedData == nullptr)
+        return;
+
+    VmaAllocator allocator = graph->GetContext()->GetAllocator();
+    vmaInvalidateAllocation(allocator, slice->allocation, 0, VK_WHOLE_SIZE);
+
+    uint32_t* requests = (uint32_t*)slice->mappedData;
+    uint32_t count = (uint32_t)std::min((VkDeviceSize)textures.size(), slice->size / sizeof(uint32_t));
+    for (uint32_t i = 0; i < count; ++i) {
+        if (requests[i] == UINT32_MAX)
+            continue;
+        if (textures[i].texture != nullptr)
+            RequestMipLevel((int)i, requests[i]);
+        requests[i] = UINT32_MAX;
+    }
+
+    vmaFlushAllocation(allocator, slice->allocation, 0, VK_WHOLE_SIZE);
+}
+
+uint32_t Vurl::TextureStreamer::GetResidentMipLevel(const StreamedTexture& streamed) const {
+    std::shared_ptr<Texture> slice = streamed.texture->GetResourceSlice(0);
+    if (slice->vkImage == VK_NULL_HANDLE)
+        return UINT32_MAX;
+    //Files storing only a base level are committed with the whole chain
+    if (streamed.file->GetLevelCount() == 0)
+        return 0;
+    return streamed.file->GetLevelCount() - std::min(slice->mipLevels, streamed.file->GetLevelCount());
+}
+
+void Vurl::TextureStreamer::CollectLoadedLevels(StreamedTexture& streamed) {
+    if (streamed.pendingLoad.valid() && streamed.pendingLoad.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        LoadedLevel loaded = streamed.pendingLoad.get();
+        //A level that fails to load stops streaming past it
+        if (!loaded.valid) {
+            streamed.requestedLevel = std::max(streamed.requestedLevel, loaded.level + 1);
+        } else {
+            statistics.loadedBytes += loaded.data.size();
+            streamed.loadedLevels.push_back(std::move(loaded));
+        }
+    }
+
+    //Levels the texture already has, after an eviction everything loaded is still useful
+    uint32_t residentLevel = GetResidentMipLevel(streamed);
+    std::erase_if(streamed.loadedLevels, [residentLevel](const LoadedLevel& loaded) { return loaded.level >= residentLevel; });
+}
+
+VkDeviceSize Vurl::TextureStreamer::UploadLoadedLevels(StreamedTexture& streamed, VkDeviceSize budget, bool uploadOversized) {
+    uint32_t residentLevel = GetResidentMipLevel(streamed);
+
+    //Only the levels right above the resident ones can be added
+    uint32_t levelCount = 0;
+    VkDeviceSize size = 0;
+    while (levelCount < streamed.loadedLevels.size()) {
+        const LoadedLevel& loaded = streamed.loadedLevels[levelCount];
+        if (loaded.level + 1 + levelCount != residentLevel)
+            break;
+        if (size + loaded.data.size() > budget && !(uploadOversized && levelCount == 0))
+            break;
+        size += loaded.data.size();
+        ++levelCount;
+    }
+    if (levelCount == 0)
+        return 0;
+
+    uint32_t baseLevel = residentLevel - levelCount;
+    std::shared_ptr<Ktx2File> file = streamed.file;
+    VkExtent3D extent = { std::max(file->GetWidth() >> baseLevel, 1u), std::max(file->GetHeight() >> baseLevel, 1u), 
+            std::max(file->GetDepth() >> baseLevel, 1u) };
+    if (!graph->AddTextureMips(streamed.texture, levelCount, extent))
+        return 0;
+
+    uint32_t arrayLayers = streamed.texture->GetResourceSlice(0)->arrayLayers;
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        const LoadedLevel& loaded = streamed.loadedLevels[i];
+        graph->UpdateTexture(streamed.texture, loaded.data.data(), (uint32_t)loaded.data.size(), loaded.level - baseLevel, 0, arrayLayers);
+    }
+    streamed.loadedLevels.erase(streamed.loadedLevels.begin(), streamed.loadedLevels.begin() + levelCount);
+
+    statistics.uploadedBytes += size;
+    statistics.uploadedLevelCount += levelCount;
+    return size;
+}
+
+void Vurl::TextureStreamer::StartLoad(StreamedTexture& streamed) {
+    //Levels load one at a time from the smallest missing one up
+    uint32_t topLevel = streamed.loadedLevels.empty() ? GetResidentMipLevel(streamed) : streamed.loadedLevels.back().level;
+    if (topLevel == 0 || topLevel - 1 < streamed.requestedLevel)
+        return;
+
+    streamed.pendingLoad = std::async(std::launch::async, LoadLevel, streamed.file, topLevel - 1, streamed.decompress);
+}
+
+Vurl::TextureStreamer::LoadedLevel Vurl::TextureStreamer::LoadLevel(std::shared_ptr<Ktx2File> file, uint32_t level, bool decompress) {
+    LoadedLevel loaded{};
+    loaded.level = level;
+
+    //Copying out of the mapping is what reads the level from disk
+    if (decompress) {
+        loaded.valid = DecompressKtx2Level(*file, level, loaded.data);
+    } else {
+        const uint8_t* data = file->GetLevelData(level);
+        loaded.data.assign(data, data + file->GetLevelSize(level));
+        loaded.valid = true;
+    }
+    return loaded;
+}
\ No newline at end of file
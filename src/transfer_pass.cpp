@@ -0,0 +1,78 @@
+#include <vurl/transfer_pass.hpp>
+#include <vurl/render_graph.hpp>
+
+
+void Vurl::TransferPass::CopyBuffer(std::shared_ptr<Resource<Buffer>> src, std::shared_ptr<Resource<Buffer>> dst, 
+        VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset) {
+    TransferOperation operation{};
+    operation.type = TransferOperationType::CopyBuffer;
+    operation.src = graph->GetBufferHandle(src);
+    operation.dst = graph->GetBufferHandle(dst);
+    operation.srcOffset = srcOffset;
+    operation.dstOffset = dstOffset;
+    operation.size = size;
+    AddOperation(operation, false, false);
+}
+
+void Vurl::TransferPass::CopyBufferToImage(std::shared_ptr<Resource<Buffer>> src, std::shared_ptr<Resource<Texture>> dst, VkDeviceSize srcOffset) {
+    TransferOperation operation{};
+    operation.type = TransferOperationType::CopyBufferToImage;
+    operation.src = graph->GetBufferHandle(src);
+    operation.dst = graph->GetTextureHandle(dst);
+    operation.srcOffset = srcOffset;
+    AddOperation(operation, false, true);
+}
+
+void Vurl::TransferPass::CopyImage(std::shared_ptr<Resource<Texture>> src, std::shared_ptr<Resource<Texture>> dst) {
+    TransferOperation operation{};
+    operation.type = TransferOperationType::CopyImage;
+    operation.src = graph->GetTextureHandle(src);
+    operation.dst = graph->GetTextureHandle(dst);
+    AddOperation(operation, true, true);
+}
+
+void Vurl::TransferPass::BlitImage(std::shared_ptr<Resource<Texture>> src, std::shared_ptr<Resource<Texture>> dst, VkFilter filter) {
+    TransferOperation operation{};
+    operation.type = TransferOperationType::BlitImage;
+    operation.src = graph->GetTextureHandle(src);
+    operation.dst = graph->GetTextureHandle(dst);
+    operation.filter = filter;
+    AddOperation(operation, true, true);
+}
+
+void Vurl::TransferPass::FillBuffer(std::shared_ptr<Resource<Buffer>> dst, uint32_t data, VkDeviceSize size, VkDeviceSize dstOffset) {
+    TransferOperation operation{};
+    operation.type = TransferOperationType::FillBuffer;
+    operation.dst = graph->GetBufferHandle(dst);
+    operation.dstOffset = dstOffset;
+    operation.size = size;
+    operation.fillData = data;
+    AddOperation(operation, false, false);
+}
+
+void Vurl::TransferPass::ClearImage(std::shared_ptr<Resource<Texture>> dst, VkClearColorValue color) {
+    TransferOperation operation{};
+    operation.type = TransferOperationType::ClearImage;
+    operation.dst = graph->GetTextureHandle(dst);
+    operation.clearColor = color;
+    AddOperation(operation, false, true);
+}
+
+bool Vurl::TransferPass::IsBufferOnly() const {
+    for (uint32_t i = 0; i < resourceAccesses.size(); ++i)
+        if (resourceAccesses[i].isTexture)
+            return false;
+    return true;
+}
+
+void Vurl::TransferPass::AddOperation(const TransferOperation& operation, bool srcIsTexture, bool dstIsTexture) {
+    //Fill and clear have no source
+    bool hasSource = operation.type != TransferOperationType::FillBuffer && operation.type != TransferOperationType::ClearImage;
+    if ((hasSource && operation.src == VURL_NULL_HANDLE) || operation.dst == VURL_NULL_HANDLE)
+        return;
+
+    operations.push_back(operation);
+    if (hasSource)
+        AddResourceAccess(srcIsTexture, operation.src, ResourceAccessType::TransferRead);
+    AddResourceAccess(dstIsTexture, operation.dst, ResourceAccessType::TransferWrite);
+}
\ No newline at end of file
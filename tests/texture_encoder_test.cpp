@@ -0,0 +1,160 @@
+#include <vurl/texture_encoder.hpp>
+#include <vurl/texture_decoder.hpp>
+#include <vurl/texture.hpp>
+#include <filesystem>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+
+//Encodes a gradient through the texture cache, decodes every level with texture_decoder and compares it with the
+//source downsampled the same way. Takes the cache directory, which is cleared first.
+
+
+namespace {
+    struct RoundTripCase {
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        //Channels the format keeps
+        uint32_t channelCount = 4;
+        //Largest and mean difference of one channel of one texel
+        uint32_t maxError = 0;
+        uint32_t meanError = 0;
+    };
+
+    //Smooth in every channel so each block is close to a line in color space
+    std::vector<uint8_t> CreateGradient(uint32_t width, uint32_t height) {
+        std::vector<uint8_t> rgba((size_t)width * height * 4);
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                uint8_t* texel = rgba.data() + ((size_t)y * width + x) * 4;
+                texel[0] = (uint8_t)(x * 255 / (width - 1));
+                texel[1] = (uint8_t)(y * 255 / (height - 1));
+                texel[2] = (uint8_t)((x + y) * 255 / (width + height - 2));
+                texel[3] = (uint8_t)(255 - y * 255 / (height - 1));
+            }
+        }
+        return rgba;
+    }
+
+    //Same 2x2 box filter as the encoder
+    std::vector<uint8_t> Downsample(const std::vector<uint8_t>& source, uint32_t width, uint32_t height) {
+        uint32_t nextWidth = std::max(width / 2, 1u);
+        uint32_t nextHeight = std::max(height / 2, 1u);
+        std::vector<uint8_t> destination((size_t)nextWidth * nextHeight * 4);
+        for (uint32_t y = 0; y < nextHeight; ++y) {
+            uint32_t y0 = std::min(y * 2, height - 1);
+            uint32_t y1 = std::min(y * 2 + 1, height - 1);
+            for (uint32_t x = 0; x < nextWidth; ++x) {
+                uint32_t x0 = std::min(x * 2, width - 1);
+                uint32_t x1 = std::min(x * 2 + 1, width - 1);
+                for (uint32_t c = 0; c < 4; ++c) {
+                    uint32_t sum = source[((size_t)y0 * width + x0) * 4 + c] + source[((size_t)y0 * width + x1) * 4 + c] + 
+                            source[((size_t)y1 * width + x0) * 4 + c] + source[((size_t)y1 * width + x1) * 4 + c];
+                    destination[((size_t)y * nextWidth + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+                }
+            }
+        }
+        return destination;
+    }
+
+    bool CheckRoundTrip(Vurl::TextureEncoder& encoder, const RoundTripCase& roundTripCase, const std::vector<uint8_t>& rgba, 
+            uint32_t width, uint32_t height) {
+        Vurl::Ktx2File file{};
+        Vurl::VurlResult result = encoder.Encode(rgba.data(), width, height, roundTripCase.format, file);
+        if (result != Vurl::VURL_SUCCESS) {
+            printf("format %d: encode failed, %s\n", roundTripCase.format, Vurl::GetErrorMessage(result));
+            return false;
+        }
+
+        uint32_t levelCount = Vurl::GetMipLevelCount(width, height);
+        if (file.GetFormat() != roundTripCase.format || file.GetWidth() != width || file.GetHeight() != height || file.GetLevelCount() != levelCount) {
+            printf("format %d: cached file does not describe the source\n", roundTripCase.format);
+            return false;
+        }
+
+        std::vector<uint8_t> source = rgba;
+        for (uint32_t level = 0; level < levelCount; ++level) {
+            uint32_t levelWidth = std::max(width >> level, 1u);
+            uint32_t levelHeight = std::max(height >> level, 1u);
+
+            std::vector<uint8_t> texels{};
+            if (!Vurl::DecompressKtx2Level(file, level, texels) || texels.size() != source.size()) {
+                printf("format %d: level %u could not be decoded\n", roundTripCase.format, level);
+                return false;
+            }
+
+            //Levels under two blocks across hold most of the gradient in one block, the line between two endpoints
+            //a block stores cannot follow it, only their size is checked
+            if (std::min(levelWidth, levelHeight) < 8) {
+                if (level + 1 < levelCount)
+                    source = Downsample(source, levelWidth, levelHeight);
+                continue;
+            }
+
+            uint32_t maxError = 0;
+            uint64_t errorSum = 0;
+            for (size_t i = 0; i < texels.size(); ++i) {
+                if (i % 4 >= roundTripCase.channelCount)
+                    continue;
+                uint32_t error = (uint32_t)std::abs((int)texels[i] - (int)source[i]);
+                maxError = std::max(maxError, error);
+                errorSum += error;
+            }
+            uint64_t sampleCount = (uint64_t)levelWidth * levelHeight * roundTripCase.channelCount;
+            if (maxError > roundTripCase.maxError || errorSum > sampleCount * roundTripCase.meanError) {
+                printf("format %d: level %u differs by up to %u, %.2f on average\n", roundTripCase.format, level, maxError, 
+                        (double)errorSum / (double)sampleCount);
+                return false;
+            }
+
+            if (level + 1 < levelCount)
+                source = Downsample(source, levelWidth, levelHeight);
+        }
+
+        //The second lookup of the same source finds the entry just written
+        uint32_t cacheHitCount = encoder.GetCacheHitCount();
+        Vurl::Ktx2File cachedFile{};
+        if (encoder.Encode(rgba.data(), width, height, roundTripCase.format, cachedFile) != Vurl::VURL_SUCCESS || 
+                encoder.GetCacheHitCount() != cacheHitCount + 1) {
+            printf("format %d: cached entry was not reused\n", roundTripCase.format);
+            return false;
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::filesystem::path cacheDirectory = argc > 1 ? argv[1] : "texture_cache";
+    std::error_code error{};
+    std::filesystem::remove_all(cacheDirectory, error);
+
+    //Not a multiple of the block size, so edge blocks and the odd downsampling edges are covered
+    const uint32_t width = 70;
+    const uint32_t height = 38;
+    std::vector<uint8_t> rgba = CreateGradient(width, height);
+
+    //BC7 has no CPU decoder to compare against
+    const RoundTripCase roundTripCases[] = {
+        { VK_FORMAT_BC1_RGB_UNORM_BLOCK, 3, 40, 10 },
+        { VK_FORMAT_BC3_UNORM_BLOCK, 4, 40, 10 },
+        { VK_FORMAT_BC3_SRGB_BLOCK, 4, 40, 10 },
+        { VK_FORMAT_BC5_UNORM_BLOCK, 2, 8, 2 }
+    };
+
+    Vurl::TextureEncoder encoder{ cacheDirectory.string() };
+    bool passed = true;
+    for (const RoundTripCase& roundTripCase : roundTripCases)
+        passed = CheckRoundTrip(encoder, roundTripCase, rgba, width, height) && passed;
+
+    //Another quality is another entry
+    encoder.SetQuality(Vurl::TextureEncodeQuality::High);
+    uint32_t cacheMissCount = encoder.GetCacheMissCount();
+    passed = CheckRoundTrip(encoder, roundTripCases[0], rgba, width, height) && passed;
+    if (encoder.GetCacheMissCount() != cacheMissCount + 1) {
+        printf("a different quality reused the cached entry\n");
+        passed = false;
+    }
+
+    printf("%s\n", passed ? "passed" : "failed");
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
\ No newline at end of file